@@ -71,8 +71,9 @@ void main()
     highp vec3 model_tangent;
     if (enable_vertex_blending > 0.0)
     {
-        highp ivec4 in_indices = indices_and_weights[gl_VertexIndex].indices;
-        highp vec4  in_weights = indices_and_weights[gl_VertexIndex].weights;
+        highp int joint_binding_index = gl_VertexIndex + mesh_instances[gl_InstanceIndex].joint_binding_index_offset;
+        highp ivec4 in_indices = indices_and_weights[joint_binding_index].indices;
+        highp vec4  in_weights = indices_and_weights[joint_binding_index].weights;
 
         highp mat4 vertex_blending_matrix = mat4x4(
             vec4(0.0, 0.0, 0.0, 0.0), vec4(0.0, 0.0, 0.0, 0.0), vec4(0.0, 0.0, 0.0, 0.0), vec4(0.0, 0.0, 0.0, 0.0));
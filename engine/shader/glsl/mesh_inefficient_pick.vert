@@ -17,6 +17,7 @@ layout(set = 0, binding = 1) readonly buffer _unused_name_perdrawcall
     mat4 model_matrices[m_mesh_per_drawcall_max_instance_count];
     uint node_ids[m_mesh_per_drawcall_max_instance_count];
     float enable_vertex_blendings[m_mesh_per_drawcall_max_instance_count];
+    int joint_binding_index_offsets[m_mesh_per_drawcall_max_instance_count];
 };
 
 layout(set = 0, binding = 2) readonly buffer _unused_name_per_drawcall_vertex_blending
@@ -41,8 +42,9 @@ void main()
     highp vec3 model_position;
     if (enable_vertex_blending > 0.0)
     {
-        highp ivec4 in_indices = indices_and_weights[gl_VertexIndex].indices;
-        highp vec4 in_weights = indices_and_weights[gl_VertexIndex].weights;
+        highp int joint_binding_index = gl_VertexIndex + joint_binding_index_offsets[gl_InstanceIndex];
+        highp ivec4 in_indices = indices_and_weights[joint_binding_index].indices;
+        highp vec4 in_weights = indices_and_weights[joint_binding_index].weights;
 
         highp mat4 vertex_blending_matrix = mat4x4(
             vec4(0.0, 0.0, 0.0, 0.0),
@@ -1,7 +1,7 @@
 struct VulkanMeshInstance
 {
     highp float enable_vertex_blending;
-    highp float _padding_enable_vertex_blending_1;
+    highp int   joint_binding_index_offset; // gl_VertexIndex includes the vertex offset of the draw
     highp float _padding_enable_vertex_blending_2;
     highp float _padding_enable_vertex_blending_3;
     highp mat4  model_matrix;
@@ -12,3 +12,36 @@ struct VulkanMeshVertexJointBinding
     highp ivec4 indices;
     highp vec4  weights;
 };
+
+struct MeshCullingInstance
+{
+    highp mat4  model_matrix;
+    highp vec4  bounding_box_min; // world space, w unused
+    highp vec4  bounding_box_max;
+    highp uint  batch_index; // ~0u for a free slot
+    highp uint  joint_matrix_offset;
+    highp int   joint_binding_index_offset;
+    highp float enable_vertex_blending;
+};
+
+struct MeshCullingBatch
+{
+    highp uint index_count;
+    highp uint first_index;
+    highp int  vertex_offset;
+    highp uint first_instance;
+    highp uint instance_count;
+    highp uint material_index;
+    highp uint first_command;
+    highp uint _padding_first_command;
+};
+
+// layout of VkDrawIndexedIndirectCommand
+struct MeshCullingDrawCommand
+{
+    highp uint index_count;
+    highp uint instance_count;
+    highp uint first_index;
+    highp int  vertex_offset;
+    highp uint first_instance;
+};
@@ -367,6 +367,15 @@ namespace Piccolo
                         }
                         ImGui::EndMenu();
                     }
+                    if (ImGui::BeginMenu("Rendering"))
+                    {
+                        bool gpu_driven_mesh_draw = g_runtime_global_context.m_render_system->isGpuDrivenMeshDrawActive();
+                        if (ImGui::MenuItem(gpu_driven_mesh_draw ? "off gpu driven mesh draw" : "gpu driven mesh draw"))
+                        {
+                            g_runtime_global_context.m_render_system->setGpuDrivenMeshDrawEnabled(!gpu_driven_mesh_draw);
+                        }
+                        ImGui::EndMenu();
+                    }
                     ImGui::EndMenu();
                 }
                 if (ImGui::MenuItem("Exit"))
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "generator/generator.h"
+
+namespace Generator
+{
+    class BinarySerializerGenerator : public GeneratorInterface
+    {
+    public:
+        BinarySerializerGenerator() = delete;
+        BinarySerializerGenerator(std::string source_directory, std::function<std::string(std::string)> get_include_function);
+
+        virtual int generate(std::string path, SchemaMoudle schema) override;
+
+        virtual void finish() override;
+
+        virtual ~BinarySerializerGenerator() override;
+
+    protected:
+        virtual void prepareStatus(std::string path) override;
+
+        virtual std::string processFileName(std::string path) override;
+
+    private:
+        Mustache::data m_class_defines {Mustache::data::type::list};
+        Mustache::data m_include_headfiles {Mustache::data::type::list};
+    };
+}
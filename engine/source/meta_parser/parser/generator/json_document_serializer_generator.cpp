@@ -0,0 +1,111 @@
+#include "generator/json_document_serializer_generator.h"
+#include "common/precompiled.h"
+#include "language_types/class.h"
+
+namespace Generator
+{
+    JsonDocumentSerializerGenerator::JsonDocumentSerializerGenerator(
+        std::string                             source_directory,
+        std::function<std::string(std::string)> get_include_function) :
+        GeneratorInterface(source_directory + "/_generated/serializer", source_directory, get_include_function)
+    {
+        prepareStatus(m_out_path);
+    }
+
+    void JsonDocumentSerializerGenerator::prepareStatus(std::string path)
+    {
+        GeneratorInterface::prepareStatus(path);
+        TemplateManager::getInstance()->loadTemplates(m_root_path, "allJsonDocumentSerializer.h");
+        TemplateManager::getInstance()->loadTemplates(m_root_path, "allJsonDocumentSerializer.ipp");
+        TemplateManager::getInstance()->loadTemplates(m_root_path, "commonJsonDocumentSerializerGenFile");
+        return;
+    }
+
+    std::string JsonDocumentSerializerGenerator::processFileName(std::string path)
+    {
+        auto relativeDir = fs::path(path).filename().replace_extension("json_document_serializer.gen.h").string();
+        return m_out_path + "/" + relativeDir;
+    }
+    int JsonDocumentSerializerGenerator::generate(std::string path, SchemaMoudle schema)
+    {
+        std::string file_path = processFileName(path);
+
+        Mustache::data muatache_data;
+        Mustache::data include_headfiles(Mustache::data::type::list);
+        Mustache::data class_defines(Mustache::data::type::list);
+
+        include_headfiles.push_back(
+            Mustache::data("headfile_name", Utils::makeRelativePath(m_root_path, path).string()));
+        for (auto class_temp : schema.classes)
+        {
+            if (!class_temp->shouldCompileFields())
+                continue;
+
+            Mustache::data class_def;
+            genClassRenderData(class_temp, class_def);
+
+            // deal base class
+            for (int index = 0; index < class_temp->m_base_classes.size(); ++index)
+            {
+                auto include_file = m_get_include_func(class_temp->m_base_classes[index]->name);
+                if (!include_file.empty())
+                {
+                    auto include_file_base = processFileName(include_file);
+                    if (file_path != include_file_base)
+                    {
+                        include_headfiles.push_back(Mustache::data(
+                            "headfile_name", Utils::makeRelativePath(m_root_path, include_file_base).string()));
+                    }
+                }
+            }
+            for (auto field : class_temp->m_fields)
+            {
+                if (!field->shouldCompile())
+                    continue;
+                // deal vector
+                if (field->m_type.find("std::vector") == 0)
+                {
+                    auto include_file = m_get_include_func(field->m_name);
+                    if (!include_file.empty())
+                    {
+                        auto include_file_base = processFileName(include_file);
+                        if (file_path != include_file_base)
+                        {
+                            include_headfiles.push_back(Mustache::data(
+                                "headfile_name", Utils::makeRelativePath(m_root_path, include_file_base).string()));
+                        }
+                    }
+                }
+                // deal normal
+            }
+            class_defines.push_back(class_def);
+            m_class_defines.push_back(class_def);
+        }
+
+        muatache_data.set("class_defines", class_defines);
+        muatache_data.set("include_headfiles", include_headfiles);
+        std::string render_string =
+            TemplateManager::getInstance()->renderByTemplate("commonJsonDocumentSerializerGenFile", muatache_data);
+        Utils::saveFile(render_string, file_path);
+
+        m_include_headfiles.push_back(
+            Mustache::data("headfile_name", Utils::makeRelativePath(m_root_path, file_path).string()));
+        return 0;
+    }
+
+    void JsonDocumentSerializerGenerator::finish()
+    {
+        Mustache::data mustache_data;
+        mustache_data.set("class_defines", m_class_defines);
+        mustache_data.set("include_headfiles", m_include_headfiles);
+
+        std::string render_string =
+            TemplateManager::getInstance()->renderByTemplate("allJsonDocumentSerializer.h", mustache_data);
+        Utils::saveFile(render_string, m_out_path + "/all_json_document_serializer.h");
+        render_string =
+            TemplateManager::getInstance()->renderByTemplate("allJsonDocumentSerializer.ipp", mustache_data);
+        Utils::saveFile(render_string, m_out_path + "/all_json_document_serializer.ipp");
+    }
+
+    JsonDocumentSerializerGenerator::~JsonDocumentSerializerGenerator() {}
+}
@@ -1,5 +1,7 @@
 #include "common/precompiled.h"
 #include "language_types/class.h"
+#include "generator/binary_serializer_generator.h"
+#include "generator/json_document_serializer_generator.h"
 #include "generator/reflection_generator.h"
 #include "generator/serializer_generator.h"
 #include "parser.h"
@@ -50,6 +52,10 @@ MetaParser::MetaParser(const std::string project_input_file,
 
     m_generators.emplace_back(new Generator::SerializerGenerator(
         m_work_paths[0], std::bind(&MetaParser::getIncludeFile, this, std::placeholders::_1)));
+    m_generators.emplace_back(new Generator::BinarySerializerGenerator(
+        m_work_paths[0], std::bind(&MetaParser::getIncludeFile, this, std::placeholders::_1)));
+    m_generators.emplace_back(new Generator::JsonDocumentSerializerGenerator(
+        m_work_paths[0], std::bind(&MetaParser::getIncludeFile, this, std::placeholders::_1)));
     m_generators.emplace_back(new Generator::ReflectionGenerator(
         m_work_paths[0], std::bind(&MetaParser::getIncludeFile, this, std::placeholders::_1)));
 }
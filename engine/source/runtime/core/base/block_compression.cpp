@@ -0,0 +1,171 @@
+#include "runtime/core/base/block_compression.h"
+
+#include <cstring>
+
+namespace Sammi
+{
+    namespace
+    {
+        constexpr size_t   k_min_match_length {4};
+        constexpr size_t   k_last_literal_count {5};  // the block always ends with at least 5 literals
+        constexpr size_t   k_match_start_margin {12}; // no match starts in the last 12 bytes
+        constexpr size_t   k_max_match_offset {65535};
+        constexpr uint32_t k_hash_bits {16};
+
+        uint32_t readU32(const uint8_t* data)
+        {
+            uint32_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        uint32_t hashSequence(uint32_t sequence) { return (sequence * 2654435761u) >> (32 - k_hash_bits); }
+
+        void writeLength(std::vector<uint8_t>& out, size_t length)
+        {
+            for (; length >= 255; length -= 255)
+            {
+                out.push_back(255);
+            }
+            out.push_back(static_cast<uint8_t>(length));
+        }
+
+        void writeSequence(std::vector<uint8_t>& out,
+                           const uint8_t*        literals,
+                           size_t                literal_count,
+                           size_t                match_offset,
+                           size_t                match_length)
+        {
+            const size_t match_code = match_length == 0 ? 0 : match_length - k_min_match_length;
+
+            const uint8_t token = static_cast<uint8_t>(((literal_count < 15 ? literal_count : 15) << 4) |
+                                                       (match_code < 15 ? match_code : 15));
+            out.push_back(token);
+            if (literal_count >= 15)
+            {
+                writeLength(out, literal_count - 15);
+            }
+            out.insert(out.end(), literals, literals + literal_count);
+
+            // the last sequence carries literals only
+            if (match_length == 0)
+                return;
+
+            out.push_back(static_cast<uint8_t>(match_offset & 0xFF));
+            out.push_back(static_cast<uint8_t>(match_offset >> 8));
+            if (match_code >= 15)
+            {
+                writeLength(out, match_code - 15);
+            }
+        }
+
+        bool readLength(const uint8_t*& in, const uint8_t* in_end, size_t& length)
+        {
+            uint8_t extra;
+            do
+            {
+                if (in >= in_end)
+                    return false;
+                extra = *in++;
+                length += extra;
+            } while (extra == 255);
+            return true;
+        }
+    } // namespace
+
+    size_t getMaxCompressedBlockSize(size_t size) { return size + size / 255 + 16; }
+
+    void compressBlock(const uint8_t* data, size_t size, std::vector<uint8_t>& out_compressed)
+    {
+        out_compressed.clear();
+        out_compressed.reserve(getMaxCompressedBlockSize(size));
+
+        size_t anchor = 0;
+        if (size > k_match_start_margin)
+        {
+            // positions of the last 4 byte sequence seen per hash, greedy single probe like the fast LZ4 mode
+            std::vector<uint32_t> hash_table(size_t(1) << k_hash_bits, UINT32_MAX);
+
+            const size_t match_start_limit = size - k_match_start_margin;
+            const size_t match_end_limit   = size - k_last_literal_count;
+
+            size_t position = 0;
+            while (position < match_start_limit)
+            {
+                const uint32_t sequence  = readU32(data + position);
+                uint32_t&      slot      = hash_table[hashSequence(sequence)];
+                const size_t   candidate = slot;
+                slot                     = static_cast<uint32_t>(position);
+
+                if (candidate == UINT32_MAX || position - candidate > k_max_match_offset ||
+                    readU32(data + candidate) != sequence)
+                {
+                    ++position;
+                    continue;
+                }
+
+                size_t match_length = k_min_match_length;
+                while (position + match_length < match_end_limit &&
+                       data[candidate + match_length] == data[position + match_length])
+                {
+                    ++match_length;
+                }
+
+                writeSequence(out_compressed, data + anchor, position - anchor, position - candidate, match_length);
+                position += match_length;
+                anchor = position;
+            }
+        }
+
+        writeSequence(out_compressed, data + anchor, size - anchor, 0, 0);
+    }
+
+    bool decompressBlock(const uint8_t* compressed, size_t compressed_size, uint8_t* out_data, size_t size)
+    {
+        const uint8_t* in      = compressed;
+        const uint8_t* in_end  = compressed + compressed_size;
+        uint8_t*       out     = out_data;
+        uint8_t* const out_end = out_data + size;
+
+        while (in < in_end)
+        {
+            const uint8_t token = *in++;
+
+            size_t literal_count = token >> 4;
+            if (literal_count == 15 && !readLength(in, in_end, literal_count))
+                return false;
+            if (literal_count > static_cast<size_t>(in_end - in) || literal_count > static_cast<size_t>(out_end - out))
+                return false;
+            std::memcpy(out, in, literal_count);
+            in += literal_count;
+            out += literal_count;
+
+            if (in == in_end)
+                break;
+
+            if (in_end - in < 2)
+                return false;
+            const size_t match_offset = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+            in += 2;
+            if (match_offset == 0 || match_offset > static_cast<size_t>(out - out_data))
+                return false;
+
+            size_t match_length = token & 0x0F;
+            if (match_length == 15 && !readLength(in, in_end, match_length))
+                return false;
+            match_length += k_min_match_length;
+            if (match_length > static_cast<size_t>(out_end - out))
+                return false;
+
+            // byte copy, the match may overlap the bytes it produces
+            const uint8_t* match = out - match_offset;
+            for (size_t i = 0; i < match_length; ++i)
+            {
+                out[i] = match[i];
+            }
+            out += match_length;
+        }
+
+        return out == out_end;
+    }
+} // namespace Sammi
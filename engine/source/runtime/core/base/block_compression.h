@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Sammi
+{
+    /// Byte-oriented LZ compression in the LZ4 block format (no frame header, no checksum), so blocks written here
+    /// can be inspected with any LZ4 block decoder. Decompression is a bounds checked copy loop with no tables,
+    /// fast enough to run on the loading threads for every compressed pak entry.
+
+    // worst case size of a compressed block, incompressible data grows by one byte every 255 bytes
+    size_t getMaxCompressedBlockSize(size_t size);
+
+    // replaces the content of out_compressed
+    void compressBlock(const uint8_t* data, size_t size, std::vector<uint8_t>& out_compressed);
+
+    // the decompressed size must be known, it is stored by the caller; false on corrupt input
+    bool decompressBlock(const uint8_t* compressed, size_t compressed_size, uint8_t* out_data, size_t size);
+} // namespace Sammi
@@ -0,0 +1,140 @@
+#include "runtime/core/base/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace Sammi
+{
+    ThreadPool::ThreadPool(size_t thread_count)
+    {
+        if (thread_count == 0)
+        {
+            const size_t hardware_thread_count = std::thread::hardware_concurrency();
+            thread_count                       = hardware_thread_count > 1 ? hardware_thread_count - 1 : 1;
+        }
+
+        m_workers.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i)
+        {
+            m_workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_is_stopping = true;
+        }
+        m_condition.notify_all();
+
+        for (std::thread& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this] { return m_is_stopping || !m_tasks.empty(); });
+                if (m_is_stopping && m_tasks.empty())
+                    return;
+
+                task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::future<void> ThreadPool::submit(std::function<void()> task)
+    {
+        // packaged_task is move only, std::function needs a copyable callable
+        auto packaged_task = std::make_shared<std::packaged_task<void()>>(std::move(task));
+        std::future<void> future = packaged_task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.emplace_back([packaged_task]() { (*packaged_task)(); });
+        }
+        m_condition.notify_one();
+        return future;
+    }
+
+    void ThreadPool::parallelFor(size_t count, size_t grain_size, const std::function<void(size_t, size_t)>& task)
+    {
+        if (count == 0)
+            return;
+
+        grain_size               = std::max<size_t>(grain_size, 1);
+        const size_t chunk_count = (count + grain_size - 1) / grain_size;
+        if (chunk_count == 1 || m_workers.empty())
+        {
+            task(0, count);
+            return;
+        }
+
+        std::atomic<size_t>     next_chunk {0};
+        size_t                  pending_helper_count = std::min(m_workers.size(), chunk_count - 1);
+        std::mutex              done_mutex;
+        std::condition_variable done_condition;
+        std::exception_ptr      first_exception;
+
+        // an exception must not leave a helper, the first one is kept and rethrown on the calling thread
+        auto run_chunks = [&]() {
+            try
+            {
+                for (size_t chunk = next_chunk.fetch_add(1); chunk < chunk_count; chunk = next_chunk.fetch_add(1))
+                {
+                    const size_t begin = chunk * grain_size;
+                    task(begin, std::min(begin + grain_size, count));
+                }
+            }
+            catch (...)
+            {
+                // the chunks not started yet are skipped
+                next_chunk.store(chunk_count);
+
+                std::lock_guard<std::mutex> done_lock(done_mutex);
+                if (!first_exception)
+                {
+                    first_exception = std::current_exception();
+                }
+            }
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (size_t i = 0; i < pending_helper_count; ++i)
+            {
+                m_tasks.emplace_back([&]() {
+                    run_chunks();
+
+                    std::lock_guard<std::mutex> done_lock(done_mutex);
+                    if (--pending_helper_count == 0)
+                    {
+                        done_condition.notify_one();
+                    }
+                });
+            }
+        }
+        m_condition.notify_all();
+
+        run_chunks();
+
+        // helpers reference this stack frame, wait until every one of them has left it
+        std::unique_lock<std::mutex> done_lock(done_mutex);
+        done_condition.wait(done_lock, [&] { return pending_helper_count == 0; });
+
+        if (first_exception)
+        {
+            std::rethrow_exception(first_exception);
+        }
+    }
+} // namespace Sammi
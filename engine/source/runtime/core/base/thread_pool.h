@@ -0,0 +1,44 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Sammi
+{
+    /// Fixed-size worker pool shared by the engine systems.
+    /// parallelFor lets the calling thread take chunks too, so it must not be called from inside a pool task.
+    class ThreadPool final
+    {
+    public:
+        // 0 means one worker per hardware thread minus the calling thread
+        explicit ThreadPool(size_t thread_count = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&)            = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t getThreadCount() const { return m_workers.size(); }
+
+        // run task(begin, end) over [0, count) in chunks of at most grain_size, block until all chunks finished.
+        // If a chunk throws, the remaining chunks are skipped and the first exception is rethrown here
+        void parallelFor(size_t count, size_t grain_size, const std::function<void(size_t, size_t)>& task);
+
+        // queue a task without waiting for it
+        std::future<void> submit(std::function<void()> task);
+
+    private:
+        void workerLoop();
+
+        std::vector<std::thread>          m_workers;
+        std::deque<std::function<void()>> m_tasks;
+        std::mutex                        m_mutex;
+        std::condition_variable           m_condition;
+        bool                              m_is_stopping {false};
+    };
+} // namespace Sammi
@@ -3,9 +3,13 @@
 #include "runtime/core/meta/json.h"
 #include "runtime/core/meta/reflection/reflection.h"
 #include "runtime/core/meta/reflection/reflection_register.h"
+#include "runtime/core/meta/serializer/binary_serializer.h"
+#include "runtime/core/meta/serializer/json_document_serializer.h"
 #include "runtime/core/meta/serializer/serializer.h"
 
 #include "_generated/reflection/all_reflection.h"
+#include "_generated/serializer/all_binary_serializer.ipp"
+#include "_generated/serializer/all_json_document_serializer.ipp"
 #include "_generated/serializer/all_serializer.ipp"
 
 namespace Piccolo
@@ -0,0 +1,210 @@
+#include "runtime/core/meta/serializer/binary_serializer.h"
+
+#include <cstring>
+
+namespace Piccolo
+{
+    void BinaryWriter::writeBytes(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+    }
+
+    size_t BinaryWriter::beginField(uint32_t tag)
+    {
+        writeValue(tag);
+        const size_t field_begin = m_buffer.size();
+        writeValue(static_cast<uint32_t>(0));
+        return field_begin;
+    }
+
+    void BinaryWriter::endField(size_t field_begin)
+    {
+        const uint32_t payload_size = static_cast<uint32_t>(m_buffer.size() - field_begin - sizeof(uint32_t));
+        std::memcpy(m_buffer.data() + field_begin, &payload_size, sizeof(uint32_t));
+    }
+
+    void BinaryWriter::endObject() { writeValue(static_cast<uint32_t>(0)); }
+
+    bool BinaryReader::readBytes(void* data, size_t size)
+    {
+        if (m_is_failed || size > m_size - m_position)
+        {
+            m_is_failed = true;
+            return false;
+        }
+        std::memcpy(data, m_data + m_position, size);
+        m_position += size;
+        return true;
+    }
+
+    bool BinaryReader::beginField(uint32_t& out_tag, size_t& out_field_end)
+    {
+        if (!readValue(out_tag) || out_tag == 0)
+            return false;
+
+        uint32_t payload_size = 0;
+        if (!readValue(payload_size) || payload_size > m_size - m_position)
+        {
+            m_is_failed = true;
+            return false;
+        }
+        out_field_end = m_position + payload_size;
+        return true;
+    }
+
+    void BinaryReader::endField(size_t field_end)
+    {
+        // a field reader that ran past its payload read a different layout than was written
+        if (m_position > field_end)
+        {
+            m_is_failed = true;
+            return;
+        }
+        m_position = field_end;
+    }
+
+    std::unordered_map<std::string, BinarySerializer::TypeFunctions>& BinarySerializer::getTypeFunctions()
+    {
+        static std::unordered_map<std::string, TypeFunctions> type_functions;
+        return type_functions;
+    }
+
+    void BinarySerializer::registerType(const std::string& type_name, ReadByNameFunc read_func, WriteByNameFunc write_func)
+    {
+        getTypeFunctions()[type_name] = TypeFunctions {read_func, write_func};
+    }
+
+    void* BinarySerializer::readByName(const std::string& type_name, BinaryReader& reader)
+    {
+        auto find_it = getTypeFunctions().find(type_name);
+        if (find_it != getTypeFunctions().end())
+        {
+            return find_it->second.m_read(reader);
+        }
+
+        // the type is gone from the schema, skip its fields so the rest of the archive still loads
+        uint32_t tag;
+        size_t   field_end;
+        while (reader.beginField(tag, field_end))
+        {
+            reader.endField(field_end);
+        }
+        return nullptr;
+    }
+
+    void BinarySerializer::writeByName(const std::string& type_name, BinaryWriter& writer, const void* instance)
+    {
+        auto find_it = getTypeFunctions().find(type_name);
+        if (find_it != getTypeFunctions().end())
+        {
+            find_it->second.m_write(writer, instance);
+        }
+        else
+        {
+            // an empty object, readers skip it like an unknown type
+            writer.endObject();
+        }
+    }
+
+    template<>
+    void BinarySerializer::write(BinaryWriter& writer, const char& instance)
+    {
+        writer.writeValue(instance);
+    }
+    template<>
+    char& BinarySerializer::read(BinaryReader& reader, char& instance)
+    {
+        reader.readValue(instance);
+        return instance;
+    }
+
+    template<>
+    void BinarySerializer::write(BinaryWriter& writer, const int& instance)
+    {
+        writer.writeValue(instance);
+    }
+    template<>
+    int& BinarySerializer::read(BinaryReader& reader, int& instance)
+    {
+        reader.readValue(instance);
+        return instance;
+    }
+
+    template<>
+    void BinarySerializer::write(BinaryWriter& writer, const unsigned int& instance)
+    {
+        writer.writeValue(instance);
+    }
+    template<>
+    unsigned int& BinarySerializer::read(BinaryReader& reader, unsigned int& instance)
+    {
+        reader.readValue(instance);
+        return instance;
+    }
+
+    template<>
+    void BinarySerializer::write(BinaryWriter& writer, const float& instance)
+    {
+        writer.writeValue(instance);
+    }
+    template<>
+    float& BinarySerializer::read(BinaryReader& reader, float& instance)
+    {
+        reader.readValue(instance);
+        return instance;
+    }
+
+    template<>
+    void BinarySerializer::write(BinaryWriter& writer, const double& instance)
+    {
+        writer.writeValue(instance);
+    }
+    template<>
+    double& BinarySerializer::read(BinaryReader& reader, double& instance)
+    {
+        reader.readValue(instance);
+        return instance;
+    }
+
+    template<>
+    void BinarySerializer::write(BinaryWriter& writer, const bool& instance)
+    {
+        writer.writeValue(static_cast<uint8_t>(instance ? 1 : 0));
+    }
+    template<>
+    bool& BinarySerializer::read(BinaryReader& reader, bool& instance)
+    {
+        uint8_t value = 0;
+        reader.readValue(value);
+        return instance = value != 0;
+    }
+
+    template<>
+    void BinarySerializer::write(BinaryWriter& writer, const std::string& instance)
+    {
+        writer.writeValue(static_cast<uint32_t>(instance.size()));
+        writer.writeBytes(instance.data(), instance.size());
+    }
+    template<>
+    std::string& BinarySerializer::read(BinaryReader& reader, std::string& instance)
+    {
+        uint32_t size = 0;
+        instance.clear();
+        if (reader.readValue(size))
+        {
+            // checked before resizing so a corrupt size fails the read instead of allocating it
+            if (size > reader.getRemaining())
+            {
+                reader.fail();
+                return instance;
+            }
+            instance.resize(size);
+            if (!reader.readBytes(&instance[0], size))
+            {
+                instance.clear();
+            }
+        }
+        return instance;
+    }
+} // namespace Piccolo
@@ -0,0 +1,306 @@
+#pragma once
+#include "runtime/core/meta/reflection/reflection.h"
+#include "runtime/core/meta/serializer/serializer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace Piccolo
+{
+    // archive header: magic, version, then the root object
+    constexpr uint32_t k_binary_archive_magic {0x4E494250}; // "PBIN"
+    constexpr uint32_t k_binary_archive_version {1};
+
+    /// Byte buffer the binary serializers append to. Objects are a list of fields, each field is a
+    /// 32-bit tag (hash of the field name), a 32-bit payload size and the payload, closed by a zero tag.
+    class BinaryWriter
+    {
+    public:
+        void writeBytes(const void* data, size_t size);
+
+        template<typename T>
+        void writeValue(const T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "BinaryWriter::writeValue needs a trivially copyable type");
+            writeBytes(&value, sizeof(T));
+        }
+
+        // returns the position endField patches the payload size into
+        size_t beginField(uint32_t tag);
+        void   endField(size_t field_begin);
+        void   endObject();
+
+        const std::vector<uint8_t>& getBuffer() const { return m_buffer; }
+        std::vector<uint8_t>&       getBuffer() { return m_buffer; }
+
+    private:
+        std::vector<uint8_t> m_buffer;
+    };
+
+    /// Bounds checked reader over a binary archive, a failed read leaves the reader invalid and all later reads fail.
+    class BinaryReader
+    {
+    public:
+        BinaryReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+
+        bool readBytes(void* data, size_t size);
+
+        template<typename T>
+        bool readValue(T& value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "BinaryReader::readValue needs a trivially copyable type");
+            return readBytes(&value, sizeof(T));
+        }
+
+        // reads the next field header of the current object, false at the closing tag or on error
+        bool beginField(uint32_t& out_tag, size_t& out_field_end);
+        // moves to the end of the field whatever the field reader consumed, fields of a changed type are skipped
+        void endField(size_t field_end);
+
+        bool   isValid() const { return !m_is_failed; }
+        size_t getPosition() const { return m_position; }
+        size_t getRemaining() const { return m_size - m_position; }
+        // marks the archive as corrupt, for checks the reader can't do itself
+        void fail() { m_is_failed = true; }
+
+    private:
+        const uint8_t* m_data {nullptr};
+        size_t         m_size {0};
+        size_t         m_position {0};
+        bool           m_is_failed {false};
+    };
+
+    /// Binary counterpart of Serializer. The reflected types get their read/write specializations from the meta
+    /// parser (all_binary_serializer.h), fields are matched by tag, so added fields keep their default value
+    /// and removed fields are skipped.
+    class BinarySerializer
+    {
+    public:
+        typedef void* (*ReadByNameFunc)(BinaryReader&);
+        typedef void (*WriteByNameFunc)(BinaryWriter&, const void*);
+
+        // FNV-1a, 0 is reserved for the end of an object
+        static constexpr uint32_t getFieldTag(const char* field_name)
+        {
+            uint32_t hash = 2166136261u;
+            for (const char* c = field_name; *c != '\0'; ++c)
+            {
+                hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+            }
+            return hash == 0 ? 1 : hash;
+        }
+
+        // polymorphic ReflectionPtr fields are resolved by type name, the generated registerTypes fills the table
+        static void  registerTypes();
+        static void  registerType(const std::string& type_name, ReadByNameFunc read_func, WriteByNameFunc write_func);
+        static void* readByName(const std::string& type_name, BinaryReader& reader);
+        static void  writeByName(const std::string& type_name, BinaryWriter& writer, const void* instance);
+
+        template<typename T>
+        static void* readNew(BinaryReader& reader)
+        {
+            T* instance = new T;
+            read(reader, *instance);
+            return instance;
+        }
+
+        template<typename T>
+        static void writeErased(BinaryWriter& writer, const void* instance)
+        {
+            write(writer, *static_cast<const T*>(instance));
+        }
+
+        // archive entry points, the root object is preceded by the magic and the version
+        template<typename T>
+        static void writeArchive(BinaryWriter& writer, const T& instance)
+        {
+            writer.writeValue(k_binary_archive_magic);
+            writer.writeValue(k_binary_archive_version);
+            write(writer, instance);
+        }
+
+        template<typename T>
+        static bool readArchive(BinaryReader& reader, T& instance)
+        {
+            uint32_t magic   = 0;
+            uint32_t version = 0;
+            if (!reader.readValue(magic) || !reader.readValue(version) || magic != k_binary_archive_magic ||
+                version > k_binary_archive_version)
+            {
+                return false;
+            }
+            read(reader, instance);
+            return reader.isValid();
+        }
+
+        template<typename T>
+        static void write(BinaryWriter& writer, const std::vector<T>& instance)
+        {
+            writer.writeValue(static_cast<uint32_t>(instance.size()));
+            for (const T& element : instance)
+            {
+                write(writer, element);
+            }
+        }
+
+        template<typename T>
+        static std::vector<T>& read(BinaryReader& reader, std::vector<T>& instance)
+        {
+            uint32_t count = 0;
+            instance.clear();
+            if (!reader.readValue(count))
+                return instance;
+
+            // every element takes at least one byte, a larger count comes from a truncated or corrupt archive
+            if (count > reader.getRemaining())
+            {
+                reader.fail();
+                return instance;
+            }
+
+            instance.resize(count);
+            for (T& element : instance)
+            {
+                read(reader, element);
+                if (!reader.isValid())
+                {
+                    instance.clear();
+                    break;
+                }
+            }
+            return instance;
+        }
+
+        // same convention as the Json serializer: "*" stores the declared type, otherwise the dynamic type name
+        template<typename T>
+        static void writePointer(BinaryWriter& writer, const std::string& type_name, const T* instance)
+        {
+            if (instance == nullptr)
+            {
+                write(writer, std::string());
+                return;
+            }
+            write(writer, type_name);
+            if (type_name == "*")
+            {
+                write(writer, *instance);
+            }
+            else
+            {
+                writeByName(type_name, writer, instance);
+            }
+        }
+
+        template<typename T>
+        static T*& readPointer(BinaryReader& reader, std::string& out_type_name, T*& instance)
+        {
+            instance = nullptr;
+            read(reader, out_type_name);
+            if (out_type_name.empty())
+                return instance;
+
+            if (out_type_name == "*")
+            {
+                instance = new T;
+                read(reader, *instance);
+            }
+            else
+            {
+                instance = static_cast<T*>(readByName(out_type_name, reader));
+            }
+            return instance;
+        }
+
+        template<typename T>
+        static void write(BinaryWriter& writer, const Reflection::ReflectionPtr<T>& instance)
+        {
+            writePointer(writer, instance.getTypeName(), static_cast<const T*>(instance.operator->()));
+        }
+
+        template<typename T>
+        static T*& read(BinaryReader& reader, Reflection::ReflectionPtr<T>& instance)
+        {
+            std::string type_name;
+            T*&         instance_ptr = readPointer(reader, type_name, instance.getPtrReference());
+            instance.setTypeName(type_name);
+            return instance_ptr;
+        }
+
+        template<typename T>
+        static void write(BinaryWriter& writer, const T& instance)
+        {
+            if constexpr (std::is_pointer<T>::value)
+            {
+                writePointer(writer, "*", instance);
+            }
+            else
+            {
+                static_assert(always_false<T>, "BinarySerializer::write<T> has not been implemented yet!");
+            }
+        }
+
+        template<typename T>
+        static T& read(BinaryReader& reader, T& instance)
+        {
+            if constexpr (std::is_pointer<T>::value)
+            {
+                std::string type_name;
+                return readPointer(reader, type_name, instance);
+            }
+            else
+            {
+                static_assert(always_false<T>, "BinarySerializer::read<T> has not been implemented yet!");
+                return instance;
+            }
+        }
+
+    private:
+        struct TypeFunctions
+        {
+            ReadByNameFunc  m_read;
+            WriteByNameFunc m_write;
+        };
+
+        static std::unordered_map<std::string, TypeFunctions>& getTypeFunctions();
+    };
+
+    // implementation of base types
+    template<>
+    void BinarySerializer::write(BinaryWriter& writer, const char& instance);
+    template<>
+    char& BinarySerializer::read(BinaryReader& reader, char& instance);
+
+    template<>
+    void BinarySerializer::write(BinaryWriter& writer, const int& instance);
+    template<>
+    int& BinarySerializer::read(BinaryReader& reader, int& instance);
+
+    template<>
+    void BinarySerializer::write(BinaryWriter& writer, const unsigned int& instance);
+    template<>
+    unsigned int& BinarySerializer::read(BinaryReader& reader, unsigned int& instance);
+
+    template<>
+    void BinarySerializer::write(BinaryWriter& writer, const float& instance);
+    template<>
+    float& BinarySerializer::read(BinaryReader& reader, float& instance);
+
+    template<>
+    void BinarySerializer::write(BinaryWriter& writer, const double& instance);
+    template<>
+    double& BinarySerializer::read(BinaryReader& reader, double& instance);
+
+    template<>
+    void BinarySerializer::write(BinaryWriter& writer, const bool& instance);
+    template<>
+    bool& BinarySerializer::read(BinaryReader& reader, bool& instance);
+
+    template<>
+    void BinarySerializer::write(BinaryWriter& writer, const std::string& instance);
+    template<>
+    std::string& BinarySerializer::read(BinaryReader& reader, std::string& instance);
+} // namespace Piccolo
@@ -0,0 +1,565 @@
+#include "runtime/core/meta/serializer/json_document_serializer.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace Piccolo
+{
+    namespace
+    {
+        // same limit as json11, deeper documents are rejected instead of overflowing the stack
+        constexpr uint32_t k_max_json_depth = 200;
+
+        bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+        int getHexValue(char c)
+        {
+            if (c >= '0' && c <= '9')
+                return c - '0';
+            if (c >= 'a' && c <= 'f')
+                return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F')
+                return c - 'A' + 10;
+            return -1;
+        }
+
+        uint32_t readHex4(const char* text)
+        {
+            uint32_t code_point = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                code_point = (code_point << 4) | static_cast<uint32_t>(getHexValue(text[i]));
+            }
+            return code_point;
+        }
+
+        void appendUtf8(std::string& out_string, uint32_t code_point)
+        {
+            if (code_point < 0x80)
+            {
+                out_string += static_cast<char>(code_point);
+            }
+            else if (code_point < 0x800)
+            {
+                out_string += static_cast<char>(0xC0 | (code_point >> 6));
+                out_string += static_cast<char>(0x80 | (code_point & 0x3F));
+            }
+            else if (code_point < 0x10000)
+            {
+                out_string += static_cast<char>(0xE0 | (code_point >> 12));
+                out_string += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+                out_string += static_cast<char>(0x80 | (code_point & 0x3F));
+            }
+            else
+            {
+                out_string += static_cast<char>(0xF0 | (code_point >> 18));
+                out_string += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+                out_string += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+                out_string += static_cast<char>(0x80 | (code_point & 0x3F));
+            }
+        }
+
+        // the parser has validated the escapes, a lone surrogate is kept as is like json11 does
+        void decodeString(const char* text, uint32_t size, std::string& out_string)
+        {
+            out_string.clear();
+            out_string.reserve(size);
+            for (uint32_t i = 0; i < size; ++i)
+            {
+                if (text[i] != '\\')
+                {
+                    out_string += text[i];
+                    continue;
+                }
+
+                const char escape = text[++i];
+                switch (escape)
+                {
+                    case 'b':
+                        out_string += '\b';
+                        break;
+                    case 'f':
+                        out_string += '\f';
+                        break;
+                    case 'n':
+                        out_string += '\n';
+                        break;
+                    case 'r':
+                        out_string += '\r';
+                        break;
+                    case 't':
+                        out_string += '\t';
+                        break;
+                    case 'u':
+                    {
+                        uint32_t code_point = readHex4(text + i + 1);
+                        i += 4;
+                        if (code_point >= 0xD800 && code_point <= 0xDBFF && i + 6 < size && text[i + 1] == '\\' &&
+                            text[i + 2] == 'u')
+                        {
+                            const uint32_t low_surrogate = readHex4(text + i + 3);
+                            if (low_surrogate >= 0xDC00 && low_surrogate <= 0xDFFF)
+                            {
+                                code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+                                i += 6;
+                            }
+                        }
+                        appendUtf8(out_string, code_point);
+                        break;
+                    }
+                    default:
+                        // '"', '\\' and '/' stand for themselves
+                        out_string += escape;
+                        break;
+                }
+            }
+        }
+    } // namespace
+
+    JsonNodeType JsonNode::getType() const
+    {
+        return m_document ? m_document->m_nodes[m_index].m_type : JsonNodeType::null_value;
+    }
+
+    bool JsonNode::getBool() const { return isBool() && m_document->m_nodes[m_index].m_bool; }
+
+    double JsonNode::getNumber() const { return isNumber() ? m_document->m_nodes[m_index].m_number : 0.0; }
+
+    void JsonNode::getString(std::string& out_string) const
+    {
+        if (!isString())
+        {
+            out_string.clear();
+            return;
+        }
+
+        const JsonDocument::Node& node = m_document->m_nodes[m_index];
+        if (node.m_has_escapes)
+        {
+            decodeString(m_document->m_text + node.m_offset, node.m_size, out_string);
+        }
+        else
+        {
+            out_string.assign(m_document->m_text + node.m_offset, node.m_size);
+        }
+    }
+
+    std::string JsonNode::getString() const
+    {
+        std::string string;
+        getString(string);
+        return string;
+    }
+
+    uint32_t JsonNode::getSize() const { return (isArray() || isObject()) ? m_document->m_nodes[m_index].m_size : 0; }
+
+    JsonNode JsonNode::getFirstChild() const
+    {
+        // children are stored right after their parent
+        return getSize() > 0 ? JsonNode(m_document, m_index + 1) : JsonNode();
+    }
+
+    JsonNode JsonNode::getNextSibling() const
+    {
+        if (!m_document)
+            return JsonNode();
+
+        const uint32_t next = m_document->m_nodes[m_index].m_next;
+        return next != 0 ? JsonNode(m_document, next) : JsonNode();
+    }
+
+    std::string_view JsonNode::getKey() const
+    {
+        if (!m_document)
+            return std::string_view();
+
+        const JsonDocument::Node& node = m_document->m_nodes[m_index];
+        return std::string_view(m_document->m_text + node.m_key_offset, node.m_key_size);
+    }
+
+    JsonNode JsonNode::operator[](std::string_view key) const
+    {
+        if (!isObject())
+            return JsonNode();
+
+        for (JsonNode member = getFirstChild(); member.isValid(); member = member.getNextSibling())
+        {
+            if (member.getKey() == key)
+                return member;
+        }
+        return JsonNode();
+    }
+
+    Json JsonNode::toJson() const
+    {
+        switch (getType())
+        {
+            case JsonNodeType::boolean:
+                return Json(getBool());
+            case JsonNodeType::number:
+                return Json(getNumber());
+            case JsonNodeType::string:
+                return Json(getString());
+            case JsonNodeType::array:
+            {
+                Json::array array;
+                array.reserve(getSize());
+                for (JsonNode element = getFirstChild(); element.isValid(); element = element.getNextSibling())
+                {
+                    array.push_back(element.toJson());
+                }
+                return Json(std::move(array));
+            }
+            case JsonNodeType::object:
+            {
+                Json::object object;
+                std::string  key;
+                for (JsonNode member = getFirstChild(); member.isValid(); member = member.getNextSibling())
+                {
+                    const JsonDocument::Node& node = m_document->m_nodes[member.m_index];
+                    if (node.m_key_has_escapes)
+                    {
+                        decodeString(m_document->m_text + node.m_key_offset, node.m_key_size, key);
+                    }
+                    else
+                    {
+                        key.assign(m_document->m_text + node.m_key_offset, node.m_key_size);
+                    }
+                    object[key] = member.toJson();
+                }
+                return Json(std::move(object));
+            }
+            default:
+                return Json();
+        }
+    }
+
+    bool JsonDocument::parse(const char* text, size_t size, std::shared_ptr<const void> text_owner)
+    {
+        m_text       = text;
+        m_size       = size;
+        m_text_owner = std::move(text_owner);
+        m_nodes.clear();
+        m_error.clear();
+
+        if (size > std::numeric_limits<uint32_t>::max())
+            return fail("document too large", 0);
+
+        // pretty printed assets average well over 16 bytes per value, one reallocation at most in practice
+        m_nodes.reserve(size / 32 + 1);
+
+        size_t position = 0;
+        skipWhitespace(position);
+        if (!parseValue(position, 0))
+            return false;
+
+        skipWhitespace(position);
+        if (position != m_size)
+            return fail("unexpected trailing characters", position);
+        return true;
+    }
+
+    bool JsonDocument::parseValue(size_t& position, uint32_t depth)
+    {
+        if (position >= m_size)
+            return fail("unexpected end of input", position);
+
+        const char c = m_text[position];
+        if (c == '{' || c == '[')
+        {
+            if (depth >= k_max_json_depth)
+                return fail("exceeded maximum nesting depth", position);
+            return parseContainer(position, depth + 1, c == '{' ? JsonNodeType::object : JsonNodeType::array);
+        }
+
+        m_nodes.emplace_back();
+        Node& node = m_nodes.back();
+        if (c == '"')
+        {
+            node.m_type = JsonNodeType::string;
+            return parseString(position, node.m_offset, node.m_size, node.m_has_escapes);
+        }
+        if (c == '-' || isDigit(c))
+        {
+            node.m_type = JsonNodeType::number;
+            return parseNumber(position, node.m_number);
+        }
+        if (c == 't' || c == 'f')
+        {
+            node.m_type = JsonNodeType::boolean;
+            node.m_bool = c == 't';
+            return parseLiteral(position, c == 't' ? "true" : "false");
+        }
+        if (c == 'n')
+        {
+            node.m_type = JsonNodeType::null_value;
+            return parseLiteral(position, "null");
+        }
+        return fail("unexpected character", position);
+    }
+
+    bool JsonDocument::parseContainer(size_t& position, uint32_t depth, JsonNodeType type)
+    {
+        const uint32_t container_index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.emplace_back();
+        m_nodes[container_index].m_type = type;
+
+        const bool is_object   = type == JsonNodeType::object;
+        const char closing     = is_object ? '}' : ']';
+        uint32_t   child_count = 0;
+        uint32_t   last_child  = 0;
+
+        ++position;
+        skipWhitespace(position);
+        if (position < m_size && m_text[position] == closing)
+        {
+            ++position;
+            return true;
+        }
+
+        while (true)
+        {
+            uint32_t key_offset      = 0;
+            uint32_t key_size        = 0;
+            bool     key_has_escapes = false;
+            if (is_object)
+            {
+                if (position >= m_size || m_text[position] != '"')
+                    return fail("expected '\"' in object", position);
+                if (!parseString(position, key_offset, key_size, key_has_escapes))
+                    return false;
+
+                skipWhitespace(position);
+                if (position >= m_size || m_text[position] != ':')
+                    return fail("expected ':' in object", position);
+                ++position;
+                skipWhitespace(position);
+            }
+
+            // the node array may grow while the child is parsed, only indices are kept across the call
+            const uint32_t child_index = static_cast<uint32_t>(m_nodes.size());
+            if (!parseValue(position, depth))
+                return false;
+
+            Node& child             = m_nodes[child_index];
+            child.m_key_offset      = key_offset;
+            child.m_key_size        = key_size;
+            child.m_key_has_escapes = key_has_escapes;
+            if (child_count > 0)
+            {
+                m_nodes[last_child].m_next = child_index;
+            }
+            last_child = child_index;
+            ++child_count;
+
+            skipWhitespace(position);
+            if (position >= m_size)
+                return fail("unexpected end of input", position);
+            if (m_text[position] == closing)
+            {
+                ++position;
+                break;
+            }
+            if (m_text[position] != ',')
+                return fail(is_object ? "expected ',' in object" : "expected ',' in list", position);
+            ++position;
+            skipWhitespace(position);
+        }
+
+        m_nodes[container_index].m_size = child_count;
+        return true;
+    }
+
+    bool JsonDocument::parseString(size_t& position, uint32_t& out_offset, uint32_t& out_size, bool& out_has_escapes)
+    {
+        const size_t begin = ++position;
+        out_has_escapes    = false;
+        while (position < m_size)
+        {
+            const char c = m_text[position];
+            if (c == '"')
+            {
+                out_offset = static_cast<uint32_t>(begin);
+                out_size   = static_cast<uint32_t>(position - begin);
+                ++position;
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20)
+                return fail("unescaped control character in string", position);
+
+            if (c == '\\')
+            {
+                out_has_escapes = true;
+                if (++position >= m_size)
+                    break;
+
+                const char escape = m_text[position];
+                if (escape == 'u')
+                {
+                    if (m_size - position <= 4)
+                        break;
+                    for (size_t i = 1; i <= 4; ++i)
+                    {
+                        if (getHexValue(m_text[position + i]) < 0)
+                            return fail("bad \\u escape", position);
+                    }
+                    position += 4;
+                }
+                else if (std::strchr("\"\\/bfnrt", escape) == nullptr || escape == '\0')
+                {
+                    return fail("invalid escape character", position);
+                }
+            }
+            ++position;
+        }
+        return fail("unexpected end of input in string", position);
+    }
+
+    bool JsonDocument::parseNumber(size_t& position, double& out_number)
+    {
+        const size_t begin = position;
+        if (m_text[position] == '-')
+            ++position;
+
+        if (position < m_size && m_text[position] == '0')
+        {
+            ++position;
+        }
+        else if (position < m_size && isDigit(m_text[position]))
+        {
+            while (position < m_size && isDigit(m_text[position]))
+                ++position;
+        }
+        else
+        {
+            return fail("invalid number", position);
+        }
+
+        if (position < m_size && m_text[position] == '.')
+        {
+            ++position;
+            if (position >= m_size || !isDigit(m_text[position]))
+                return fail("at least one digit required in fractional part", position);
+            while (position < m_size && isDigit(m_text[position]))
+                ++position;
+        }
+
+        if (position < m_size && (m_text[position] == 'e' || m_text[position] == 'E'))
+        {
+            ++position;
+            if (position < m_size && (m_text[position] == '+' || m_text[position] == '-'))
+                ++position;
+            if (position >= m_size || !isDigit(m_text[position]))
+                return fail("at least one digit required in exponent", position);
+            while (position < m_size && isDigit(m_text[position]))
+                ++position;
+        }
+
+        // strtod needs a terminated string and the text is not, numbers in assets always fit the local buffer
+        const size_t length = position - begin;
+        char         number_text[64];
+        if (length < sizeof(number_text))
+        {
+            std::memcpy(number_text, m_text + begin, length);
+            number_text[length] = '\0';
+            out_number          = std::strtod(number_text, nullptr);
+        }
+        else
+        {
+            out_number = std::strtod(std::string(m_text + begin, length).c_str(), nullptr);
+        }
+        return true;
+    }
+
+    bool JsonDocument::parseLiteral(size_t& position, const char* literal)
+    {
+        const size_t length = std::strlen(literal);
+        if (m_size - position < length || std::memcmp(m_text + position, literal, length) != 0)
+            return fail("invalid literal", position);
+        position += length;
+        return true;
+    }
+
+    void JsonDocument::skipWhitespace(size_t& position) const
+    {
+        while (position < m_size)
+        {
+            const char c = m_text[position];
+            if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+                break;
+            ++position;
+        }
+    }
+
+    bool JsonDocument::fail(const char* error, size_t position)
+    {
+        m_error = std::string(error) + " at offset " + std::to_string(position);
+        m_nodes.clear();
+        return false;
+    }
+
+    std::unordered_map<std::string, JsonDocumentSerializer::ReadByNameFunc>& JsonDocumentSerializer::getReadFunctions()
+    {
+        static std::unordered_map<std::string, ReadByNameFunc> read_functions;
+        return read_functions;
+    }
+
+    void JsonDocumentSerializer::registerType(const std::string& type_name, ReadByNameFunc read_func)
+    {
+        getReadFunctions()[type_name] = read_func;
+    }
+
+    void* JsonDocumentSerializer::readByName(const std::string& type_name, const JsonNode& json_node)
+    {
+        auto find_it = getReadFunctions().find(type_name);
+        if (find_it != getReadFunctions().end())
+        {
+            return find_it->second(json_node);
+        }
+        return Reflection::TypeMeta::newFromNameAndJson(type_name, json_node.toJson()).m_instance;
+    }
+
+    template<>
+    char& JsonDocumentSerializer::read(const JsonNode& json_node, char& instance)
+    {
+        return instance = static_cast<char>(json_node.getNumber());
+    }
+
+    template<>
+    int& JsonDocumentSerializer::read(const JsonNode& json_node, int& instance)
+    {
+        return instance = static_cast<int>(json_node.getNumber());
+    }
+
+    template<>
+    unsigned int& JsonDocumentSerializer::read(const JsonNode& json_node, unsigned int& instance)
+    {
+        return instance = static_cast<unsigned int>(json_node.getNumber());
+    }
+
+    template<>
+    float& JsonDocumentSerializer::read(const JsonNode& json_node, float& instance)
+    {
+        return instance = static_cast<float>(json_node.getNumber());
+    }
+
+    template<>
+    double& JsonDocumentSerializer::read(const JsonNode& json_node, double& instance)
+    {
+        return instance = json_node.getNumber();
+    }
+
+    template<>
+    bool& JsonDocumentSerializer::read(const JsonNode& json_node, bool& instance)
+    {
+        return instance = json_node.getBool();
+    }
+
+    template<>
+    std::string& JsonDocumentSerializer::read(const JsonNode& json_node, std::string& instance)
+    {
+        json_node.getString(instance);
+        return instance;
+    }
+} // namespace Piccolo
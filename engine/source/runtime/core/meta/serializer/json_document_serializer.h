@@ -0,0 +1,218 @@
+#pragma once
+#include "runtime/core/meta/reflection/reflection.h"
+#include "runtime/core/meta/serializer/serializer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Piccolo
+{
+    enum class JsonNodeType : uint8_t
+    {
+        null_value,
+        boolean,
+        number,
+        string,
+        array,
+        object,
+    };
+
+    class JsonDocument;
+
+    /// Handle to one value of a JsonDocument, only valid while the document lives. Reading a missing member or a
+    /// value of another type gives the same defaults as json11 (0, false, empty string, no children).
+    class JsonNode
+    {
+    public:
+        JsonNode() = default;
+        JsonNode(const JsonDocument* document, uint32_t index) : m_document(document), m_index(index) {}
+
+        bool         isValid() const { return m_document != nullptr; }
+        JsonNodeType getType() const;
+        bool         isNull() const { return getType() == JsonNodeType::null_value; }
+        bool         isBool() const { return getType() == JsonNodeType::boolean; }
+        bool         isNumber() const { return getType() == JsonNodeType::number; }
+        bool         isString() const { return getType() == JsonNodeType::string; }
+        bool         isArray() const { return getType() == JsonNodeType::array; }
+        bool         isObject() const { return getType() == JsonNodeType::object; }
+
+        bool   getBool() const;
+        double getNumber() const;
+        // escape sequences are decoded here, the parser only validates them
+        void        getString(std::string& out_string) const;
+        std::string getString() const;
+
+        // element count of an array, member count of an object
+        uint32_t getSize() const;
+        // first element or member, the others follow through getNextSibling
+        JsonNode getFirstChild() const;
+        JsonNode getNextSibling() const;
+        // key of an object member as written in the file, escape sequences are not decoded
+        std::string_view getKey() const;
+        // linear in the member count, an invalid node when the member is missing
+        JsonNode operator[](std::string_view key) const;
+
+        // deep copy for the readers that only take json11 values
+        Json toJson() const;
+
+    private:
+        const JsonDocument* m_document {nullptr};
+        uint32_t            m_index {0};
+    };
+
+    /// JSON parsed without copying the text: strings stay in the source buffer and all values are stored in one
+    /// node array, children directly after their parent, so a document costs a single allocation however many
+    /// values it has. The text must outlive the document unless text_owner keeps it alive.
+    class JsonDocument
+    {
+    public:
+        bool parse(const char* text, size_t size, std::shared_ptr<const void> text_owner = nullptr);
+
+        JsonNode           getRoot() const { return m_nodes.empty() ? JsonNode() : JsonNode(this, 0); }
+        const std::string& getError() const { return m_error; }
+
+    private:
+        friend class JsonNode;
+
+        struct Node
+        {
+            JsonNodeType m_type {JsonNodeType::null_value};
+            bool         m_has_escapes {false};
+            bool         m_key_has_escapes {false};
+            // next sibling, 0 after the last child since the root is never a sibling
+            uint32_t m_next {0};
+            // string length or child count
+            uint32_t m_size {0};
+            uint32_t m_key_offset {0};
+            uint32_t m_key_size {0};
+            union
+            {
+                double   m_number;
+                bool     m_bool;
+                uint32_t m_offset;
+            };
+        };
+
+        bool parseValue(size_t& position, uint32_t depth);
+        bool parseContainer(size_t& position, uint32_t depth, JsonNodeType type);
+        bool parseString(size_t& position, uint32_t& out_offset, uint32_t& out_size, bool& out_has_escapes);
+        bool parseNumber(size_t& position, double& out_number);
+        bool parseLiteral(size_t& position, const char* literal);
+        void skipWhitespace(size_t& position) const;
+        bool fail(const char* error, size_t position);
+
+        const char*                 m_text {nullptr};
+        size_t                      m_size {0};
+        std::shared_ptr<const void> m_text_owner;
+        std::vector<Node>           m_nodes;
+        std::string                 m_error;
+    };
+
+    /// Reads reflected types straight from a JsonDocument, without building json11 values. The reflected types get
+    /// their read specializations from the meta parser (all_json_document_serializer.h), members are matched by name
+    /// like the Json serializer, unknown members are skipped and missing ones keep their default value.
+    class JsonDocumentSerializer
+    {
+    public:
+        typedef void* (*ReadByNameFunc)(const JsonNode&);
+
+        // polymorphic ReflectionPtr members are resolved by type name, the generated registerTypes fills the table;
+        // unregistered types fall back to the Json reflection path
+        static void  registerTypes();
+        static void  registerType(const std::string& type_name, ReadByNameFunc read_func);
+        static void* readByName(const std::string& type_name, const JsonNode& json_node);
+
+        template<typename T>
+        static void* readNew(const JsonNode& json_node)
+        {
+            T* instance = new T;
+            read(json_node, *instance);
+            return instance;
+        }
+
+        template<typename T>
+        static std::vector<T>& read(const JsonNode& json_node, std::vector<T>& instance)
+        {
+            instance.clear();
+            instance.resize(json_node.isArray() ? json_node.getSize() : 0);
+
+            JsonNode element = json_node.getFirstChild();
+            for (T& value : instance)
+            {
+                read(element, value);
+                element = element.getNextSibling();
+            }
+            return instance;
+        }
+
+        // same layout as the Json serializer: "$typeName" is "*" for the declared type, otherwise the dynamic type
+        template<typename T>
+        static T*& readPointer(const JsonNode& json_node, std::string& out_type_name, T*& instance)
+        {
+            instance = nullptr;
+            json_node["$typeName"].getString(out_type_name);
+            if (out_type_name.empty())
+                return instance;
+
+            const JsonNode context = json_node["$context"];
+            if ('*' == out_type_name[0])
+            {
+                instance = new T;
+                read(context, *instance);
+            }
+            else
+            {
+                instance = static_cast<T*>(readByName(out_type_name, context));
+            }
+            return instance;
+        }
+
+        template<typename T>
+        static T*& read(const JsonNode& json_node, Reflection::ReflectionPtr<T>& instance)
+        {
+            std::string type_name;
+            T*&         instance_ptr = readPointer(json_node, type_name, instance.getPtrReference());
+            instance.setTypeName(type_name);
+            return instance_ptr;
+        }
+
+        template<typename T>
+        static T& read(const JsonNode& json_node, T& instance)
+        {
+            if constexpr (std::is_pointer<T>::value)
+            {
+                std::string type_name;
+                return readPointer(json_node, type_name, instance);
+            }
+            else
+            {
+                static_assert(always_false<T>, "JsonDocumentSerializer::read<T> has not been implemented yet!");
+                return instance;
+            }
+        }
+
+    private:
+        static std::unordered_map<std::string, ReadByNameFunc>& getReadFunctions();
+    };
+
+    // implementation of base types
+    template<>
+    char& JsonDocumentSerializer::read(const JsonNode& json_node, char& instance);
+    template<>
+    int& JsonDocumentSerializer::read(const JsonNode& json_node, int& instance);
+    template<>
+    unsigned int& JsonDocumentSerializer::read(const JsonNode& json_node, unsigned int& instance);
+    template<>
+    float& JsonDocumentSerializer::read(const JsonNode& json_node, float& instance);
+    template<>
+    double& JsonDocumentSerializer::read(const JsonNode& json_node, double& instance);
+    template<>
+    bool& JsonDocumentSerializer::read(const JsonNode& json_node, bool& instance);
+    template<>
+    std::string& JsonDocumentSerializer::read(const JsonNode& json_node, std::string& instance);
+} // namespace Piccolo
@@ -3,6 +3,8 @@
 // 包含核心功能头文件
 #include "runtime/core/base/macro.h"                               // 宏定义（如ASSERT、LOG_INFO等）
 #include "runtime/core/meta/reflection/reflection_register.h"      // 反射系统注册（用于类型元信息管理）
+#include "runtime/core/meta/serializer/binary_serializer.h"        // 二进制序列化（.pbin资产的多态类型表）
+#include "runtime/core/meta/serializer/json_document_serializer.h" // JSON资产直接反序列化（多态类型表）
 
 // 包含各功能模块头文件（引擎核心子系统）
 #include "runtime/function/framework/world/world_manager.h"        // 世界管理器（管理游戏对象/场景）
@@ -24,6 +26,9 @@ namespace Sammi
         // 步骤1：注册反射类型元信息
         // 反射系统用于在运行时获取类型信息（如类成员、函数），常用于序列化、脚本绑定、编辑器反射等场景
         Reflection::TypeMetaRegister::metaRegister();
+        // 注册二进制及JSON文档序列化的类型表，ReflectionPtr按类型名读写多态对象
+        BinarySerializer::registerTypes();
+        JsonDocumentSerializer::registerTypes();
 
         // 步骤2：启动全局上下文中的所有系统
         // g_runtime_global_context是全局单例，管理引擎所有子系统（如窗口、输入、渲染等）
@@ -0,0 +1,504 @@
+#include "runtime/function/animation/animation_compression.h"
+
+#include "runtime/core/base/macro.h"
+
+#include "runtime/resource/res_type/data/animation_clip.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Piccolo
+{
+    namespace
+    {
+        constexpr uint32_t k_compressed_clip_magic {0x4C434150}; // "PACL"
+        constexpr uint32_t k_compressed_clip_version {1};
+
+        // frames are stored as uint16_t
+        constexpr int32_t k_max_frame_count {std::numeric_limits<uint16_t>::max() + 1};
+
+        // keys the cursor may walk forward before falling back to a binary search
+        constexpr uint32_t k_cursor_walk_limit {4};
+
+        // smallest three components of a unit quaternion lie in [-1/sqrt(2), 1/sqrt(2)]
+        constexpr float    k_smallest_three_range {0.70710678f};
+        constexpr uint32_t k_smallest_three_max_value {0x7FFF};
+
+        // file layout, little endian: header, tracks, key frames, key values
+        struct CompressedClipHeader
+        {
+            uint32_t m_magic;
+            uint32_t m_version;
+            int32_t  m_total_frame;
+            int32_t  m_node_count;
+            uint32_t m_track_count;
+            uint32_t m_key_count;
+        };
+
+        uint16_t quantizeUnit(float value, uint32_t max_value)
+        {
+            value = std::min(std::max(value, 0.0f), 1.0f);
+            return static_cast<uint16_t>(std::lround(value * max_value));
+        }
+
+        void encodeVector(const Vector3& value, const CompressedAnimationClip::Track& track, uint16_t* out_words)
+        {
+            for (size_t i = 0; i < 3; i++)
+            {
+                const float extent = track.m_range_extent[i];
+                out_words[i] = extent > 0.0f ? quantizeUnit((value[i] - track.m_range_min[i]) / extent, 0xFFFF) : 0;
+            }
+        }
+
+        Vector3 decodeVector(const uint16_t* words, const CompressedAnimationClip::Track& track)
+        {
+            Vector3 value;
+            for (size_t i = 0; i < 3; i++)
+            {
+                value[i] = track.m_range_min[i] + track.m_range_extent[i] * (words[i] / 65535.0f);
+            }
+            return value;
+        }
+
+        // the three smallest components take the upper 15 bits of each word,
+        // the index of the dropped largest component is split over the lowest bit of the first two words
+        void encodeRotation(Quaternion rotation, uint16_t* out_words)
+        {
+            rotation.normalise();
+            float components[4] = {rotation.w, rotation.x, rotation.y, rotation.z};
+
+            uint32_t largest_index = 0;
+            for (uint32_t i = 1; i < 4; i++)
+            {
+                if (std::fabs(components[i]) > std::fabs(components[largest_index]))
+                {
+                    largest_index = i;
+                }
+            }
+            // q and -q are the same rotation, keep the dropped component positive
+            const float sign = components[largest_index] < 0.0f ? -1.0f : 1.0f;
+
+            uint32_t word_index = 0;
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                if (i == largest_index)
+                    continue;
+
+                const float    unit_value = (sign * components[i] + k_smallest_three_range) / (2.0f * k_smallest_three_range);
+                const uint16_t value      = quantizeUnit(unit_value, k_smallest_three_max_value);
+                out_words[word_index]     = static_cast<uint16_t>(value << 1);
+                word_index++;
+            }
+            out_words[0] |= largest_index & 1;
+            out_words[1] |= (largest_index >> 1) & 1;
+        }
+
+        Quaternion decodeRotation(const uint16_t* words)
+        {
+            const uint32_t largest_index = (words[0] & 1) | ((words[1] & 1) << 1);
+
+            float    components[4];
+            float    square_sum = 0.0f;
+            uint32_t word_index = 0;
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                if (i == largest_index)
+                    continue;
+
+                const float unit_value = static_cast<float>(words[word_index] >> 1) / k_smallest_three_max_value;
+                components[i]          = unit_value * 2.0f * k_smallest_three_range - k_smallest_three_range;
+                square_sum += components[i] * components[i];
+                word_index++;
+            }
+            components[largest_index] = std::sqrt(std::max(0.0f, 1.0f - square_sum));
+
+            return Quaternion(components[0], components[1], components[2], components[3]);
+        }
+
+        // angle between two unit quaternions, |lhs - rhs| = 2 * sin(angle / 4) keeps precision for small angles
+        // where acos(dot) does not
+        float rotationError(const Quaternion& lhs, const Quaternion& rhs)
+        {
+            const Quaternion aligned_rhs = lhs.dot(rhs) < 0.0f ? -rhs : rhs;
+            const Quaternion difference  = lhs - aligned_rhs;
+            const float      chord       = std::sqrt(difference.dot(difference));
+            return 4.0f * std::asin(std::min(chord * 0.5f, 1.0f));
+        }
+
+        float vectorError(const Vector3& lhs, const Vector3& rhs) { return lhs.distance(rhs); }
+
+        Vector3 interpolate(const Vector3& low, const Vector3& high, float ratio)
+        {
+            return Vector3::lerp(low, high, ratio);
+        }
+
+        Quaternion interpolate(const Quaternion& low, const Quaternion& high, float ratio)
+        {
+            return Quaternion::nLerp(ratio, low, high, true);
+        }
+
+        float keyError(const Vector3& lhs, const Vector3& rhs) { return vectorError(lhs, rhs); }
+        float keyError(const Quaternion& lhs, const Quaternion& rhs) { return rotationError(lhs, rhs); }
+
+        // greedy key reduction: a key is dropped while the line between the last kept key and the next one
+        // stays within tolerance of every source key it skips
+        template<typename T>
+        void reduceKeys(const std::vector<T>& keys, float tolerance, std::vector<uint32_t>& out_kept_keys)
+        {
+            out_kept_keys.clear();
+            const uint32_t key_count = static_cast<uint32_t>(keys.size());
+            if (key_count == 0)
+            {
+                return;
+            }
+
+            out_kept_keys.push_back(0);
+
+            bool is_constant = true;
+            for (uint32_t i = 1; i < key_count && is_constant; i++)
+            {
+                is_constant = keyError(keys[0], keys[i]) <= tolerance;
+            }
+            if (is_constant)
+            {
+                return;
+            }
+
+            auto fits = [&](uint32_t begin, uint32_t end) {
+                for (uint32_t i = begin + 1; i < end; i++)
+                {
+                    const float ratio = static_cast<float>(i - begin) / (end - begin);
+                    if (keyError(interpolate(keys[begin], keys[end], ratio), keys[i]) > tolerance)
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            };
+
+            uint32_t anchor = 0;
+            for (uint32_t end = 2; end < key_count; end++)
+            {
+                if (!fits(anchor, end))
+                {
+                    anchor = end - 1;
+                    out_kept_keys.push_back(anchor);
+                }
+            }
+            out_kept_keys.push_back(key_count - 1);
+        }
+
+        template<typename T>
+        const T& clampedKey(const std::vector<T>& keys, int frame)
+        {
+            return keys[std::min(static_cast<size_t>(frame), keys.size() - 1)];
+        }
+    } // namespace
+
+    std::shared_ptr<CompressedAnimationClip> CompressedAnimationClip::compress(const AnimationClip&                clip,
+                                                                               const AnimationCompressionSettings& settings,
+                                                                               AnimationCompressionReport* out_report)
+    {
+        if (clip.total_frame > k_max_frame_count)
+        {
+            LOG_WARN("animation clip has {} frames, more than the {} a compressed clip supports",
+                     clip.total_frame,
+                     k_max_frame_count);
+            return nullptr;
+        }
+
+        auto compressed_clip           = std::make_shared<CompressedAnimationClip>();
+        compressed_clip->m_total_frame = clip.total_frame;
+        compressed_clip->m_node_count  = static_cast<int32_t>(clip.node_channels.size());
+        compressed_clip->m_tracks.resize(clip.node_channels.size() * track_type_count);
+
+        AnimationCompressionReport report;
+        std::vector<uint32_t>      kept_keys;
+
+        auto add_keys = [&](Track& track) {
+            track.m_first_key = static_cast<uint32_t>(compressed_clip->m_key_frames.size());
+            track.m_key_count = static_cast<uint32_t>(kept_keys.size());
+            for (uint32_t key : kept_keys)
+            {
+                compressed_clip->m_key_frames.push_back(static_cast<uint16_t>(key));
+            }
+            compressed_clip->m_key_values.resize(compressed_clip->m_key_frames.size() * 3);
+        };
+
+        auto add_vector_track = [&](const std::vector<Vector3>& keys, float tolerance, Track& track) {
+            reduceKeys(keys, tolerance, kept_keys);
+            add_keys(track);
+            if (kept_keys.empty())
+            {
+                return;
+            }
+
+            Vector3 range_min = keys[kept_keys[0]];
+            Vector3 range_max = range_min;
+            for (uint32_t key : kept_keys)
+            {
+                range_min.makeFloor(keys[key]);
+                range_max.makeCeil(keys[key]);
+            }
+            for (size_t i = 0; i < 3; i++)
+            {
+                track.m_range_min[i]    = range_min[i];
+                track.m_range_extent[i] = range_max[i] - range_min[i];
+            }
+
+            uint16_t* words = &compressed_clip->m_key_values[track.m_first_key * 3];
+            for (size_t i = 0; i < kept_keys.size(); i++)
+            {
+                encodeVector(keys[kept_keys[i]], track, words + i * 3);
+            }
+        };
+
+        for (size_t channel_index = 0; channel_index < clip.node_channels.size(); channel_index++)
+        {
+            const AnimationChannel& channel = clip.node_channels[channel_index];
+            Track*                  tracks  = &compressed_clip->m_tracks[channel_index * track_type_count];
+
+            add_vector_track(channel.position_keys, settings.m_position_tolerance, tracks[position_track]);
+            add_vector_track(channel.scaling_keys, settings.m_scale_tolerance, tracks[scale_track]);
+
+            std::vector<Quaternion> rotation_keys = channel.rotation_keys;
+            for (Quaternion& rotation : rotation_keys)
+            {
+                rotation.normalise();
+            }
+            reduceKeys(rotation_keys, settings.m_rotation_tolerance, kept_keys);
+            add_keys(tracks[rotation_track]);
+            uint16_t* words = compressed_clip->m_key_values.data() + tracks[rotation_track].m_first_key * 3;
+            for (size_t i = 0; i < kept_keys.size(); i++)
+            {
+                encodeRotation(rotation_keys[kept_keys[i]], words + i * 3);
+            }
+
+            report.m_raw_key_count +=
+                channel.position_keys.size() + channel.rotation_keys.size() + channel.scaling_keys.size();
+            report.m_raw_byte_size += channel.position_keys.size() * sizeof(Vector3) +
+                                      channel.rotation_keys.size() * sizeof(Quaternion) +
+                                      channel.scaling_keys.size() * sizeof(Vector3);
+        }
+
+        if (out_report)
+        {
+            report.m_compressed_key_count = compressed_clip->m_key_frames.size();
+            report.m_compressed_byte_size = compressed_clip->getByteSize();
+
+            // every frame of every channel once, the same access pattern as playback
+            std::vector<AnimationSampleCursor> cursors(clip.node_channels.size());
+            Vector3                            position;
+            Vector3                            scale;
+            Quaternion                         rotation;
+            float                              checksum = 0.0f;
+            const auto                         start    = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < clip.total_frame; frame++)
+            {
+                for (size_t channel_index = 0; channel_index < cursors.size(); channel_index++)
+                {
+                    compressed_clip->sampleChannel(
+                        channel_index, static_cast<float>(frame), cursors[channel_index], position, rotation, scale);
+                    checksum += position.x + rotation.w + scale.x;
+                }
+            }
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            const size_t sample_count = static_cast<size_t>(std::max(clip.total_frame, 0)) * cursors.size();
+            if (elapsed.count() > 0.0 && std::isfinite(checksum))
+            {
+                report.m_samples_per_second = sample_count / elapsed.count();
+            }
+
+            for (size_t channel_index = 0; channel_index < cursors.size(); channel_index++)
+            {
+                const AnimationChannel& channel = clip.node_channels[channel_index];
+                for (int frame = 0; frame < clip.total_frame; frame++)
+                {
+                    compressed_clip->sampleChannel(
+                        channel_index, static_cast<float>(frame), cursors[channel_index], position, rotation, scale);
+                    if (!channel.position_keys.empty())
+                    {
+                        report.m_max_position_error = std::max(report.m_max_position_error,
+                                                               vectorError(position, clampedKey(channel.position_keys, frame)));
+                    }
+                    if (!channel.rotation_keys.empty())
+                    {
+                        Quaternion source_rotation = clampedKey(channel.rotation_keys, frame);
+                        source_rotation.normalise();
+                        report.m_max_rotation_error =
+                            std::max(report.m_max_rotation_error, rotationError(rotation, source_rotation));
+                    }
+                    if (!channel.scaling_keys.empty())
+                    {
+                        report.m_max_scale_error =
+                            std::max(report.m_max_scale_error, vectorError(scale, clampedKey(channel.scaling_keys, frame)));
+                    }
+                }
+            }
+
+            *out_report = report;
+        }
+
+        return compressed_clip;
+    }
+
+    uint32_t CompressedAnimationClip::findKey(const Track& track, float frame, uint32_t& cursor_key) const
+    {
+        const uint16_t* frames = m_key_frames.data() + track.m_first_key;
+
+        uint32_t key = cursor_key < track.m_key_count ? cursor_key : 0;
+        if (frames[key] > frame)
+        {
+            // looped or played backwards
+            key = 0;
+        }
+
+        // playback usually advances a key or two per tick, so walk forward before searching
+        uint32_t walk_count = 0;
+        while (key + 1 < track.m_key_count && frames[key + 1] <= frame)
+        {
+            if (++walk_count > k_cursor_walk_limit)
+            {
+                key = static_cast<uint32_t>(std::upper_bound(frames + key, frames + track.m_key_count, frame) - frames) - 1;
+                break;
+            }
+            key++;
+        }
+
+        cursor_key = key;
+        return key;
+    }
+
+    Vector3 CompressedAnimationClip::sampleVectorTrack(const Track& track, float frame, uint32_t& cursor_key) const
+    {
+        const uint32_t key   = findKey(track, frame, cursor_key);
+        const uint16_t* words = m_key_values.data() + (track.m_first_key + key) * 3;
+        const Vector3   low   = decodeVector(words, track);
+        if (key + 1 >= track.m_key_count)
+        {
+            return low;
+        }
+
+        const uint16_t* frames = m_key_frames.data() + track.m_first_key;
+        const float     ratio  = std::min(std::max((frame - frames[key]) / (frames[key + 1] - frames[key]), 0.0f), 1.0f);
+        return Vector3::lerp(low, decodeVector(words + 3, track), ratio);
+    }
+
+    Quaternion CompressedAnimationClip::sampleRotationTrack(const Track& track, float frame, uint32_t& cursor_key) const
+    {
+        const uint32_t   key   = findKey(track, frame, cursor_key);
+        const uint16_t*  words = m_key_values.data() + (track.m_first_key + key) * 3;
+        const Quaternion low   = decodeRotation(words);
+        if (key + 1 >= track.m_key_count)
+        {
+            return low;
+        }
+
+        const uint16_t* frames = m_key_frames.data() + track.m_first_key;
+        const float     ratio  = std::min(std::max((frame - frames[key]) / (frames[key + 1] - frames[key]), 0.0f), 1.0f);
+        return Quaternion::nLerp(ratio, low, decodeRotation(words + 3), true);
+    }
+
+    void CompressedAnimationClip::sampleChannel(size_t                 channel_index,
+                                                float                  frame,
+                                                AnimationSampleCursor& cursor,
+                                                Vector3&               out_position,
+                                                Quaternion&            out_rotation,
+                                                Vector3&               out_scale) const
+    {
+        const Track* tracks = &m_tracks[channel_index * track_type_count];
+
+        // an empty track leaves the bind pose untouched
+        out_position = tracks[position_track].m_key_count == 0 ?
+                           Vector3::ZERO :
+                           sampleVectorTrack(tracks[position_track], frame, cursor.m_track_keys[position_track]);
+        out_rotation = tracks[rotation_track].m_key_count == 0 ?
+                           Quaternion::IDENTITY :
+                           sampleRotationTrack(tracks[rotation_track], frame, cursor.m_track_keys[rotation_track]);
+        out_scale    = tracks[scale_track].m_key_count == 0 ?
+                           Vector3::UNIT_SCALE :
+                           sampleVectorTrack(tracks[scale_track], frame, cursor.m_track_keys[scale_track]);
+    }
+
+    size_t CompressedAnimationClip::getByteSize() const
+    {
+        return sizeof(CompressedClipHeader) + m_tracks.size() * sizeof(Track) +
+               m_key_frames.size() * sizeof(uint16_t) + m_key_values.size() * sizeof(uint16_t);
+    }
+
+    void CompressedAnimationClip::serialize(std::vector<uint8_t>& out_data) const
+    {
+        CompressedClipHeader header;
+        header.m_magic       = k_compressed_clip_magic;
+        header.m_version     = k_compressed_clip_version;
+        header.m_total_frame = m_total_frame;
+        header.m_node_count  = m_node_count;
+        header.m_track_count = static_cast<uint32_t>(m_tracks.size());
+        header.m_key_count   = static_cast<uint32_t>(m_key_frames.size());
+
+        out_data.resize(getByteSize());
+        uint8_t* cursor = out_data.data();
+        std::memcpy(cursor, &header, sizeof(header));
+        cursor += sizeof(header);
+        std::memcpy(cursor, m_tracks.data(), m_tracks.size() * sizeof(Track));
+        cursor += m_tracks.size() * sizeof(Track);
+        std::memcpy(cursor, m_key_frames.data(), m_key_frames.size() * sizeof(uint16_t));
+        cursor += m_key_frames.size() * sizeof(uint16_t);
+        std::memcpy(cursor, m_key_values.data(), m_key_values.size() * sizeof(uint16_t));
+    }
+
+    bool CompressedAnimationClip::deserialize(const uint8_t* data, size_t size)
+    {
+        CompressedClipHeader header;
+        if (size < sizeof(header))
+        {
+            LOG_ERROR("compressed animation clip is truncated");
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        if (header.m_magic != k_compressed_clip_magic || header.m_version != k_compressed_clip_version)
+        {
+            LOG_ERROR("compressed animation clip has an unknown format or version {}", header.m_version);
+            return false;
+        }
+
+        const size_t expected_size = sizeof(header) + static_cast<size_t>(header.m_track_count) * sizeof(Track) +
+                                     static_cast<size_t>(header.m_key_count) * sizeof(uint16_t) * 4;
+        if (header.m_node_count < 0 ||
+            header.m_track_count != static_cast<uint32_t>(header.m_node_count) * track_type_count ||
+            size != expected_size)
+        {
+            LOG_ERROR("compressed animation clip is corrupted");
+            return false;
+        }
+
+        m_total_frame = header.m_total_frame;
+        m_node_count  = header.m_node_count;
+        m_tracks.resize(header.m_track_count);
+        m_key_frames.resize(header.m_key_count);
+        m_key_values.resize(static_cast<size_t>(header.m_key_count) * 3);
+
+        const uint8_t* cursor = data + sizeof(header);
+        std::memcpy(m_tracks.data(), cursor, m_tracks.size() * sizeof(Track));
+        cursor += m_tracks.size() * sizeof(Track);
+        std::memcpy(m_key_frames.data(), cursor, m_key_frames.size() * sizeof(uint16_t));
+        cursor += m_key_frames.size() * sizeof(uint16_t);
+        std::memcpy(m_key_values.data(), cursor, m_key_values.size() * sizeof(uint16_t));
+
+        for (const Track& track : m_tracks)
+        {
+            if (static_cast<size_t>(track.m_first_key) + track.m_key_count > m_key_frames.size())
+            {
+                LOG_ERROR("compressed animation clip is corrupted");
+                m_tracks.clear();
+                m_key_frames.clear();
+                m_key_values.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace Piccolo
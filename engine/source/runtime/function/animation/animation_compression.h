@@ -0,0 +1,108 @@
+#pragma once
+
+#include "runtime/core/math/quaternion.h"
+#include "runtime/core/math/vector3.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Piccolo
+{
+    class AnimationClip;
+
+    struct AnimationCompressionSettings
+    {
+        // compress json clips when they are loaded, cooked .anim clips are always used when they exist
+        bool  m_enable_load_time_compression {false};
+        float m_position_tolerance {0.0005f}; // in model units
+        float m_rotation_tolerance {0.0005f}; // in radians
+        float m_scale_tolerance {0.0005f};
+    };
+
+    struct AnimationCompressionReport
+    {
+        size_t m_raw_byte_size {0};
+        size_t m_compressed_byte_size {0};
+        size_t m_raw_key_count {0};
+        size_t m_compressed_key_count {0};
+
+        // measured against the source keys at every frame
+        float m_max_position_error {0.0f};
+        float m_max_rotation_error {0.0f};
+        float m_max_scale_error {0.0f};
+
+        // channel samples per second over one pass of all the frames
+        double m_samples_per_second {0.0};
+
+        float getCompressionRatio() const
+        {
+            return m_compressed_byte_size == 0 ? 0.0f : static_cast<float>(m_raw_byte_size) / m_compressed_byte_size;
+        }
+    };
+
+    /// key position of the last sample of each track, lets consecutive frames skip the binary search
+    struct AnimationSampleCursor
+    {
+        uint32_t m_track_keys[3] {0, 0, 0};
+    };
+
+    /// Animation clip with redundant keys removed and every key packed in 48 bits:
+    /// positions and scales are quantized to 16 bits per component in the range of their track,
+    /// rotations use the smallest three encoding with 15 bits per component
+    class CompressedAnimationClip
+    {
+    public:
+        enum TrackType : uint32_t
+        {
+            position_track = 0,
+            rotation_track,
+            scale_track,
+            track_type_count
+        };
+
+        struct Track
+        {
+            uint32_t m_first_key {0};
+            uint32_t m_key_count {0};
+            float    m_range_min[3] {0.0f, 0.0f, 0.0f};
+            float    m_range_extent[3] {0.0f, 0.0f, 0.0f};
+        };
+
+        static std::shared_ptr<CompressedAnimationClip> compress(const AnimationClip&                clip,
+                                                                 const AnimationCompressionSettings& settings,
+                                                                 AnimationCompressionReport*         out_report = nullptr);
+
+        int getTotalFrame() const { return m_total_frame; }
+        int getNodeCount() const { return m_node_count; }
+
+        // frame is fractional, tracks are clamped to their last key
+        void sampleChannel(size_t                 channel_index,
+                           float                  frame,
+                           AnimationSampleCursor& cursor,
+                           Vector3&               out_position,
+                           Quaternion&            out_rotation,
+                           Vector3&               out_scale) const;
+
+        void   serialize(std::vector<uint8_t>& out_data) const;
+        bool   deserialize(const uint8_t* data, size_t size);
+        size_t getByteSize() const;
+
+    private:
+        uint32_t findKey(const Track& track, float frame, uint32_t& cursor_key) const;
+
+        Vector3    sampleVectorTrack(const Track& track, float frame, uint32_t& cursor_key) const;
+        Quaternion sampleRotationTrack(const Track& track, float frame, uint32_t& cursor_key) const;
+
+        int32_t m_total_frame {0};
+        int32_t m_node_count {0};
+
+        // track_type_count tracks per channel
+        std::vector<Track> m_tracks;
+        // frame index of every key, tracks are stored one after another
+        std::vector<uint16_t> m_key_frames;
+        // 3 quantized components per key
+        std::vector<uint16_t> m_key_values;
+    };
+} // namespace Piccolo
@@ -1,6 +1,8 @@
 
 #include "runtime/function/animation/animation_loader.h"
 
+#include "runtime/core/base/macro.h"
+
 #include "runtime/resource/asset_manager/asset_manager.h"
 #include "runtime/resource/res_type/data/animation_clip.h"
 #include "runtime/resource/res_type/data/skeleton_mask.h"
@@ -10,6 +12,9 @@
 
 #include "_generated/serializer/all_serializer.h"
 
+#include <filesystem>
+#include <fstream>
+
 namespace Piccolo
 {
     namespace
@@ -27,6 +32,22 @@ namespace Piccolo
             return bone_ptr;
         }
 
+        void logCompressionReport(const std::string& animation_clip_url, const AnimationCompressionReport& report)
+        {
+            LOG_INFO("compressed animation {}: {} -> {} bytes ({:.2f}x), {} -> {} keys, max error position {} rotation "
+                     "{} scale {}, {:.0f} samples/s",
+                     animation_clip_url,
+                     report.m_raw_byte_size,
+                     report.m_compressed_byte_size,
+                     report.getCompressionRatio(),
+                     report.m_raw_key_count,
+                     report.m_compressed_key_count,
+                     report.m_max_position_error,
+                     report.m_max_rotation_error,
+                     report.m_max_scale_error,
+                     report.m_samples_per_second);
+        }
+
         AnimSkelMap buildAnimSkelMap(const AnimNodeMap& anim, const SkeletonData& skeleton)
         {
             AnimSkelMap anim_skel_map;
@@ -71,6 +92,17 @@ namespace Piccolo
         }
     } // namespace
 
+    std::string AnimationLoader::getCompressedAnimationClipUrl(const std::string& animation_clip_url)
+    {
+        // run.animation_clip.json is cooked to run.anim
+        std::filesystem::path compressed_url(animation_clip_url);
+        if (compressed_url.extension() == ".json")
+        {
+            compressed_url.replace_extension();
+        }
+        return compressed_url.replace_extension(".anim").generic_string();
+    }
+
     std::shared_ptr<Piccolo::AnimationClip> AnimationLoader::loadAnimationClipData(std::string animation_clip_url)
     {
         AnimationAsset animation_clip;
@@ -78,6 +110,64 @@ namespace Piccolo
         return std::make_shared<Piccolo::AnimationClip>(animation_clip.clip_data);
     }
 
+    std::shared_ptr<CompressedAnimationClip>
+    AnimationLoader::loadCompressedAnimationClip(std::string                         animation_clip_url,
+                                                 const AnimationCompressionSettings& settings)
+    {
+        std::shared_ptr<AssetManager> asset_manager       = g_runtime_global_context.m_asset_manager;
+        const std::string             compressed_clip_url = getCompressedAnimationClipUrl(animation_clip_url);
+
+        // like cooked meshes and textures, a cooked clip older than its json is ignored until it is cooked again
+        std::shared_ptr<AssetFile> compressed_clip_file;
+        if (asset_manager->isDerivedAssetUpToDate(animation_clip_url, compressed_clip_url))
+        {
+            compressed_clip_file = asset_manager->openAssetFile(compressed_clip_url);
+        }
+        if (compressed_clip_file)
+        {
+            auto compressed_clip = std::make_shared<CompressedAnimationClip>();
+            if (compressed_clip->deserialize(compressed_clip_file->getData(), compressed_clip_file->getSize()))
+            {
+                return compressed_clip;
+            }
+            LOG_ERROR("failed to load compressed animation clip {}", compressed_clip_url);
+        }
+
+        if (!settings.m_enable_load_time_compression)
+        {
+            return nullptr;
+        }
+
+        AnimationCompressionReport report;
+        std::shared_ptr<CompressedAnimationClip> compressed_clip =
+            CompressedAnimationClip::compress(*loadAnimationClipData(animation_clip_url), settings, &report);
+        if (compressed_clip)
+        {
+            logCompressionReport(animation_clip_url, report);
+        }
+        return compressed_clip;
+    }
+
+    bool AnimationLoader::saveCompressedAnimationClip(const CompressedAnimationClip& compressed_clip,
+                                                      std::string                    animation_clip_url)
+    {
+        const std::filesystem::path compressed_clip_path =
+            g_runtime_global_context.m_asset_manager->getFullPath(getCompressedAnimationClipUrl(animation_clip_url));
+
+        std::vector<uint8_t> compressed_clip_data;
+        compressed_clip.serialize(compressed_clip_data);
+
+        std::ofstream compressed_clip_file(compressed_clip_path, std::ios::binary);
+        if (!compressed_clip_file)
+        {
+            LOG_ERROR("failed to open {}", compressed_clip_path.generic_string());
+            return false;
+        }
+        compressed_clip_file.write(reinterpret_cast<const char*>(compressed_clip_data.data()),
+                                   compressed_clip_data.size());
+        return compressed_clip_file.good();
+    }
+
     std::shared_ptr<Piccolo::SkeletonData> AnimationLoader::loadSkeletonData(std::string skeleton_data_url)
     {
         SkeletonData data;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "runtime/function/animation/animation_compression.h"
+
 #include "runtime/resource/res_type/data/animation_clip.h"
 #include "runtime/resource/res_type/data/animation_skeleton_node_map.h"
 #include "runtime/resource/res_type/data/skeleton_data.h"
@@ -14,6 +16,12 @@ namespace Piccolo
     {
     public:
         std::shared_ptr<AnimationClip> loadAnimationClipData(std::string animation_clip_url);
+        // cooked .anim next to the json clip if there is one, otherwise compress the json clip when enabled
+        std::shared_ptr<CompressedAnimationClip> loadCompressedAnimationClip(std::string animation_clip_url,
+                                                                             const AnimationCompressionSettings& settings);
+        bool saveCompressedAnimationClip(const CompressedAnimationClip& compressed_clip, std::string animation_clip_url);
+        // run.animation_clip.json -> run.anim
+        static std::string getCompressedAnimationClipUrl(const std::string& animation_clip_url);
         std::shared_ptr<SkeletonData>  loadSkeletonData(std::string skeleton_data_url);
         std::shared_ptr<AnimSkelMap>   loadAnimSkelMap(std::string anim_skel_map_url);
         std::shared_ptr<BoneBlendMask> loadSkeletonMask(std::string skeleton_mask_file_url);
@@ -1,5 +1,7 @@
 #include "runtime/function/animation/animation_system.h"
 
+#include "runtime/core/base/macro.h"
+
 #include "resource/res_type/data/skeleton_mask.h"
 
 #include "runtime/function/animation/animation_loader.h"
@@ -11,6 +13,8 @@ namespace Piccolo
     std::map<std::string, std::shared_ptr<AnimationClip>> AnimationManager::m_animation_data_cache;
     std::map<std::string, std::shared_ptr<AnimSkelMap>>   AnimationManager::m_animation_skeleton_map_cache;
     std::map<std::string, std::shared_ptr<BoneBlendMask>> AnimationManager::m_skeleton_mask_cache;
+    std::map<std::string, std::shared_ptr<CompressedAnimationClip>> AnimationManager::m_compressed_animation_cache;
+    AnimationCompressionSettings                                    AnimationManager::m_compression_settings;
 
     std::shared_ptr<SkeletonData> AnimationManager::tryLoadSkeleton(std::string file_path)
     {
@@ -80,41 +84,105 @@ namespace Piccolo
         return res;
     }
 
-    BlendStateWithClipData AnimationManager::getBlendStateWithClipData(const BlendState& blend_state)
+    std::shared_ptr<CompressedAnimationClip> AnimationManager::tryLoadCompressedAnimation(std::string file_path)
     {
-
-        for (auto animation_file_path : blend_state.blend_clip_file_path)
+        std::shared_ptr<CompressedAnimationClip> res;
+        AnimationLoader                          loader;
+        auto                                     found = m_compressed_animation_cache.find(file_path);
+        if (found == m_compressed_animation_cache.end())
         {
-            tryLoadAnimation(animation_file_path);
+            res = loader.loadCompressedAnimationClip(file_path, m_compression_settings);
+            m_compressed_animation_cache.emplace(file_path, res);
         }
-        for (auto anim_skel_map_path : blend_state.blend_anim_skel_map_path)
+        else
         {
-            tryLoadAnimationSkeletonMap(anim_skel_map_path);
+            res = found->second;
         }
-        for (auto skeleton_mask_path : blend_state.blend_mask_file_path)
+        return res;
+    }
+
+    void AnimationManager::setCompressionSettings(const AnimationCompressionSettings& settings)
+    {
+        m_compression_settings = settings;
+    }
+
+    bool AnimationManager::cookAnimation(std::string file_path)
+    {
+        // a clip that failed to load is empty, cooking it would hide the json behind an empty .anim
+        std::shared_ptr<AnimationClip> clip = tryLoadAnimation(file_path);
+        if (!clip || clip->node_channels.empty())
         {
-            tryLoadSkeletonMask(skeleton_mask_path);
+            LOG_ERROR("failed to cook animation clip {}, it has no channels", file_path);
+            return false;
         }
 
-        BlendStateWithClipData blend_state_with_clip_data;
+        AnimationLoader                          loader;
+        AnimationCompressionReport               report;
+        std::shared_ptr<CompressedAnimationClip> compressed_clip =
+            CompressedAnimationClip::compress(*clip, m_compression_settings, &report);
+        if (!compressed_clip || !loader.saveCompressedAnimationClip(*compressed_clip, file_path))
+        {
+            LOG_ERROR("failed to cook animation clip {}", file_path);
+            return false;
+        }
+
+        LOG_INFO("cooked animation {}: {} -> {} bytes ({:.2f}x), max error position {} rotation {} scale {}",
+                 file_path,
+                 report.m_raw_byte_size,
+                 report.m_compressed_byte_size,
+                 report.getCompressionRatio(),
+                 report.m_max_position_error,
+                 report.m_max_rotation_error,
+                 report.m_max_scale_error);
+        m_compressed_animation_cache[file_path] = compressed_clip;
+        return true;
+    }
+
+    bool AnimationManager::isSameBlendSetup(const BlendState& lhs, const BlendState& rhs)
+    {
+        return lhs.clip_count == rhs.clip_count && lhs.blend_clip_file_path == rhs.blend_clip_file_path &&
+               lhs.blend_anim_skel_map_path == rhs.blend_anim_skel_map_path && lhs.blend_weight == rhs.blend_weight &&
+               lhs.blend_mask_file_path == rhs.blend_mask_file_path;
+    }
+
+    void AnimationManager::buildBlendStateWithClipData(const BlendState&       blend_state,
+                                                       BlendStateWithClipData& blend_state_with_clip_data)
+    {
         blend_state_with_clip_data.clip_count  = blend_state.clip_count;
         blend_state_with_clip_data.blend_ratio = blend_state.blend_ratio;
-        for (const auto& iter : blend_state.blend_clip_file_path)
+
+        // clips and maps are immutable once loaded, so just share them with the cache
+        blend_state_with_clip_data.blend_clip.clear();
+        blend_state_with_clip_data.blend_compressed_clip.clear();
+        for (const auto& animation_file_path : blend_state.blend_clip_file_path)
         {
-            blend_state_with_clip_data.blend_clip.push_back(*m_animation_data_cache[iter]);
+            // the raw clip is only loaded when there is no compressed one
+            std::shared_ptr<CompressedAnimationClip> compressed_clip = tryLoadCompressedAnimation(animation_file_path);
+            blend_state_with_clip_data.blend_compressed_clip.push_back(compressed_clip);
+            blend_state_with_clip_data.blend_clip.push_back(compressed_clip ? nullptr :
+                                                                              tryLoadAnimation(animation_file_path));
         }
-        for (const auto& iter : blend_state.blend_anim_skel_map_path)
+        blend_state_with_clip_data.blend_anim_skel_map.clear();
+        for (const auto& anim_skel_map_path : blend_state.blend_anim_skel_map_path)
         {
-            blend_state_with_clip_data.blend_anim_skel_map.push_back(*m_animation_skeleton_map_cache[iter]);
+            blend_state_with_clip_data.blend_anim_skel_map.push_back(tryLoadAnimationSkeletonMap(anim_skel_map_path));
         }
         std::vector<std::shared_ptr<BoneBlendMask>> blend_masks;
-        for (auto& iter : blend_state.blend_mask_file_path)
+        for (const auto& skeleton_mask_path : blend_state.blend_mask_file_path)
         {
-            blend_masks.push_back(m_skeleton_mask_cache[iter]);
-            tryLoadAnimationSkeletonMap(m_skeleton_mask_cache[iter]->skeleton_file_path);
+            blend_masks.push_back(tryLoadSkeletonMask(skeleton_mask_path));
         }
-        size_t skeleton_bone_count = m_skeleton_definition_cache[blend_masks[0]->skeleton_file_path]->bones_map.size();
+
         blend_state_with_clip_data.blend_weight.resize(blend_state.clip_count);
+        if (blend_masks.empty())
+        {
+            LOG_ERROR("blend state of clip {} has no skeleton mask, its blend weights are left empty",
+                      blend_state.blend_clip_file_path.empty() ? std::string() : blend_state.blend_clip_file_path[0]);
+            return;
+        }
+
+        const std::string& skeleton_file_path  = blend_masks[0]->skeleton_file_path;
+        size_t             skeleton_bone_count = tryLoadSkeleton(skeleton_file_path)->bones_map.size();
         for (size_t clip_index = 0; clip_index < blend_state.clip_count; clip_index++)
         {
             blend_state_with_clip_data.blend_weight[clip_index].blend_weight.resize(skeleton_bone_count);
@@ -131,7 +199,7 @@ namespace Piccolo
             }
             if (fabs(sum_weight) < 0.0001f)
             {
-                // LOG_ERROR
+                LOG_ERROR("bone {} of skeleton {} has no blend weight in any clip", bone_index, skeleton_file_path);
             }
             for (size_t clip_index = 0; clip_index < blend_state.clip_count; clip_index++)
             {
@@ -147,6 +215,5 @@ namespace Piccolo
                 }
             }
         }
-        return blend_state_with_clip_data;
     }
 } // namespace Piccolo
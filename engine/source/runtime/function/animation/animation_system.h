@@ -1,5 +1,7 @@
 #pragma once
 
+#include "runtime/function/animation/animation_compression.h"
+
 #include "runtime/resource/res_type/data/animation_clip.h"
 #include "runtime/resource/res_type/data/animation_skeleton_node_map.h"
 #include "runtime/resource/res_type/data/blend_state.h"
@@ -19,13 +21,28 @@ namespace Piccolo
         static std::map<std::string, std::shared_ptr<AnimationClip>> m_animation_data_cache;
         static std::map<std::string, std::shared_ptr<AnimSkelMap>>   m_animation_skeleton_map_cache;
         static std::map<std::string, std::shared_ptr<BoneBlendMask>> m_skeleton_mask_cache;
+        // also caches clips that have no compressed version, as nullptr
+        static std::map<std::string, std::shared_ptr<CompressedAnimationClip>> m_compressed_animation_cache;
+        static AnimationCompressionSettings                                    m_compression_settings;
 
     public:
         static std::shared_ptr<SkeletonData>  tryLoadSkeleton(std::string file_path);
         static std::shared_ptr<AnimationClip> tryLoadAnimation(std::string file_path);
         static std::shared_ptr<AnimSkelMap>   tryLoadAnimationSkeletonMap(std::string file_path);
         static std::shared_ptr<BoneBlendMask> tryLoadSkeletonMask(std::string file_path);
-        static BlendStateWithClipData         getBlendStateWithClipData(const BlendState& blend_state);
+        static std::shared_ptr<CompressedAnimationClip> tryLoadCompressedAnimation(std::string file_path);
+
+        // only affects clips loaded afterwards
+        static void setCompressionSettings(const AnimationCompressionSettings& settings);
+        static const AnimationCompressionSettings& getCompressionSettings() { return m_compression_settings; }
+        // offline compression, writes the cooked .anim next to the json clip
+        static bool cookAnimation(std::string file_path);
+
+        // whether two blend states use the same clips, maps, weights and masks, blend ratio is not compared
+        static bool isSameBlendSetup(const BlendState& lhs, const BlendState& rhs);
+        // rebuild clip handles and per-bone blend weights, reusing the storage of blend_state_with_clip_data
+        static void buildBlendStateWithClipData(const BlendState&       blend_state,
+                                                BlendStateWithClipData& blend_state_with_clip_data);
 
         AnimationManager() = default;
     };
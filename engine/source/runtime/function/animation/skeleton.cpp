@@ -2,76 +2,273 @@
 
 #include "runtime/core/math/math.h"
 
-#include "runtime/function/animation/utilities.h"
+#include "runtime/resource/res_type/data/animation_clip.h"
+#include "runtime/resource/res_type/data/animation_skeleton_node_map.h"
+#include "runtime/resource/res_type/data/blend_state.h"
+#include "runtime/resource/res_type/data/skeleton_data.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define PICCOLO_ANIMATION_SSE
+#include <xmmintrin.h>
+#endif
 
 namespace Piccolo
 {
-    Skeleton::~Skeleton() { delete[] m_bones; }
+    namespace
+    {
+#ifdef PICCOLO_ANIMATION_SSE
+        // Quaternion is laid out as w, x, y, z, so lane 0 is w
+        inline __m128 loadQuaternion(const Quaternion& q) { return _mm_loadu_ps(&q.w); }
+        inline void   storeQuaternion(__m128 v, Quaternion& q) { _mm_storeu_ps(&q.w, v); }
+
+        // lane 3 is always 0, Vector3 is only 12 bytes so it can't be loaded as a whole
+        inline __m128 loadVector3(const Vector3& v) { return _mm_set_ps(0.0f, v.z, v.y, v.x); }
+        inline void   storeVector3(__m128 v, Vector3& out)
+        {
+            alignas(16) float lanes[4];
+            _mm_store_ps(lanes, v);
+            out.x = lanes[0];
+            out.y = lanes[1];
+            out.z = lanes[2];
+        }
+
+        inline __m128 broadcast(__m128 v, int lane)
+        {
+            switch (lane)
+            {
+                case 0:
+                    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+                case 1:
+                    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+                case 2:
+                    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+                default:
+                    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+            }
+        }
+
+        // same as Quaternion::operator*(const Quaternion&)
+        inline __m128 multiplyQuaternion(__m128 a, __m128 b)
+        {
+            const __m128 b_xwzy = _mm_mul_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1)), _mm_set_ps(1, -1, 1, -1));
+            const __m128 b_yzwx = _mm_mul_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2)), _mm_set_ps(-1, 1, 1, -1));
+            const __m128 b_zyxw = _mm_mul_ps(_mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 1, 2, 3)), _mm_set_ps(1, 1, -1, -1));
+
+            __m128 result = _mm_mul_ps(broadcast(a, 0), b);
+            result        = _mm_add_ps(result, _mm_mul_ps(broadcast(a, 1), b_xwzy));
+            result        = _mm_add_ps(result, _mm_mul_ps(broadcast(a, 2), b_yzwx));
+            result        = _mm_add_ps(result, _mm_mul_ps(broadcast(a, 3), b_zyxw));
+            return result;
+        }
+
+        inline __m128 normaliseQuaternion(__m128 q)
+        {
+            __m128 square = _mm_mul_ps(q, q);
+            square        = _mm_add_ps(square, _mm_shuffle_ps(square, square, _MM_SHUFFLE(2, 3, 0, 1)));
+            square        = _mm_add_ps(square, _mm_shuffle_ps(square, square, _MM_SHUFFLE(1, 0, 3, 2)));
+            return _mm_div_ps(q, _mm_sqrt_ps(square));
+        }
+
+        inline __m128 crossProduct(__m128 a, __m128 b)
+        {
+            const __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+            const __m128 a_zxy = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+            const __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+            const __m128 b_zxy = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+            return _mm_sub_ps(_mm_mul_ps(a_yzx, b_zxy), _mm_mul_ps(a_zxy, b_yzx));
+        }
+
+        // same as Quaternion::operator*(const Vector3&)
+        inline __m128 rotateVector(__m128 q, __m128 v)
+        {
+            const __m128 q_vector = _mm_shuffle_ps(q, q, _MM_SHUFFLE(0, 3, 2, 1));
+            const __m128 two      = _mm_set1_ps(2.0f);
+            const __m128 uv       = crossProduct(q_vector, v);
+            const __m128 uuv      = crossProduct(q_vector, uv);
+            return _mm_add_ps(v,
+                              _mm_add_ps(_mm_mul_ps(uv, _mm_mul_ps(two, broadcast(q, 0))), _mm_mul_ps(uuv, two)));
+        }
+#endif
+
+        // (translate * rotate * scale) * rhs, rhs is usually the inverse bind pose
+        inline void composeTransform(const Vector3&    translation,
+                                     const Quaternion& rotation,
+                                     const Vector3&    scale,
+                                     const Matrix4x4&  rhs,
+                                     Matrix4x4&        out_matrix)
+        {
+            const float tx  = rotation.x + rotation.x;
+            const float ty  = rotation.y + rotation.y;
+            const float tz  = rotation.z + rotation.z;
+            const float twx = tx * rotation.w;
+            const float twy = ty * rotation.w;
+            const float twz = tz * rotation.w;
+            const float txx = tx * rotation.x;
+            const float txy = ty * rotation.x;
+            const float txz = tz * rotation.x;
+            const float tyy = ty * rotation.y;
+            const float tyz = tz * rotation.y;
+            const float tzz = tz * rotation.z;
+
+            // upper 3 rows of the model matrix, the last row is (0, 0, 0, 1)
+            const float model[3][4] = {
+                {scale.x * (1.0f - (tyy + tzz)), scale.y * (txy - twz), scale.z * (txz + twy), translation.x},
+                {scale.x * (txy + twz), scale.y * (1.0f - (txx + tzz)), scale.z * (tyz - twx), translation.y},
+                {scale.x * (txz - twy), scale.y * (tyz + twx), scale.z * (1.0f - (txx + tyy)), translation.z}};
+
+#ifdef PICCOLO_ANIMATION_SSE
+            const __m128 rhs_row0 = _mm_loadu_ps(rhs.m_mat[0]);
+            const __m128 rhs_row1 = _mm_loadu_ps(rhs.m_mat[1]);
+            const __m128 rhs_row2 = _mm_loadu_ps(rhs.m_mat[2]);
+            const __m128 rhs_row3 = _mm_loadu_ps(rhs.m_mat[3]);
+            for (int row = 0; row < 3; ++row)
+            {
+                __m128 result = _mm_mul_ps(_mm_set1_ps(model[row][0]), rhs_row0);
+                result        = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(model[row][1]), rhs_row1));
+                result        = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(model[row][2]), rhs_row2));
+                result        = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(model[row][3]), rhs_row3));
+                _mm_storeu_ps(out_matrix.m_mat[row], result);
+            }
+            _mm_storeu_ps(out_matrix.m_mat[3], rhs_row3);
+#else
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int column = 0; column < 4; ++column)
+                {
+                    out_matrix.m_mat[row][column] =
+                        model[row][0] * rhs.m_mat[0][column] + model[row][1] * rhs.m_mat[1][column] +
+                        model[row][2] * rhs.m_mat[2][column] + model[row][3] * rhs.m_mat[3][column];
+                }
+            }
+            for (int column = 0; column < 4; ++column)
+            {
+                out_matrix.m_mat[3][column] = rhs.m_mat[3][column];
+            }
+#endif
+        }
+    } // namespace
 
     void Skeleton::resetSkeleton()
     {
-        for (size_t i = 0; i < m_bone_count; i++)
-            m_bones[i].resetToInitialPose();
+        m_local_translations = m_bind_translations;
+        m_local_rotations    = m_bind_rotations;
+        m_local_scales       = m_bind_scales;
     }
 
     void Skeleton::buildSkeleton(const SkeletonData& skeleton_definition)
     {
-        m_is_flat = skeleton_definition.is_flat;
-        if (m_bones != nullptr)
-        {
-            delete[] m_bones;
-        }
+        m_is_flat    = skeleton_definition.is_flat;
+        m_bone_count = 0;
         if (!m_is_flat || !skeleton_definition.in_topological_order)
         {
             // LOG_ERROR
             return;
         }
-        m_bone_count = skeleton_definition.bones_map.size();
-        m_bones      = new Bone[m_bone_count];
-        for (size_t i = 0; i < m_bone_count; i++)
+
+        m_bone_count = static_cast<int32_t>(skeleton_definition.bones_map.size());
+
+        m_parent_indices.resize(m_bone_count);
+        m_bone_names.resize(m_bone_count);
+        m_bind_translations.resize(m_bone_count);
+        m_bind_rotations.resize(m_bone_count);
+        m_bind_scales.resize(m_bone_count);
+        m_inverse_bind_matrices.resize(m_bone_count);
+        for (int32_t i = 0; i < m_bone_count; i++)
         {
-            const RawBone bone_definition = skeleton_definition.bones_map[i];
-            Bone*         parent_bone     = find_by_index(m_bones, bone_definition.parent_index, i, m_is_flat);
-            m_bones[i].initialize(std::make_shared<RawBone>(bone_definition), parent_bone);
+            const RawBone& bone_definition = skeleton_definition.bones_map[i];
+
+            // in topological order a valid parent is always stored before its child
+            const int32_t parent_index = bone_definition.parent_index;
+            m_parent_indices[i] = (parent_index >= 0 && parent_index < i) ? parent_index : k_invalid_parent_index;
+
+            m_bone_names[i] = bone_definition.name;
+
+            Quaternion bind_rotation = bone_definition.binding_pose.m_rotation;
+            if (bind_rotation.isNaN())
+            {
+                bind_rotation = Quaternion::IDENTITY;
+            }
+            bind_rotation.normalise();
+
+            m_bind_translations[i]     = bone_definition.binding_pose.m_position;
+            m_bind_rotations[i]        = bind_rotation;
+            m_bind_scales[i]           = bone_definition.binding_pose.m_scale;
+            m_inverse_bind_matrices[i] = bone_definition.tpose_matrix;
         }
+
+        m_model_translations.resize(m_bone_count);
+        m_model_rotations.resize(m_bone_count);
+        m_model_scales.resize(m_bone_count);
+
+        resetSkeleton();
+        updateModelPose();
     }
 
     void Skeleton::applyAnimation(const BlendStateWithClipData& blend_state)
     {
-        if (!m_bones)
+        if (m_bone_count == 0)
         {
             return;
         }
         resetSkeleton();
         for (size_t clip_index = 0; clip_index < 1; clip_index++)
         {
-            const AnimationClip& animation_clip = blend_state.blend_clip[clip_index];
-            const float          phase          = blend_state.blend_ratio[clip_index];
-            const AnimSkelMap&   anim_skel_map  = blend_state.blend_anim_skel_map[clip_index];
-
-            float exact_frame        = phase * (animation_clip.total_frame - 1);
-            int   current_frame_low  = floor(exact_frame);
-            int   current_frame_high = ceil(exact_frame);
-            float lerp_ratio         = exact_frame - current_frame_low;
-            // for (size_t node_index = 0; node_index < 0; node_index++)
+            const float        phase         = blend_state.blend_ratio[clip_index];
+            const AnimSkelMap& anim_skel_map = *blend_state.blend_anim_skel_map[clip_index];
+
+            const CompressedAnimationClip* compressed_clip =
+                clip_index < blend_state.blend_compressed_clip.size() ? blend_state.blend_compressed_clip[clip_index].get() :
+                                                                        nullptr;
+            if (compressed_clip)
+            {
+                const size_t channel_count =
+                    std::min<size_t>(compressed_clip->getNodeCount(), anim_skel_map.convert.size());
+                if (m_sample_cursors.size() < channel_count)
+                {
+                    m_sample_cursors.resize(channel_count);
+                }
+
+                const float exact_frame = std::max(phase * (compressed_clip->getTotalFrame() - 1), 0.0f);
+                for (size_t node_index = 0; node_index < channel_count; node_index++)
+                {
+                    const int bone_index = anim_skel_map.convert[node_index];
+                    if (bone_index < 0 || bone_index >= m_bone_count)
+                    {
+                        // LOG_WARNING
+                        continue;
+                    }
+
+                    Vector3    position;
+                    Quaternion rotation;
+                    Vector3    scaling;
+                    compressed_clip->sampleChannel(
+                        node_index, exact_frame, m_sample_cursors[node_index], position, rotation, scaling);
+                    applyBoneKey(bone_index, position, rotation, scaling);
+                }
+                continue;
+            }
+
+            const AnimationClip& animation_clip = *blend_state.blend_clip[clip_index];
+
+            float exact_frame = phase * (animation_clip.total_frame - 1);
+            int   frame_low   = floor(exact_frame);
+            int   frame_high  = ceil(exact_frame);
+            float lerp_ratio  = exact_frame - frame_low;
             for (size_t node_index = 0;
                  node_index < animation_clip.node_count && node_index < anim_skel_map.convert.size();
                  node_index++)
             {
-                AnimationChannel channel    = animation_clip.node_channels[node_index];
-                size_t           bone_index = anim_skel_map.convert[node_index];
-                float            weight     = 1; // blend_state.blend_weight[clip_index]->blend_weight[bone_index];
-                weight                      = 1;
-                if (fabs(weight) < 0.0001f)
-                {
-                    continue;
-                }
-                if (bone_index == std::numeric_limits<size_t>().max())
+                const AnimationChannel& channel    = animation_clip.node_channels[node_index];
+                const int               bone_index = anim_skel_map.convert[node_index];
+                if (bone_index < 0 || bone_index >= m_bone_count)
                 {
                     // LOG_WARNING
                     continue;
                 }
-                Bone* bone = &m_bones[bone_index];
+
+                int current_frame_high = frame_high;
                 if (channel.position_keys.size() <= current_frame_high)
                 {
                     current_frame_high = channel.position_keys.size() - 1;
@@ -84,8 +281,9 @@ namespace Piccolo
                 {
                     current_frame_high = channel.rotation_keys.size() - 1;
                 }
-                current_frame_low = (current_frame_low < current_frame_high) ? current_frame_low : current_frame_high;
-                Vector3 position  = Vector3::lerp(
+                const int current_frame_low = (frame_low < current_frame_high) ? frame_low : current_frame_high;
+
+                Vector3 position = Vector3::lerp(
                     channel.position_keys[current_frame_low], channel.position_keys[current_frame_high], lerp_ratio);
                 Vector3 scaling = Vector3::lerp(
                     channel.scaling_keys[current_frame_low], channel.scaling_keys[current_frame_high], lerp_ratio);
@@ -93,75 +291,74 @@ namespace Piccolo
                                                         channel.rotation_keys[current_frame_low],
                                                         channel.rotation_keys[current_frame_high],
                                                         true);
-
-                {
-                    bone->rotate(rotation);
-                    bone->scale(scaling);
-                    bone->translate(position);
-
-                    // bone->rotate({ {},0.01,0,0,1 });
-                    // bone->scale({ {},0.9,0.9,0.9 });
-                }
+                applyBoneKey(bone_index, position, rotation, scaling);
             }
         }
-        // bones[77].rotate(Quaternion{ {},1,0,0,1 });
-        // bones[18].translate(Vector3{ {},0,1,0 });
-        // bones[0].setScale(Vector3{ {},0,1,0.01 });
-        for (size_t i = 0; i < m_bone_count; i++)
-        {
-            m_bones[i].update();
-        }
-#ifdef _DEBUG
-        // bones[107].m_derived_position += Vector3{ {},10, 0, 0 };
-#endif
+
+        updateModelPose();
     }
 
-    AnimationResult Skeleton::outputAnimationResult()
+    void Skeleton::applyBoneKey(int32_t           bone_index,
+                                const Vector3&    position,
+                                const Quaternion& rotation,
+                                const Vector3&    scaling)
     {
-        AnimationResult animation_result;
-        for (size_t i = 0; i < m_bone_count; i++)
-        {
-            std::shared_ptr<AnimationResultElement> animation_result_element =
-                std::make_shared<AnimationResultElement>();
-            Bone* bone                      = &m_bones[i];
-            animation_result_element->index = bone->getID() + 1;
-            Vector3 temp_translation        = bone->_getDerivedPosition();
-
-            // TODO: the unit of the joint matrices is wrong
-            Vector3 temp_scale = bone->_getDerivedScale();
+        Quaternion normalised_rotation = rotation;
+        normalised_rotation.normalise();
 
-            Quaternion temp_rotation = bone->_getDerivedOrientation();
+        m_local_rotations[bone_index]    = m_local_rotations[bone_index] * normalised_rotation;
+        m_local_scales[bone_index]       = m_local_scales[bone_index] * scaling;
+        m_local_translations[bone_index] = m_local_translations[bone_index] + position;
+    }
 
-            // auto scale = bone->_getDerivedTScale();
-            // scale.x = 1.f / scale.x;
-            // scale.y = 1.f / scale.y;
-            // scale.z = 1.f / scale.z;
+    void Skeleton::updateModelPose()
+    {
+        for (int32_t i = 0; i < m_bone_count; i++)
+        {
+            const int32_t parent_index = m_parent_indices[i];
+            if (parent_index == k_invalid_parent_index)
+            {
+                m_model_translations[i] = m_local_translations[i];
+                m_model_rotations[i]    = m_local_rotations[i];
+                m_model_scales[i]       = m_local_scales[i];
+                continue;
+            }
 
-            // auto revTmat = getMatrix(
-            //	-bone->_getDerivedTPosition(),
-            //	scale,
-            //	conjugate( bone->_getDerivedTOrientation())
-            //);
-            auto objMat =
-                Transform(bone->_getDerivedPosition(), bone->_getDerivedOrientation(), bone->_getDerivedScale())
-                    .getMatrix();
+#ifdef PICCOLO_ANIMATION_SSE
+            const __m128 parent_rotation = loadQuaternion(m_model_rotations[parent_index]);
+            const __m128 parent_scale    = loadVector3(m_model_scales[parent_index]);
 
-            auto resMat = objMat * bone->_getInverseTpose();
+            storeQuaternion(normaliseQuaternion(multiplyQuaternion(parent_rotation, loadQuaternion(m_local_rotations[i]))),
+                            m_model_rotations[i]);
+            storeVector3(_mm_mul_ps(parent_scale, loadVector3(m_local_scales[i])), m_model_scales[i]);
 
-            animation_result_element->transform = resMat.toMatrix4x4_();
+            const __m128 scaled_translation = _mm_mul_ps(parent_scale, loadVector3(m_local_translations[i]));
+            storeVector3(_mm_add_ps(rotateVector(parent_rotation, scaled_translation),
+                                    loadVector3(m_model_translations[parent_index])),
+                         m_model_translations[i]);
+#else
+            const Quaternion& parent_rotation = m_model_rotations[parent_index];
+            const Vector3&    parent_scale    = m_model_scales[parent_index];
 
-            animation_result.node.push_back(*animation_result_element);
+            m_model_rotations[i] = parent_rotation * m_local_rotations[i];
+            m_model_rotations[i].normalise();
+            m_model_scales[i] = parent_scale * m_local_scales[i];
+            m_model_translations[i] =
+                parent_rotation * (parent_scale * m_local_translations[i]) + m_model_translations[parent_index];
+#endif
         }
-        return animation_result;
     }
 
-    const Bone* Skeleton::getBones() const
+    void Skeleton::outputJointMatrices(Matrix4x4* out_joint_matrices) const
     {
-        return m_bones;
-    }
-
-    int32_t Skeleton::getBonesCount() const
-    {
-        return m_bone_count;
+        // TODO: the unit of the joint matrices is wrong
+        for (int32_t i = 0; i < m_bone_count; i++)
+        {
+            composeTransform(m_model_translations[i],
+                             m_model_rotations[i],
+                             m_model_scales[i],
+                             m_inverse_bind_matrices[i],
+                             out_joint_matrices[i]);
+        }
     }
-} // namespace Piccolo
\ No newline at end of file
+} // namespace Piccolo
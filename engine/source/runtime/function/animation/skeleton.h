@@ -1,29 +1,68 @@
 #pragma once
 
+#include "runtime/function/animation/animation_compression.h"
+
 #include "runtime/resource/res_type/components/animation.h"
 
-#include "runtime/function/animation/node.h"
+#include "runtime/core/math/matrix4.h"
+#include "runtime/core/math/quaternion.h"
+#include "runtime/core/math/vector3.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
 
 namespace Piccolo
 {
     class SkeletonData;
     class BlendStateWithClipData;
 
+    /// Skeleton pose stored as structure of arrays in topological order, a parent always comes before its children,
+    /// so local to model transform is a single linear pass without any per-bone allocation
     class Skeleton
     {
+    public:
+        static constexpr int32_t k_invalid_parent_index {-1};
+
+        void buildSkeleton(const SkeletonData& skeleton_definition);
+        void applyAnimation(const BlendStateWithClipData& blend_state);
+        void resetSkeleton();
+
+        // write getBonesCount() skinning matrices (model pose * inverse bind pose) into the caller's span
+        void outputJointMatrices(Matrix4x4* out_joint_matrices) const;
+
+        int32_t            getBonesCount() const { return m_bone_count; }
+        int32_t            getBoneParentIndex(int32_t bone_index) const { return m_parent_indices[bone_index]; }
+        const std::string& getBoneName(int32_t bone_index) const { return m_bone_names[bone_index]; }
+        const Vector3&     getBoneModelPosition(int32_t bone_index) const { return m_model_translations[bone_index]; }
+
     private:
-        bool  m_is_flat {false};
-        int   m_bone_count {0};
-        Bone* m_bones {nullptr};
+        void updateModelPose();
+        // keys are applied on top of the bind pose
+        void applyBoneKey(int32_t bone_index, const Vector3& position, const Quaternion& rotation, const Vector3& scaling);
 
-    public:
-        ~Skeleton();
-
-        void            buildSkeleton(const SkeletonData& skeleton_definition);
-        void            applyAnimation(const BlendStateWithClipData& blend_state);
-        AnimationResult outputAnimationResult();
-        void            resetSkeleton();
-        const Bone*     getBones() const;
-        int32_t         getBonesCount() const;
+        bool    m_is_flat {false};
+        int32_t m_bone_count {0};
+
+        // hierarchy and bind pose
+        std::vector<int32_t>     m_parent_indices;
+        std::vector<std::string> m_bone_names;
+        std::vector<Vector3>     m_bind_translations;
+        std::vector<Quaternion>  m_bind_rotations;
+        std::vector<Vector3>     m_bind_scales;
+        std::vector<Matrix4x4>   m_inverse_bind_matrices;
+
+        // pose relative to the parent bone
+        std::vector<Vector3>    m_local_translations;
+        std::vector<Quaternion> m_local_rotations;
+        std::vector<Vector3>    m_local_scales;
+
+        // pose relative to the skeleton root
+        std::vector<Vector3>    m_model_translations;
+        std::vector<Quaternion> m_model_rotations;
+        std::vector<Vector3>    m_model_scales;
+
+        // one per channel of the sampled compressed clip
+        std::vector<AnimationSampleCursor> m_sample_cursors;
     };
 } // namespace Piccolo
@@ -12,19 +12,47 @@ namespace Piccolo
         auto skeleton_res = AnimationManager::tryLoadSkeleton(m_animation_res.skeleton_file_path);
 
         m_skeleton.buildSkeleton(*skeleton_res);
+
+        m_joint_matrices.assign(m_skeleton.getBonesCount() + 1, Matrix4x4::IDENTITY);
     }
 
     void AnimationComponent::tick(float delta_time)
+    {
+        if (m_is_evaluated_by_stage)
+        {
+            m_is_evaluated_by_stage = false;
+            return;
+        }
+
+        prepareAnimation(delta_time);
+        evaluateAnimation();
+    }
+
+    void AnimationComponent::prepareAnimation(float delta_time)
     {
         m_animation_res.blend_state.blend_ratio[0] +=
             (delta_time / m_animation_res.blend_state.blend_clip_file_length[0]);
         m_animation_res.blend_state.blend_ratio[0] -= floor(m_animation_res.blend_state.blend_ratio[0]);
 
-        m_skeleton.applyAnimation(AnimationManager::getBlendStateWithClipData(m_animation_res.blend_state));
-        m_animation_res.animation_result = m_skeleton.outputAnimationResult();
+        const BlendState& blend_state = m_animation_res.blend_state;
+        if (!m_is_blend_state_built || !AnimationManager::isSameBlendSetup(blend_state, m_built_blend_state))
+        {
+            AnimationManager::buildBlendStateWithClipData(blend_state, m_blend_state_with_clip_data);
+            m_built_blend_state    = blend_state;
+            m_is_blend_state_built = true;
+        }
+        else
+        {
+            // same size every tick, so the assignment reuses the storage
+            m_blend_state_with_clip_data.blend_ratio = blend_state.blend_ratio;
+        }
     }
 
-    const AnimationResult& AnimationComponent::getResult() const { return m_animation_res.animation_result; }
+    void AnimationComponent::evaluateAnimation()
+    {
+        m_skeleton.applyAnimation(m_blend_state_with_clip_data);
+        m_skeleton.outputJointMatrices(m_joint_matrices.data() + 1);
+    }
 
     const Skeleton& AnimationComponent::getSkeleton() const { return m_skeleton; }
 } // namespace Piccolo
@@ -4,6 +4,8 @@
 #include "runtime/function/framework/component/component.h"
 #include "runtime/resource/res_type/components/animation.h"
 
+#include <vector>
+
 namespace Piccolo
 {
     REFLECTION_TYPE(AnimationComponent)
@@ -18,7 +20,15 @@ namespace Piccolo
 
         void tick(float delta_time) override;
 
-        const AnimationResult& getResult() const;
+        // advance the clip and refresh the blend data, must run on the logic thread
+        void prepareAnimation(float delta_time);
+        // sample the clips and write the pose into the preallocated result, safe to run on a worker thread
+        void evaluateAnimation();
+
+        void setEvaluatedByStage(bool is_evaluated_by_stage) { m_is_evaluated_by_stage = is_evaluated_by_stage; }
+
+        // slot 0 is identity for unskinned vertices, slot i + 1 is the skinning matrix of bone i
+        const std::vector<Matrix4x4>& getJointMatrices() const { return m_joint_matrices; }
 
         const Skeleton& getSkeleton() const;
 
@@ -27,5 +37,16 @@ namespace Piccolo
         AnimationComponentRes m_animation_res;
 
         Skeleton m_skeleton;
+
+        // allocated once in postLoadResource, overwritten in place by every evaluation
+        std::vector<Matrix4x4> m_joint_matrices;
+
+        // blend data built from m_built_blend_state, only rebuilt when the blend setup changes
+        BlendStateWithClipData m_blend_state_with_clip_data;
+        BlendState             m_built_blend_state;
+        bool                   m_is_blend_state_built {false};
+
+        // set when the level animation stage already evaluated this frame, so tick skips it
+        bool m_is_evaluated_by_stage {false};
     };
 } // namespace Piccolo
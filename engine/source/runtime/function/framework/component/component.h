@@ -21,6 +21,10 @@ namespace Piccolo
         // Instantiating the component after definition loaded
         virtual void postLoadResource(std::weak_ptr<GObject> parent_object) { m_parent_object = parent_object; }
 
+        // true if postLoadResource only touches the component and its object, so level loading may run it on a
+        // worker thread; components registering into shared systems (physics, particles, scripts) keep the default
+        virtual bool isPostLoadThreadSafe() const { return false; }
+
         virtual void tick(float delta_time) {};
 
         bool isDirty() const { return m_is_dirty; }
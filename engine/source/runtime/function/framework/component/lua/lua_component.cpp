@@ -1,62 +1,20 @@
 #include "runtime/function/framework/component/lua/lua_component.h"
 #include "runtime/core/base/macro.h"
 #include "runtime/function/framework/object/object.h"
+
+#include <algorithm>
+#include <chrono>
+
 namespace Piccolo
 {
 
-    bool find_component_field(std::weak_ptr<GObject>     game_object,
-                              const char*                field_name,
-                              Reflection::FieldAccessor& field_accessor,
-                              void*&                     target_instance)
-    {
-        auto components = game_object.lock()->getComponents();
-
-        std::istringstream iss(field_name);
-        std::string        current_name;
-        std::getline(iss, current_name, '.');
-        auto component_iter = std::find_if(
-            components.begin(), components.end(), [current_name](auto c) { return c.getTypeName() == current_name; });
-        if (component_iter != components.end())
-        {
-            auto  meta           = Reflection::TypeMeta::newMetaFromName(current_name);
-            void* field_instance = component_iter->getPtr();
-
-            // find target field
-            while (std::getline(iss, current_name, '.'))
-            {
-                Reflection::FieldAccessor* fields;
-                int                        fields_count = meta.getFieldsList(fields);
-                auto                       field_iter   = std::find_if(
-                    fields, fields + fields_count, [current_name](auto f) { return f.getFieldName() == current_name; });
-                if (field_iter == fields + fields_count) // not found
-                {
-                    delete[] fields;
-                    return false;
-                }
-
-                field_accessor = *field_iter;
-                delete[] fields;
-
-                target_instance = field_instance;
-
-                // for next iteration
-                field_instance = field_accessor.get(target_instance);
-                field_accessor.getTypeMeta(meta);
-            }
-            return true;
-        }
-        return false;
-    }
-
     template<typename T>
     void LuaComponent::set(std::weak_ptr<GObject> game_object, const char* name, T value)
     {
-        LOG_INFO(name);
-        Reflection::FieldAccessor field_accessor;
-        void*                     target_instance;
-        if (find_component_field(game_object, name, field_accessor, target_instance))
+        LuaFieldHandle field_handle;
+        if (bindLuaField(game_object, name, field_handle))
         {
-            field_accessor.set(target_instance, &value);
+            field_handle.set<T>(value);
         }
         else
         {
@@ -67,98 +25,117 @@ namespace Piccolo
     template<typename T>
     T LuaComponent::get(std::weak_ptr<GObject> game_object, const char* name)
     {
-
-        LOG_INFO(name);
-
-        Reflection::FieldAccessor field_accessor;
-        void*                     target_instance;
-        if (find_component_field(game_object, name, field_accessor, target_instance))
+        LuaFieldHandle field_handle;
+        if (bindLuaField(game_object, name, field_handle))
         {
-            return *(T*)field_accessor.get(target_instance);
+            return field_handle.get<T>();
         }
         else
         {
             LOG_ERROR("Can't find target field.");
+            return T {};
         }
     }
 
     void LuaComponent::invoke(std::weak_ptr<GObject> game_object, const char* name)
     {
-        LOG_INFO(name);
+        std::shared_ptr<GObject> object = game_object.lock();
+        if (!object)
+            return;
 
-        Reflection::TypeMeta meta;
-        void*                target_instance = nullptr;
-        std::string          method_name;
-
-        // get target instance and meta
-        std::string target_name(name);
-        size_t      pos = target_name.find_last_of('.');
-        method_name     = target_name.substr(pos + 1, target_name.size());
-        target_name     = target_name.substr(0, pos);
-
-        if (target_name.find_first_of('.') == target_name.npos)
+        const LuaMethodPath* method_path = LuaReflectionCache::getInstance().findMethodPath(name);
+        if (method_path == nullptr)
         {
-            // target is a component
-            auto components = game_object.lock()->getComponents();
-
-            auto component_iter = std::find_if(
-                components.begin(), components.end(), [target_name](auto c) { return c.getTypeName() == target_name; });
-            if (component_iter != components.end())
-            {
-                meta            = Reflection::TypeMeta::newMetaFromName(target_name);
-                target_instance = component_iter->getPtr();
-            }
-            else
-            {
-                LOG_ERROR("Cand find component");
-                return;
-            }
+            LOG_ERROR("Cand find method");
+            return;
         }
-        else
+
+        void* target_instance = findComponentInstance(*object, method_path->m_component_type_name);
+        if (target_instance == nullptr)
         {
-            Reflection::FieldAccessor field_accessor;
-            if (find_component_field(game_object, name, field_accessor, target_instance))
-            {
-                target_instance = field_accessor.get(target_instance);
-                field_accessor.getTypeMeta(meta);
-            }
-            else
-            {
-                LOG_ERROR("Can't find target field.");
-                return;
-            }
+            LOG_ERROR("Cand find component");
+            return;
         }
 
-        // invoke function
-        Reflection::MethodAccessor* methods;
-        size_t                      method_count = meta.getMethodsList(methods);
-        auto                        method_iter  = std::find_if(
-            methods, methods + method_count, [method_name](auto m) { return m.getMethodName() == method_name; });
-        if (method_iter != methods + method_count)
+        for (auto field_accessor : method_path->m_field_chain)
         {
-            method_iter->invoke(target_instance);
+            target_instance = field_accessor.get(target_instance);
         }
-        else
+
+        Reflection::MethodAccessor method = method_path->m_method;
+        method.invoke(target_instance);
+    }
+
+    LuaFieldHandle LuaComponent::bindField(std::weak_ptr<GObject> game_object, const char* name)
+    {
+        LuaFieldHandle field_handle;
+        if (!bindLuaField(game_object, name, field_handle))
         {
-            LOG_ERROR("Cand find method");
+            LOG_ERROR("Can't find target field.");
         }
-        delete[] methods;
+        return field_handle;
+    }
+
+    void LuaComponent::registerScriptFunctions(sol::state& lua_state)
+    {
+        lua_state.set_function("set_float", &LuaComponent::set<float>);
+        lua_state.set_function("get_bool", &LuaComponent::get<bool>);
+        lua_state.set_function("invoke", &LuaComponent::invoke);
+
+        // bind once, then read and write the field through the handle in hot loops
+        lua_state.new_usertype<LuaFieldHandle>("FieldHandle",
+                                               "is_valid",
+                                               &LuaFieldHandle::isValid,
+                                               "get_float",
+                                               &LuaFieldHandle::get<float>,
+                                               "set_float",
+                                               &LuaFieldHandle::set<float>,
+                                               "get_bool",
+                                               &LuaFieldHandle::get<bool>,
+                                               "set_bool",
+                                               &LuaFieldHandle::set<bool>);
+        lua_state.set_function("bind_field", &LuaComponent::bindField);
     }
 
     void LuaComponent::postLoadResource(std::weak_ptr<GObject> parent_object)
     {
         m_parent_object = parent_object;
-        m_lua_state.open_libraries(sol::lib::base);
-        m_lua_state.set_function("set_float", &LuaComponent::set<float>);
-        m_lua_state.set_function("get_bool", &LuaComponent::get<bool>);
-        m_lua_state.set_function("invoke", &LuaComponent::invoke);
-        m_lua_state["GameObject"] = m_parent_object;
+
+        LuaScriptCache& script_cache = LuaScriptCache::getInstance();
+        sol::state&     lua_state    = script_cache.getState();
+
+        // globals written by the script land in this environment, unknown names fall back to the shared globals
+        m_lua_environment                = sol::environment(lua_state, sol::create, lua_state.globals());
+        m_lua_environment["GameObject"] = m_parent_object;
+
+        std::shared_ptr<GObject> parent = m_parent_object.lock();
+        m_compiled_script = script_cache.getOrCompile(m_lua_script, parent ? parent->getName() : std::string());
     }
 
     void LuaComponent::tick(float delta_time)
     {
-        // LOG_INFO(m_lua_script);
-        m_lua_state.script(m_lua_script);
+        if (!m_compiled_script)
+            return;
+
+        const auto start_time = std::chrono::steady_clock::now();
+
+        // the chunk is shared, so point it at this component's environment before every call
+        sol::set_environment(m_lua_environment, m_compiled_script->m_chunk);
+        sol::protected_function_result result = m_compiled_script->m_chunk();
+        if (!result.valid())
+        {
+            sol::error error = result;
+            LOG_ERROR(error.what());
+        }
+
+        const double elapsed_ms =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+        LuaScriptProfile& profile = m_compiled_script->m_profile;
+        ++profile.m_invoke_count;
+        profile.m_last_time_ms = elapsed_ms;
+        profile.m_total_time_ms += elapsed_ms;
+        profile.m_max_time_ms = std::max(profile.m_max_time_ms, elapsed_ms);
     }
 
 } // namespace Piccolo
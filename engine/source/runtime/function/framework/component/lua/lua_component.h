@@ -1,6 +1,8 @@
 #pragma once
 #include "sol/sol.hpp"
 #include "runtime/function/framework/component/component.h"
+#include "runtime/function/framework/component/lua/lua_field_binding.h"
+#include "runtime/function/framework/component/lua/lua_script_cache.h"
 
 namespace Piccolo
 {
@@ -23,8 +25,21 @@ namespace Piccolo
         static T get(std::weak_ptr<GObject> game_object, const char* name);
 
         static void invoke(std::weak_ptr<GObject> game_object, const char* name);
+
+        static LuaFieldHandle bindField(std::weak_ptr<GObject> game_object, const char* name);
+
+        // bind the native functions scripts can call, done once for the shared lua state
+        static void registerScriptFunctions(sol::state& lua_state);
+
+        const LuaScriptProfile* getScriptProfile() const
+        {
+            return m_compiled_script ? &m_compiled_script->m_profile : nullptr;
+        }
+
     protected:
-        sol::state m_lua_state;
+        std::shared_ptr<LuaCompiledScript> m_compiled_script;
+        sol::environment                   m_lua_environment;
+
         META(Enable)
         std::string m_lua_script;
     };
@@ -0,0 +1,179 @@
+#include "runtime/function/framework/component/lua/lua_field_binding.h"
+
+#include "runtime/core/base/macro.h"
+
+#include "runtime/function/framework/object/object.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace Piccolo
+{
+    namespace
+    {
+        std::vector<std::string> splitPath(const std::string& path)
+        {
+            std::vector<std::string> names;
+            std::istringstream       iss(path);
+            std::string              current_name;
+            while (std::getline(iss, current_name, '.'))
+            {
+                names.push_back(current_name);
+            }
+            return names;
+        }
+
+        // resolve names[begin, end) as a field chain starting from meta, meta ends as the type of the last field
+        bool resolveFieldChain(Reflection::TypeMeta&                   meta,
+                               const std::vector<std::string>&         names,
+                               size_t                                  begin,
+                               size_t                                  end,
+                               std::vector<Reflection::FieldAccessor>& out_field_chain)
+        {
+            for (size_t index = begin; index < end; ++index)
+            {
+                const std::string& current_name = names[index];
+
+                Reflection::FieldAccessor* fields;
+                int                        fields_count = meta.getFieldsList(fields);
+                auto                       field_iter   = std::find_if(
+                    fields, fields + fields_count, [&current_name](auto f) { return f.getFieldName() == current_name; });
+                if (field_iter == fields + fields_count) // not found
+                {
+                    delete[] fields;
+                    return false;
+                }
+
+                Reflection::FieldAccessor field_accessor = *field_iter;
+                delete[] fields;
+
+                field_accessor.getTypeMeta(meta);
+                out_field_chain.push_back(field_accessor);
+            }
+            return true;
+        }
+    } // namespace
+
+    void* LuaFieldPath::getFieldOwner(void* component_instance) const
+    {
+        void* field_owner = component_instance;
+        for (size_t index = 0; index + 1 < m_field_chain.size(); ++index)
+        {
+            // FieldAccessor::get is not const, but it doesn't modify the accessor
+            field_owner = const_cast<Reflection::FieldAccessor&>(m_field_chain[index]).get(field_owner);
+        }
+        return field_owner;
+    }
+
+    LuaReflectionCache& LuaReflectionCache::getInstance()
+    {
+        static LuaReflectionCache instance;
+        return instance;
+    }
+
+    const LuaFieldPath* LuaReflectionCache::findFieldPath(const std::string& path)
+    {
+        auto iter = m_field_paths.find(path);
+        if (iter != m_field_paths.end())
+        {
+            return iter->second.get();
+        }
+
+        std::unique_ptr<LuaFieldPath> field_path;
+
+        std::vector<std::string> names = splitPath(path);
+        if (names.size() >= 2)
+        {
+            field_path                        = std::make_unique<LuaFieldPath>();
+            field_path->m_component_type_name = names[0];
+
+            auto meta = Reflection::TypeMeta::newMetaFromName(names[0]);
+            if (!resolveFieldChain(meta, names, 1, names.size(), field_path->m_field_chain))
+            {
+                field_path.reset();
+            }
+        }
+
+        const LuaFieldPath* result = field_path.get();
+        m_field_paths.emplace(path, std::move(field_path));
+        return result;
+    }
+
+    const LuaMethodPath* LuaReflectionCache::findMethodPath(const std::string& path)
+    {
+        auto iter = m_method_paths.find(path);
+        if (iter != m_method_paths.end())
+        {
+            return iter->second.get();
+        }
+
+        std::unique_ptr<LuaMethodPath> method_path;
+
+        std::vector<std::string> names = splitPath(path);
+        if (names.size() >= 2)
+        {
+            method_path                        = std::make_unique<LuaMethodPath>();
+            method_path->m_component_type_name = names[0];
+
+            // the method owner is the component itself or the last field before the method name
+            auto meta = Reflection::TypeMeta::newMetaFromName(names[0]);
+            bool is_resolved = resolveFieldChain(meta, names, 1, names.size() - 1, method_path->m_field_chain);
+            if (is_resolved)
+            {
+                const std::string& method_name = names.back();
+
+                Reflection::MethodAccessor* methods;
+                size_t                      method_count = meta.getMethodsList(methods);
+                auto                        method_iter  = std::find_if(
+                    methods, methods + method_count, [&method_name](auto m) { return m.getMethodName() == method_name; });
+                if (method_iter != methods + method_count)
+                {
+                    method_path->m_method = *method_iter;
+                }
+                else
+                {
+                    is_resolved = false;
+                }
+                delete[] methods;
+            }
+
+            if (!is_resolved)
+            {
+                method_path.reset();
+            }
+        }
+
+        const LuaMethodPath* result = method_path.get();
+        m_method_paths.emplace(path, std::move(method_path));
+        return result;
+    }
+
+    void LuaReflectionCache::clear()
+    {
+        m_field_paths.clear();
+        m_method_paths.clear();
+    }
+
+    void* findComponentInstance(GObject& game_object, const std::string& component_type_name)
+    {
+        return game_object.tryGetComponent<Component>(component_type_name);
+    }
+
+    bool bindLuaField(std::weak_ptr<GObject> game_object, const std::string& path, LuaFieldHandle& out_handle)
+    {
+        std::shared_ptr<GObject> object = game_object.lock();
+        if (!object)
+            return false;
+
+        const LuaFieldPath* field_path = LuaReflectionCache::getInstance().findFieldPath(path);
+        if (field_path == nullptr)
+            return false;
+
+        void* component_instance = findComponentInstance(*object, field_path->m_component_type_name);
+        if (component_instance == nullptr)
+            return false;
+
+        out_handle = LuaFieldHandle(game_object, field_path->getFieldOwner(component_instance), field_path->m_field_chain.back());
+        return true;
+    }
+} // namespace Piccolo
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "runtime/core/meta/reflection/reflection.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Piccolo
+{
+    class GObject;
+
+    /// A dotted path like "MotorComponent.m_motor_res.m_jump_height" resolved once into an accessor chain.
+    /// The first name is the component type, every following name is a field of the previous one.
+    struct LuaFieldPath
+    {
+        std::string                            m_component_type_name;
+        std::vector<Reflection::FieldAccessor> m_field_chain;
+
+        // walk all the accessors but the last one, return the instance owning the target field
+        void* getFieldOwner(void* component_instance) const;
+    };
+
+    /// A dotted path ending with a method name, the method owner is reached through m_field_chain
+    struct LuaMethodPath
+    {
+        std::string                            m_component_type_name;
+        std::vector<Reflection::FieldAccessor> m_field_chain;
+        Reflection::MethodAccessor             m_method;
+    };
+
+    /// Field handle given to scripts by bind_field, reads and writes don't touch any string
+    class LuaFieldHandle
+    {
+    public:
+        LuaFieldHandle() = default;
+        LuaFieldHandle(std::weak_ptr<GObject> game_object, void* field_owner, const Reflection::FieldAccessor& field) :
+            m_game_object(game_object), m_field_owner(field_owner), m_field(field)
+        {}
+
+        bool isValid() const { return m_field_owner != nullptr && !m_game_object.expired(); }
+
+        template<typename T>
+        T get()
+        {
+            if (!isValid())
+                return T {};
+            return *static_cast<T*>(m_field.get(m_field_owner));
+        }
+
+        template<typename T>
+        void set(T value)
+        {
+            if (!isValid())
+                return;
+            m_field.set(m_field_owner, &value);
+        }
+
+    private:
+        std::weak_ptr<GObject>    m_game_object;
+        void*                     m_field_owner {nullptr};
+        Reflection::FieldAccessor m_field;
+    };
+
+    /// Resolved field and method paths shared by all the lua scripts.
+    /// Key: dotted path, which starts with the component type name, so it identifies (type name, field path).
+    class LuaReflectionCache
+    {
+    public:
+        static LuaReflectionCache& getInstance();
+
+        // return nullptr if the path can't be resolved, failures are cached too
+        const LuaFieldPath*  findFieldPath(const std::string& path);
+        const LuaMethodPath* findMethodPath(const std::string& path);
+
+        void clear();
+
+    private:
+        std::unordered_map<std::string, std::unique_ptr<LuaFieldPath>>  m_field_paths;
+        std::unordered_map<std::string, std::unique_ptr<LuaMethodPath>> m_method_paths;
+    };
+
+    // find the component instance of the given type name on the object, without copying the component list
+    void* findComponentInstance(GObject& game_object, const std::string& component_type_name);
+
+    bool bindLuaField(std::weak_ptr<GObject> game_object, const std::string& path, LuaFieldHandle& out_handle);
+} // namespace Piccolo
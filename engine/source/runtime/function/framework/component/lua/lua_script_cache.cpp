@@ -0,0 +1,60 @@
+#include "runtime/function/framework/component/lua/lua_script_cache.h"
+
+#include "runtime/core/base/macro.h"
+
+#include "runtime/function/framework/component/lua/lua_component.h"
+
+namespace Piccolo
+{
+    LuaScriptCache& LuaScriptCache::getInstance()
+    {
+        static LuaScriptCache instance;
+        return instance;
+    }
+
+    LuaScriptCache::LuaScriptCache()
+    {
+        m_lua_state.open_libraries(sol::lib::base);
+        LuaComponent::registerScriptFunctions(m_lua_state);
+    }
+
+    std::shared_ptr<LuaCompiledScript> LuaScriptCache::getOrCompile(const std::string& source, const std::string& name)
+    {
+        auto iter = m_scripts.find(source);
+        if (iter != m_scripts.end())
+        {
+            return iter->second;
+        }
+
+        sol::load_result load_result = m_lua_state.load(source);
+        if (!load_result.valid())
+        {
+            sol::error error = load_result;
+            LOG_ERROR("failed to compile lua script of {}: {}", name, error.what());
+            return nullptr;
+        }
+
+        auto compiled_script     = std::make_shared<LuaCompiledScript>();
+        compiled_script->m_name  = name;
+        compiled_script->m_chunk = load_result.get<sol::protected_function>();
+
+        m_scripts.emplace(source, compiled_script);
+        return compiled_script;
+    }
+
+    void LuaScriptCache::logProfiles() const
+    {
+        for (const auto& script_pair : m_scripts)
+        {
+            const LuaScriptProfile& profile = script_pair.second->m_profile;
+            LOG_INFO("lua script of {} invoked {} times, avg {} ms, max {} ms, total {} ms",
+                     script_pair.second->m_name,
+                     profile.m_invoke_count,
+                     profile.getAverageTimeMs(),
+                     profile.m_max_time_ms,
+                     profile.m_total_time_ms);
+        }
+    }
+
+    void LuaScriptCache::clear() { m_scripts.clear(); }
+} // namespace Piccolo
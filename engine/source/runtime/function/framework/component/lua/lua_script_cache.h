@@ -0,0 +1,62 @@
+#pragma once
+
+#include "sol/sol.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace Piccolo
+{
+    /// timing counters accumulated over every invocation of a compiled script
+    struct LuaScriptProfile
+    {
+        uint64_t m_invoke_count {0};
+        double   m_last_time_ms {0.0};
+        double   m_max_time_ms {0.0};
+        double   m_total_time_ms {0.0};
+
+        double getAverageTimeMs() const { return m_invoke_count == 0 ? 0.0 : m_total_time_ms / m_invoke_count; }
+    };
+
+    /// a lua chunk compiled once and shared by all the components with the same source
+    struct LuaCompiledScript
+    {
+        // name of the object that compiled it first, scripts are inline so logs use it instead of the source
+        std::string             m_name;
+        sol::protected_function m_chunk;
+        LuaScriptProfile        m_profile;
+    };
+
+    /// Owns the lua state shared by all LuaComponents and the compiled chunks keyed by script source.
+    /// Every component runs its chunk inside its own environment, so script globals stay per object.
+    class LuaScriptCache
+    {
+    public:
+        static LuaScriptCache& getInstance();
+
+        sol::state& getState() { return m_lua_state; }
+
+        // compile the source on first use, return nullptr if it fails to compile
+        std::shared_ptr<LuaCompiledScript> getOrCompile(const std::string& source, const std::string& name);
+
+        const std::unordered_map<std::string, std::shared_ptr<LuaCompiledScript>>& getScripts() const
+        {
+            return m_scripts;
+        }
+
+        void logProfiles() const;
+
+        // drop the compiled chunks, called once the level that used them is unloaded
+        void clear();
+
+    private:
+        LuaScriptCache();
+
+        sol::state m_lua_state;
+
+        // key: script source, value: compiled chunk
+        std::unordered_map<std::string, std::shared_ptr<LuaCompiledScript>> m_scripts;
+    };
+} // namespace Piccolo
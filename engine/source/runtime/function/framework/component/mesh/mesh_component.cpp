@@ -33,8 +33,9 @@ namespace Piccolo
 
             if (meshComponent.m_material_desc.m_with_texture)
             {
+                // materials are shared by many sub meshes, parse each file once
                 MaterialRes material_res;
-                asset_manager->loadAsset(sub_mesh.m_material, material_res);
+                asset_manager->loadCachedAsset(sub_mesh.m_material, material_res);
 
                 meshComponent.m_material_desc.m_base_color_texture_file =
                     asset_manager->getFullPath(material_res.m_base_colour_texture_file).generic_string();
@@ -69,14 +70,19 @@ namespace Piccolo
         {
             std::vector<GameObjectPartDesc> dirty_mesh_parts;
             SkeletonAnimationResult         animation_result;
-            animation_result.m_transforms.push_back({Matrix4x4::IDENTITY});
             if (animation_component != nullptr)
             {
-                for (auto& node : animation_component->getResult().node)
+                const std::vector<Matrix4x4>& joint_matrices = animation_component->getJointMatrices();
+                animation_result.m_transforms.resize(joint_matrices.size());
+                for (size_t i = 0; i < joint_matrices.size(); ++i)
                 {
-                    animation_result.m_transforms.push_back({Matrix4x4(node.transform)});
+                    animation_result.m_transforms[i].m_matrix = joint_matrices[i];
                 }
             }
+            else
+            {
+                animation_result.m_transforms.push_back({Matrix4x4::IDENTITY});
+            }
             for (GameObjectPartDesc& mesh_part : m_raw_meshes)
             {
                 if (animation_component)
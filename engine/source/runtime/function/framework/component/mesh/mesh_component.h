@@ -20,6 +20,7 @@ namespace Piccolo
         MeshComponent() {};
 
         void postLoadResource(std::weak_ptr<GObject> parent_object) override;
+        bool isPostLoadThreadSafe() const override { return true; }
 
         const std::vector<GameObjectPartDesc>& getRawMeshes() const { return m_raw_meshes; }
 
@@ -17,6 +17,7 @@ namespace Piccolo
         TransformComponent() = default;
 
         void postLoadResource(std::weak_ptr<GObject> parent_object) override;
+        bool isPostLoadThreadSafe() const override { return true; }
 
         Vector3    getPosition() const { return m_transform_buffer[m_current_index].m_position; }
         Vector3    getScale() const { return m_transform_buffer[m_current_index].m_scale; }
@@ -1,16 +1,20 @@
 #include "runtime/function/framework/level/level.h"
 
 #include "runtime/core/base/macro.h"
+#include "runtime/core/base/thread_pool.h"
 
 #include "runtime/resource/asset_manager/asset_manager.h"
 #include "runtime/resource/res_type/common/level.h"
 
 #include "runtime/engine.h"
 #include "runtime/function/character/character.h"
+#include "runtime/function/framework/component/animation/animation_component.h"
+#include "runtime/function/framework/component/lua/lua_script_cache.h"
 #include "runtime/function/framework/object/object.h"
 #include "runtime/function/particle/particle_manager.h"
 #include "runtime/function/physics/physics_manager.h"
 #include "runtime/function/physics/physics_scene.h"
+#include <algorithm>
 #include <limits>
 
 namespace Piccolo
@@ -18,6 +22,7 @@ namespace Piccolo
     void Level::clear()
     {
         m_current_active_character.reset();
+        m_animation_components.clear();
         m_gobjects.clear();
 
         ASSERT(g_runtime_global_context.m_physics_manager);
@@ -58,8 +63,17 @@ namespace Piccolo
 
         m_level_res_url = level_res_url;
 
-        LevelRes   level_res;
-        const bool is_load_success = g_runtime_global_context.m_asset_manager->loadAsset(level_res_url, level_res);
+        // the binary variant written by save() skips json parsing, it is used while it is newer than the json
+        std::shared_ptr<AssetManager> asset_manager = g_runtime_global_context.m_asset_manager;
+        const std::string             load_url      = asset_manager->getPreferredAssetUrl(level_res_url);
+
+        LevelRes level_res;
+        bool     is_load_success = asset_manager->loadAsset(load_url, level_res);
+        if (is_load_success == false && load_url != level_res_url)
+        {
+            level_res       = LevelRes {};
+            is_load_success = asset_manager->loadAsset(level_res_url, level_res);
+        }
         if (is_load_success == false)
         {
             return false;
@@ -69,9 +83,39 @@ namespace Piccolo
         m_physics_scene = g_runtime_global_context.m_physics_manager->createPhysicsScene(level_res.m_gravity);
         ParticleEmitterIDAllocator::reset();
 
-        for (const ObjectInstanceRes& object_instance_res : level_res.m_objects)
+        // parse and instantiate the objects on the worker pool, definitions shared by several objects are parsed once
+        const size_t                          object_count = level_res.m_objects.size();
+        std::vector<std::shared_ptr<GObject>> loaded_objects(object_count);
+        std::vector<char>                     is_object_prepared(object_count, 0);
+        for (size_t object_index = 0; object_index < object_count; ++object_index)
         {
-            createObject(object_instance_res);
+            GObjectID object_id = ObjectIDAllocator::alloc();
+            ASSERT(object_id != k_invalid_gobject_id);
+            loaded_objects[object_index] = std::make_shared<GObject>(object_id);
+        }
+
+        ThreadPool&  thread_pool = *g_runtime_global_context.m_thread_pool;
+        const size_t grain_size  = std::max<size_t>(1, object_count / (4 * (thread_pool.getThreadCount() + 1)));
+        thread_pool.parallelFor(object_count, grain_size, [&](size_t begin, size_t end) {
+            for (size_t object_index = begin; object_index < end; ++object_index)
+            {
+                is_object_prepared[object_index] =
+                    loaded_objects[object_index]->prepareLoad(level_res.m_objects[object_index]);
+            }
+        });
+
+        // components registering into the physics scene and other shared systems are post-loaded here, in level order
+        for (size_t object_index = 0; object_index < object_count; ++object_index)
+        {
+            const std::shared_ptr<GObject>& gobject = loaded_objects[object_index];
+            if (!is_object_prepared[object_index])
+            {
+                LOG_ERROR("loading object " + level_res.m_objects[object_index].m_name + " failed");
+                continue;
+            }
+
+            gobject->finishLoad();
+            m_gobjects.emplace(gobject->getID(), gobject);
         }
 
         // create active character
@@ -98,6 +142,12 @@ namespace Piccolo
     void Level::unload()
     {
         clear();
+
+        // the timings of the scripts run by this level are reported before their compiled chunks are dropped
+        LuaScriptCache::getInstance().logProfiles();
+        LuaScriptCache::getInstance().clear();
+        // definitions shared by the objects of this level are parsed again by the next one, drop them with the level
+        g_runtime_global_context.m_asset_manager->clearAssetCache();
         LOG_INFO("unload level: {}", m_level_res_url);
     }
 
@@ -129,6 +179,12 @@ namespace Piccolo
         }
         else
         {
+            // the json stays the source of truth, a missing binary variant only costs load time
+            if (!g_runtime_global_context.m_asset_manager->saveAsset(
+                    output_level_res, AssetManager::getBinaryAssetUrl(m_level_res_url)))
+            {
+                LOG_WARN("failed to save the binary variant of {}", m_level_res_url);
+            }
             LOG_INFO("level save succeed");
         }
 
@@ -142,6 +198,8 @@ namespace Piccolo
             return;
         }
 
+        tickAnimations(delta_time);
+
         for (const auto& id_object_pair : m_gobjects)
         {
             assert(id_object_pair.second);
@@ -162,6 +220,45 @@ namespace Piccolo
         }
     }
 
+    void Level::tickAnimations(float delta_time)
+    {
+        m_animation_components.clear();
+        if (!shouldComponentTick("AnimationComponent"))
+        {
+            return;
+        }
+
+        // blend data refresh touches the shared animation caches, keep it on this thread
+        for (const auto& id_object_pair : m_gobjects)
+        {
+            if (!id_object_pair.second)
+                continue;
+
+            AnimationComponent* animation_component = id_object_pair.second->tryGetComponent(AnimationComponent);
+            if (animation_component)
+            {
+                animation_component->prepareAnimation(delta_time);
+                m_animation_components.push_back(animation_component);
+            }
+        }
+
+        // skeletons are independent and only read the immutable clips, so evaluate them on the worker pool
+        ThreadPool&  thread_pool = *g_runtime_global_context.m_thread_pool;
+        const size_t grain_size =
+            std::max<size_t>(1, m_animation_components.size() / (4 * (thread_pool.getThreadCount() + 1)));
+        thread_pool.parallelFor(m_animation_components.size(), grain_size, [this](size_t begin, size_t end) {
+            for (size_t index = begin; index < end; ++index)
+            {
+                m_animation_components[index]->evaluateAnimation();
+            }
+        });
+
+        for (AnimationComponent* animation_component : m_animation_components)
+        {
+            animation_component->setEvaluatedByStage(true);
+        }
+    }
+
     std::weak_ptr<GObject> Level::getGObjectByID(GObjectID go_id) const
     {
         auto iter = m_gobjects.find(go_id);
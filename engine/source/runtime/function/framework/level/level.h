@@ -5,9 +5,11 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace Piccolo
 {
+    class AnimationComponent;
     class Character;
     class GObject;
     class ObjectInstanceRes;
@@ -43,6 +45,9 @@ namespace Piccolo
     protected:
         void clear();
 
+        // evaluate every active skeleton in parallel before the objects tick, so meshes consume this frame's pose
+        void tickAnimations(float delta_time);
+
         bool        m_is_loaded {false};
         std::string m_level_res_url;
 
@@ -52,5 +57,8 @@ namespace Piccolo
         std::shared_ptr<Character> m_current_active_character;
 
         std::weak_ptr<PhysicsScene> m_physics_scene;
+
+        // gathered every tick, kept as a member to reuse the storage
+        std::vector<AnimationComponent*> m_animation_components;
     };
 } // namespace Piccolo
@@ -108,37 +108,23 @@ namespace Piccolo
                                       .getMatrix();
 
         const Skeleton& skeleton    = animation_component->getSkeleton();
-        const Bone*     bones       = skeleton.getBones();
         int32_t         bones_count = skeleton.getBonesCount();
         for (int32_t bone_index = 0; bone_index < bones_count; bone_index++)
         {
-            if (bones[bone_index].getParent() == nullptr || bone_index == 1)
+            const int32_t parent_index = skeleton.getBoneParentIndex(bone_index);
+            if (parent_index == Skeleton::k_invalid_parent_index || bone_index == 1)
                 continue;
 
-            Matrix4x4 bone_matrix = Transform(bones[bone_index]._getDerivedPosition(),
-                                              bones[bone_index]._getDerivedOrientation(),
-                                              bones[bone_index]._getDerivedScale())
-                                        .getMatrix();
-            Vector4 bone_position(0.0f, 0.0f, 0.0f, 1.0f);
-            bone_position = object_matrix * bone_matrix * bone_position;
-            bone_position /= bone_position[3];
-
-            Node*     parent_bone        = bones[bone_index].getParent();
-            Matrix4x4 parent_bone_matrix = Transform(parent_bone->_getDerivedPosition(),
-                                                     parent_bone->_getDerivedOrientation(),
-                                                     parent_bone->_getDerivedScale())
-                                               .getMatrix();
-            Vector4 parent_bone_position(0.0f, 0.0f, 0.0f, 1.0f);
-            parent_bone_position = object_matrix * parent_bone_matrix * parent_bone_position;
-            parent_bone_position /= parent_bone_position[3];
-
-            debug_draw_group->addLine(Vector3(bone_position.x, bone_position.y, bone_position.z),
-                                      Vector3(parent_bone_position.x, parent_bone_position.y, parent_bone_position.z),
+            Vector3 bone_position        = object_matrix * skeleton.getBoneModelPosition(bone_index);
+            Vector3 parent_bone_position = object_matrix * skeleton.getBoneModelPosition(parent_index);
+
+            debug_draw_group->addLine(bone_position,
+                                      parent_bone_position,
                                       Vector4(1.0f, 0.0f, 0.0f, 1.0f),
                                       Vector4(1.0f, 0.0f, 0.0f, 1.0f),
                                       0.0f,
                                       true);
-            debug_draw_group->addSphere(Vector3(bone_position.x, bone_position.y, bone_position.z),
+            debug_draw_group->addSphere(bone_position,
                                         0.015f,
                                         Vector4(0.0f, 0.0f, 1.0f, 1.0f),
                                         0.0f,
@@ -165,24 +151,17 @@ namespace Piccolo
                                       .getMatrix();
 
         const Skeleton& skeleton    = animation_component->getSkeleton();
-        const Bone*     bones       = skeleton.getBones();
         int32_t         bones_count = skeleton.getBonesCount();
         for (int32_t bone_index = 0; bone_index < bones_count; bone_index++)
         {
-            if (bones[bone_index].getParent() == nullptr || bone_index == 1)
+            if (skeleton.getBoneParentIndex(bone_index) == Skeleton::k_invalid_parent_index || bone_index == 1)
                 continue;
 
-            Matrix4x4 bone_matrix = Transform(bones[bone_index]._getDerivedPosition(),
-                                              bones[bone_index]._getDerivedOrientation(),
-                                              bones[bone_index]._getDerivedScale())
-                                        .getMatrix();
-            Vector4 bone_position(0.0f, 0.0f, 0.0f, 1.0f);
-            bone_position = object_matrix * bone_matrix * bone_position;
-            bone_position /= bone_position[3];
+            Vector3 bone_position = object_matrix * skeleton.getBoneModelPosition(bone_index);
 
-            debug_draw_group->addText(bones[bone_index].getName(),
+            debug_draw_group->addText(skeleton.getBoneName(bone_index),
                                       Vector4(1.0f, 0.0f, 0.0f, 1.0f),
-                                      Vector3(bone_position.x, bone_position.y, bone_position.z),
+                                      bone_position,
                                       8,
                                       false);
         }
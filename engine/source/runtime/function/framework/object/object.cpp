@@ -61,6 +61,15 @@ namespace Piccolo
     }
 
     bool GObject::load(const ObjectInstanceRes& object_instance_res)
+    {
+        if (!prepareLoad(object_instance_res))
+            return false;
+
+        finishLoad();
+        return true;
+    }
+
+    bool GObject::prepareLoad(const ObjectInstanceRes& object_instance_res)
     {
         // clear old components
         m_components.clear();
@@ -69,20 +78,14 @@ namespace Piccolo
 
         // load object instanced components
         m_components = object_instance_res.m_instanced_components;
-        for (auto component : m_components)
-        {
-            if (component)
-            {
-                component->postLoadResource(weak_from_this());
-            }
-        }
 
-        // load object definition components
+        // load object definition components, instances of a prefab share one parsed definition file
         m_definition_url = object_instance_res.m_definition;
 
         ObjectDefinitionRes definition_res;
 
-        const bool is_loaded_success = g_runtime_global_context.m_asset_manager->loadAsset(m_definition_url, definition_res);
+        const bool is_loaded_success =
+            g_runtime_global_context.m_asset_manager->loadCachedAsset(m_definition_url, definition_res);
         if (!is_loaded_success)
             return false;
 
@@ -93,14 +96,31 @@ namespace Piccolo
             if (hasComponent(type_name))
                 continue;
 
-            loaded_component->postLoadResource(weak_from_this());
-
             m_components.push_back(loaded_component);
         }
 
+        for (auto& component : m_components)
+        {
+            if (component && component->isPostLoadThreadSafe())
+            {
+                component->postLoadResource(weak_from_this());
+            }
+        }
+
         return true;
     }
 
+    void GObject::finishLoad()
+    {
+        for (auto& component : m_components)
+        {
+            if (component && !component->isPostLoadThreadSafe())
+            {
+                component->postLoadResource(weak_from_this());
+            }
+        }
+    }
+
     void GObject::save(ObjectInstanceRes& out_object_instance_res)
     {
         out_object_instance_res.m_name       = m_name;
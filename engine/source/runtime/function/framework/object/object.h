@@ -12,6 +12,9 @@
 
 namespace Piccolo
 {
+    // in editor mode only the component types registered in g_editor_tick_component_types tick
+    bool shouldComponentTick(std::string component_type_name);
+
     /// GObject : Game Object base class
     class GObject : public std::enable_shared_from_this<GObject>
     {
@@ -24,6 +27,12 @@ namespace Piccolo
         virtual void tick(float delta_time);
 
         bool load(const ObjectInstanceRes& object_instance_res);
+        // load split in two for parallel level loading: prepareLoad builds the components from the instance and the
+        // cached definition and may run on a worker thread, finishLoad post-loads the remaining components and
+        // must run on the logic thread
+        bool prepareLoad(const ObjectInstanceRes& object_instance_res);
+        void finishLoad();
+
         void save(ObjectInstanceRes& out_object_instance_res);
 
         GObjectID getID() const { return m_id; }
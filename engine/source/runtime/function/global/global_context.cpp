@@ -1,5 +1,6 @@
 #include "runtime/function/global/global_context.h"
 
+#include "core/base/thread_pool.h"
 #include "core/log/log_system.h"
 
 #include "runtime/engine.h"
@@ -36,7 +37,14 @@ namespace Sammi
 
         m_logger_system = std::make_shared<LogSystem>();
 
+        m_thread_pool = std::make_shared<ThreadPool>();
+
         m_asset_manager = std::make_shared<AssetManager>();
+        // ԴʱȴԴȡԴûеԴ˵ɢļ
+        if (!m_config_manager->getAssetPakPath().empty())
+        {
+            m_asset_manager->mountPak(m_config_manager->getAssetPakPath());
+        }
 
         m_physics_manager = std::make_shared<PhysicsManager>();
         m_physics_manager->initialize();
@@ -65,25 +73,53 @@ namespace Sammi
         m_render_debug_config = std::make_shared<RenderDebugConfig>();
     }
 
+    void RuntimeGlobalContext::startToolSystems(const std::string& config_file_path)
+    {
+        m_config_manager = std::make_shared<ConfigManager>();
+        m_config_manager->initialize(config_file_path);
+
+        m_file_system = std::make_shared<FileSystem>();
+
+        m_logger_system = std::make_shared<LogSystem>();
+
+        m_thread_pool = std::make_shared<ThreadPool>();
+
+        // ߶дĶɢļԴ
+        m_asset_manager = std::make_shared<AssetManager>();
+    }
+
     void RuntimeGlobalContext::shutdownSystems()
     {
         m_render_debug_config.reset();
 
         m_debugdraw_manager.reset();
 
-        m_render_system->clear();
-        m_render_system.reset();
+        // startToolSystemsϵͳ
+        if (m_render_system)
+        {
+            m_render_system->clear();
+            m_render_system.reset();
+        }
 
         m_window_system.reset();
 
-        m_world_manager->clear();
-        m_world_manager.reset();
+        if (m_world_manager)
+        {
+            m_world_manager->clear();
+            m_world_manager.reset();
+        }
 
-        m_physics_manager->clear();
-        m_physics_manager.reset();
+        if (m_physics_manager)
+        {
+            m_physics_manager->clear();
+            m_physics_manager.reset();
+        }
 
-        m_input_system->clear();
-        m_input_system.reset();
+        if (m_input_system)
+        {
+            m_input_system->clear();
+            m_input_system.reset();
+        }
 
         m_asset_manager.reset();
 
@@ -94,5 +130,7 @@ namespace Sammi
         m_config_manager.reset();
 
         m_particle_manager.reset();
+
+        m_thread_pool.reset();
     }
 } // namespace Piccolo
\ No newline at end of file
@@ -20,6 +20,7 @@ namespace Sammi
     class ParticleManager;    // ӹЧ桢
     class DebugDrawManager;   // Իƹʾײ塢߽ȵϢ
     class RenderDebugConfig;  // ȾãƵԹܿأʾ
+    class ThreadPool;         // ̳߳أ޳ԴصȲʹã
 
     // ʼṹ壨ǰδչܰʼѡ
     // 磺ǷõģʽԶԴ·ȣԤչ
@@ -34,6 +35,10 @@ namespace Sammi
         // config_file_path - ļ·"Config/Engine.ini"
         void startSystems(const std::string& config_file_path);
 
+        // ֻ߹Ҫϵͳá־̳߳ءʲȾҲԴ
+        // Դ決йʹãͬshutdownSystemsر
+        void startToolSystems(const std::string& config_file_path);
+
         // رȫϵͳ˳ͷԴ
         void shutdownSystems();
 
@@ -50,6 +55,7 @@ namespace Sammi
         std::shared_ptr<ParticleManager>   m_particle_manager;
         std::shared_ptr<DebugDrawManager>  m_debugdraw_manager;
         std::shared_ptr<RenderDebugConfig> m_render_debug_config;
+        std::shared_ptr<ThreadPool>        m_thread_pool;
     };
 
     // ȫʵģʽȫΨһڣ
@@ -28,6 +28,13 @@ namespace Sammi
         virtual void prepareContext() = 0;
 
         virtual bool isPointLightShadowEnabled() = 0;
+        virtual bool isTextureCompressionBCSupported() = 0;
+        // indirect draws with a non-zero firstInstance, required by the gpu driven mesh draws
+        virtual bool isDrawIndirectFirstInstanceSupported() = 0;
+        // drawCount > 1 in one indirect draw
+        virtual bool isMultiDrawIndirectSupported() = 0;
+        // draw count read from a buffer (VK_KHR_draw_indirect_count)
+        virtual bool isDrawIndirectCountSupported() = 0;
         // allocate and create
         virtual bool allocateCommandBuffers(const RHICommandBufferAllocateInfo* pAllocateInfo, RHICommandBuffer* &pCommandBuffers) = 0;
         virtual bool allocateDescriptorSets(const RHIDescriptorSetAllocateInfo* pAllocateInfo, RHIDescriptorSet* &pDescriptorSets) = 0;
@@ -59,8 +66,8 @@ namespace Sammi
             RHIImage* &image, RHIDeviceMemory* &memory, RHIImageCreateFlags image_create_flags, uint32_t array_layers, uint32_t miplevels) = 0;
         virtual void createImageView(RHIImage* image, RHIFormat format, RHIImageAspectFlags image_aspect_flags, RHIImageViewType view_type, uint32_t layout_count, uint32_t miplevels,
             RHIImageView* &image_view) = 0;
-        virtual void createGlobalImage(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, void* texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels = 0) = 0;
-        virtual void createCubeMap(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, std::array<void*, 6> texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels) = 0;
+        virtual void createGlobalImage(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, void* texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels = 0, uint32_t uploaded_miplevels = 1) = 0;
+        virtual void createCubeMap(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, std::array<void*, 6> texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels, uint32_t uploaded_miplevels = 1) = 0;
         virtual void createCommandPool() = 0;
         virtual bool createCommandPool(const RHICommandPoolCreateInfo* pCreateInfo, RHICommandPool*& pCommandPool) = 0;
         virtual bool createDescriptorPool(const RHIDescriptorPoolCreateInfo* pCreateInfo, RHIDescriptorPool* &pDescriptorPool) = 0;
@@ -112,6 +119,10 @@ namespace Sammi
         virtual void cmdDraw(RHICommandBuffer* commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) = 0;
         virtual void cmdDispatch(RHICommandBuffer* commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) = 0;
         virtual void cmdDispatchIndirect(RHICommandBuffer* commandBuffer, RHIBuffer* buffer, RHIDeviceSize offset) = 0;
+        virtual void cmdDrawIndexedIndirect(RHICommandBuffer* commandBuffer, RHIBuffer* buffer, RHIDeviceSize offset, uint32_t drawCount, uint32_t stride) = 0;
+        virtual void cmdDrawIndexedIndirectCount(RHICommandBuffer* commandBuffer, RHIBuffer* buffer, RHIDeviceSize offset, RHIBuffer* countBuffer, RHIDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride) = 0;
+        // runs secondary command buffers from a primary one, the secondaries of a subpass need its inheritance info
+        virtual void cmdExecuteCommands(RHICommandBuffer* commandBuffer, uint32_t commandBufferCount, RHICommandBuffer* const* pCommandBuffers) = 0;
         virtual void cmdPipelineBarrier(RHICommandBuffer* commandBuffer, RHIPipelineStageFlags srcStageMask, RHIPipelineStageFlags dstStageMask, RHIDependencyFlags dependencyFlags, uint32_t memoryBarrierCount, const RHIMemoryBarrier* pMemoryBarriers, uint32_t bufferMemoryBarrierCount, const RHIBufferMemoryBarrier* pBufferMemoryBarriers, uint32_t imageMemoryBarrierCount, const RHIImageMemoryBarrier* pImageMemoryBarriers) = 0;
         virtual bool endCommandBuffer(RHICommandBuffer* commandBuffer) = 0;
         virtual void updateDescriptorSets(uint32_t descriptorWriteCount, const RHIWriteDescriptorSet* pDescriptorWrites, uint32_t descriptorCopyCount, const RHICopyDescriptorSet* pDescriptorCopies) = 0;
@@ -139,6 +150,13 @@ namespace Sammi
         // command write
         virtual RHICommandBuffer* beginSingleTimeCommands() = 0;
         virtual void            endSingleTimeCommands(RHICommandBuffer* command_buffer) = 0;
+        // upload batch: single time commands recorded between begin and the outermost end share one command buffer
+        // and one submit, without waiting for the queue. Staging memory comes from a persistent mapped ring that is
+        // recycled once the fence of the batch that read it has signaled. It is only valid inside a batch, and the copies
+        // reading an allocation are recorded before the next allocation, which may submit the batch when the ring is full
+        virtual void  beginUploadBatch() = 0;
+        virtual void  endUploadBatch() = 0;
+        virtual void* allocateStagingMemory(RHIDeviceSize size, RHIDeviceSize alignment, RHIBuffer*& out_buffer, RHIDeviceSize& out_offset) = 0;
         virtual bool prepareBeforePass(std::function<void()> passUpdateAfterRecreateSwapchain) = 0;
         virtual void submitRendering(std::function<void()> passUpdateAfterRecreateSwapchain) = 0;
         virtual void pushEvent(RHICommandBuffer* commond_buffer, const char* name, const float* color) = 0;
@@ -160,6 +178,7 @@ namespace Sammi
         virtual void destroyDevice() = 0;
         virtual void destroyCommandPool(RHICommandPool* commandPool) = 0;
         virtual void destroyBuffer(RHIBuffer* &buffer) = 0;
+        virtual void destroyBufferVMA(VmaAllocator allocator, RHIBuffer* &buffer, VmaAllocation allocation) = 0;
         virtual void freeCommandBuffers(RHICommandPool* commandPool, uint32_t commandBufferCount, RHICommandBuffer* pCommandBuffers) = 0;
 
         // memory
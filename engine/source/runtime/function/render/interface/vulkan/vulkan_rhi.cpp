@@ -152,6 +152,8 @@ namespace Sammi
         createFramebufferImageAndView();
 
         createAssetAllocator();
+
+        createUploadResources();
     }
 
     void VulkanRHI::prepareContext()
@@ -162,6 +164,8 @@ namespace Sammi
 
     void VulkanRHI::clear()
     {
+        destroyUploadResources();
+
         if (m_enable_validation_Layers)
         {
             destroyDebugUtilsMessengerEXT(m_instance, m_debug_messenger, nullptr);
@@ -510,6 +514,29 @@ namespace Sammi
 
     RHICommandBuffer* VulkanRHI::beginSingleTimeCommands()
     {
+        // inside an upload batch every caller records into the batch command buffer
+        if (m_upload_batch_depth > 0)
+        {
+            if (m_upload_command_buffer == VK_NULL_HANDLE)
+            {
+                VkCommandBufferAllocateInfo upload_alloc_info {};
+                upload_alloc_info.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+                upload_alloc_info.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+                upload_alloc_info.commandPool        = m_upload_command_pool;
+                upload_alloc_info.commandBufferCount = 1;
+                vkAllocateCommandBuffers(m_device, &upload_alloc_info, &m_upload_command_buffer);
+
+                VkCommandBufferBeginInfo upload_begin_info {};
+                upload_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+                upload_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+                _vkBeginCommandBuffer(m_upload_command_buffer, &upload_begin_info);
+            }
+
+            RHICommandBuffer* rhi_upload_command_buffer = new VulkanCommandBuffer();
+            ((VulkanCommandBuffer*)rhi_upload_command_buffer)->setResource(m_upload_command_buffer);
+            return rhi_upload_command_buffer;
+        }
+
         VkCommandBufferAllocateInfo allocInfo {};
         allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
@@ -533,6 +560,13 @@ namespace Sammi
     void VulkanRHI::endSingleTimeCommands(RHICommandBuffer* command_buffer)
     {
         VkCommandBuffer vk_command_buffer = ((VulkanCommandBuffer*)command_buffer)->getResource();
+        if (m_upload_batch_depth > 0 && vk_command_buffer == m_upload_command_buffer)
+        {
+            // submitted by endUploadBatch
+            delete(command_buffer);
+            return;
+        }
+
         _vkEndCommandBuffer(vk_command_buffer);
 
         VkSubmitInfo submitInfo {};
@@ -547,6 +581,219 @@ namespace Sammi
         delete(command_buffer);
     }
 
+    void VulkanRHI::beginUploadBatch()
+    {
+        if (m_upload_batch_depth++ == 0)
+        {
+            // recycle what the gpu has already consumed, without blocking
+            retireUploadSubmissions(false);
+        }
+    }
+
+    void VulkanRHI::endUploadBatch()
+    {
+        if (m_upload_batch_depth == 0)
+        {
+            LOG_ERROR("endUploadBatch without beginUploadBatch");
+            return;
+        }
+        if (--m_upload_batch_depth == 0)
+        {
+            submitUploadCommands();
+        }
+    }
+
+    void* VulkanRHI::allocateStagingMemory(RHIDeviceSize size, RHIDeviceSize alignment, RHIBuffer*& out_buffer, RHIDeviceSize& out_offset)
+    {
+        if (m_upload_batch_depth == 0)
+        {
+            LOG_ERROR("allocateStagingMemory outside of an upload batch");
+        }
+
+        // larger than the whole ring, it gets its own buffer released with the batch
+        if (size > k_upload_staging_ring_size)
+        {
+            return allocateDedicatedStagingMemory(size, out_buffer, out_offset);
+        }
+
+        alignment = std::max<RHIDeviceSize>(alignment, 1);
+        for (;;)
+        {
+            const bool is_ring_empty = m_upload_submissions.empty() && !m_has_pending_staging;
+            if (is_ring_empty)
+            {
+                m_upload_staging_head = 0;
+                m_upload_staging_tail = 0;
+            }
+
+            VkDeviceSize offset = (m_upload_staging_head + alignment - 1) / alignment * alignment;
+            bool         is_fit = false;
+            if (is_ring_empty || m_upload_staging_head > m_upload_staging_tail)
+            {
+                if (offset + size <= k_upload_staging_ring_size)
+                {
+                    is_fit = true;
+                }
+                else if (size <= m_upload_staging_tail)
+                {
+                    // wrap around, the end of the ring is skipped
+                    offset = 0;
+                    is_fit = true;
+                }
+            }
+            else
+            {
+                is_fit = offset + size <= m_upload_staging_tail;
+            }
+
+            if (is_fit)
+            {
+                m_upload_staging_head = offset + size;
+                m_has_pending_staging = true;
+                out_buffer            = m_upload_staging_buffer;
+                out_offset            = offset;
+                return m_upload_staging_data + offset;
+            }
+
+            // the ring is full: submit what the batch recorded so far and wait for the oldest upload
+            if (m_upload_command_buffer != VK_NULL_HANDLE)
+            {
+                submitUploadCommands();
+            }
+            if (m_upload_submissions.empty())
+            {
+                // only allocations of this batch whose copies are not recorded yet, nothing to wait for
+                return allocateDedicatedStagingMemory(size, out_buffer, out_offset);
+            }
+            retireUploadSubmissions(true);
+        }
+    }
+
+    void* VulkanRHI::allocateDedicatedStagingMemory(RHIDeviceSize size, RHIBuffer*& out_buffer, RHIDeviceSize& out_offset)
+    {
+        VkBufferCreateInfo buffer_create_info {};
+        buffer_create_info.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_create_info.size        = size;
+        buffer_create_info.usage       = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        VmaAllocationCreateInfo allocation_create_info {};
+        allocation_create_info.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+        allocation_create_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        VkBuffer          vk_buffer;
+        VmaAllocation     allocation;
+        VmaAllocationInfo allocation_info;
+        if (vmaCreateBuffer(m_assets_allocator,
+                            &buffer_create_info,
+                            &allocation_create_info,
+                            &vk_buffer,
+                            &allocation,
+                            &allocation_info) != VK_SUCCESS)
+        {
+            LOG_ERROR("create dedicated staging buffer failed!");
+            return nullptr;
+        }
+
+        out_buffer = new VulkanBuffer();
+        ((VulkanBuffer*)out_buffer)->setResource(vk_buffer);
+        out_offset = 0;
+        m_pending_dedicated_staging_buffers.emplace_back(out_buffer, allocation);
+        return allocation_info.pMappedData;
+    }
+
+    void VulkanRHI::submitUploadCommands()
+    {
+        if (m_upload_command_buffer == VK_NULL_HANDLE)
+        {
+            // nothing recorded, nothing reads the staging memory of this batch
+            for (auto& dedicated_staging_buffer : m_pending_dedicated_staging_buffers)
+            {
+                vmaDestroyBuffer(m_assets_allocator,
+                                 ((VulkanBuffer*)dedicated_staging_buffer.first)->getResource(),
+                                 dedicated_staging_buffer.second);
+                delete dedicated_staging_buffer.first;
+            }
+            m_pending_dedicated_staging_buffers.clear();
+            m_has_pending_staging = false;
+            return;
+        }
+
+        // the uploaded buffers and images are used by the frames submitted after this batch on the same queue
+        VkMemoryBarrier memory_barrier {};
+        memory_barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memory_barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        vkCmdPipelineBarrier(m_upload_command_buffer,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0,
+                             1,
+                             &memory_barrier,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr);
+        _vkEndCommandBuffer(m_upload_command_buffer);
+
+        UploadSubmission submission;
+        submission.m_command_buffer            = m_upload_command_buffer;
+        submission.m_staging_end               = m_upload_staging_head;
+        submission.m_dedicated_staging_buffers = std::move(m_pending_dedicated_staging_buffers);
+        m_pending_dedicated_staging_buffers.clear();
+
+        VkFenceCreateInfo fence_create_info {};
+        fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        if (vkCreateFence(m_device, &fence_create_info, nullptr, &submission.m_fence) != VK_SUCCESS)
+        {
+            LOG_ERROR("vk create upload fence");
+        }
+
+        VkSubmitInfo submit_info {};
+        submit_info.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers    = &submission.m_command_buffer;
+        if (vkQueueSubmit(((VulkanQueue*)m_graphics_queue)->getResource(), 1, &submit_info, submission.m_fence) !=
+            VK_SUCCESS)
+        {
+            LOG_ERROR("upload vkQueueSubmit failed!");
+        }
+
+        m_upload_submissions.push_back(std::move(submission));
+        m_upload_command_buffer = VK_NULL_HANDLE;
+        m_has_pending_staging   = false;
+    }
+
+    void VulkanRHI::retireUploadSubmissions(bool is_oldest_waited)
+    {
+        if (is_oldest_waited && !m_upload_submissions.empty())
+        {
+            _vkWaitForFences(m_device, 1, &m_upload_submissions.front().m_fence, VK_TRUE, UINT64_MAX);
+        }
+
+        while (!m_upload_submissions.empty() &&
+               vkGetFenceStatus(m_device, m_upload_submissions.front().m_fence) == VK_SUCCESS)
+        {
+            m_upload_staging_tail = m_upload_submissions.front().m_staging_end;
+            releaseUploadSubmission(m_upload_submissions.front());
+            m_upload_submissions.pop_front();
+        }
+    }
+
+    void VulkanRHI::releaseUploadSubmission(UploadSubmission& submission)
+    {
+        vkDestroyFence(m_device, submission.m_fence, nullptr);
+        vkFreeCommandBuffers(m_device, m_upload_command_pool, 1, &submission.m_command_buffer);
+        for (auto& dedicated_staging_buffer : submission.m_dedicated_staging_buffers)
+        {
+            vmaDestroyBuffer(m_assets_allocator,
+                             ((VulkanBuffer*)dedicated_staging_buffer.first)->getResource(),
+                             dedicated_staging_buffer.second);
+            delete dedicated_staging_buffer.first;
+        }
+        submission.m_dedicated_staging_buffers.clear();
+    }
+
     // validation layers
     bool VulkanRHI::checkValidationLayerSupport()
     {
@@ -794,6 +1041,32 @@ namespace Sammi
             physical_device_features.geometryShader = VK_TRUE;
         }
 
+        // support block compressed textures (cooked textures), optional
+        VkPhysicalDeviceFeatures supported_features;
+        vkGetPhysicalDeviceFeatures(m_physical_device, &supported_features);
+        m_enable_texture_compression_bc = supported_features.textureCompressionBC == VK_TRUE;
+        physical_device_features.textureCompressionBC = supported_features.textureCompressionBC;
+
+        // support gpu driven mesh draws, optional
+        m_enable_draw_indirect_first_instance = supported_features.drawIndirectFirstInstance == VK_TRUE;
+        physical_device_features.drawIndirectFirstInstance = supported_features.drawIndirectFirstInstance;
+        m_enable_multi_draw_indirect = supported_features.multiDrawIndirect == VK_TRUE;
+        physical_device_features.multiDrawIndirect = supported_features.multiDrawIndirect;
+
+        uint32_t extension_count = 0;
+        vkEnumerateDeviceExtensionProperties(m_physical_device, nullptr, &extension_count, nullptr);
+        std::vector<VkExtensionProperties> available_extensions(extension_count);
+        vkEnumerateDeviceExtensionProperties(m_physical_device, nullptr, &extension_count, available_extensions.data());
+        for (const auto& extension : available_extensions)
+        {
+            if (strcmp(extension.extensionName, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0)
+            {
+                m_enable_draw_indirect_count = true;
+                m_device_extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+                break;
+            }
+        }
+
         // device create info
         VkDeviceCreateInfo device_create_info {};
         device_create_info.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -840,6 +1113,12 @@ namespace Sammi
         _vkCmdBindDescriptorSets = (PFN_vkCmdBindDescriptorSets)vkGetDeviceProcAddr(m_device, "vkCmdBindDescriptorSets");
         _vkCmdClearAttachments   = (PFN_vkCmdClearAttachments)vkGetDeviceProcAddr(m_device, "vkCmdClearAttachments");
 
+        if (m_enable_draw_indirect_count)
+        {
+            _vkCmdDrawIndexedIndirectCountKHR = (PFN_vkCmdDrawIndexedIndirectCountKHR)vkGetDeviceProcAddr(
+                m_device, "vkCmdDrawIndexedIndirectCountKHR");
+        }
+
         m_depth_image_format = (RHIFormat)findDepthFormat();
     }
 
@@ -2509,6 +2788,33 @@ namespace Sammi
         vkCmdDispatchIndirect(((VulkanCommandBuffer*)commandBuffer)->getResource(), ((VulkanBuffer*)buffer)->getResource(), offset);
     }
 
+    void VulkanRHI::cmdDrawIndexedIndirect(RHICommandBuffer* commandBuffer, RHIBuffer* buffer, RHIDeviceSize offset, uint32_t drawCount, uint32_t stride)
+    {
+        vkCmdDrawIndexedIndirect(((VulkanCommandBuffer*)commandBuffer)->getResource(), ((VulkanBuffer*)buffer)->getResource(), offset, drawCount, stride);
+    }
+
+    void VulkanRHI::cmdDrawIndexedIndirectCount(RHICommandBuffer* commandBuffer, RHIBuffer* buffer, RHIDeviceSize offset, RHIBuffer* countBuffer, RHIDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride)
+    {
+        _vkCmdDrawIndexedIndirectCountKHR(((VulkanCommandBuffer*)commandBuffer)->getResource(),
+                                          ((VulkanBuffer*)buffer)->getResource(),
+                                          offset,
+                                          ((VulkanBuffer*)countBuffer)->getResource(),
+                                          countBufferOffset,
+                                          maxDrawCount,
+                                          stride);
+    }
+
+    void VulkanRHI::cmdExecuteCommands(RHICommandBuffer* commandBuffer, uint32_t commandBufferCount, RHICommandBuffer* const* pCommandBuffers)
+    {
+        std::vector<VkCommandBuffer> vk_command_buffer_list(commandBufferCount);
+        for (uint32_t i = 0; i < commandBufferCount; ++i)
+        {
+            vk_command_buffer_list[i] = ((VulkanCommandBuffer*)pCommandBuffers[i])->getResource();
+        }
+
+        vkCmdExecuteCommands(((VulkanCommandBuffer*)commandBuffer)->getResource(), commandBufferCount, vk_command_buffer_list.data());
+    }
+
     void VulkanRHI::cmdCopyImageToBuffer(
         RHICommandBuffer* commandBuffer,
         RHIImage* srcImage,
@@ -2586,16 +2892,19 @@ namespace Sammi
 
     void VulkanRHI::cmdCopyBuffer(RHICommandBuffer* commandBuffer, RHIBuffer* srcBuffer, RHIBuffer* dstBuffer, uint32_t regionCount, RHIBufferCopy* pRegions)
     {
-        VkBufferCopy copyRegion{};
-        copyRegion.srcOffset = pRegions->srcOffset;
-        copyRegion.dstOffset = pRegions->dstOffset;
-        copyRegion.size = pRegions->size;
+        std::vector<VkBufferCopy> copy_regions(regionCount);
+        for (uint32_t i = 0; i < regionCount; ++i)
+        {
+            copy_regions[i].srcOffset = pRegions[i].srcOffset;
+            copy_regions[i].dstOffset = pRegions[i].dstOffset;
+            copy_regions[i].size = pRegions[i].size;
+        }
 
         vkCmdCopyBuffer(((VulkanCommandBuffer*)commandBuffer)->getResource(),
             ((VulkanBuffer*)srcBuffer)->getResource(),
             ((VulkanBuffer*)dstBuffer)->getResource(),
             regionCount,
-            &copyRegion);
+            copy_regions.data());
     }
 
     void VulkanRHI::createCommandBuffers()
@@ -2629,7 +2938,7 @@ namespace Sammi
         pool_sizes[0].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
         pool_sizes[0].descriptorCount = 3 + 2 + 2 + 2 + 1 + 1 + 3 + 3;
         pool_sizes[1].type            = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-        pool_sizes[1].descriptorCount = 1 + 1 + 1 * m_max_vertex_blending_mesh_count;
+        pool_sizes[1].descriptorCount = 1 + 1 + 1 * m_max_vertex_blending_mesh_count + (3 + 6) * k_max_frames_in_flight; // + mesh culling
         pool_sizes[2].type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         pool_sizes[2].descriptorCount = 1 * m_max_material_count;
         pool_sizes[3].type            = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -2646,7 +2955,8 @@ namespace Sammi
         pool_info.poolSizeCount = sizeof(pool_sizes) / sizeof(pool_sizes[0]);
         pool_info.pPoolSizes    = pool_sizes;
         pool_info.maxSets =
-            1 + 1 + 1 + m_max_material_count + m_max_vertex_blending_mesh_count + 1 + 1; // +skybox + axis descriptor set
+            1 + 1 + 1 + m_max_material_count + m_max_vertex_blending_mesh_count + 1 + 1 +
+            2 * k_max_frames_in_flight; // +skybox + axis descriptor set + mesh culling descriptor sets
         pool_info.flags = 0U;
 
         if (vkCreateDescriptorPool(m_device, &pool_info, nullptr, &m_vk_descriptor_pool) != VK_SUCCESS)
@@ -2917,12 +3227,12 @@ namespace Sammi
         ((VulkanImageView*)image_view)->setResource(vk_image_view);
     }
 
-    void VulkanRHI::createGlobalImage(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, void* texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels)
+    void VulkanRHI::createGlobalImage(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, void* texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels, uint32_t uploaded_miplevels)
     {
         VkImage vk_image;
         VkImageView vk_image_view;
         
-        VulkanUtil::createGlobalImage(this, vk_image, vk_image_view,image_allocation,texture_image_width,texture_image_height,texture_image_pixels,texture_image_format,miplevels);
+        VulkanUtil::createGlobalImage(this, vk_image, vk_image_view,image_allocation,texture_image_width,texture_image_height,texture_image_pixels,texture_image_format,miplevels,uploaded_miplevels);
         
         image = new VulkanImage();
         image_view = new VulkanImageView();
@@ -2930,12 +3240,12 @@ namespace Sammi
         ((VulkanImageView*)image_view)->setResource(vk_image_view);
     }
 
-    void VulkanRHI::createCubeMap(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, std::array<void*, 6> texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels)
+    void VulkanRHI::createCubeMap(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, std::array<void*, 6> texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels, uint32_t uploaded_miplevels)
     {
         VkImage vk_image;
         VkImageView vk_image_view;
 
-        VulkanUtil::createCubeMap(this, vk_image, vk_image_view, image_allocation, texture_image_width, texture_image_height, texture_image_pixels, texture_image_format, miplevels);
+        VulkanUtil::createCubeMap(this, vk_image, vk_image_view, image_allocation, texture_image_width, texture_image_height, texture_image_pixels, texture_image_format, miplevels, uploaded_miplevels);
 
         image = new VulkanImage();
         image_view = new VulkanImageView();
@@ -2979,6 +3289,79 @@ namespace Sammi
         vmaCreateAllocator(&allocatorCreateInfo, &m_assets_allocator);
     }
 
+    void VulkanRHI::createUploadResources()
+    {
+        // upload batches are submitted to the graphics queue, the mip blits and the transitions to the shader read
+        // layout need it
+        VkCommandPoolCreateInfo command_pool_create_info {};
+        command_pool_create_info.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        command_pool_create_info.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        command_pool_create_info.queueFamilyIndex = m_queue_indices.graphics_family.value();
+        if (vkCreateCommandPool(m_device, &command_pool_create_info, nullptr, &m_upload_command_pool) != VK_SUCCESS)
+        {
+            LOG_ERROR("vk create upload command pool");
+        }
+
+        // persistently mapped staging ring
+        VkBufferCreateInfo buffer_create_info {};
+        buffer_create_info.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_create_info.size        = k_upload_staging_ring_size;
+        buffer_create_info.usage       = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        VmaAllocationCreateInfo allocation_create_info {};
+        allocation_create_info.usage = VMA_MEMORY_USAGE_CPU_ONLY;
+        allocation_create_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+        VkBuffer          vk_staging_buffer;
+        VmaAllocationInfo allocation_info;
+        if (vmaCreateBuffer(m_assets_allocator,
+                            &buffer_create_info,
+                            &allocation_create_info,
+                            &vk_staging_buffer,
+                            &m_upload_staging_allocation,
+                            &allocation_info) != VK_SUCCESS)
+        {
+            LOG_ERROR("create upload staging ring failed!");
+            return;
+        }
+        m_upload_staging_buffer = new VulkanBuffer();
+        ((VulkanBuffer*)m_upload_staging_buffer)->setResource(vk_staging_buffer);
+        m_upload_staging_data = static_cast<uint8_t*>(allocation_info.pMappedData);
+    }
+
+    void VulkanRHI::destroyUploadResources()
+    {
+        if (m_upload_batch_depth > 0)
+        {
+            m_upload_batch_depth = 0;
+            submitUploadCommands();
+        }
+
+        for (UploadSubmission& submission : m_upload_submissions)
+        {
+            _vkWaitForFences(m_device, 1, &submission.m_fence, VK_TRUE, UINT64_MAX);
+            releaseUploadSubmission(submission);
+        }
+        m_upload_submissions.clear();
+
+        if (m_upload_staging_allocation != VK_NULL_HANDLE)
+        {
+            vmaDestroyBuffer(m_assets_allocator,
+                             ((VulkanBuffer*)m_upload_staging_buffer)->getResource(),
+                             m_upload_staging_allocation);
+            m_upload_staging_allocation = VK_NULL_HANDLE;
+            m_upload_staging_data       = nullptr;
+        }
+        delete m_upload_staging_buffer;
+        m_upload_staging_buffer = nullptr;
+        if (m_upload_command_pool != VK_NULL_HANDLE)
+        {
+            vkDestroyCommandPool(m_device, m_upload_command_pool, nullptr);
+            m_upload_command_pool = VK_NULL_HANDLE;
+        }
+    }
+
     // todo : more descriptorSet
     bool VulkanRHI::allocateDescriptorSets(const RHIDescriptorSetAllocateInfo* pAllocateInfo, RHIDescriptorSet* &pDescriptorSets)
     {
@@ -3030,7 +3413,7 @@ namespace Sammi
         command_buffer_allocate_info.commandBufferCount = pAllocateInfo->commandBufferCount;
 
         VkCommandBuffer vk_command_buffer;
-        pCommandBuffers = new RHICommandBuffer();
+        pCommandBuffers = new VulkanCommandBuffer();
         VkResult result = vkAllocateCommandBuffers(m_device, &command_buffer_allocate_info, &vk_command_buffer);
         ((VulkanCommandBuffer*)pCommandBuffers)->setResource(vk_command_buffer);
 
@@ -3208,6 +3591,12 @@ namespace Sammi
         RHI_DELETE_PTR(buffer);
     }
 
+    void VulkanRHI::destroyBufferVMA(VmaAllocator allocator, RHIBuffer* &buffer, VmaAllocation allocation)
+    {
+        vmaDestroyBuffer(allocator, ((VulkanBuffer*)buffer)->getResource(), allocation);
+        RHI_DELETE_PTR(buffer);
+    }
+
     void VulkanRHI::freeCommandBuffers(RHICommandPool* commandPool, uint32_t commandBufferCount, RHICommandBuffer* pCommandBuffers)
     {
         VkCommandBuffer vk_command_buffer = ((VulkanCommandBuffer*)pCommandBuffers)->getResource();
@@ -3543,6 +3932,10 @@ namespace Sammi
         }
     }
     bool VulkanRHI::isPointLightShadowEnabled(){ return m_enable_point_light_shadow; }
+    bool VulkanRHI::isTextureCompressionBCSupported(){ return m_enable_texture_compression_bc; }
+    bool VulkanRHI::isDrawIndirectFirstInstanceSupported(){ return m_enable_draw_indirect_first_instance; }
+    bool VulkanRHI::isMultiDrawIndirectSupported(){ return m_enable_multi_draw_indirect; }
+    bool VulkanRHI::isDrawIndirectCountSupported(){ return m_enable_draw_indirect_count; }
 
     RHICommandBuffer* VulkanRHI::getCurrentCommandBuffer() const
     {
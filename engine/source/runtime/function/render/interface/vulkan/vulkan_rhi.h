@@ -6,8 +6,10 @@
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan.h>
 
+#include <deque>
 #include <functional>
 #include <map>
+#include <utility>
 #include <vector>
 
 namespace Sammi
@@ -50,8 +52,8 @@ namespace Sammi
             RHIImage* &image, RHIDeviceMemory* &memory, RHIImageCreateFlags image_create_flags, uint32_t array_layers, uint32_t miplevels) override;
         void createImageView(RHIImage* image, RHIFormat format, RHIImageAspectFlags image_aspect_flags, RHIImageViewType view_type, uint32_t layout_count, uint32_t miplevels,
             RHIImageView* &image_view) override;
-        void createGlobalImage(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, void* texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels = 0) override;
-        void createCubeMap(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, std::array<void*, 6> texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels) override;
+        void createGlobalImage(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, void* texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels = 0, uint32_t uploaded_miplevels = 1) override;
+        void createCubeMap(RHIImage* &image, RHIImageView* &image_view, VmaAllocation& image_allocation, uint32_t texture_image_width, uint32_t texture_image_height, std::array<void*, 6> texture_image_pixels, RHIFormat texture_image_format, uint32_t miplevels, uint32_t uploaded_miplevels = 1) override;
         bool createCommandPool(const RHICommandPoolCreateInfo* pCreateInfo, RHICommandPool* &pCommandPool) override;
         bool createDescriptorPool(const RHIDescriptorPoolCreateInfo* pCreateInfo, RHIDescriptorPool* &pDescriptorPool) override;
         bool createDescriptorSetLayout(const RHIDescriptorSetLayoutCreateInfo* pCreateInfo, RHIDescriptorSetLayout* &pSetLayout) override;
@@ -102,6 +104,9 @@ namespace Sammi
         void cmdDraw(RHICommandBuffer* commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) override;
         void cmdDispatch(RHICommandBuffer* commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override;
         void cmdDispatchIndirect(RHICommandBuffer* commandBuffer, RHIBuffer* buffer, RHIDeviceSize offset) override;
+        void cmdDrawIndexedIndirect(RHICommandBuffer* commandBuffer, RHIBuffer* buffer, RHIDeviceSize offset, uint32_t drawCount, uint32_t stride) override;
+        void cmdDrawIndexedIndirectCount(RHICommandBuffer* commandBuffer, RHIBuffer* buffer, RHIDeviceSize offset, RHIBuffer* countBuffer, RHIDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride) override;
+        void cmdExecuteCommands(RHICommandBuffer* commandBuffer, uint32_t commandBufferCount, RHICommandBuffer* const* pCommandBuffers) override;
         void cmdPipelineBarrier(RHICommandBuffer* commandBuffer, RHIPipelineStageFlags srcStageMask, RHIPipelineStageFlags dstStageMask, RHIDependencyFlags dependencyFlags, uint32_t memoryBarrierCount, const RHIMemoryBarrier* pMemoryBarriers, uint32_t bufferMemoryBarrierCount, const RHIBufferMemoryBarrier* pBufferMemoryBarriers, uint32_t imageMemoryBarrierCount, const RHIImageMemoryBarrier* pImageMemoryBarriers) override;
         bool endCommandBuffer(RHICommandBuffer* commandBuffer) override;
         void updateDescriptorSets(uint32_t descriptorWriteCount, const RHIWriteDescriptorSet* pDescriptorWrites, uint32_t descriptorCopyCount, const RHICopyDescriptorSet* pDescriptorCopies) override;
@@ -130,6 +135,9 @@ namespace Sammi
         // command write
         RHICommandBuffer* beginSingleTimeCommands() override;
         void            endSingleTimeCommands(RHICommandBuffer* command_buffer) override;
+        void  beginUploadBatch() override;
+        void  endUploadBatch() override;
+        void* allocateStagingMemory(RHIDeviceSize size, RHIDeviceSize alignment, RHIBuffer*& out_buffer, RHIDeviceSize& out_offset) override;
         bool prepareBeforePass(std::function<void()> passUpdateAfterRecreateSwapchain) override;
         void submitRendering(std::function<void()> passUpdateAfterRecreateSwapchain) override;
         void pushEvent(RHICommandBuffer* commond_buffer, const char* name, const float* color) override;
@@ -152,6 +160,7 @@ namespace Sammi
         void destroyDevice() override;
         void destroyCommandPool(RHICommandPool* commandPool) override;
         void destroyBuffer(RHIBuffer* &buffer) override;
+        void destroyBufferVMA(VmaAllocator allocator, RHIBuffer* &buffer, VmaAllocation allocation) override;
         void freeCommandBuffers(RHICommandPool* commandPool, uint32_t commandBufferCount, RHICommandBuffer* pCommandBuffers) override;
 
         // memory
@@ -227,6 +236,8 @@ namespace Sammi
         PFN_vkCmdBindDescriptorSets _vkCmdBindDescriptorSets;
         PFN_vkCmdDrawIndexed        _vkCmdDrawIndexed;
         PFN_vkCmdClearAttachments   _vkCmdClearAttachments;
+        // null without VK_KHR_draw_indirect_count
+        PFN_vkCmdDrawIndexedIndirectCountKHR _vkCmdDrawIndexedIndirectCountKHR {nullptr};
 
         // global descriptor pool
         VkDescriptorPool m_vk_descriptor_pool;
@@ -267,19 +278,62 @@ namespace Sammi
         void createDescriptorPool();
         void createSyncPrimitives();
         void createAssetAllocator();
+        void createUploadResources();
+        void destroyUploadResources();
 
     public:
         bool isPointLightShadowEnabled() override;
+        bool isTextureCompressionBCSupported() override;
+        bool isDrawIndirectFirstInstanceSupported() override;
+        bool isMultiDrawIndirectSupported() override;
+        bool isDrawIndirectCountSupported() override;
 
     private:
         bool m_enable_validation_Layers{ true };
         bool m_enable_debug_utils_label{ true };
         bool m_enable_point_light_shadow{ true };
+        bool m_enable_texture_compression_bc{ false };
+        bool m_enable_draw_indirect_first_instance{ false };
+        bool m_enable_multi_draw_indirect{ false };
+        bool m_enable_draw_indirect_count{ false };
 
         // used in descriptor pool creation
         uint32_t m_max_vertex_blending_mesh_count{ 256 };
         uint32_t m_max_material_count{ 256 };
 
+        // upload batches, see RHI::beginUploadBatch
+        struct UploadSubmission
+        {
+            VkCommandBuffer m_command_buffer {VK_NULL_HANDLE};
+            VkFence         m_fence {VK_NULL_HANDLE};
+            // the staging ring is free up to here once the fence has signaled
+            VkDeviceSize                                      m_staging_end {0};
+            std::vector<std::pair<RHIBuffer*, VmaAllocation>> m_dedicated_staging_buffers;
+        };
+
+        static constexpr VkDeviceSize k_upload_staging_ring_size {64 * 1024 * 1024};
+
+        VkCommandPool   m_upload_command_pool {VK_NULL_HANDLE};
+        VkCommandBuffer m_upload_command_buffer {VK_NULL_HANDLE};
+        uint32_t        m_upload_batch_depth {0};
+
+        RHIBuffer*    m_upload_staging_buffer {nullptr};
+        VmaAllocation m_upload_staging_allocation {VK_NULL_HANDLE};
+        uint8_t*      m_upload_staging_data {nullptr};
+        // [tail, head) is in use, wrapping around the end of the ring
+        VkDeviceSize m_upload_staging_head {0};
+        VkDeviceSize m_upload_staging_tail {0};
+        // staging memory written by the batch being recorded, not submitted yet
+        bool                                              m_has_pending_staging {false};
+        std::vector<std::pair<RHIBuffer*, VmaAllocation>> m_pending_dedicated_staging_buffers;
+        std::deque<UploadSubmission>                      m_upload_submissions;
+
+        void* allocateDedicatedStagingMemory(RHIDeviceSize size, RHIBuffer*& out_buffer, RHIDeviceSize& out_offset);
+        void  submitUploadCommands();
+        // releases the submissions whose fence has signaled, waiting for the oldest one first if asked
+        void  retireUploadSubmissions(bool is_oldest_waited);
+        void  releaseUploadSubmission(UploadSubmission& submission);
+
         bool                     checkValidationLayerSupport();
         std::vector<const char*> getRequiredExtensions();
         void                     populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
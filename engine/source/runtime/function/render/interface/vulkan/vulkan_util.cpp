@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <numeric>
 #include <stdexcept>
 
 namespace Sammi
@@ -274,74 +275,113 @@ namespace Sammi
                                        uint32_t           texture_image_height,
                                        void*              texture_image_pixels,
                                        RHIFormat texture_image_format,
-                                       uint32_t           miplevels)
+                                       uint32_t           miplevels,
+                                       uint32_t           uploaded_miplevels)
     {
         if (!texture_image_pixels)
         {
             return;
         }
 
-        VkDeviceSize texture_byte_size;
+        // bytes per texel, or per 4x4 block for the block compressed formats
+        VkDeviceSize texel_byte_size     = 0;
+        bool         is_block_compressed = false;
         VkFormat     vulkan_image_format;
         switch (texture_image_format)
         {
             case RHIFormat::RHI_FORMAT_R8G8B8_UNORM:
-                texture_byte_size   = texture_image_width * texture_image_height * 3;
+                texel_byte_size     = 3;
                 vulkan_image_format = VK_FORMAT_R8G8B8_UNORM;
                 break;
             case RHIFormat::RHI_FORMAT_R8G8B8_SRGB:
-                texture_byte_size   = texture_image_width * texture_image_height * 3;
+                texel_byte_size     = 3;
                 vulkan_image_format = VK_FORMAT_R8G8B8_SRGB;
                 break;
             case RHIFormat::RHI_FORMAT_R8G8B8A8_UNORM:
-                texture_byte_size   = texture_image_width * texture_image_height * 4;
+                texel_byte_size     = 4;
                 vulkan_image_format = VK_FORMAT_R8G8B8A8_UNORM;
                 break;
             case RHIFormat::RHI_FORMAT_R8G8B8A8_SRGB:
-                texture_byte_size   = texture_image_width * texture_image_height * 4;
+                texel_byte_size     = 4;
                 vulkan_image_format = VK_FORMAT_R8G8B8A8_SRGB;
                 break;
             case RHIFormat::RHI_FORMAT_R32_SFLOAT:
-                texture_byte_size = texture_image_width * texture_image_height * 4;
+                texel_byte_size     = 4;
                 vulkan_image_format = VK_FORMAT_R32_SFLOAT;
                 break;
             case RHIFormat::RHI_FORMAT_R32G32_SFLOAT:
-                texture_byte_size   = texture_image_width * texture_image_height * 4 * 2;
+                texel_byte_size     = 4 * 2;
                 vulkan_image_format = VK_FORMAT_R32G32_SFLOAT;
                 break;
             case RHIFormat::RHI_FORMAT_R32G32B32_SFLOAT:
-                texture_byte_size   = texture_image_width * texture_image_height * 4 * 3;
+                texel_byte_size     = 4 * 3;
                 vulkan_image_format = VK_FORMAT_R32G32B32_SFLOAT;
                 break;
             case RHIFormat::RHI_FORMAT_R32G32B32A32_SFLOAT:
-                texture_byte_size   = texture_image_width * texture_image_height * 4 * 4;
+                texel_byte_size     = 4 * 4;
                 vulkan_image_format = VK_FORMAT_R32G32B32A32_SFLOAT;
                 break;
+            case RHIFormat::RHI_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case RHIFormat::RHI_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            case RHIFormat::RHI_FORMAT_BC3_UNORM_BLOCK:
+            case RHIFormat::RHI_FORMAT_BC3_SRGB_BLOCK:
+            case RHIFormat::RHI_FORMAT_BC5_UNORM_BLOCK:
+            case RHIFormat::RHI_FORMAT_BC7_UNORM_BLOCK:
+            case RHIFormat::RHI_FORMAT_BC7_SRGB_BLOCK:
+                is_block_compressed = true;
+                texel_byte_size     = (texture_image_format == RHIFormat::RHI_FORMAT_BC1_RGBA_UNORM_BLOCK ||
+                                   texture_image_format == RHIFormat::RHI_FORMAT_BC1_RGBA_SRGB_BLOCK) ?
+                                      8 :
+                                      16;
+                vulkan_image_format = static_cast<VkFormat>(texture_image_format);
+                break;
             default:
                 LOG_ERROR("invalid texture_byte_size");
-                break;
+                return;
         }
 
-        // use staging buffer
-        VkBuffer       inefficient_staging_buffer;
-        VkDeviceMemory inefficient_staging_buffer_memory;
-        VulkanUtil::createBuffer(static_cast<VulkanRHI*>(rhi)->m_physical_device,
-                                 static_cast<VulkanRHI*>(rhi)->m_device,
-                                 texture_byte_size,
-                                 VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                                 inefficient_staging_buffer,
-                                 inefficient_staging_buffer_memory);
-
-        void* data;
-        vkMapMemory(
-            static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer_memory, 0, texture_byte_size, 0, &data);
-        memcpy(data, texture_image_pixels, static_cast<size_t>(texture_byte_size));
-        vkUnmapMemory(static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer_memory);
-
-        // generate mipmapped image
         uint32_t mip_levels =
             (miplevels != 0) ? miplevels : floor(log2(std::max(texture_image_width, texture_image_height))) + 1;
+        uploaded_miplevels = std::clamp(uploaded_miplevels, 1u, mip_levels);
+        // block compressed images can not be blitted, they keep only the mips they come with
+        if (is_block_compressed)
+        {
+            mip_levels = uploaded_miplevels;
+        }
+        // a complete chain (cooked texture) is copied as is, otherwise the mips are generated from mip 0
+        const bool is_mip_chain_uploaded = uploaded_miplevels == mip_levels;
+        if (!is_mip_chain_uploaded)
+        {
+            uploaded_miplevels = 1;
+        }
+
+        std::vector<VkDeviceSize> level_offsets(uploaded_miplevels);
+        VkDeviceSize              texture_byte_size = 0;
+        for (uint32_t level = 0; level < uploaded_miplevels; ++level)
+        {
+            const uint32_t level_width  = std::max(texture_image_width >> level, 1u);
+            const uint32_t level_height = std::max(texture_image_height >> level, 1u);
+            level_offsets[level]        = texture_byte_size;
+            texture_byte_size += is_block_compressed ?
+                                     static_cast<VkDeviceSize>((level_width + 3) / 4) * ((level_height + 3) / 4) *
+                                         texel_byte_size :
+                                     static_cast<VkDeviceSize>(level_width) * level_height * texel_byte_size;
+        }
+
+        // copies go to the current upload batch, the staging memory comes from the ring; buffer offsets of a copy
+        // must be a multiple of the texel (block) size and of 4
+        rhi->beginUploadBatch();
+
+        RHIBuffer*    staging_buffer        = nullptr;
+        RHIDeviceSize staging_buffer_offset = 0;
+        void*         data                  = rhi->allocateStagingMemory(
+            texture_byte_size, std::lcm<VkDeviceSize>(texel_byte_size, 4), staging_buffer, staging_buffer_offset);
+        memcpy(data, texture_image_pixels, static_cast<size_t>(texture_byte_size));
+        VkBuffer vk_staging_buffer = ((VulkanBuffer*)staging_buffer)->getResource();
+        for (VkDeviceSize& level_offset : level_offsets)
+        {
+            level_offset += staging_buffer_offset;
+        }
 
         // use the vmaAllocator to allocate asset texture image
         VkImageCreateInfo image_create_info {};
@@ -371,30 +411,53 @@ namespace Sammi
                        &image_allocation,
                        NULL);
 
-        // layout transitions -- image layout is set from none to destination
-        transitionImageLayout(rhi,
-                              image,
-                              VK_IMAGE_LAYOUT_UNDEFINED,
-                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                              1,
-                              1,
-                              VK_IMAGE_ASPECT_COLOR_BIT);
-        // copy from staging buffer as destination
-        copyBufferToImage(rhi, inefficient_staging_buffer, image, texture_image_width, texture_image_height, 1);
-        // layout transitions -- image layout is set from destination to shader_read
-        transitionImageLayout(rhi,
-                              image,
-                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                              VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                              1,
-                              1,
-                              VK_IMAGE_ASPECT_COLOR_BIT);
-
-        vkDestroyBuffer(static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer, nullptr);
-        vkFreeMemory(static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer_memory, nullptr);
+        if (is_mip_chain_uploaded)
+        {
+            // every mip comes from the staging buffer, no blit pass
+            transitionImageLayout(rhi,
+                                  image,
+                                  VK_IMAGE_LAYOUT_UNDEFINED,
+                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  1,
+                                  mip_levels,
+                                  VK_IMAGE_ASPECT_COLOR_BIT);
+            copyBufferToImageMipLevels(
+                rhi, vk_staging_buffer, image, texture_image_width, texture_image_height, level_offsets);
+            transitionImageLayout(rhi,
+                                  image,
+                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                  1,
+                                  mip_levels,
+                                  VK_IMAGE_ASPECT_COLOR_BIT);
+        }
+        else
+        {
+            // layout transitions -- image layout is set from none to destination
+            transitionImageLayout(rhi,
+                                  image,
+                                  VK_IMAGE_LAYOUT_UNDEFINED,
+                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  1,
+                                  1,
+                                  VK_IMAGE_ASPECT_COLOR_BIT);
+            // copy from staging buffer as destination
+            copyBufferToImage(
+                rhi, vk_staging_buffer, image, texture_image_width, texture_image_height, 1, staging_buffer_offset);
+            // layout transitions -- image layout is set from destination to shader_read
+            transitionImageLayout(rhi,
+                                  image,
+                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                  1,
+                                  1,
+                                  VK_IMAGE_ASPECT_COLOR_BIT);
+
+            // generate mipmapped image
+            genMipmappedImage(rhi, image, texture_image_width, texture_image_height, mip_levels);
+        }
 
-        // generate mipmapped image
-        genMipmappedImage(rhi, image, texture_image_width, texture_image_height, mip_levels);
+        rhi->endUploadBatch();
 
         image_view = createImageView(static_cast<VulkanRHI*>(rhi)->m_device,
                                      image,
@@ -413,7 +476,8 @@ namespace Sammi
                                    uint32_t             texture_image_height,
                                    std::array<void*, 6> texture_image_pixels,
                                    RHIFormat   texture_image_format,
-                                   uint32_t             miplevels)
+                                   uint32_t             miplevels,
+                                   uint32_t             uploaded_miplevels)
     {
         VkDeviceSize texture_layer_byte_size;
         VkDeviceSize cube_byte_size;
@@ -448,6 +512,14 @@ namespace Sammi
                 texture_layer_byte_size = texture_image_width * texture_image_height * 4 * 4;
                 vulkan_image_format     = VK_FORMAT_R32G32B32A32_SFLOAT;
                 break;
+            case RHIFormat::RHI_FORMAT_R16G16B16A16_SFLOAT:
+                texture_layer_byte_size = texture_image_width * texture_image_height * 2 * 4;
+                vulkan_image_format     = VK_FORMAT_R16G16B16A16_SFLOAT;
+                break;
+            case RHIFormat::RHI_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+                texture_layer_byte_size = texture_image_width * texture_image_height * 4;
+                vulkan_image_format     = VK_FORMAT_E5B9G9R9_UFLOAT_PACK32;
+                break;
             default:
                 texture_layer_byte_size = VkDeviceSize(-1);
                 LOG_ERROR("invalid texture_layer_byte_size");
@@ -455,7 +527,22 @@ namespace Sammi
                 break;
         }
 
-        cube_byte_size = texture_layer_byte_size * 6;
+        // a face holding its whole chain (cooked ibl) is copied mip by mip, otherwise only mip 0 is uploaded and the
+        // rest is generated by blits
+        const VkDeviceSize texel_byte_size       = texture_layer_byte_size / (texture_image_width * texture_image_height);
+        const bool         is_mip_chain_uploaded = uploaded_miplevels >= miplevels && miplevels > 1;
+        const uint32_t     copied_miplevels      = is_mip_chain_uploaded ? miplevels : 1;
+
+        std::vector<VkDeviceSize> level_offsets(copied_miplevels);
+        std::vector<VkDeviceSize> level_byte_sizes(copied_miplevels);
+        cube_byte_size = 0;
+        for (uint32_t level = 0; level < copied_miplevels; level++)
+        {
+            level_offsets[level]    = cube_byte_size;
+            level_byte_sizes[level] = static_cast<VkDeviceSize>(std::max(texture_image_width >> level, 1u)) *
+                                      std::max(texture_image_height >> level, 1u) * texel_byte_size;
+            cube_byte_size += level_byte_sizes[level] * 6;
+        }
 
         // create cubemap texture image
         // use the vmaAllocator to allocate asset texture image
@@ -486,26 +573,29 @@ namespace Sammi
                        &image_allocation,
                        NULL);
 
-        VkBuffer       inefficient_staging_buffer;
-        VkDeviceMemory inefficient_staging_buffer_memory;
-        createBuffer(static_cast<VulkanRHI*>(rhi)->m_physical_device,
-                     static_cast<VulkanRHI*>(rhi)->m_device,
-                     cube_byte_size,
-                     VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     inefficient_staging_buffer,
-                     inefficient_staging_buffer_memory);
-
-        void* data = NULL;
-        vkMapMemory(
-            static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer_memory, 0, cube_byte_size, 0, &data);
+        rhi->beginUploadBatch();
+
+        RHIBuffer*    staging_buffer        = nullptr;
+        RHIDeviceSize staging_buffer_offset = 0;
+        void*         data                  = rhi->allocateStagingMemory(
+            cube_byte_size, std::lcm<VkDeviceSize>(texel_byte_size, 4), staging_buffer, staging_buffer_offset);
+        VkBuffer vk_staging_buffer = ((VulkanBuffer*)staging_buffer)->getResource();
+        // the buffer holds all faces of a mip together, a face in texture_image_pixels holds its mips together
         for (int i = 0; i < 6; i++)
         {
-            memcpy((void*)(static_cast<char*>(data) + texture_layer_byte_size * i),
-                   texture_image_pixels[i],
-                   static_cast<size_t>(texture_layer_byte_size));
+            const char* face_pixels = static_cast<const char*>(texture_image_pixels[i]);
+            for (uint32_t level = 0; level < copied_miplevels; level++)
+            {
+                memcpy(static_cast<char*>(data) + level_offsets[level] + level_byte_sizes[level] * i,
+                       face_pixels,
+                       static_cast<size_t>(level_byte_sizes[level]));
+                face_pixels += level_byte_sizes[level];
+            }
+        }
+        for (VkDeviceSize& level_offset : level_offsets)
+        {
+            level_offset += staging_buffer_offset;
         }
-        vkUnmapMemory(static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer_memory);
 
         // layout transitions -- image layout is set from none to destination
         transitionImageLayout(rhi,
@@ -515,19 +605,39 @@ namespace Sammi
                               6,
                               miplevels,
                               VK_IMAGE_ASPECT_COLOR_BIT);
-        // copy from staging buffer as destination
-        copyBufferToImage(rhi,
-                          inefficient_staging_buffer,
-                          image,
-                          static_cast<uint32_t>(texture_image_width),
-                          static_cast<uint32_t>(texture_image_height),
-                          6);
+        if (is_mip_chain_uploaded)
+        {
+            copyBufferToImageMipLevels(rhi,
+                                       vk_staging_buffer,
+                                       image,
+                                       static_cast<uint32_t>(texture_image_width),
+                                       static_cast<uint32_t>(texture_image_height),
+                                       level_offsets,
+                                       6);
+            transitionImageLayout(rhi,
+                                  image,
+                                  VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                  6,
+                                  miplevels,
+                                  VK_IMAGE_ASPECT_COLOR_BIT);
+        }
+        else
+        {
+            // copy from staging buffer as destination
+            copyBufferToImage(rhi,
+                              vk_staging_buffer,
+                              image,
+                              static_cast<uint32_t>(texture_image_width),
+                              static_cast<uint32_t>(texture_image_height),
+                              6,
+                              staging_buffer_offset);
 
-        vkDestroyBuffer(static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer, nullptr);
-        vkFreeMemory(static_cast<VulkanRHI*>(rhi)->m_device, inefficient_staging_buffer_memory, nullptr);
+            generateTextureMipMaps(
+                rhi, image, vulkan_image_format, texture_image_width, texture_image_height, 6, miplevels);
+        }
 
-        generateTextureMipMaps(
-            rhi, image, vulkan_image_format, texture_image_width, texture_image_height, 6, miplevels);
+        rhi->endUploadBatch();
 
         image_view = createImageView(static_cast<VulkanRHI*>(rhi)->m_device,
                                      image,
@@ -746,12 +856,13 @@ namespace Sammi
         static_cast<VulkanRHI*>(rhi)->endSingleTimeCommands(rhi_command_buffer);
     }
 
-    void VulkanUtil::copyBufferToImage(RHI*     rhi,
-                                       VkBuffer buffer,
-                                       VkImage  image,
-                                       uint32_t width,
-                                       uint32_t height,
-                                       uint32_t layer_count)
+    void VulkanUtil::copyBufferToImage(RHI*         rhi,
+                                       VkBuffer     buffer,
+                                       VkImage      image,
+                                       uint32_t     width,
+                                       uint32_t     height,
+                                       uint32_t     layer_count,
+                                       VkDeviceSize buffer_offset)
     {
         if (rhi == nullptr)
         {
@@ -763,7 +874,7 @@ namespace Sammi
         VkCommandBuffer command_buffer = ((VulkanCommandBuffer*)rhi_command_buffer)->getResource();
 
         VkBufferImageCopy region {};
-        region.bufferOffset                    = 0;
+        region.bufferOffset                    = buffer_offset;
         region.bufferRowLength                 = 0;
         region.bufferImageHeight               = 0;
         region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -778,6 +889,48 @@ namespace Sammi
         static_cast<VulkanRHI*>(rhi)->endSingleTimeCommands(rhi_command_buffer);
     }
 
+    void VulkanUtil::copyBufferToImageMipLevels(RHI*                             rhi,
+                                                VkBuffer                         buffer,
+                                                VkImage                          image,
+                                                uint32_t                         width,
+                                                uint32_t                         height,
+                                                const std::vector<VkDeviceSize>& level_offsets,
+                                                uint32_t                         layer_count)
+    {
+        if (rhi == nullptr)
+        {
+            LOG_ERROR("rhi is nullptr");
+            return;
+        }
+
+        RHICommandBuffer* rhi_command_buffer = static_cast<VulkanRHI*>(rhi)->beginSingleTimeCommands();
+        VkCommandBuffer command_buffer = ((VulkanCommandBuffer*)rhi_command_buffer)->getResource();
+
+        std::vector<VkBufferImageCopy> regions(level_offsets.size());
+        for (uint32_t level = 0; level < regions.size(); ++level)
+        {
+            VkBufferImageCopy& region              = regions[level];
+            region.bufferOffset                    = level_offsets[level];
+            region.bufferRowLength                 = 0;
+            region.bufferImageHeight               = 0;
+            region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel       = level;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount     = layer_count;
+            region.imageOffset                     = {0, 0, 0};
+            region.imageExtent                     = {std::max(width >> level, 1u), std::max(height >> level, 1u), 1};
+        }
+
+        vkCmdCopyBufferToImage(command_buffer,
+                               buffer,
+                               image,
+                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               static_cast<uint32_t>(regions.size()),
+                               regions.data());
+
+        static_cast<VulkanRHI*>(rhi)->endSingleTimeCommands(rhi_command_buffer);
+    }
+
     void VulkanUtil::genMipmappedImage(RHI* rhi, VkImage image, uint32_t width, uint32_t height, uint32_t mip_levels)
     {
         if (rhi == nullptr)
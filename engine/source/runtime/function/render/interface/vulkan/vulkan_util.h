@@ -67,7 +67,8 @@ namespace Sammi
                                                 uint32_t           texture_image_height,
                                                 void*              texture_image_pixels,
                                                 RHIFormat texture_image_format,
-                                                uint32_t           miplevels = 0);
+                                                uint32_t           miplevels = 0,
+                                                uint32_t           uploaded_miplevels = 1);
         static void           createCubeMap(RHI*                 rhi,
                                             VkImage&             image,
                                             VkImageView&         image_view,
@@ -76,7 +77,8 @@ namespace Sammi
                                             uint32_t             texture_image_height,
                                             std::array<void*, 6> texture_image_pixels,
                                             RHIFormat   texture_image_format,
-                                            uint32_t             miplevels);
+                                            uint32_t             miplevels,
+                                            uint32_t             uploaded_miplevels = 1);
         static void           generateTextureMipMaps(RHI*     rhi,
                                                      VkImage  image,
                                                      VkFormat image_format,
@@ -91,12 +93,21 @@ namespace Sammi
                                                     uint32_t           layer_count,
                                                     uint32_t           miplevels,
                                                     VkImageAspectFlags aspect_mask_bits);
-        static void           copyBufferToImage(RHI*     rhi,
-                                                VkBuffer buffer,
-                                                VkImage  image,
-                                                uint32_t width,
-                                                uint32_t height,
-                                                uint32_t layer_count);
+        static void           copyBufferToImage(RHI*         rhi,
+                                                VkBuffer     buffer,
+                                                VkImage      image,
+                                                uint32_t     width,
+                                                uint32_t     height,
+                                                uint32_t     layer_count,
+                                                VkDeviceSize buffer_offset = 0);
+        // one region per mip level, level i of all layers starts at level_offsets[i] of the buffer
+        static void           copyBufferToImageMipLevels(RHI*                             rhi,
+                                                         VkBuffer                         buffer,
+                                                         VkImage                          image,
+                                                         uint32_t                         width,
+                                                         uint32_t                         height,
+                                                         const std::vector<VkDeviceSize>& level_offsets,
+                                                         uint32_t                         layer_count = 1);
         static void genMipmappedImage(RHI* rhi, VkImage image, uint32_t width, uint32_t height, uint32_t mip_levels);
 
         static VkSampler
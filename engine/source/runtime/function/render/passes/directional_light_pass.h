@@ -1,6 +1,8 @@
 #pragma once
 
+#include "runtime/function/render/render_command_recorder.h"
 #include "runtime/function/render/render_pass.h"
+#include "runtime/function/render/render_queue.h"
 
 namespace Piccolo
 {
@@ -24,10 +26,18 @@ namespace Piccolo
         void setupPipelines();
         void setupDescriptorSet();
         void drawModel();
+        // records the mesh runs [run_begin, run_end) of m_mesh_runs, called concurrently for disjoint chunks
+        void drawMeshRuns(RHICommandBuffer* command_buffer,
+                          size_t            run_begin,
+                          size_t            run_end,
+                          uint32_t          perframe_dynamic_offset);
 
     private:
         RHIDescriptorSetLayout* m_per_mesh_layout;
         MeshDirectionalLightShadowPerframeStorageBufferObject
             m_mesh_directional_light_shadow_perframe_storage_buffer_object;
+
+        RenderQueue                 m_render_queue;
+        std::vector<RenderQueueRun> m_mesh_runs;
     };
 } // namespace Piccolo
@@ -6,7 +6,6 @@
 #include "runtime/function/render/interface/vulkan/vulkan_rhi.h"
 #include "runtime/function/render/interface/vulkan/vulkan_util.h"
 
-#include <map>
 #include <stdexcept>
 
 #include <axis_frag.h>
@@ -15,6 +14,7 @@
 #include <deferred_lighting_vert.h>
 #include <mesh_frag.h>
 #include <mesh_gbuffer_frag.h>
+#include <mesh_indirect_vert.h>
 #include <mesh_vert.h>
 #include <skybox_frag.h>
 #include <skybox_vert.h>
@@ -956,6 +956,40 @@ namespace Piccolo
                 throw std::runtime_error("create mesh gbuffer graphics pipeline");
             }
 
+            // gpu driven variant, the instances and their matrices come from the mesh culling pass
+            if (m_mesh_culling_pass && m_mesh_culling_pass->isSupported())
+            {
+                RHIDescriptorSetLayout* indirect_descriptorset_layouts[4] = {
+                    m_descriptor_infos[_mesh_global].layout,
+                    m_descriptor_infos[_per_mesh].layout,
+                    m_descriptor_infos[_mesh_per_material].layout,
+                    m_mesh_culling_pass->getInstanceDescriptorSetLayout()};
+                pipeline_layout_create_info.setLayoutCount = 4;
+                pipeline_layout_create_info.pSetLayouts    = indirect_descriptorset_layouts;
+
+                if (m_rhi->createPipelineLayout(&pipeline_layout_create_info,
+                                                m_render_pipelines[_render_pipeline_type_mesh_gbuffer_indirect].layout) !=
+                    RHI_SUCCESS)
+                {
+                    throw std::runtime_error("create mesh gbuffer indirect pipeline layout");
+                }
+
+                RHIShader* indirect_vert_shader_module = m_rhi->createShaderModule(MESH_INDIRECT_VERT);
+                shader_stages[0].module = indirect_vert_shader_module;
+                pipelineInfo.layout     = m_render_pipelines[_render_pipeline_type_mesh_gbuffer_indirect].layout;
+
+                if (m_rhi->createGraphicsPipelines(RHI_NULL_HANDLE,
+                                                   1,
+                                                   &pipelineInfo,
+                                                   m_render_pipelines[_render_pipeline_type_mesh_gbuffer_indirect].pipeline) !=
+                    RHI_SUCCESS)
+                {
+                    throw std::runtime_error("create mesh gbuffer indirect graphics pipeline");
+                }
+
+                m_rhi->destroyShaderModule(indirect_vert_shader_module);
+            }
+
             m_rhi->destroyShaderModule(vert_shader_module);
             m_rhi->destroyShaderModule(frag_shader_module);
         }
@@ -1236,6 +1270,40 @@ namespace Piccolo
                 throw std::runtime_error("create mesh lighting graphics pipeline");
             }
 
+            // gpu driven variant, the instances and their matrices come from the mesh culling pass
+            if (m_mesh_culling_pass && m_mesh_culling_pass->isSupported())
+            {
+                RHIDescriptorSetLayout* indirect_descriptorset_layouts[4] = {
+                    m_descriptor_infos[_mesh_global].layout,
+                    m_descriptor_infos[_per_mesh].layout,
+                    m_descriptor_infos[_mesh_per_material].layout,
+                    m_mesh_culling_pass->getInstanceDescriptorSetLayout()};
+                pipeline_layout_create_info.setLayoutCount = 4;
+                pipeline_layout_create_info.pSetLayouts    = indirect_descriptorset_layouts;
+
+                if (m_rhi->createPipelineLayout(&pipeline_layout_create_info,
+                                                m_render_pipelines[_render_pipeline_type_mesh_lighting_indirect].layout) !=
+                    RHI_SUCCESS)
+                {
+                    throw std::runtime_error("create mesh lighting indirect pipeline layout");
+                }
+
+                RHIShader* indirect_vert_shader_module = m_rhi->createShaderModule(MESH_INDIRECT_VERT);
+                shader_stages[0].module = indirect_vert_shader_module;
+                pipelineInfo.layout     = m_render_pipelines[_render_pipeline_type_mesh_lighting_indirect].layout;
+
+                if (m_rhi->createGraphicsPipelines(RHI_NULL_HANDLE,
+                                                   1,
+                                                   &pipelineInfo,
+                                                   m_render_pipelines[_render_pipeline_type_mesh_lighting_indirect].pipeline) !=
+                    RHI_SUCCESS)
+                {
+                    throw std::runtime_error("create mesh lighting indirect graphics pipeline");
+                }
+
+                m_rhi->destroyShaderModule(indirect_vert_shader_module);
+            }
+
             m_rhi->destroyShaderModule(vert_shader_module);
             m_rhi->destroyShaderModule(frag_shader_module);
         }
@@ -1918,6 +1986,10 @@ namespace Piccolo
                               ParticlePass&     particle_pass,
                               uint32_t          current_swapchain_image_index)
     {
+        // opened outside the render pass, a subpass taking secondaries records no other commands
+        float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        m_rhi->pushEvent(m_rhi->getCurrentCommandBuffer(), "BasePass", color);
+
         {
             RHIRenderPassBeginInfo renderpass_begin_info {};
             renderpass_begin_info.sType             = RHI_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -1939,18 +2011,20 @@ namespace Piccolo
             renderpass_begin_info.clearValueCount = (sizeof(clear_values) / sizeof(clear_values[0]));
             renderpass_begin_info.pClearValues    = clear_values;
 
-            m_rhi->cmdBeginRenderPassPFN(m_rhi->getCurrentCommandBuffer(), &renderpass_begin_info, RHI_SUBPASS_CONTENTS_INLINE);
+            // the gpu driven base pass is one indirect draw, otherwise the meshes are recorded into secondaries
+            const bool gpu_driven = m_mesh_culling_pass && m_mesh_culling_pass->isActive();
+            m_rhi->cmdBeginRenderPassPFN(m_rhi->getCurrentCommandBuffer(),
+                                         &renderpass_begin_info,
+                                         gpu_driven ? RHI_SUBPASS_CONTENTS_INLINE :
+                                                      RHI_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
         }
 
-        float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
-        m_rhi->pushEvent(m_rhi->getCurrentCommandBuffer(), "BasePass", color);
+        drawMeshGbuffer(m_swapchain_framebuffers[current_swapchain_image_index]);
 
-        drawMeshGbuffer();
+        m_rhi->cmdNextSubpassPFN(m_rhi->getCurrentCommandBuffer(), RHI_SUBPASS_CONTENTS_INLINE);
 
         m_rhi->popEvent(m_rhi->getCurrentCommandBuffer());
 
-        m_rhi->cmdNextSubpassPFN(m_rhi->getCurrentCommandBuffer(), RHI_SUBPASS_CONTENTS_INLINE);
-
         m_rhi->pushEvent(m_rhi->getCurrentCommandBuffer(), "Deferred Lighting", color);
 
         drawDeferredLighting();
@@ -2100,233 +2174,186 @@ namespace Piccolo
         m_rhi->cmdEndRenderPassPFN(m_rhi->getCurrentCommandBuffer());
     }
 
-    void MainCameraPass::drawMeshGbuffer()
+    void MainCameraPass::drawMeshGbuffer(RHIFramebuffer* framebuffer)
     {
-        struct MeshNode
+        if (m_mesh_culling_pass && m_mesh_culling_pass->isActive())
         {
-            const Matrix4x4* model_matrix {nullptr};
-            const Matrix4x4* joint_matrices {nullptr};
-            uint32_t         joint_count {0};
-        };
-
-        std::map<VulkanPBRMaterial*, std::map<VulkanMesh*, std::vector<MeshNode>>> main_camera_mesh_drawcall_batch;
-
-        // reorganize mesh
-        for (RenderMeshNode& node : *(m_visiable_nodes.p_main_camera_visible_mesh_nodes))
-        {
-            auto& mesh_instanced = main_camera_mesh_drawcall_batch[node.ref_material];
-            auto& mesh_nodes     = mesh_instanced[node.ref_mesh];
-
-            MeshNode temp;
-            temp.model_matrix = node.model_matrix;
-            if (node.enable_vertex_blending)
-            {
-                temp.joint_matrices = node.joint_matrices;
-                temp.joint_count    = node.joint_count;
-            }
-
-            mesh_nodes.push_back(temp);
+            drawMeshIndirect(_render_pipeline_type_mesh_gbuffer_indirect, "Mesh GBuffer");
+            return;
         }
 
-        float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
-        m_rhi->pushEvent(m_rhi->getCurrentCommandBuffer(), "Mesh GBuffer", color);
-
-        m_rhi->cmdBindPipelinePFN(m_rhi->getCurrentCommandBuffer(),
-                                  RHI_PIPELINE_BIND_POINT_GRAPHICS,
-                                  m_render_pipelines[_render_pipeline_type_mesh_gbuffer].pipeline);
-        m_rhi->cmdSetViewportPFN(m_rhi->getCurrentCommandBuffer(), 0, 1, m_rhi->getSwapchainInfo().viewport);
-        m_rhi->cmdSetScissorPFN(m_rhi->getCurrentCommandBuffer(), 0, 1, m_rhi->getSwapchainInfo().scissor);
+        // sort the visible nodes into runs of one material and one mesh, near to far inside a run
+        m_render_queue.build(*(m_visiable_nodes.p_main_camera_visible_mesh_nodes),
+                             true,
+                             &m_mesh_perframe_storage_buffer_object.proj_view_matrix);
 
         // perframe storage buffer
-        uint32_t perframe_dynamic_offset =
-            roundUp(m_global_render_resource->_storage_buffer
-                        ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                    m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-
-        m_global_render_resource->_storage_buffer._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-            perframe_dynamic_offset + sizeof(MeshPerframeStorageBufferObject);
-        assert(m_global_render_resource->_storage_buffer
-                   ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-               (m_global_render_resource->_storage_buffer
-                    ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                m_global_render_resource->_storage_buffer
-                    ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
+        uint32_t perframe_dynamic_offset = m_global_render_resource->_storage_buffer.allocateUploadRingbuffer(
+            m_rhi->getCurrentFrameIndex(), sizeof(MeshPerframeStorageBufferObject));
 
         (*reinterpret_cast<MeshPerframeStorageBufferObject*>(
             reinterpret_cast<uintptr_t>(
                 m_global_render_resource->_storage_buffer._global_upload_ringbuffer_memory_pointer) +
             perframe_dynamic_offset)) = m_mesh_perframe_storage_buffer_object;
 
-        for (auto& pair1 : main_camera_mesh_drawcall_batch)
-        {
-            VulkanPBRMaterial& material       = (*pair1.first);
-            auto&              mesh_instanced = pair1.second;
-
-            // bind per material
-            m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
-                                            RHI_PIPELINE_BIND_POINT_GRAPHICS,
-                                            m_render_pipelines[_render_pipeline_type_mesh_gbuffer].layout,
-                                            2,
-                                            1,
-                                            &material.material_descriptor_set,
-                                            0,
-                                            NULL);
+        // the mesh runs are recorded in chunks on the worker threads, the base pass subpass takes secondaries
+        m_render_queue.getRuns(RenderQueue::s_mesh_key_mask, m_mesh_runs);
+        m_command_recorder->record(m_framebuffer.render_pass,
+                                   _main_camera_subpass_basepass,
+                                   framebuffer,
+                                   m_mesh_runs.size(),
+                                   k_min_command_chunk_draw_count,
+                                   [&](RHICommandBuffer* command_buffer, size_t run_begin, size_t run_end) {
+                                       drawMeshGbufferRuns(command_buffer, run_begin, run_end, perframe_dynamic_offset);
+                                   });
+    }
 
-            // TODO: render from near to far
+    void MainCameraPass::drawMeshGbufferRuns(RHICommandBuffer* command_buffer,
+                                             size_t            run_begin,
+                                             size_t            run_end,
+                                             uint32_t          perframe_dynamic_offset)
+    {
+        float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        m_rhi->pushEvent(command_buffer, "Mesh GBuffer", color);
 
-            for (auto& pair2 : mesh_instanced)
-            {
-                VulkanMesh& mesh       = (*pair2.first);
-                auto&       mesh_nodes = pair2.second;
+        m_rhi->cmdBindPipelinePFN(command_buffer,
+                                  RHI_PIPELINE_BIND_POINT_GRAPHICS,
+                                  m_render_pipelines[_render_pipeline_type_mesh_gbuffer].pipeline);
+        m_rhi->cmdSetViewportPFN(command_buffer, 0, 1, m_rhi->getSwapchainInfo().viewport);
+        m_rhi->cmdSetScissorPFN(command_buffer, 0, 1, m_rhi->getSwapchainInfo().scissor);
 
-                uint32_t total_instance_count = static_cast<uint32_t>(mesh_nodes.size());
-                if (total_instance_count > 0)
-                {
-                    // bind per mesh
-                    m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
-                                                    RHI_PIPELINE_BIND_POINT_GRAPHICS,
-                                                    m_render_pipelines[_render_pipeline_type_mesh_gbuffer].layout,
-                                                    1,
-                                                    1,
-                                                    &mesh.mesh_vertex_blending_descriptor_set,
-                                                    0,
-                                                    NULL);
+        // the meshes share the geometry buffer, bound once for all draws of the chunk
+        bindGeometryBuffer(command_buffer, m_render_pipelines[_render_pipeline_type_mesh_gbuffer].layout, 3);
 
+        const VulkanPBRMaterial* bound_material = nullptr;
+        for (size_t run_index = run_begin; run_index < run_end; ++run_index)
+        {
+            const RenderQueueRun& mesh_nodes = m_mesh_runs[run_index];
+            VulkanPBRMaterial&    material   = *mesh_nodes[0].ref_material;
+            VulkanMesh&           mesh       = *mesh_nodes[0].ref_mesh;
 
-                    RHIBuffer* vertex_buffers[] = {mesh.mesh_vertex_position_buffer,
-                                                 mesh.mesh_vertex_varying_enable_blending_buffer,
-                                                 mesh.mesh_vertex_varying_buffer};
-                    RHIDeviceSize offsets[]        = {0, 0, 0};
-                    m_rhi->cmdBindVertexBuffersPFN(m_rhi->getCurrentCommandBuffer(),
-                                                   0,
-                                                   (sizeof(vertex_buffers) / sizeof(vertex_buffers[0])),
-                                                   vertex_buffers,
-                                                   offsets);
-                    m_rhi->cmdBindIndexBufferPFN(m_rhi->getCurrentCommandBuffer(), mesh.mesh_index_buffer, 0, RHI_INDEX_TYPE_UINT16);
+            // bind per material, the runs of a material are consecutive
+            if (&material != bound_material)
+            {
+                m_rhi->cmdBindDescriptorSetsPFN(command_buffer,
+                                                RHI_PIPELINE_BIND_POINT_GRAPHICS,
+                                                m_render_pipelines[_render_pipeline_type_mesh_gbuffer].layout,
+                                                2,
+                                                1,
+                                                &material.material_descriptor_set,
+                                                0,
+                                                NULL);
+                bound_material = &material;
+            }
 
-                    uint32_t drawcall_max_instance_count =
-                        (sizeof(MeshPerdrawcallStorageBufferObject::mesh_instances) /
-                         sizeof(MeshPerdrawcallStorageBufferObject::mesh_instances[0]));
-                    uint32_t drawcall_count =
-                        roundUp(total_instance_count, drawcall_max_instance_count) / drawcall_max_instance_count;
+            uint32_t total_instance_count = static_cast<uint32_t>(mesh_nodes.size());
+            if (total_instance_count > 0)
+            {
+                uint32_t drawcall_max_instance_count =
+                    (sizeof(MeshPerdrawcallStorageBufferObject::mesh_instances) /
+                     sizeof(MeshPerdrawcallStorageBufferObject::mesh_instances[0]));
+                uint32_t drawcall_count =
+                    roundUp(total_instance_count, drawcall_max_instance_count) / drawcall_max_instance_count;
 
-                    for (uint32_t drawcall_index = 0; drawcall_index < drawcall_count; ++drawcall_index)
+                for (uint32_t drawcall_index = 0; drawcall_index < drawcall_count; ++drawcall_index)
+                {
+                    uint32_t current_instance_count =
+                        ((total_instance_count - drawcall_max_instance_count * drawcall_index) <
+                         drawcall_max_instance_count) ?
+                            (total_instance_count - drawcall_max_instance_count * drawcall_index) :
+                            drawcall_max_instance_count;
+
+                    // per drawcall storage buffer
+                    uint32_t perdrawcall_dynamic_offset =
+                        m_global_render_resource->_storage_buffer.allocateUploadRingbuffer(
+                            m_rhi->getCurrentFrameIndex(),
+                            sizeof(MeshPerdrawcallStorageBufferObject));
+
+                    MeshPerdrawcallStorageBufferObject& perdrawcall_storage_buffer_object =
+                        (*reinterpret_cast<MeshPerdrawcallStorageBufferObject*>(
+                            reinterpret_cast<uintptr_t>(m_global_render_resource->_storage_buffer
+                                                            ._global_upload_ringbuffer_memory_pointer) +
+                            perdrawcall_dynamic_offset));
+                    for (uint32_t i = 0; i < current_instance_count; ++i)
                     {
-                        uint32_t current_instance_count =
-                            ((total_instance_count - drawcall_max_instance_count * drawcall_index) <
-                             drawcall_max_instance_count) ?
-                                (total_instance_count - drawcall_max_instance_count * drawcall_index) :
-                                drawcall_max_instance_count;
-
-                        // per drawcall storage buffer
-                        uint32_t perdrawcall_dynamic_offset =
-                            roundUp(m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                                    m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-                        m_global_render_resource->_storage_buffer
-                            ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-                            perdrawcall_dynamic_offset + sizeof(MeshPerdrawcallStorageBufferObject);
-                        assert(m_global_render_resource->_storage_buffer
-                                   ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-                               (m_global_render_resource->_storage_buffer
-                                    ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                                m_global_render_resource->_storage_buffer
-                                    ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
+                        perdrawcall_storage_buffer_object.mesh_instances[i].model_matrix =
+                            *mesh_nodes[drawcall_max_instance_count * drawcall_index + i].model_matrix;
+                        perdrawcall_storage_buffer_object.mesh_instances[i].enable_vertex_blending =
+                            mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices ? 1.0 :
+                                                                                                          -1.0;
+                        perdrawcall_storage_buffer_object.mesh_instances[i].joint_binding_index_offset =
+                            getJointBindingIndexOffset(mesh);
+                    }
 
-                        MeshPerdrawcallStorageBufferObject& perdrawcall_storage_buffer_object =
-                            (*reinterpret_cast<MeshPerdrawcallStorageBufferObject*>(
-                                reinterpret_cast<uintptr_t>(m_global_render_resource->_storage_buffer
-                                                                ._global_upload_ringbuffer_memory_pointer) +
-                                perdrawcall_dynamic_offset));
-                        for (uint32_t i = 0; i < current_instance_count; ++i)
+                    // per drawcall vertex blending storage buffer
+                    uint32_t per_drawcall_vertex_blending_dynamic_offset;
+                    bool     least_one_enable_vertex_blending = true;
+                    for (uint32_t i = 0; i < current_instance_count; ++i)
+                    {
+                        if (!mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices)
                         {
-                            perdrawcall_storage_buffer_object.mesh_instances[i].model_matrix =
-                                *mesh_nodes[drawcall_max_instance_count * drawcall_index + i].model_matrix;
-                            perdrawcall_storage_buffer_object.mesh_instances[i].enable_vertex_blending =
-                                mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices ? 1.0 :
-                                                                                                              -1.0;
+                            least_one_enable_vertex_blending = false;
+                            break;
                         }
-
-                        // per drawcall vertex blending storage buffer
-                        uint32_t per_drawcall_vertex_blending_dynamic_offset;
-                        bool     least_one_enable_vertex_blending = true;
+                    }
+                    if (least_one_enable_vertex_blending)
+                    {
+                        per_drawcall_vertex_blending_dynamic_offset =
+                            m_global_render_resource->_storage_buffer.allocateUploadRingbuffer(
+                                m_rhi->getCurrentFrameIndex(),
+                                sizeof(MeshPerdrawcallVertexBlendingStorageBufferObject));
+
+                        MeshPerdrawcallVertexBlendingStorageBufferObject&
+                            per_drawcall_vertex_blending_storage_buffer_object =
+                                (*reinterpret_cast<MeshPerdrawcallVertexBlendingStorageBufferObject*>(
+                                    reinterpret_cast<uintptr_t>(m_global_render_resource->_storage_buffer
+                                                                    ._global_upload_ringbuffer_memory_pointer) +
+                                    per_drawcall_vertex_blending_dynamic_offset));
                         for (uint32_t i = 0; i < current_instance_count; ++i)
                         {
-                            if (!mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices)
-                            {
-                                least_one_enable_vertex_blending = false;
-                                break;
-                            }
-                        }
-                        if (least_one_enable_vertex_blending)
-                        {
-                            per_drawcall_vertex_blending_dynamic_offset =
-                                roundUp(m_global_render_resource->_storage_buffer
-                                            ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                                        m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-                            m_global_render_resource->_storage_buffer
-                                ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-                                per_drawcall_vertex_blending_dynamic_offset +
-                                sizeof(MeshPerdrawcallVertexBlendingStorageBufferObject);
-                            assert(m_global_render_resource->_storage_buffer
-                                       ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-                                   (m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                                    m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
-
-                            MeshPerdrawcallVertexBlendingStorageBufferObject&
-                                per_drawcall_vertex_blending_storage_buffer_object =
-                                    (*reinterpret_cast<MeshPerdrawcallVertexBlendingStorageBufferObject*>(
-                                        reinterpret_cast<uintptr_t>(m_global_render_resource->_storage_buffer
-                                                                        ._global_upload_ringbuffer_memory_pointer) +
-                                        per_drawcall_vertex_blending_dynamic_offset));
-                            for (uint32_t i = 0; i < current_instance_count; ++i)
+                            if (mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices)
                             {
-                                if (mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices)
+                                for (uint32_t j = 0;
+                                     j < mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_count;
+                                     ++j)
                                 {
-                                    for (uint32_t j = 0;
-                                         j < mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_count;
-                                         ++j)
-                                    {
-                                        per_drawcall_vertex_blending_storage_buffer_object
-                                            .joint_matrices[s_mesh_vertex_blending_max_joint_count * i + j] =
-                                            mesh_nodes[drawcall_max_instance_count * drawcall_index + i]
-                                                .joint_matrices[j];
-                                    }
+                                    per_drawcall_vertex_blending_storage_buffer_object
+                                        .joint_matrices[s_mesh_vertex_blending_max_joint_count * i + j] =
+                                        mesh_nodes[drawcall_max_instance_count * drawcall_index + i]
+                                            .joint_matrices[j];
                                 }
                             }
                         }
-                        else
-                        {
-                            per_drawcall_vertex_blending_dynamic_offset = 0;
-                        }
-
-                        // bind perdrawcall
-                        uint32_t dynamic_offsets[3] = {perframe_dynamic_offset,
-                                                       perdrawcall_dynamic_offset,
-                                                       per_drawcall_vertex_blending_dynamic_offset};
-                        m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
-                                                        RHI_PIPELINE_BIND_POINT_GRAPHICS,
-                                                        m_render_pipelines[_render_pipeline_type_mesh_gbuffer].layout,
-                                                        0,
-                                                        1,
-                                                        &m_descriptor_infos[_mesh_global].descriptor_set,
-                                                        3,
-                                                        dynamic_offsets);
-
-                        m_rhi->cmdDrawIndexedPFN(m_rhi->getCurrentCommandBuffer(),
-                                                 mesh.mesh_index_count,
-                                                 current_instance_count,
-                                                 0,
-                                                 0,
-                                                 0);
                     }
+                    else
+                    {
+                        per_drawcall_vertex_blending_dynamic_offset = 0;
+                    }
+
+                    // bind perdrawcall
+                    uint32_t dynamic_offsets[3] = {perframe_dynamic_offset,
+                                                   perdrawcall_dynamic_offset,
+                                                   per_drawcall_vertex_blending_dynamic_offset};
+                    m_rhi->cmdBindDescriptorSetsPFN(command_buffer,
+                                                    RHI_PIPELINE_BIND_POINT_GRAPHICS,
+                                                    m_render_pipelines[_render_pipeline_type_mesh_gbuffer].layout,
+                                                    0,
+                                                    1,
+                                                    &m_descriptor_infos[_mesh_global].descriptor_set,
+                                                    3,
+                                                    dynamic_offsets);
+
+                    m_rhi->cmdDrawIndexedPFN(command_buffer,
+                                             mesh.mesh_index_count,
+                                             current_instance_count,
+                                             mesh.mesh_first_index,
+                                             static_cast<int32_t>(mesh.mesh_vertex_offset),
+                                             0);
                 }
             }
         }
 
-        m_rhi->popEvent(m_rhi->getCurrentCommandBuffer());
+        m_rhi->popEvent(command_buffer);
     }
 
     void MainCameraPass::drawDeferredLighting()
@@ -2338,19 +2365,8 @@ namespace Piccolo
         m_rhi->cmdSetViewportPFN(m_rhi->getCurrentCommandBuffer(), 0, 1, m_rhi->getSwapchainInfo().viewport);
         m_rhi->cmdSetScissorPFN(m_rhi->getCurrentCommandBuffer(), 0, 1, m_rhi->getSwapchainInfo().scissor);
 
-        uint32_t perframe_dynamic_offset =
-            roundUp(m_global_render_resource->_storage_buffer
-                        ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                    m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-
-        m_global_render_resource->_storage_buffer._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-            perframe_dynamic_offset + sizeof(MeshPerframeStorageBufferObject);
-        assert(m_global_render_resource->_storage_buffer
-                   ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-               (m_global_render_resource->_storage_buffer
-                    ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                m_global_render_resource->_storage_buffer
-                    ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
+        uint32_t perframe_dynamic_offset = m_global_render_resource->_storage_buffer.allocateUploadRingbuffer(
+            m_rhi->getCurrentFrameIndex(), sizeof(MeshPerframeStorageBufferObject));
 
         (*reinterpret_cast<MeshPerframeStorageBufferObject*>(
             reinterpret_cast<uintptr_t>(
@@ -2375,32 +2391,17 @@ namespace Piccolo
 
     void MainCameraPass::drawMeshLighting()
     {
-        struct MeshNode
+        if (m_mesh_culling_pass && m_mesh_culling_pass->isActive())
         {
-            const Matrix4x4* model_matrix {nullptr};
-            const Matrix4x4* joint_matrices {nullptr};
-            uint32_t         joint_count {0};
-        };
-
-        std::map<VulkanPBRMaterial*, std::map<VulkanMesh*, std::vector<MeshNode>>> main_camera_mesh_drawcall_batch;
-
-        // reorganize mesh
-        for (RenderMeshNode& node : *(m_visiable_nodes.p_main_camera_visible_mesh_nodes))
-        {
-            auto& mesh_instanced = main_camera_mesh_drawcall_batch[node.ref_material];
-            auto& mesh_nodes     = mesh_instanced[node.ref_mesh];
-
-            MeshNode temp;
-            temp.model_matrix = node.model_matrix;
-            if (node.enable_vertex_blending)
-            {
-                temp.joint_matrices = node.joint_matrices;
-                temp.joint_count    = node.joint_count;
-            }
-
-            mesh_nodes.push_back(temp);
+            drawMeshIndirect(_render_pipeline_type_mesh_lighting_indirect, "Model");
+            return;
         }
 
+        // sort the visible nodes into runs of one material and one mesh, near to far inside a run
+        m_render_queue.build(*(m_visiable_nodes.p_main_camera_visible_mesh_nodes),
+                             true,
+                             &m_mesh_perframe_storage_buffer_object.proj_view_matrix);
+
         float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
         m_rhi->pushEvent(m_rhi->getCurrentCommandBuffer(), "Model", color);
 
@@ -2411,29 +2412,22 @@ namespace Piccolo
         m_rhi->cmdSetScissorPFN(m_rhi->getCurrentCommandBuffer(), 0, 1, m_rhi->getSwapchainInfo().scissor);
 
         // perframe storage buffer
-        uint32_t perframe_dynamic_offset =
-            roundUp(m_global_render_resource->_storage_buffer
-                        ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                    m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-
-        m_global_render_resource->_storage_buffer._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-            perframe_dynamic_offset + sizeof(MeshPerframeStorageBufferObject);
-        assert(m_global_render_resource->_storage_buffer
-                   ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-               (m_global_render_resource->_storage_buffer
-                    ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                m_global_render_resource->_storage_buffer
-                    ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
+        uint32_t perframe_dynamic_offset = m_global_render_resource->_storage_buffer.allocateUploadRingbuffer(
+            m_rhi->getCurrentFrameIndex(), sizeof(MeshPerframeStorageBufferObject));
 
         (*reinterpret_cast<MeshPerframeStorageBufferObject*>(
             reinterpret_cast<uintptr_t>(
                 m_global_render_resource->_storage_buffer._global_upload_ringbuffer_memory_pointer) +
             perframe_dynamic_offset)) = m_mesh_perframe_storage_buffer_object;
 
-        for (auto& pair1 : main_camera_mesh_drawcall_batch)
+        // the meshes share the geometry buffer, bound once for all draws
+        bindGeometryBuffer(m_render_pipelines[_render_pipeline_type_mesh_lighting].layout, 3);
+
+        for (size_t material_begin = 0; material_begin < m_render_queue.getItemCount();)
         {
-            VulkanPBRMaterial& material       = (*pair1.first);
-            auto&              mesh_instanced = pair1.second;
+            RenderQueueRun     material_run = m_render_queue.getRun(material_begin, RenderQueue::s_material_key_mask);
+            VulkanPBRMaterial& material     = *material_run[0].ref_material;
+            material_begin                  = material_run.getEnd();
 
             // bind per material
             m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
@@ -2445,37 +2439,15 @@ namespace Piccolo
                                             0,
                                             NULL);
 
-            // TODO: render from near to far
-
-            for (auto& pair2 : mesh_instanced)
+            for (size_t mesh_begin = material_run.getBegin(); mesh_begin < material_run.getEnd();)
             {
-                VulkanMesh& mesh       = (*pair2.first);
-                auto&       mesh_nodes = pair2.second;
+                RenderQueueRun mesh_nodes = m_render_queue.getRun(mesh_begin, RenderQueue::s_mesh_key_mask);
+                VulkanMesh&    mesh       = *mesh_nodes[0].ref_mesh;
+                mesh_begin                = mesh_nodes.getEnd();
 
                 uint32_t total_instance_count = static_cast<uint32_t>(mesh_nodes.size());
                 if (total_instance_count > 0)
                 {
-                    // bind per mesh
-                    m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
-                                                    RHI_PIPELINE_BIND_POINT_GRAPHICS,
-                                                    m_render_pipelines[_render_pipeline_type_mesh_lighting].layout,
-                                                    1,
-                                                    1,
-                                                    &mesh.mesh_vertex_blending_descriptor_set,
-                                                    0,
-                                                    NULL);
-
-                    RHIBuffer*     vertex_buffers[3] = {mesh.mesh_vertex_position_buffer,
-                                                 mesh.mesh_vertex_varying_enable_blending_buffer,
-                                                 mesh.mesh_vertex_varying_buffer};
-                    RHIDeviceSize offsets[]        = {0, 0, 0};
-                    m_rhi->cmdBindVertexBuffersPFN(m_rhi->getCurrentCommandBuffer(),
-                                                   0,
-                                                   (sizeof(vertex_buffers) / sizeof(vertex_buffers[0])),
-                                                   vertex_buffers,
-                                                   offsets);
-                    m_rhi->cmdBindIndexBufferPFN(m_rhi->getCurrentCommandBuffer(), mesh.mesh_index_buffer, 0, RHI_INDEX_TYPE_UINT16);
-
                     uint32_t drawcall_max_instance_count =
                         (sizeof(MeshPerdrawcallStorageBufferObject::mesh_instances) /
                          sizeof(MeshPerdrawcallStorageBufferObject::mesh_instances[0]));
@@ -2492,18 +2464,9 @@ namespace Piccolo
 
                         // per drawcall storage buffer
                         uint32_t perdrawcall_dynamic_offset =
-                            roundUp(m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                                    m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-                        m_global_render_resource->_storage_buffer
-                            ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-                            perdrawcall_dynamic_offset + sizeof(MeshPerdrawcallStorageBufferObject);
-                        assert(m_global_render_resource->_storage_buffer
-                                   ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-                               (m_global_render_resource->_storage_buffer
-                                    ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                                m_global_render_resource->_storage_buffer
-                                    ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
+                            m_global_render_resource->_storage_buffer.allocateUploadRingbuffer(
+                                m_rhi->getCurrentFrameIndex(),
+                                sizeof(MeshPerdrawcallStorageBufferObject));
 
                         MeshPerdrawcallStorageBufferObject& perdrawcall_storage_buffer_object =
                             (*reinterpret_cast<MeshPerdrawcallStorageBufferObject*>(
@@ -2517,6 +2480,8 @@ namespace Piccolo
                             perdrawcall_storage_buffer_object.mesh_instances[i].enable_vertex_blending =
                                 mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices ? 1.0 :
                                                                                                               -1.0;
+                            perdrawcall_storage_buffer_object.mesh_instances[i].joint_binding_index_offset =
+                                getJointBindingIndexOffset(mesh);
                         }
 
                         // per drawcall vertex blending storage buffer
@@ -2533,19 +2498,9 @@ namespace Piccolo
                         if (least_one_enable_vertex_blending)
                         {
                             per_drawcall_vertex_blending_dynamic_offset =
-                                roundUp(m_global_render_resource->_storage_buffer
-                                            ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                                        m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-                            m_global_render_resource->_storage_buffer
-                                ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-                                per_drawcall_vertex_blending_dynamic_offset +
-                                sizeof(MeshPerdrawcallVertexBlendingStorageBufferObject);
-                            assert(m_global_render_resource->_storage_buffer
-                                       ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-                                   (m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                                    m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
+                                m_global_render_resource->_storage_buffer.allocateUploadRingbuffer(
+                                    m_rhi->getCurrentFrameIndex(),
+                                    sizeof(MeshPerdrawcallVertexBlendingStorageBufferObject));
 
                             MeshPerdrawcallVertexBlendingStorageBufferObject&
                                 per_drawcall_vertex_blending_storage_buffer_object =
@@ -2590,8 +2545,8 @@ namespace Piccolo
                         m_rhi->cmdDrawIndexedPFN(m_rhi->getCurrentCommandBuffer(),
                                                  mesh.mesh_index_count,
                                                  current_instance_count,
-                                                 0,
-                                                 0,
+                                                 mesh.mesh_first_index,
+                                                 static_cast<int32_t>(mesh.mesh_vertex_offset),
                                                  0);
                     }
                 }
@@ -2601,21 +2556,58 @@ namespace Piccolo
         m_rhi->popEvent(m_rhi->getCurrentCommandBuffer());
     }
 
+    void MainCameraPass::drawMeshIndirect(RenderPipeLineType pipeline_type, const char* event_name)
+    {
+        float color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        m_rhi->pushEvent(m_rhi->getCurrentCommandBuffer(), event_name, color);
+
+        m_rhi->cmdBindPipelinePFN(m_rhi->getCurrentCommandBuffer(),
+                                  RHI_PIPELINE_BIND_POINT_GRAPHICS,
+                                  m_render_pipelines[pipeline_type].pipeline);
+        m_rhi->cmdSetViewportPFN(m_rhi->getCurrentCommandBuffer(), 0, 1, m_rhi->getSwapchainInfo().viewport);
+        m_rhi->cmdSetScissorPFN(m_rhi->getCurrentCommandBuffer(), 0, 1, m_rhi->getSwapchainInfo().scissor);
+
+        // perframe storage buffer
+        uint32_t perframe_dynamic_offset = m_global_render_resource->_storage_buffer.allocateUploadRingbuffer(
+            m_rhi->getCurrentFrameIndex(), sizeof(MeshPerframeStorageBufferObject));
+
+        (*reinterpret_cast<MeshPerframeStorageBufferObject*>(
+            reinterpret_cast<uintptr_t>(
+                m_global_render_resource->_storage_buffer._global_upload_ringbuffer_memory_pointer) +
+            perframe_dynamic_offset)) = m_mesh_perframe_storage_buffer_object;
+
+        // the per drawcall bindings are unused by the indirect vertex shader
+        uint32_t dynamic_offsets[3] = {perframe_dynamic_offset, 0, 0};
+        m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
+                                        RHI_PIPELINE_BIND_POINT_GRAPHICS,
+                                        m_render_pipelines[pipeline_type].layout,
+                                        0,
+                                        1,
+                                        &m_descriptor_infos[_mesh_global].descriptor_set,
+                                        3,
+                                        dynamic_offsets);
+
+        RHIDescriptorSet* instance_descriptor_set = m_mesh_culling_pass->getInstanceDescriptorSet();
+        m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
+                                        RHI_PIPELINE_BIND_POINT_GRAPHICS,
+                                        m_render_pipelines[pipeline_type].layout,
+                                        3,
+                                        1,
+                                        &instance_descriptor_set,
+                                        0,
+                                        NULL);
+
+        bindGeometryBuffer(m_render_pipelines[pipeline_type].layout, 3);
+
+        m_mesh_culling_pass->drawIndirect(m_render_pipelines[pipeline_type].layout, 2);
+
+        m_rhi->popEvent(m_rhi->getCurrentCommandBuffer());
+    }
+
     void MainCameraPass::drawSkybox()
     {
-        uint32_t perframe_dynamic_offset =
-            roundUp(m_global_render_resource->_storage_buffer
-                        ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                    m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-
-        m_global_render_resource->_storage_buffer._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-            perframe_dynamic_offset + sizeof(MeshPerframeStorageBufferObject);
-        assert(m_global_render_resource->_storage_buffer
-                   ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-               (m_global_render_resource->_storage_buffer
-                    ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                m_global_render_resource->_storage_buffer
-                    ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
+        uint32_t perframe_dynamic_offset = m_global_render_resource->_storage_buffer.allocateUploadRingbuffer(
+            m_rhi->getCurrentFrameIndex(), sizeof(MeshPerframeStorageBufferObject));
 
         (*reinterpret_cast<MeshPerframeStorageBufferObject*>(
             reinterpret_cast<uintptr_t>(
@@ -2646,19 +2638,8 @@ namespace Piccolo
         if (!m_is_show_axis)
             return;
 
-        uint32_t perframe_dynamic_offset =
-            roundUp(m_global_render_resource->_storage_buffer
-                        ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                    m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-
-        m_global_render_resource->_storage_buffer._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-            perframe_dynamic_offset + sizeof(MeshPerframeStorageBufferObject);
-        assert(m_global_render_resource->_storage_buffer
-                   ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-               (m_global_render_resource->_storage_buffer
-                    ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                m_global_render_resource->_storage_buffer
-                    ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
+        uint32_t perframe_dynamic_offset = m_global_render_resource->_storage_buffer.allocateUploadRingbuffer(
+            m_rhi->getCurrentFrameIndex(), sizeof(MeshPerframeStorageBufferObject));
 
         (*reinterpret_cast<MeshPerframeStorageBufferObject*>(
             reinterpret_cast<uintptr_t>(
@@ -2685,19 +2666,9 @@ namespace Piccolo
         m_axis_storage_buffer_object.selected_axis = m_selected_axis;
         m_axis_storage_buffer_object.model_matrix  = m_visiable_nodes.p_axis_node->model_matrix;
 
-        RHIBuffer*     vertex_buffers[3] = {m_visiable_nodes.p_axis_node->ref_mesh->mesh_vertex_position_buffer,
-                                     m_visiable_nodes.p_axis_node->ref_mesh->mesh_vertex_varying_enable_blending_buffer,
-                                     m_visiable_nodes.p_axis_node->ref_mesh->mesh_vertex_varying_buffer};
-        RHIDeviceSize offsets[3]        = {0, 0, 0};
-        m_rhi->cmdBindVertexBuffersPFN(m_rhi->getCurrentCommandBuffer(),
-                                       0,
-                                       (sizeof(vertex_buffers) / sizeof(vertex_buffers[0])),
-                                       vertex_buffers,
-                                       offsets);
-        m_rhi->cmdBindIndexBufferPFN(m_rhi->getCurrentCommandBuffer(),
-                                     m_visiable_nodes.p_axis_node->ref_mesh->mesh_index_buffer,
-                                     0,
-                                     RHI_INDEX_TYPE_UINT16);
+        // the axis layout has no joint binding set
+        bindGeometryBuffer(nullptr, 3);
+
         (*reinterpret_cast<AxisStorageBufferObject*>(reinterpret_cast<uintptr_t>(
             m_global_render_resource->_storage_buffer._axis_inefficient_storage_buffer_memory_pointer))) =
             m_axis_storage_buffer_object;
@@ -2705,8 +2676,8 @@ namespace Piccolo
         m_rhi->cmdDrawIndexedPFN(m_rhi->getCurrentCommandBuffer(),
                                  m_visiable_nodes.p_axis_node->ref_mesh->mesh_index_count,
                                  1,
-                                 0,
-                                 0,
+                                 m_visiable_nodes.p_axis_node->ref_mesh->mesh_first_index,
+                                 static_cast<int32_t>(m_visiable_nodes.p_axis_node->ref_mesh->mesh_vertex_offset),
                                  0);
 
         m_rhi->popEvent(m_rhi->getCurrentCommandBuffer());
@@ -2724,4 +2695,6 @@ namespace Piccolo
 
     void MainCameraPass::setParticlePass(std::shared_ptr<ParticlePass> pass) { m_particle_pass = pass; }
 
+    void MainCameraPass::setMeshCullingPass(std::shared_ptr<MeshCullingPass> pass) { m_mesh_culling_pass = pass; }
+
 } // namespace Piccolo
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "runtime/function/render/render_command_recorder.h"
 #include "runtime/function/render/render_pass.h"
+#include "runtime/function/render/render_queue.h"
 
 #include "runtime/function/render/passes/color_grading_pass.h"
 #include "runtime/function/render/passes/combine_ui_pass.h"
@@ -8,6 +10,7 @@
 #include "runtime/function/render/passes/tone_mapping_pass.h"
 #include "runtime/function/render/passes/ui_pass.h"
 #include "runtime/function/render/passes/particle_pass.h"
+#include "runtime/function/render/passes/mesh_culling_pass.h"
 
 namespace Piccolo
 {
@@ -44,6 +47,7 @@ namespace Piccolo
         // 2. sky box
         // 3. axis
         // 4. billboard type particle
+        // 5. gpu driven model, drawn indirectly from the mesh culling pass
         enum RenderPipeLineType : uint8_t
         {
             _render_pipeline_type_mesh_gbuffer = 0,
@@ -52,6 +56,8 @@ namespace Piccolo
             _render_pipeline_type_skybox,
             _render_pipeline_type_axis,
             _render_pipeline_type_particle,
+            _render_pipeline_type_mesh_gbuffer_indirect,
+            _render_pipeline_type_mesh_lighting_indirect,
             _render_pipeline_type_count
         };
 
@@ -92,6 +98,9 @@ namespace Piccolo
 
         void setParticlePass(std::shared_ptr<ParticlePass> pass);
 
+        // must be set and initialized before initialize to create the gpu driven mesh pipelines
+        void setMeshCullingPass(std::shared_ptr<MeshCullingPass> pass);
+
     private:
         void setupParticlePass();
         void setupAttachments();
@@ -108,9 +117,15 @@ namespace Piccolo
         void setupParticleDescriptorSet();
         void setupGbufferLightingDescriptorSet();
 
-        void drawMeshGbuffer();
+        void drawMeshGbuffer(RHIFramebuffer* framebuffer);
+        // records the mesh runs [run_begin, run_end) of the gbuffer into one secondary command buffer
+        void drawMeshGbufferRuns(RHICommandBuffer* command_buffer,
+                                 size_t            run_begin,
+                                 size_t            run_end,
+                                 uint32_t          perframe_dynamic_offset);
         void drawDeferredLighting();
         void drawMeshLighting();
+        void drawMeshIndirect(RenderPipeLineType pipeline_type, const char* event_name);
         void drawSkybox();
         void drawAxis();
 
@@ -119,5 +134,9 @@ namespace Piccolo
     private:
         std::vector<RHIFramebuffer*> m_swapchain_framebuffers;
         std::shared_ptr<ParticlePass> m_particle_pass;
+        std::shared_ptr<MeshCullingPass> m_mesh_culling_pass;
+        // rebuilt every frame, keeps its storage across frames
+        RenderQueue                      m_render_queue;
+        std::vector<RenderQueueRun>      m_mesh_runs;
     };
 } // namespace Piccolo
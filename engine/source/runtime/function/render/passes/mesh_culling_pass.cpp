@@ -0,0 +1,854 @@
+#include "runtime/function/render/passes/mesh_culling_pass.h"
+#include "runtime/function/render/render_helper.h"
+#include "runtime/function/render/render_guid_allocator.h"
+#include "runtime/function/render/render_resource.h"
+#include "runtime/function/render/render_scene.h"
+
+#include "runtime/function/render/interface/vulkan/vulkan_rhi.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <mesh_culling_comp.h>
+#include <mesh_culling_compact_comp.h>
+
+namespace Piccolo
+{
+    // initial capacities, the buffers grow to the size of the scene
+    static const uint32_t s_mesh_culling_initial_instance_count = 1024;
+    static const uint32_t s_mesh_culling_initial_batch_count    = 256;
+    static const uint32_t s_mesh_culling_group_size             = 64; // local_size_x of the culling shaders
+    static const uint32_t s_mesh_culling_free_slot_batch_index  = 0xFFFFFFFFu; // skipped by the culling shader
+
+    void MeshCullingPass::initialize(const RenderPassInitInfo* init_info)
+    {
+        RenderPass::initialize(nullptr);
+
+        if (!isSupported())
+        {
+            LOG_INFO("drawIndirectFirstInstance is not supported, the main camera meshes are culled on the cpu");
+            return;
+        }
+
+        setupDescriptorSetLayout();
+        setupPipelines();
+        setupDescriptorSet();
+
+        m_is_initialized = true;
+    }
+
+    void MeshCullingPass::preparePassData(std::shared_ptr<RenderResourceBase> render_resource)
+    {
+        const RenderResource* vulkan_resource = static_cast<const RenderResource*>(render_resource.get());
+        if (vulkan_resource)
+        {
+            m_proj_view_matrix = vulkan_resource->m_mesh_perframe_storage_buffer_object.proj_view_matrix;
+        }
+    }
+
+    void MeshCullingPass::setupDescriptorSetLayout()
+    {
+        m_descriptor_infos.resize(_layout_type_count);
+
+        {
+            RHIDescriptorSetLayoutBinding culling_layout_bindings[6] = {};
+            for (uint32_t i = 0; i < 6; ++i)
+            {
+                culling_layout_bindings[i].binding         = i;
+                culling_layout_bindings[i].descriptorType  = RHI_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                culling_layout_bindings[i].descriptorCount = 1;
+                culling_layout_bindings[i].stageFlags      = RHI_SHADER_STAGE_COMPUTE_BIT;
+            }
+
+            RHIDescriptorSetLayoutCreateInfo culling_layout_create_info {};
+            culling_layout_create_info.sType        = RHI_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            culling_layout_create_info.pNext        = NULL;
+            culling_layout_create_info.flags        = 0;
+            culling_layout_create_info.bindingCount = sizeof(culling_layout_bindings) / sizeof(culling_layout_bindings[0]);
+            culling_layout_create_info.pBindings    = culling_layout_bindings;
+
+            if (RHI_SUCCESS !=
+                m_rhi->createDescriptorSetLayout(&culling_layout_create_info, m_descriptor_infos[_culling].layout))
+            {
+                throw std::runtime_error("create mesh culling layout");
+            }
+        }
+
+        {
+            RHIDescriptorSetLayoutBinding instance_layout_bindings[3] = {};
+            for (uint32_t i = 0; i < 3; ++i)
+            {
+                instance_layout_bindings[i].binding         = i;
+                instance_layout_bindings[i].descriptorType  = RHI_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                instance_layout_bindings[i].descriptorCount = 1;
+                instance_layout_bindings[i].stageFlags      = RHI_SHADER_STAGE_VERTEX_BIT;
+            }
+
+            RHIDescriptorSetLayoutCreateInfo instance_layout_create_info {};
+            instance_layout_create_info.sType = RHI_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            instance_layout_create_info.pNext = NULL;
+            instance_layout_create_info.flags = 0;
+            instance_layout_create_info.bindingCount =
+                sizeof(instance_layout_bindings) / sizeof(instance_layout_bindings[0]);
+            instance_layout_create_info.pBindings = instance_layout_bindings;
+
+            if (RHI_SUCCESS !=
+                m_rhi->createDescriptorSetLayout(&instance_layout_create_info, m_descriptor_infos[_instance].layout))
+            {
+                throw std::runtime_error("create mesh culling instance layout");
+            }
+        }
+    }
+
+    void MeshCullingPass::setupPipelines()
+    {
+        m_render_pipelines.resize(_render_pipeline_type_count);
+
+        RHIDescriptorSetLayout*     descriptorset_layouts[1] = {m_descriptor_infos[_culling].layout};
+        RHIPipelineLayoutCreateInfo pipeline_layout_create_info {};
+        pipeline_layout_create_info.sType          = RHI_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipeline_layout_create_info.setLayoutCount = 1;
+        pipeline_layout_create_info.pSetLayouts    = descriptorset_layouts;
+
+        RHIPipelineLayout* pipeline_layout = nullptr;
+        if (m_rhi->createPipelineLayout(&pipeline_layout_create_info, pipeline_layout) != RHI_SUCCESS)
+        {
+            throw std::runtime_error("create mesh culling pipeline layout");
+        }
+        m_render_pipelines[_render_pipeline_type_culling].layout = pipeline_layout;
+        m_render_pipelines[_render_pipeline_type_compact].layout = pipeline_layout;
+
+        RHIComputePipelineCreateInfo compute_pipeline_create_info {};
+        compute_pipeline_create_info.sType  = RHI_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        compute_pipeline_create_info.layout = pipeline_layout;
+        compute_pipeline_create_info.flags  = 0;
+
+        RHIPipelineShaderStageCreateInfo shader_stage {};
+        shader_stage.sType               = RHI_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shader_stage.stage               = RHI_SHADER_STAGE_COMPUTE_BIT;
+        shader_stage.pName               = "main";
+        shader_stage.pSpecializationInfo = nullptr;
+
+        compute_pipeline_create_info.pStages = &shader_stage;
+
+        {
+            shader_stage.module = m_rhi->createShaderModule(MESH_CULLING_COMP);
+            if (RHI_SUCCESS != m_rhi->createComputePipelines(nullptr,
+                                                             1,
+                                                             &compute_pipeline_create_info,
+                                                             m_render_pipelines[_render_pipeline_type_culling].pipeline))
+            {
+                throw std::runtime_error("create mesh culling pipeline");
+            }
+            m_rhi->destroyShaderModule(shader_stage.module);
+        }
+
+        {
+            shader_stage.module = m_rhi->createShaderModule(MESH_CULLING_COMPACT_COMP);
+            if (RHI_SUCCESS != m_rhi->createComputePipelines(nullptr,
+                                                             1,
+                                                             &compute_pipeline_create_info,
+                                                             m_render_pipelines[_render_pipeline_type_compact].pipeline))
+            {
+                throw std::runtime_error("create mesh culling compact pipeline");
+            }
+            m_rhi->destroyShaderModule(shader_stage.module);
+        }
+    }
+
+    void MeshCullingPass::setupDescriptorSet()
+    {
+        m_frame_resources.resize(m_rhi->getMaxFramesInFlight());
+
+        reservePersistentBuffer(m_instances, s_mesh_culling_initial_instance_count * sizeof(MeshCullingInstance));
+        reservePersistentBuffer(m_joint_matrices, s_mesh_culling_initial_instance_count * sizeof(Matrix4x4));
+
+        for (FrameResource& frame_resource : m_frame_resources)
+        {
+            RHIDescriptorSetAllocateInfo descriptor_set_alloc_info {};
+            descriptor_set_alloc_info.sType              = RHI_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            descriptor_set_alloc_info.pNext              = NULL;
+            descriptor_set_alloc_info.descriptorPool     = m_rhi->getDescriptorPoor();
+            descriptor_set_alloc_info.descriptorSetCount = 1;
+
+            descriptor_set_alloc_info.pSetLayouts = &m_descriptor_infos[_culling].layout;
+            if (RHI_SUCCESS !=
+                m_rhi->allocateDescriptorSets(&descriptor_set_alloc_info, frame_resource.culling_descriptor_set))
+            {
+                throw std::runtime_error("allocate mesh culling descriptor set");
+            }
+
+            descriptor_set_alloc_info.pSetLayouts = &m_descriptor_infos[_instance].layout;
+            if (RHI_SUCCESS !=
+                m_rhi->allocateDescriptorSets(&descriptor_set_alloc_info, frame_resource.instance_descriptor_set))
+            {
+                throw std::runtime_error("allocate mesh culling instance descriptor set");
+            }
+
+            RHIMemoryPropertyFlags host_properties =
+                RHI_MEMORY_PROPERTY_HOST_VISIBLE_BIT | RHI_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            reserveBuffer(frame_resource.parameters,
+                          sizeof(MeshCullingParameters),
+                          RHI_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                          host_properties);
+            reserveBuffer(frame_resource.batches,
+                          s_mesh_culling_initial_batch_count * sizeof(MeshCullingBatch),
+                          RHI_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                          host_properties);
+            reserveBuffer(frame_resource.draw_counts,
+                          s_mesh_culling_initial_batch_count * sizeof(uint32_t),
+                          RHI_BUFFER_USAGE_STORAGE_BUFFER_BIT | RHI_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                          host_properties);
+            reserveBuffer(frame_resource.upload,
+                          s_mesh_culling_initial_instance_count * sizeof(MeshCullingInstance),
+                          RHI_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                          host_properties);
+            reserveBuffer(frame_resource.visible_instances,
+                          s_mesh_culling_initial_instance_count * sizeof(uint32_t),
+                          RHI_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                          RHI_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            reserveBuffer(frame_resource.draw_commands,
+                          s_mesh_culling_initial_batch_count * sizeof(MeshCullingDrawCommand),
+                          RHI_BUFFER_USAGE_STORAGE_BUFFER_BIT | RHI_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                          RHI_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            updateDescriptorSet(frame_resource);
+        }
+    }
+
+    void MeshCullingPass::updateDescriptorSet(FrameResource& frame_resource)
+    {
+        RHIDescriptorBufferInfo culling_buffer_infos[6] = {
+            {frame_resource.parameters.buffer, 0, RHI_WHOLE_SIZE},
+            {m_instances.buffer, 0, RHI_WHOLE_SIZE},
+            {frame_resource.batches.buffer, 0, RHI_WHOLE_SIZE},
+            {frame_resource.visible_instances.buffer, 0, RHI_WHOLE_SIZE},
+            {frame_resource.draw_commands.buffer, 0, RHI_WHOLE_SIZE},
+            {frame_resource.draw_counts.buffer, 0, RHI_WHOLE_SIZE}};
+
+        RHIDescriptorBufferInfo instance_buffer_infos[3] = {
+            {m_instances.buffer, 0, RHI_WHOLE_SIZE},
+            {frame_resource.visible_instances.buffer, 0, RHI_WHOLE_SIZE},
+            {m_joint_matrices.buffer, 0, RHI_WHOLE_SIZE}};
+
+        RHIWriteDescriptorSet descriptor_writes[9] = {};
+        for (uint32_t i = 0; i < 6; ++i)
+        {
+            RHIWriteDescriptorSet& descriptor_write = descriptor_writes[i];
+            descriptor_write.sType                  = RHI_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptor_write.pNext                  = NULL;
+            descriptor_write.dstSet                 = frame_resource.culling_descriptor_set;
+            descriptor_write.dstBinding             = i;
+            descriptor_write.dstArrayElement        = 0;
+            descriptor_write.descriptorType         = RHI_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptor_write.descriptorCount        = 1;
+            descriptor_write.pBufferInfo            = &culling_buffer_infos[i];
+        }
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            RHIWriteDescriptorSet& descriptor_write = descriptor_writes[6 + i];
+            descriptor_write.sType                  = RHI_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptor_write.pNext                  = NULL;
+            descriptor_write.dstSet                 = frame_resource.instance_descriptor_set;
+            descriptor_write.dstBinding             = i;
+            descriptor_write.dstArrayElement        = 0;
+            descriptor_write.descriptorType         = RHI_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptor_write.descriptorCount        = 1;
+            descriptor_write.pBufferInfo            = &instance_buffer_infos[i];
+        }
+
+        m_rhi->updateDescriptorSets(sizeof(descriptor_writes) / sizeof(descriptor_writes[0]), descriptor_writes, 0, NULL);
+
+        frame_resource.bound_instances      = m_instances.buffer;
+        frame_resource.bound_joint_matrices = m_joint_matrices.buffer;
+    }
+
+    bool MeshCullingPass::reserveBuffer(CullingBuffer&         culling_buffer,
+                                        RHIDeviceSize          size,
+                                        RHIBufferUsageFlags    usage,
+                                        RHIMemoryPropertyFlags properties)
+    {
+        if (culling_buffer.buffer != nullptr && culling_buffer.size >= size)
+        {
+            return false;
+        }
+
+        // the frame index of the buffer is not in flight anymore when its frame records again
+        destroyBuffer(culling_buffer);
+        createBuffer(culling_buffer, size, usage, properties);
+        return true;
+    }
+
+    bool MeshCullingPass::reservePersistentBuffer(CullingBuffer& culling_buffer, RHIDeviceSize size)
+    {
+        if (culling_buffer.buffer != nullptr && culling_buffer.size >= size)
+        {
+            return false;
+        }
+
+        // the frames in flight read the old buffer, it is released once the last of them completed
+        if (culling_buffer.buffer != nullptr)
+        {
+            RetiredBuffer retired_buffer;
+            retired_buffer.buffer           = culling_buffer;
+            retired_buffer.remaining_frames = m_rhi->getMaxFramesInFlight() + 1;
+            m_retired_buffers.push_back(retired_buffer);
+            culling_buffer.buffer = nullptr;
+            culling_buffer.memory = nullptr;
+        }
+
+        createBuffer(culling_buffer,
+                     size,
+                     RHI_BUFFER_USAGE_STORAGE_BUFFER_BIT | RHI_BUFFER_USAGE_TRANSFER_DST_BIT,
+                     RHI_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        return true;
+    }
+
+    void MeshCullingPass::createBuffer(CullingBuffer&         culling_buffer,
+                                       RHIDeviceSize          size,
+                                       RHIBufferUsageFlags    usage,
+                                       RHIMemoryPropertyFlags properties)
+    {
+        // grow geometrically so a slowly growing scene does not recreate the buffers every frame
+        RHIDeviceSize new_size = std::max(size, culling_buffer.size * 2);
+        m_rhi->createBuffer(new_size, usage, properties, culling_buffer.buffer, culling_buffer.memory);
+        culling_buffer.size = new_size;
+
+        if (properties & RHI_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        {
+            m_rhi->mapMemory(culling_buffer.memory, 0, RHI_WHOLE_SIZE, 0, &culling_buffer.mapped);
+        }
+    }
+
+    void MeshCullingPass::destroyBuffer(CullingBuffer& culling_buffer)
+    {
+        if (culling_buffer.buffer == nullptr)
+        {
+            return;
+        }
+
+        if (culling_buffer.mapped != nullptr)
+        {
+            m_rhi->unmapMemory(culling_buffer.memory);
+            culling_buffer.mapped = nullptr;
+        }
+        m_rhi->destroyBuffer(culling_buffer.buffer);
+        m_rhi->freeMemory(culling_buffer.memory);
+        culling_buffer.buffer = nullptr;
+        culling_buffer.memory = nullptr;
+    }
+
+    void MeshCullingPass::releaseRetiredBuffers()
+    {
+        for (auto it = m_retired_buffers.begin(); it != m_retired_buffers.end();)
+        {
+            if (it->remaining_frames > 0)
+            {
+                --it->remaining_frames;
+                ++it;
+                continue;
+            }
+            destroyBuffer(it->buffer);
+            it = m_retired_buffers.erase(it);
+        }
+    }
+
+    void MeshCullingPass::updateInstances(const RenderScene& render_scene, RenderResource& render_resource)
+    {
+        if (!m_is_initialized)
+        {
+            return;
+        }
+
+        for (uint32_t instance_id : render_scene.getDirtyInstanceIds())
+        {
+            const uint32_t slot_index = GuidAllocator<GameObjectPartId>::getGuidIndex(instance_id);
+            if (slot_index >= m_instance_slots.size())
+            {
+                // new slots hold garbage on the gpu until they are written as free slots
+                const uint32_t old_slot_count = static_cast<uint32_t>(m_instance_slots.size());
+                m_instance_slots.resize(slot_index + 1);
+                for (uint32_t new_slot_index = old_slot_count; new_slot_index <= slot_index; ++new_slot_index)
+                {
+                    m_instance_slots[new_slot_index].instance.batch_index = s_mesh_culling_free_slot_batch_index;
+                    markSlotDirty(new_slot_index);
+                }
+            }
+            InstanceSlot& slot = m_instance_slots[slot_index];
+
+            BoundingBox         bounding_box;
+            const RenderEntity* entity = render_scene.findRenderEntity(instance_id, bounding_box);
+            if (entity == nullptr)
+            {
+                // a recycled id may already have given the slot to a new part in the same frame
+                if (slot.is_used && slot.instance_id == instance_id)
+                {
+                    slot.is_used = false;
+                    slot.joint_matrices.clear();
+                    slot.instance.batch_index = s_mesh_culling_free_slot_batch_index;
+                    --m_used_slot_count;
+                    m_is_batches_dirty = true;
+                    markSlotDirty(slot_index);
+                }
+                continue;
+            }
+
+            // only vertex blended entities carry joint matrices, like the cpu mesh nodes
+            const size_t joint_count =
+                entity->m_enable_vertex_blending ? entity->m_joint_matrices.size() : static_cast<size_t>(0);
+            if (!slot.is_used || slot.mesh_asset_id != entity->m_mesh_asset_id ||
+                slot.material_asset_id != entity->m_material_asset_id || slot.joint_matrices.size() != joint_count)
+            {
+                m_is_batches_dirty = true;
+            }
+            if (!slot.is_used)
+            {
+                ++m_used_slot_count;
+            }
+
+            const VulkanMesh& mesh = render_resource.getEntityMesh(*entity);
+            slot.mesh              = &mesh;
+            slot.mesh_asset_id     = entity->m_mesh_asset_id;
+            slot.material_asset_id = entity->m_material_asset_id;
+            slot.instance_id       = instance_id;
+            slot.is_used           = true;
+            slot.joint_matrices.assign(entity->m_joint_matrices.begin(), entity->m_joint_matrices.begin() + joint_count);
+
+            slot.instance.model_matrix               = entity->m_model_matrix;
+            slot.instance.bounding_box_min           = Vector4(bounding_box.min_bound, 1.0f);
+            slot.instance.bounding_box_max           = Vector4(bounding_box.max_bound, 1.0f);
+            slot.instance.joint_binding_index_offset = getJointBindingIndexOffset(mesh);
+            slot.instance.enable_vertex_blending     = joint_count > 0 ? 1.0f : -1.0f;
+            markSlotDirty(slot_index);
+        }
+
+        if (m_is_batches_dirty)
+        {
+            rebuildBatches();
+            m_is_batches_dirty = false;
+        }
+
+        // materials stream in after their entities, the placeholder is drawn until the upload finished
+        RenderEntity material_entity;
+        for (MaterialRange& material_range : m_material_ranges)
+        {
+            material_entity.m_material_asset_id = material_range.material_asset_id;
+            material_range.material             = &render_resource.getEntityMaterial(material_entity);
+        }
+    }
+
+    void MeshCullingPass::markSlotDirty(uint32_t slot_index)
+    {
+        InstanceSlot& slot = m_instance_slots[slot_index];
+        if (!slot.is_dirty)
+        {
+            slot.is_dirty = true;
+            m_dirty_slots.push_back(slot_index);
+        }
+    }
+
+    void MeshCullingPass::rebuildBatches()
+    {
+        m_sorted_slots.clear();
+        for (uint32_t slot_index = 0; slot_index < m_instance_slots.size(); ++slot_index)
+        {
+            if (m_instance_slots[slot_index].is_used)
+            {
+                m_sorted_slots.push_back(slot_index);
+            }
+        }
+        std::sort(m_sorted_slots.begin(), m_sorted_slots.end(), [this](uint32_t lhs, uint32_t rhs) {
+            const InstanceSlot& lhs_slot = m_instance_slots[lhs];
+            const InstanceSlot& rhs_slot = m_instance_slots[rhs];
+            if (lhs_slot.material_asset_id != rhs_slot.material_asset_id)
+                return lhs_slot.material_asset_id < rhs_slot.material_asset_id;
+            if (lhs_slot.mesh_asset_id != rhs_slot.mesh_asset_id)
+                return lhs_slot.mesh_asset_id < rhs_slot.mesh_asset_id;
+            return lhs < rhs;
+        });
+
+        // one batch per (material, mesh) run, the batches of a material are contiguous; only the slots whose
+        // batch or joint range moved are uploaded again
+        m_batches.clear();
+        m_material_ranges.clear();
+        for (uint32_t sorted_index = 0; sorted_index < m_sorted_slots.size(); ++sorted_index)
+        {
+            const uint32_t slot_index = m_sorted_slots[sorted_index];
+            InstanceSlot&  slot       = m_instance_slots[slot_index];
+
+            const bool is_new_material =
+                m_material_ranges.empty() || m_material_ranges.back().material_asset_id != slot.material_asset_id;
+            if (is_new_material)
+            {
+                MaterialRange material_range;
+                material_range.material_asset_id = slot.material_asset_id;
+                material_range.first_batch       = static_cast<uint32_t>(m_batches.size());
+                m_material_ranges.push_back(material_range);
+            }
+
+            if (is_new_material || m_instance_slots[m_sorted_slots[sorted_index - 1]].mesh_asset_id != slot.mesh_asset_id)
+            {
+                MeshCullingBatch batch {};
+                batch.index_count    = slot.mesh->mesh_index_count;
+                batch.first_index    = slot.mesh->mesh_first_index;
+                batch.vertex_offset  = static_cast<int32_t>(slot.mesh->mesh_vertex_offset);
+                batch.first_instance = sorted_index;
+                batch.instance_count = 0;
+                batch.material_index = static_cast<uint32_t>(m_material_ranges.size() - 1);
+                batch.first_command  = m_material_ranges.back().first_batch;
+                m_batches.push_back(batch);
+                ++m_material_ranges.back().batch_count;
+            }
+
+            const uint32_t batch_index = static_cast<uint32_t>(m_batches.size() - 1);
+            if (slot.instance.batch_index != batch_index)
+            {
+                slot.instance.batch_index = batch_index;
+                markSlotDirty(slot_index);
+            }
+        }
+
+        m_joint_matrix_count = 0;
+        for (uint32_t slot_index = 0; slot_index < m_instance_slots.size(); ++slot_index)
+        {
+            InstanceSlot& slot = m_instance_slots[slot_index];
+            if (!slot.is_used || slot.joint_matrices.empty())
+            {
+                continue;
+            }
+
+            if (slot.instance.joint_matrix_offset != m_joint_matrix_count)
+            {
+                slot.instance.joint_matrix_offset = m_joint_matrix_count;
+                markSlotDirty(slot_index);
+            }
+            m_joint_matrix_count += static_cast<uint32_t>(slot.joint_matrices.size());
+        }
+    }
+
+    void MeshCullingPass::uploadDirtySlots(FrameResource& frame_resource, RHICommandBuffer* command_buffer)
+    {
+        // a recreated buffer starts empty, every slot is written again
+        bool is_buffer_recreated = false;
+        is_buffer_recreated |=
+            reservePersistentBuffer(m_instances, m_instance_slots.size() * sizeof(MeshCullingInstance));
+        is_buffer_recreated |=
+            reservePersistentBuffer(m_joint_matrices, std::max(m_joint_matrix_count, 1u) * sizeof(Matrix4x4));
+        if (is_buffer_recreated)
+        {
+            for (uint32_t slot_index = 0; slot_index < m_instance_slots.size(); ++slot_index)
+            {
+                markSlotDirty(slot_index);
+            }
+        }
+
+        if (m_dirty_slots.empty())
+        {
+            return;
+        }
+
+        // slots in order, so neighbouring slots and their joint ranges are copied as one region
+        std::sort(m_dirty_slots.begin(), m_dirty_slots.end());
+
+        RHIDeviceSize instance_upload_size     = m_dirty_slots.size() * sizeof(MeshCullingInstance);
+        RHIDeviceSize joint_matrix_upload_size = 0;
+        for (uint32_t slot_index : m_dirty_slots)
+        {
+            joint_matrix_upload_size += m_instance_slots[slot_index].joint_matrices.size() * sizeof(Matrix4x4);
+        }
+        reserveBuffer(frame_resource.upload,
+                      instance_upload_size + joint_matrix_upload_size,
+                      RHI_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                      RHI_MEMORY_PROPERTY_HOST_VISIBLE_BIT | RHI_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        uint8_t*      upload_data          = static_cast<uint8_t*>(frame_resource.upload.mapped);
+        RHIDeviceSize instance_offset      = 0;
+        RHIDeviceSize joint_matrix_offset  = instance_upload_size;
+        m_instance_copy_regions.clear();
+        m_joint_matrix_copy_regions.clear();
+        for (uint32_t slot_index : m_dirty_slots)
+        {
+            InstanceSlot& slot = m_instance_slots[slot_index];
+            slot.is_dirty      = false;
+
+            memcpy(upload_data + instance_offset, &slot.instance, sizeof(MeshCullingInstance));
+            const RHIDeviceSize instance_dst_offset = slot_index * sizeof(MeshCullingInstance);
+            if (!m_instance_copy_regions.empty() &&
+                m_instance_copy_regions.back().dstOffset + m_instance_copy_regions.back().size == instance_dst_offset)
+            {
+                m_instance_copy_regions.back().size += sizeof(MeshCullingInstance);
+            }
+            else
+            {
+                m_instance_copy_regions.push_back({instance_offset, instance_dst_offset, sizeof(MeshCullingInstance)});
+            }
+            instance_offset += sizeof(MeshCullingInstance);
+
+            if (slot.joint_matrices.empty())
+            {
+                continue;
+            }
+
+            const RHIDeviceSize joint_matrix_size       = slot.joint_matrices.size() * sizeof(Matrix4x4);
+            const RHIDeviceSize joint_matrix_dst_offset = slot.instance.joint_matrix_offset * sizeof(Matrix4x4);
+            memcpy(upload_data + joint_matrix_offset, slot.joint_matrices.data(), joint_matrix_size);
+            if (!m_joint_matrix_copy_regions.empty() &&
+                m_joint_matrix_copy_regions.back().dstOffset + m_joint_matrix_copy_regions.back().size ==
+                    joint_matrix_dst_offset)
+            {
+                m_joint_matrix_copy_regions.back().size += joint_matrix_size;
+            }
+            else
+            {
+                m_joint_matrix_copy_regions.push_back({joint_matrix_offset, joint_matrix_dst_offset, joint_matrix_size});
+            }
+            joint_matrix_offset += joint_matrix_size;
+        }
+        m_dirty_slots.clear();
+
+        // the previous frames may still read the slots that are overwritten
+        RHIMemoryBarrier memory_barrier {};
+        memory_barrier.sType         = RHI_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memory_barrier.srcAccessMask = RHI_ACCESS_SHADER_READ_BIT;
+        memory_barrier.dstAccessMask = RHI_ACCESS_TRANSFER_WRITE_BIT;
+        m_rhi->cmdPipelineBarrier(command_buffer,
+                                  RHI_PIPELINE_STAGE_COMPUTE_SHADER_BIT | RHI_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                                  RHI_PIPELINE_STAGE_TRANSFER_BIT,
+                                  0,
+                                  1,
+                                  &memory_barrier,
+                                  0,
+                                  nullptr,
+                                  0,
+                                  nullptr);
+
+        m_rhi->cmdCopyBuffer(command_buffer,
+                             frame_resource.upload.buffer,
+                             m_instances.buffer,
+                             static_cast<uint32_t>(m_instance_copy_regions.size()),
+                             m_instance_copy_regions.data());
+        if (!m_joint_matrix_copy_regions.empty())
+        {
+            m_rhi->cmdCopyBuffer(command_buffer,
+                                 frame_resource.upload.buffer,
+                                 m_joint_matrices.buffer,
+                                 static_cast<uint32_t>(m_joint_matrix_copy_regions.size()),
+                                 m_joint_matrix_copy_regions.data());
+        }
+
+        // read by the culling shader and the indirect mesh vertex shader
+        memory_barrier.srcAccessMask = RHI_ACCESS_TRANSFER_WRITE_BIT;
+        memory_barrier.dstAccessMask = RHI_ACCESS_SHADER_READ_BIT;
+        m_rhi->cmdPipelineBarrier(command_buffer,
+                                  RHI_PIPELINE_STAGE_TRANSFER_BIT,
+                                  RHI_PIPELINE_STAGE_COMPUTE_SHADER_BIT | RHI_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                                  0,
+                                  1,
+                                  &memory_barrier,
+                                  0,
+                                  nullptr,
+                                  0,
+                                  nullptr);
+    }
+
+    void MeshCullingPass::draw()
+    {
+        if (!m_is_initialized)
+        {
+            return;
+        }
+        releaseRetiredBuffers();
+        if (!isActive())
+        {
+            return;
+        }
+
+        FrameResource&    frame_resource = m_frame_resources[m_rhi->getCurrentFrameIndex()];
+        RHICommandBuffer* command_buffer = m_rhi->getCurrentCommandBuffer();
+
+        float color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        m_rhi->pushEvent(command_buffer, "Mesh Culling", color);
+
+        uploadDirtySlots(frame_resource, command_buffer);
+
+        const uint32_t slot_count     = static_cast<uint32_t>(m_instance_slots.size());
+        const uint32_t material_count = static_cast<uint32_t>(m_material_ranges.size());
+        const uint32_t batch_count    = static_cast<uint32_t>(m_batches.size());
+        if (batch_count == 0)
+        {
+            m_rhi->popEvent(command_buffer);
+            return;
+        }
+
+        RHIMemoryPropertyFlags host_properties =
+            RHI_MEMORY_PROPERTY_HOST_VISIBLE_BIT | RHI_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+        bool is_buffer_recreated = false;
+        is_buffer_recreated |= reserveBuffer(frame_resource.batches,
+                                             batch_count * sizeof(MeshCullingBatch),
+                                             RHI_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                             host_properties);
+        is_buffer_recreated |= reserveBuffer(frame_resource.draw_counts,
+                                             material_count * sizeof(uint32_t),
+                                             RHI_BUFFER_USAGE_STORAGE_BUFFER_BIT | RHI_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                             host_properties);
+        is_buffer_recreated |= reserveBuffer(frame_resource.visible_instances,
+                                             m_used_slot_count * sizeof(uint32_t),
+                                             RHI_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                             RHI_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        is_buffer_recreated |= reserveBuffer(frame_resource.draw_commands,
+                                             batch_count * sizeof(MeshCullingDrawCommand),
+                                             RHI_BUFFER_USAGE_STORAGE_BUFFER_BIT | RHI_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                             RHI_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (is_buffer_recreated || frame_resource.bound_instances != m_instances.buffer ||
+            frame_resource.bound_joint_matrices != m_joint_matrices.buffer)
+        {
+            updateDescriptorSet(frame_resource);
+        }
+
+        // the batches are few, copying them whole every frame also resets their visible instance counts
+        memcpy(frame_resource.batches.mapped, m_batches.data(), batch_count * sizeof(MeshCullingBatch));
+
+        m_compact_draw_commands = m_rhi->isDrawIndirectCountSupported();
+
+        MeshCullingParameters& parameters = *static_cast<MeshCullingParameters*>(frame_resource.parameters.mapped);
+        ClusterFrustum         frustum =
+            CreateClusterFrustumFromMatrix(m_proj_view_matrix, -1.0, 1.0, -1.0, 1.0, 0.0, 1.0);
+        parameters.frustum_planes[0]     = frustum.m_plane_right;
+        parameters.frustum_planes[1]     = frustum.m_plane_left;
+        parameters.frustum_planes[2]     = frustum.m_plane_top;
+        parameters.frustum_planes[3]     = frustum.m_plane_bottom;
+        parameters.frustum_planes[4]     = frustum.m_plane_near;
+        parameters.frustum_planes[5]     = frustum.m_plane_far;
+        parameters.instance_count        = slot_count;
+        parameters.batch_count           = batch_count;
+        parameters.compact_draw_commands = m_compact_draw_commands ? 1 : 0;
+
+        memset(frame_resource.draw_counts.mapped, 0, material_count * sizeof(uint32_t));
+
+        m_rhi->cmdBindPipelinePFN(
+            command_buffer, RHI_PIPELINE_BIND_POINT_COMPUTE, m_render_pipelines[_render_pipeline_type_culling].pipeline);
+        m_rhi->cmdBindDescriptorSetsPFN(command_buffer,
+                                        RHI_PIPELINE_BIND_POINT_COMPUTE,
+                                        m_render_pipelines[_render_pipeline_type_culling].layout,
+                                        0,
+                                        1,
+                                        &frame_resource.culling_descriptor_set,
+                                        0,
+                                        NULL);
+        m_rhi->cmdDispatch(
+            command_buffer, roundUp(slot_count, s_mesh_culling_group_size) / s_mesh_culling_group_size, 1, 1);
+
+        // the compaction reads the visible instance counts of the batches
+        RHIMemoryBarrier memory_barrier {};
+        memory_barrier.sType         = RHI_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memory_barrier.srcAccessMask = RHI_ACCESS_SHADER_WRITE_BIT;
+        memory_barrier.dstAccessMask = RHI_ACCESS_SHADER_READ_BIT | RHI_ACCESS_SHADER_WRITE_BIT;
+        m_rhi->cmdPipelineBarrier(command_buffer,
+                                  RHI_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                  RHI_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                  0,
+                                  1,
+                                  &memory_barrier,
+                                  0,
+                                  nullptr,
+                                  0,
+                                  nullptr);
+
+        // same pipeline layout, the descriptor set stays bound
+        m_rhi->cmdBindPipelinePFN(
+            command_buffer, RHI_PIPELINE_BIND_POINT_COMPUTE, m_render_pipelines[_render_pipeline_type_compact].pipeline);
+        m_rhi->cmdDispatch(
+            command_buffer, roundUp(batch_count, s_mesh_culling_group_size) / s_mesh_culling_group_size, 1, 1);
+
+        // the draw commands and counts are read by the indirect draws, the visible instances by the vertex shader
+        memory_barrier.srcAccessMask = RHI_ACCESS_SHADER_WRITE_BIT;
+        memory_barrier.dstAccessMask = RHI_ACCESS_INDIRECT_COMMAND_READ_BIT | RHI_ACCESS_SHADER_READ_BIT;
+        m_rhi->cmdPipelineBarrier(command_buffer,
+                                  RHI_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                  RHI_PIPELINE_STAGE_DRAW_INDIRECT_BIT | RHI_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                                  0,
+                                  1,
+                                  &memory_barrier,
+                                  0,
+                                  nullptr,
+                                  0,
+                                  nullptr);
+
+        m_rhi->popEvent(command_buffer);
+    }
+
+    void MeshCullingPass::drawIndirect(RHIPipelineLayout* pipeline_layout, uint32_t material_set_index)
+    {
+        if (m_material_ranges.empty())
+        {
+            return;
+        }
+
+        const FrameResource& frame_resource = m_frame_resources[m_rhi->getCurrentFrameIndex()];
+        RHICommandBuffer*    command_buffer = m_rhi->getCurrentCommandBuffer();
+        const uint32_t       command_stride = sizeof(MeshCullingDrawCommand);
+
+        for (uint32_t material_index = 0; material_index < m_material_ranges.size(); ++material_index)
+        {
+            const MaterialRange& material_range = m_material_ranges[material_index];
+
+            m_rhi->cmdBindDescriptorSetsPFN(command_buffer,
+                                            RHI_PIPELINE_BIND_POINT_GRAPHICS,
+                                            pipeline_layout,
+                                            material_set_index,
+                                            1,
+                                            &material_range.material->material_descriptor_set,
+                                            0,
+                                            NULL);
+
+            RHIDeviceSize command_offset = material_range.first_batch * command_stride;
+            if (m_compact_draw_commands)
+            {
+                m_rhi->cmdDrawIndexedIndirectCount(command_buffer,
+                                                   frame_resource.draw_commands.buffer,
+                                                   command_offset,
+                                                   frame_resource.draw_counts.buffer,
+                                                   material_index * sizeof(uint32_t),
+                                                   material_range.batch_count,
+                                                   command_stride);
+            }
+            else if (m_rhi->isMultiDrawIndirectSupported())
+            {
+                // culled batches keep their command with zero instances
+                m_rhi->cmdDrawIndexedIndirect(command_buffer,
+                                              frame_resource.draw_commands.buffer,
+                                              command_offset,
+                                              material_range.batch_count,
+                                              command_stride);
+            }
+            else
+            {
+                for (uint32_t i = 0; i < material_range.batch_count; ++i)
+                {
+                    m_rhi->cmdDrawIndexedIndirect(command_buffer,
+                                                  frame_resource.draw_commands.buffer,
+                                                  command_offset + i * command_stride,
+                                                  1,
+                                                  command_stride);
+                }
+            }
+        }
+    }
+
+    RHIDescriptorSetLayout* MeshCullingPass::getInstanceDescriptorSetLayout() const
+    {
+        return m_descriptor_infos[_instance].layout;
+    }
+
+    RHIDescriptorSet* MeshCullingPass::getInstanceDescriptorSet() const
+    {
+        return m_frame_resources[m_rhi->getCurrentFrameIndex()].instance_descriptor_set;
+    }
+
+    bool MeshCullingPass::isSupported() const { return m_rhi->isDrawIndirectFirstInstanceSupported(); }
+
+    bool MeshCullingPass::isActive() const { return m_is_enabled && m_is_initialized; }
+} // namespace Piccolo
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "runtime/function/render/render_pass.h"
+
+#include <vector>
+
+namespace Piccolo
+{
+    class RenderResource;
+    class RenderResourceBase;
+    class RenderScene;
+
+    /// GPU driven draws of the main camera meshes. Every render entity keeps one slot of a persistent device local
+    /// instance buffer, indexed by its instance id, and only the entities the scene changed are uploaded. The
+    /// instances are grouped in one batch per (material, mesh) pair, a compute shader frustum culls them into the
+    /// slots of their batch and writes one indirect draw command per batch. The main camera pass then records one
+    /// indirect draw per material instead of one draw per 64 instances.
+    class MeshCullingPass : public RenderPass
+    {
+    public:
+        // 0: parameters, 1: instances, 2: batches, 3: visible instances, 4: draw commands, 5: draw counts
+        // 1: instances, visible instances and joint matrices read by the indirect mesh vertex shader
+        enum LayoutType : uint8_t
+        {
+            _culling = 0,
+            _instance,
+            _layout_type_count
+        };
+
+        // the culling and the compaction share one pipeline layout
+        enum RenderPipeLineType : uint8_t
+        {
+            _render_pipeline_type_culling = 0,
+            _render_pipeline_type_compact,
+            _render_pipeline_type_count
+        };
+
+        void initialize(const RenderPassInitInfo* init_info) override final;
+
+        void preparePassData(std::shared_ptr<RenderResourceBase> render_resource) override final;
+
+        // applies the entities the scene added, changed or removed since the last call, their slots are uploaded by
+        // the next draw; the batches are only rebuilt when an instance is added or removed or changes its mesh,
+        // material or joint count
+        void updateInstances(const RenderScene& render_scene, RenderResource& render_resource);
+
+        // records the upload of the changed instances and the culling dispatches into the current command buffer,
+        // outside of any render pass
+        void draw() override final;
+
+        // records the indirect draws of the culled batches, the gpu driven mesh pipeline must be bound with the
+        // per material set at material_set_index and getInstanceDescriptorSet() bound
+        void drawIndirect(RHIPipelineLayout* pipeline_layout, uint32_t material_set_index);
+
+        RHIDescriptorSetLayout* getInstanceDescriptorSetLayout() const;
+        RHIDescriptorSet*       getInstanceDescriptorSet() const;
+
+        void setEnabled(bool enabled) { m_is_enabled = enabled; }
+        // the gpu driven draws need indirect draws with a first instance
+        bool isSupported() const;
+        // enabled and supported, the main camera mesh draws go through drawIndirect
+        bool isActive() const;
+
+    private:
+        struct CullingBuffer
+        {
+            RHIBuffer*       buffer {nullptr};
+            RHIDeviceMemory* memory {nullptr};
+            void*            mapped {nullptr}; // host visible buffers only
+            RHIDeviceSize    size {0};
+        };
+
+        struct FrameResource
+        {
+            CullingBuffer parameters;
+            CullingBuffer batches;
+            CullingBuffer visible_instances;
+            CullingBuffer draw_commands;
+            CullingBuffer draw_counts;
+            // the changed instances and their joint matrices, copied into the persistent buffers by draw
+            CullingBuffer upload;
+
+            RHIDescriptorSet* culling_descriptor_set {nullptr};
+            RHIDescriptorSet* instance_descriptor_set {nullptr};
+            // the persistent buffers the descriptor sets of this frame point to
+            RHIBuffer* bound_instances {nullptr};
+            RHIBuffer* bound_joint_matrices {nullptr};
+        };
+
+        // cpu copy of one slot of the instance buffer, the slot index is the dense index of the instance id
+        struct InstanceSlot
+        {
+            MeshCullingInstance    instance {};
+            std::vector<Matrix4x4> joint_matrices;
+            const VulkanMesh*      mesh {nullptr};
+            size_t                 mesh_asset_id {0};
+            size_t                 material_asset_id {0};
+            uint32_t               instance_id {0};
+            bool                   is_used {false};
+            bool                   is_dirty {false};
+        };
+
+        // the batches [first_batch, first_batch + batch_count) share one material
+        struct MaterialRange
+        {
+            size_t             material_asset_id {0};
+            VulkanPBRMaterial* material {nullptr};
+            uint32_t           first_batch {0};
+            uint32_t           batch_count {0};
+        };
+
+        // a replaced persistent buffer, frames in flight may still read it
+        struct RetiredBuffer
+        {
+            CullingBuffer buffer;
+            uint32_t      remaining_frames {0};
+        };
+
+        void setupDescriptorSetLayout();
+        void setupPipelines();
+        void setupDescriptorSet();
+        void updateDescriptorSet(FrameResource& frame_resource);
+
+        void markSlotDirty(uint32_t slot_index);
+        void rebuildBatches();
+        void uploadDirtySlots(FrameResource& frame_resource, RHICommandBuffer* command_buffer);
+
+        // grows a per frame buffer to at least size, returns true when the buffer was recreated
+        bool reserveBuffer(CullingBuffer&        culling_buffer,
+                           RHIDeviceSize         size,
+                           RHIBufferUsageFlags   usage,
+                           RHIMemoryPropertyFlags properties);
+        // same for the device local buffers shared by the frames, the old buffer is retired instead of destroyed
+        bool reservePersistentBuffer(CullingBuffer& culling_buffer, RHIDeviceSize size);
+        void createBuffer(CullingBuffer&         culling_buffer,
+                          RHIDeviceSize          size,
+                          RHIBufferUsageFlags    usage,
+                          RHIMemoryPropertyFlags properties);
+        void destroyBuffer(CullingBuffer& culling_buffer);
+        void releaseRetiredBuffers();
+
+        std::vector<FrameResource> m_frame_resources;
+
+        // indexed by slot, free slots stay in the buffers with an invalid batch index
+        std::vector<InstanceSlot> m_instance_slots;
+        std::vector<uint32_t>     m_dirty_slots;
+        CullingBuffer             m_instances;
+        CullingBuffer             m_joint_matrices;
+        uint32_t                  m_used_slot_count {0};
+        uint32_t                  m_joint_matrix_count {0};
+
+        // rebuilt when the instance membership changes, the material pointers are refreshed every frame
+        std::vector<MeshCullingBatch> m_batches;
+        std::vector<MaterialRange>    m_material_ranges;
+        std::vector<uint32_t>         m_sorted_slots;
+        bool                          m_is_batches_dirty {false};
+
+        std::vector<RHIBufferCopy> m_instance_copy_regions;
+        std::vector<RHIBufferCopy> m_joint_matrix_copy_regions;
+        std::vector<RetiredBuffer> m_retired_buffers;
+
+        Matrix4x4 m_proj_view_matrix {Matrix4x4::IDENTITY};
+
+        bool m_is_enabled {true};
+        bool m_is_initialized {false};
+        // the commands of a material are packed and counted on the gpu when the draw count can be read from a buffer
+        bool m_compact_draw_commands {false};
+    };
+} // namespace Piccolo
@@ -2,6 +2,7 @@
 
 #include "runtime/core/math/vector2.h"
 #include "runtime/function/render/render_pass.h"
+#include "runtime/function/render/render_queue.h"
 
 namespace Piccolo
 {
@@ -39,5 +40,7 @@ namespace Piccolo
         RHIImageView*      _object_id_image_view = nullptr;
 
         RHIDescriptorSetLayout* _per_mesh_layout = nullptr;
+
+        RenderQueue m_render_queue;
     };
 } // namespace Piccolo
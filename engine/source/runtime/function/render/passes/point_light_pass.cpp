@@ -9,7 +9,6 @@
 #include <mesh_point_light_shadow_geom.h>
 #include <mesh_point_light_shadow_vert.h>
 
-#include <map>
 #include <stdexcept>
 #include <vector>
 
@@ -469,31 +468,8 @@ namespace Sammi
     }
     void PointLightShadowPass::drawModel()
     {
-        struct MeshNode
-        {
-            const Matrix4x4* model_matrix {nullptr};
-            const Matrix4x4* joint_matrices {nullptr};
-            uint32_t         joint_count {0};
-        };
-
-        std::map<VulkanPBRMaterial*, std::map<VulkanMesh*, std::vector<MeshNode>>> point_lights_mesh_drawcall_batch;
-
-        // reorganize mesh
-        for (RenderMeshNode& node : *(m_visiable_nodes.p_point_lights_visible_mesh_nodes))
-        {
-            auto& mesh_instanced = point_lights_mesh_drawcall_batch[node.ref_material];
-            auto& mesh_nodes     = mesh_instanced[node.ref_mesh];
-
-            MeshNode temp;
-            temp.model_matrix = node.model_matrix;
-            if (node.enable_vertex_blending)
-            {
-                temp.joint_matrices = node.joint_matrices;
-                temp.joint_count    = node.joint_count;
-            }
-
-            mesh_nodes.push_back(temp);
-        }
+        // the shadow pass binds no material, a mesh batches across its materials
+        m_render_queue.build(*(m_visiable_nodes.p_point_lights_visible_mesh_nodes), false, nullptr);
 
         RHIRenderPassBeginInfo renderpass_begin_info {};
         renderpass_begin_info.sType             = RHI_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -509,27 +485,15 @@ namespace Sammi
         renderpass_begin_info.clearValueCount = (sizeof(clear_values) / sizeof(clear_values[0]));
         renderpass_begin_info.pClearValues    = clear_values;
 
-        m_rhi->cmdBeginRenderPassPFN(m_rhi->getCurrentCommandBuffer(), &renderpass_begin_info, RHI_SUBPASS_CONTENTS_INLINE);
+        // the draws are recorded into secondary command buffers, the primary only executes them
+        m_rhi->cmdBeginRenderPassPFN(
+            m_rhi->getCurrentCommandBuffer(), &renderpass_begin_info, RHI_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
 
         if (m_rhi->isPointLightShadowEnabled())
         {
-            float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
-            m_rhi->pushEvent(m_rhi->getCurrentCommandBuffer(), "Mesh", color);
-
-            m_rhi->cmdBindPipelinePFN(
-                m_rhi->getCurrentCommandBuffer(), RHI_PIPELINE_BIND_POINT_GRAPHICS, m_render_pipelines[0].pipeline);
-
             // perframe storage buffer
-            uint32_t perframe_dynamic_offset =
-                roundUp(m_global_render_resource->_storage_buffer._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                        m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-
-            m_global_render_resource->_storage_buffer._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-                perframe_dynamic_offset + sizeof(MeshPerframeStorageBufferObject);
-
-            assert(m_global_render_resource->_storage_buffer._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-                   (m_global_render_resource->_storage_buffer._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                    m_global_render_resource->_storage_buffer._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
+            uint32_t perframe_dynamic_offset = m_global_render_resource->_storage_buffer.allocateUploadRingbuffer(
+                m_rhi->getCurrentFrameIndex(), sizeof(MeshPerframeStorageBufferObject));
 
             MeshPointLightShadowPerframeStorageBufferObject& perframe_storage_buffer_object =
                     (*reinterpret_cast<MeshPointLightShadowPerframeStorageBufferObject*>(
@@ -538,165 +502,149 @@ namespace Sammi
                     perframe_dynamic_offset));
             perframe_storage_buffer_object = m_mesh_point_light_shadow_perframe_storage_buffer_object;
 
-            for (auto& pair1 : point_lights_mesh_drawcall_batch)
-            {
-                VulkanPBRMaterial& material       = (*pair1.first);
-                auto&              mesh_instanced = pair1.second;
+            // the mesh runs are split into chunks recorded in parallel into secondary command buffers
+            m_render_queue.getRuns(RenderQueue::s_mesh_key_mask, m_mesh_runs);
+            m_command_recorder->record(m_framebuffer.render_pass,
+                                       0,
+                                       m_framebuffer.framebuffer,
+                                       m_mesh_runs.size(),
+                                       k_min_command_chunk_draw_count,
+                                       [&](RHICommandBuffer* command_buffer, size_t run_begin, size_t run_end) {
+                                           drawMeshRuns(command_buffer, run_begin, run_end, perframe_dynamic_offset);
+                                       });
+        }
+
+        m_rhi->cmdEndRenderPassPFN(m_rhi->getCurrentCommandBuffer());
+    }
 
-                // TODO: render from near to far
+    void PointLightShadowPass::drawMeshRuns(RHICommandBuffer* command_buffer,
+                                            size_t            run_begin,
+                                            size_t            run_end,
+                                            uint32_t          perframe_dynamic_offset)
+    {
+        float color[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        m_rhi->pushEvent(command_buffer, "Mesh", color);
+
+        m_rhi->cmdBindPipelinePFN(command_buffer, RHI_PIPELINE_BIND_POINT_GRAPHICS, m_render_pipelines[0].pipeline);
+
+        // a secondary command buffer inherits no bindings, every chunk binds the geometry buffer
+        bindGeometryBuffer(command_buffer, m_render_pipelines[0].layout, 1);
+
+        for (size_t run_index = run_begin; run_index < run_end; ++run_index)
+        {
+            const RenderQueueRun& mesh_nodes = m_mesh_runs[run_index];
+            VulkanMesh&           mesh       = *mesh_nodes[0].ref_mesh;
 
-                for (auto& pair2 : mesh_instanced)
+            uint32_t total_instance_count = static_cast<uint32_t>(mesh_nodes.size());
+            if (total_instance_count > 0)
+            {
+                uint32_t drawcall_max_instance_count =
+                    (sizeof(MeshPointLightShadowPerdrawcallStorageBufferObject::mesh_instances) /
+                     sizeof(MeshPointLightShadowPerdrawcallStorageBufferObject::mesh_instances[0]));
+                uint32_t drawcall_count = roundUp(total_instance_count, drawcall_max_instance_count) / drawcall_max_instance_count;
+
+                for (uint32_t drawcall_index = 0; drawcall_index < drawcall_count; ++drawcall_index)
                 {
-                    VulkanMesh& mesh       = (*pair2.first);
-                    auto&       mesh_nodes = pair2.second;
+                    uint32_t current_instance_count =
+                        ((total_instance_count - drawcall_max_instance_count * drawcall_index) <
+                         drawcall_max_instance_count) ?
+                            (total_instance_count - drawcall_max_instance_count * drawcall_index) :
+                            drawcall_max_instance_count;
+
+                    // perdrawcall storage buffer
+                    uint32_t perdrawcall_dynamic_offset =
+                        m_global_render_resource->_storage_buffer.allocateUploadRingbuffer(
+                            m_rhi->getCurrentFrameIndex(),
+                            sizeof(MeshPointLightShadowPerdrawcallStorageBufferObject));
+
+                    MeshPointLightShadowPerdrawcallStorageBufferObject& perdrawcall_storage_buffer_object =
+                        (*reinterpret_cast<MeshPointLightShadowPerdrawcallStorageBufferObject*>(
+                            reinterpret_cast<uintptr_t>(m_global_render_resource->_storage_buffer
+                                                            ._global_upload_ringbuffer_memory_pointer) +
+                            perdrawcall_dynamic_offset));
+                    for (uint32_t i = 0; i < current_instance_count; ++i)
+                    {
+                        perdrawcall_storage_buffer_object.mesh_instances[i].model_matrix =
+                            *mesh_nodes[drawcall_max_instance_count * drawcall_index + i].model_matrix;
+                        perdrawcall_storage_buffer_object.mesh_instances[i].enable_vertex_blending =
+                            mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices ? 1.0 :
+                                                                                                          -1.0;
+                        perdrawcall_storage_buffer_object.mesh_instances[i].joint_binding_index_offset =
+                            getJointBindingIndexOffset(mesh);
+                    }
 
-                    uint32_t total_instance_count = static_cast<uint32_t>(mesh_nodes.size());
-                    if (total_instance_count > 0)
+                    // per drawcall vertex blending storage buffer
+                    uint32_t per_drawcall_vertex_blending_dynamic_offset;
+                    bool     least_one_enable_vertex_blending = true;
+                    for (uint32_t i = 0; i < current_instance_count; ++i)
                     {
-                        // bind per mesh
-                        m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
-                                                        RHI_PIPELINE_BIND_POINT_GRAPHICS,
-                                                        m_render_pipelines[0].layout,
-                                                        1,
-                                                        1,
-                                                        &mesh.mesh_vertex_blending_descriptor_set,
-                                                        0,
-                                                        NULL);
-
-                        RHIBuffer*     vertex_buffers[] = {mesh.mesh_vertex_position_buffer};
-                        RHIDeviceSize offsets[]        = {0};
-                        m_rhi->cmdBindVertexBuffersPFN(
-                            m_rhi->getCurrentCommandBuffer(), 0, 1, vertex_buffers, offsets);
-                        m_rhi->cmdBindIndexBufferPFN(
-                            m_rhi->getCurrentCommandBuffer(), mesh.mesh_index_buffer, 0, RHI_INDEX_TYPE_UINT16);
-
-                        uint32_t drawcall_max_instance_count =
-                            (sizeof(MeshPointLightShadowPerdrawcallStorageBufferObject::mesh_instances) /
-                             sizeof(MeshPointLightShadowPerdrawcallStorageBufferObject::mesh_instances[0]));
-                        uint32_t drawcall_count = roundUp(total_instance_count, drawcall_max_instance_count) / drawcall_max_instance_count;
-
-                        for (uint32_t drawcall_index = 0; drawcall_index < drawcall_count; ++drawcall_index)
+                        if (!mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices)
                         {
-                            uint32_t current_instance_count =
-                                ((total_instance_count - drawcall_max_instance_count * drawcall_index) <
-                                 drawcall_max_instance_count) ?
-                                    (total_instance_count - drawcall_max_instance_count * drawcall_index) :
-                                    drawcall_max_instance_count;
-
-                            // perdrawcall storage buffer
-                            uint32_t perdrawcall_dynamic_offset =
-                                roundUp(m_global_render_resource->_storage_buffer
-                                            ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                                        m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-                            m_global_render_resource->_storage_buffer
-                                ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-                                perdrawcall_dynamic_offset + sizeof(MeshPointLightShadowPerdrawcallStorageBufferObject);
-                            assert(m_global_render_resource->_storage_buffer
-                                       ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-                                   (m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                                    m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
-
-                            MeshPointLightShadowPerdrawcallStorageBufferObject& perdrawcall_storage_buffer_object =
-                                (*reinterpret_cast<MeshPointLightShadowPerdrawcallStorageBufferObject*>(
+                            least_one_enable_vertex_blending = false;
+                            break;
+                        }
+                    }
+                    if (mesh.enable_vertex_blending)
+                    {
+                        per_drawcall_vertex_blending_dynamic_offset =
+                            m_global_render_resource->_storage_buffer.allocateUploadRingbuffer(
+                                m_rhi->getCurrentFrameIndex(),
+                                sizeof(MeshPointLightShadowPerdrawcallVertexBlendingStorageBufferObject));
+
+                        MeshPointLightShadowPerdrawcallVertexBlendingStorageBufferObject&
+                            per_drawcall_vertex_blending_storage_buffer_object =
+                                (*reinterpret_cast<
+                                    MeshPointLightShadowPerdrawcallVertexBlendingStorageBufferObject*>(
                                     reinterpret_cast<uintptr_t>(m_global_render_resource->_storage_buffer
                                                                     ._global_upload_ringbuffer_memory_pointer) +
-                                    perdrawcall_dynamic_offset));
-                            for (uint32_t i = 0; i < current_instance_count; ++i)
-                            {
-                                perdrawcall_storage_buffer_object.mesh_instances[i].model_matrix =
-                                    *mesh_nodes[drawcall_max_instance_count * drawcall_index + i].model_matrix;
-                                perdrawcall_storage_buffer_object.mesh_instances[i].enable_vertex_blending =
-                                    mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices ? 1.0 :
-                                                                                                                  -1.0;
-                            }
-
-                            // per drawcall vertex blending storage buffer
-                            uint32_t per_drawcall_vertex_blending_dynamic_offset;
-                            bool     least_one_enable_vertex_blending = true;
-                            for (uint32_t i = 0; i < current_instance_count; ++i)
-                            {
-                                if (!mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices)
-                                {
-                                    least_one_enable_vertex_blending = false;
-                                    break;
-                                }
-                            }
-                            if (mesh.enable_vertex_blending)
+                                    per_drawcall_vertex_blending_dynamic_offset));
+                        for (uint32_t i = 0; i < current_instance_count; ++i)
+                        {
+                            if (mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices)
                             {
-                                per_drawcall_vertex_blending_dynamic_offset = roundUp(
-                                    m_global_render_resource->_storage_buffer
-                                        ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()],
-                                    m_global_render_resource->_storage_buffer._min_storage_buffer_offset_alignment);
-                                m_global_render_resource->_storage_buffer
-                                    ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] =
-                                    per_drawcall_vertex_blending_dynamic_offset +
-                                    sizeof(MeshPointLightShadowPerdrawcallVertexBlendingStorageBufferObject);
-                                assert(m_global_render_resource->_storage_buffer
-                                           ._global_upload_ringbuffers_end[m_rhi->getCurrentFrameIndex()] <=
-                                       (m_global_render_resource->_storage_buffer
-                                            ._global_upload_ringbuffers_begin[m_rhi->getCurrentFrameIndex()] +
-                                        m_global_render_resource->_storage_buffer
-                                            ._global_upload_ringbuffers_size[m_rhi->getCurrentFrameIndex()]));
-
-                                MeshPointLightShadowPerdrawcallVertexBlendingStorageBufferObject&
-                                    per_drawcall_vertex_blending_storage_buffer_object =
-                                        (*reinterpret_cast<
-                                            MeshPointLightShadowPerdrawcallVertexBlendingStorageBufferObject*>(
-                                            reinterpret_cast<uintptr_t>(m_global_render_resource->_storage_buffer
-                                                                            ._global_upload_ringbuffer_memory_pointer) +
-                                            per_drawcall_vertex_blending_dynamic_offset));
-                                for (uint32_t i = 0; i < current_instance_count; ++i)
+                                for (uint32_t j = 0;
+                                     j <
+                                     mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_count;
+                                     ++j)
                                 {
-                                    if (mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_matrices)
-                                    {
-                                        for (uint32_t j = 0;
-                                             j <
-                                             mesh_nodes[drawcall_max_instance_count * drawcall_index + i].joint_count;
-                                             ++j)
-                                        {
-                                            per_drawcall_vertex_blending_storage_buffer_object
-                                                .joint_matrices[s_mesh_vertex_blending_max_joint_count * i + j] =
-                                                mesh_nodes[drawcall_max_instance_count * drawcall_index + i]
-                                                    .joint_matrices[j];
-                                        }
-                                    }
+                                    per_drawcall_vertex_blending_storage_buffer_object
+                                        .joint_matrices[s_mesh_vertex_blending_max_joint_count * i + j] =
+                                        mesh_nodes[drawcall_max_instance_count * drawcall_index + i]
+                                            .joint_matrices[j];
                                 }
                             }
-                            else
-                            {
-                                per_drawcall_vertex_blending_dynamic_offset = 0;
-                            }
-
-                            // bind perdrawcall
-                            uint32_t dynamic_offsets[3] = {perframe_dynamic_offset,
-                                                           perdrawcall_dynamic_offset,
-                                                           per_drawcall_vertex_blending_dynamic_offset};
-                            m_rhi->cmdBindDescriptorSetsPFN(m_rhi->getCurrentCommandBuffer(),
-                                                            RHI_PIPELINE_BIND_POINT_GRAPHICS,
-                                                            m_render_pipelines[0].layout,
-                                                            0,
-                                                            1,
-                                                            &m_descriptor_infos[0].descriptor_set,
-                                                            (sizeof(dynamic_offsets) / sizeof(dynamic_offsets[0])),
-                                                            dynamic_offsets);
-
-                            m_rhi->cmdDrawIndexedPFN(m_rhi->getCurrentCommandBuffer(),
-                                                     mesh.mesh_index_count,
-                                                     current_instance_count,
-                                                     0,
-                                                     0,
-                                                     0);
                         }
                     }
+                    else
+                    {
+                        per_drawcall_vertex_blending_dynamic_offset = 0;
+                    }
+
+                    // bind perdrawcall
+                    uint32_t dynamic_offsets[3] = {perframe_dynamic_offset,
+                                                   perdrawcall_dynamic_offset,
+                                                   per_drawcall_vertex_blending_dynamic_offset};
+                    m_rhi->cmdBindDescriptorSetsPFN(command_buffer,
+                                                    RHI_PIPELINE_BIND_POINT_GRAPHICS,
+                                                    m_render_pipelines[0].layout,
+                                                    0,
+                                                    1,
+                                                    &m_descriptor_infos[0].descriptor_set,
+                                                    (sizeof(dynamic_offsets) / sizeof(dynamic_offsets[0])),
+                                                    dynamic_offsets);
+
+                    m_rhi->cmdDrawIndexedPFN(command_buffer,
+                                             mesh.mesh_index_count,
+                                             current_instance_count,
+                                             mesh.mesh_first_index,
+                                             static_cast<int32_t>(mesh.mesh_vertex_offset),
+                                             0);
                 }
             }
 
-            m_rhi->popEvent(m_rhi->getCurrentCommandBuffer());
         }
 
-        m_rhi->cmdEndRenderPassPFN(m_rhi->getCurrentCommandBuffer());
+        m_rhi->popEvent(command_buffer);
     }
 
 } // namespace Piccolo
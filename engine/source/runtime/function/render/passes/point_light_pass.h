@@ -1,6 +1,8 @@
 ﻿#pragma once
 
+#include "runtime/function/render/render_command_recorder.h"
 #include "runtime/function/render/render_pass.h"
+#include "runtime/function/render/render_queue.h"
 
 namespace Sammi
 {
@@ -36,6 +38,11 @@ namespace Sammi
         void setupPipelines();
         void setupDescriptorSet();
         void drawModel();
+        // 录制m_mesh_runs中[run_begin, run_end)的网格批次，不相交的分块会在多个线程中同时调用
+        void drawMeshRuns(RHICommandBuffer* command_buffer,
+                          size_t            run_begin,
+                          size_t            run_end,
+                          uint32_t          perframe_dynamic_offset);
 
     private:
         // 每个网格的描述符集布局指针，用于绑定模型级资源
@@ -44,5 +51,10 @@ namespace Sammi
         // 点光源阴影每帧存储缓冲区对象（SSBO）
         // 存储每帧动态变化的点光源相关数据（如光源位置、投影矩阵、视锥体参数等）
         MeshPointLightShadowPerframeStorageBufferObject m_mesh_point_light_shadow_perframe_storage_buffer_object;
+
+        // 可见网格节点按网格排序后的绘制顺序，跨帧复用存储
+        RenderQueue                 m_render_queue;
+        // 按网格划分的批次，作为并行录制的分块单位
+        std::vector<RenderQueueRun> m_mesh_runs;
     };
 }
@@ -0,0 +1,172 @@
+#include "runtime/function/render/render_asset_streamer.h"
+
+#include "runtime/function/render/render_resource_base.h"
+
+#include <unordered_map>
+#include <utility>
+
+namespace Sammi
+{
+    namespace
+    {
+        size_t getBufferSize(const std::shared_ptr<BufferData>& buffer) { return buffer ? buffer->m_size : 0; }
+
+        size_t getMeshUploadSize(const RenderMeshData& mesh_data)
+        {
+            return getBufferSize(mesh_data.m_static_mesh_data.m_vertex_buffer) +
+                   getBufferSize(mesh_data.m_static_mesh_data.m_index_buffer) +
+                   getBufferSize(mesh_data.m_skeleton_binding_buffer);
+        }
+
+        // loadTexture always decodes to 4 channels of 8 bits
+        size_t getTextureUploadSize(const std::shared_ptr<TextureData>& texture)
+        {
+            return texture ? static_cast<size_t>(texture->m_width) * texture->m_height * 4 : 0;
+        }
+
+        size_t getMaterialUploadSize(const RenderMaterialData& material_data)
+        {
+            return getTextureUploadSize(material_data.m_base_color_texture) +
+                   getTextureUploadSize(material_data.m_metallic_roughness_texture) +
+                   getTextureUploadSize(material_data.m_normal_texture) +
+                   getTextureUploadSize(material_data.m_occlusion_texture) +
+                   getTextureUploadSize(material_data.m_emissive_texture);
+        }
+    } // namespace
+
+    RenderAssetStreamer::RenderAssetStreamer(std::shared_ptr<RenderResourceBase> render_resource, size_t worker_count) :
+        m_render_resource(std::move(render_resource)), m_worker_pool(worker_count)
+    {}
+
+    RenderAssetStreamer::~RenderAssetStreamer()
+    {
+        // queued requests return without loading, the pool destructor then drains and joins
+        m_is_stopping = true;
+    }
+
+    void RenderAssetStreamer::requestMesh(const MeshSourceDesc& source, size_t mesh_asset_id)
+    {
+        if (!m_pending_mesh_asset_ids.insert(mesh_asset_id).second)
+            return;
+
+        m_worker_pool.submit([this, source, mesh_asset_id]() {
+            if (m_is_stopping)
+                return;
+
+            LoadedMesh loaded_mesh;
+            loaded_mesh.m_asset_id  = mesh_asset_id;
+            loaded_mesh.m_mesh_data = m_render_resource->loadMeshData(source, loaded_mesh.m_bounding_box);
+
+            std::lock_guard<std::mutex> lock(m_completed_mutex);
+            m_completed_meshes.push_back(std::move(loaded_mesh));
+        });
+    }
+
+    void RenderAssetStreamer::requestMaterial(const MaterialSourceDesc& source, size_t material_asset_id)
+    {
+        m_pending_material_count++;
+
+        m_worker_pool.submit([this, source, material_asset_id]() {
+            if (m_is_stopping)
+                return;
+
+            LoadedMaterial loaded_material;
+            loaded_material.m_asset_id      = material_asset_id;
+            loaded_material.m_material_data = m_render_resource->loadMaterialData(source);
+
+            std::lock_guard<std::mutex> lock(m_completed_mutex);
+            m_completed_materials.push_back(std::move(loaded_material));
+        });
+    }
+
+    void RenderAssetStreamer::deferEntity(GObjectID gobject_id, const RenderEntity& entity)
+    {
+        DeferredEntity& deferred_entity = m_deferred_entities[entity.m_instance_id];
+        deferred_entity.m_gobject_id    = gobject_id;
+        deferred_entity.m_entity        = entity;
+    }
+
+    void RenderAssetStreamer::cancelDeferredEntities(GObjectID gobject_id)
+    {
+        for (auto it = m_deferred_entities.begin(); it != m_deferred_entities.end();)
+        {
+            if (it->second.m_gobject_id == gobject_id)
+            {
+                it = m_deferred_entities.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void RenderAssetStreamer::uploadCompletedAssets(std::shared_ptr<RHI> rhi, std::vector<RenderEntity>& out_ready_entities)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_completed_mutex);
+            for (LoadedMesh& loaded_mesh : m_completed_meshes)
+            {
+                m_meshes_to_upload.push_back(std::move(loaded_mesh));
+            }
+            for (LoadedMaterial& loaded_material : m_completed_materials)
+            {
+                m_materials_to_upload.push_back(std::move(loaded_material));
+            }
+            m_completed_meshes.clear();
+            m_completed_materials.clear();
+        }
+
+        size_t uploaded_size  = 0;
+        size_t uploaded_count = 0;
+        auto   has_budget     = [&]() { return uploaded_count == 0 || uploaded_size < m_upload_budget; };
+
+        std::unordered_map<size_t, AxisAlignedBox> uploaded_mesh_bounding_boxes;
+        while (!m_meshes_to_upload.empty() && has_budget())
+        {
+            LoadedMesh& loaded_mesh = m_meshes_to_upload.front();
+
+            RenderEntity mesh_entity;
+            mesh_entity.m_mesh_asset_id = loaded_mesh.m_asset_id;
+            m_render_resource->uploadGameObjectRenderResource(rhi, mesh_entity, loaded_mesh.m_mesh_data);
+
+            uploaded_size += getMeshUploadSize(loaded_mesh.m_mesh_data);
+            uploaded_count++;
+            uploaded_mesh_bounding_boxes[loaded_mesh.m_asset_id] = loaded_mesh.m_bounding_box;
+            m_pending_mesh_asset_ids.erase(loaded_mesh.m_asset_id);
+            m_meshes_to_upload.pop_front();
+        }
+
+        while (!m_materials_to_upload.empty() && has_budget())
+        {
+            LoadedMaterial& loaded_material = m_materials_to_upload.front();
+
+            RenderEntity material_entity;
+            material_entity.m_material_asset_id = loaded_material.m_asset_id;
+            m_render_resource->uploadGameObjectRenderResource(rhi, material_entity, loaded_material.m_material_data);
+
+            uploaded_size += getMaterialUploadSize(loaded_material.m_material_data);
+            uploaded_count++;
+            m_pending_material_count--;
+            m_materials_to_upload.pop_front();
+        }
+
+        if (uploaded_mesh_bounding_boxes.empty())
+            return;
+
+        for (auto it = m_deferred_entities.begin(); it != m_deferred_entities.end();)
+        {
+            auto find_it = uploaded_mesh_bounding_boxes.find(it->second.m_entity.m_mesh_asset_id);
+            if (find_it != uploaded_mesh_bounding_boxes.end())
+            {
+                it->second.m_entity.m_bounding_box = find_it->second;
+                out_ready_entities.push_back(std::move(it->second.m_entity));
+                it = m_deferred_entities.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+} // namespace Sammi
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "runtime/core/base/thread_pool.h"
+#include "runtime/function/framework/object/object_id_allocator.h"
+#include "runtime/function/render/render_entity.h"
+#include "runtime/function/render/render_type.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Sammi
+{
+    class RHI;
+    class RenderResourceBase;
+
+    constexpr size_t k_asset_streaming_worker_count {2};
+    constexpr size_t k_default_asset_upload_budget {16 * 1024 * 1024};
+
+    /// Loads meshes and materials off the render thread and uploads them under a per-frame byte budget.
+    /// Decoding runs on a dedicated pool, the shared engine pool is left to the per-frame parallelFor work
+    /// which would otherwise queue behind long image decodes.
+    /// A material is drawn with the placeholder material until it is uploaded; an entity whose mesh is still
+    /// loading waits here and enters the scene once its mesh and bounding box are available.
+    class RenderAssetStreamer
+    {
+    public:
+        explicit RenderAssetStreamer(std::shared_ptr<RenderResourceBase> render_resource,
+                                     size_t                              worker_count = k_asset_streaming_worker_count);
+        ~RenderAssetStreamer();
+
+        RenderAssetStreamer(const RenderAssetStreamer&)            = delete;
+        RenderAssetStreamer& operator=(const RenderAssetStreamer&) = delete;
+
+        // request once per asset, the asset ids come from the render scene allocators
+        void requestMesh(const MeshSourceDesc& source, size_t mesh_asset_id);
+        void requestMaterial(const MaterialSourceDesc& source, size_t material_asset_id);
+
+        bool isMeshPending(size_t mesh_asset_id) const { return m_pending_mesh_asset_ids.count(mesh_asset_id) != 0; }
+        size_t getPendingRequestCount() const { return m_pending_mesh_asset_ids.size() + m_pending_material_count; }
+
+        // keep the entity until its mesh is uploaded, a later state of the same instance replaces it
+        void deferEntity(GObjectID gobject_id, const RenderEntity& entity);
+        // drop the waiting state of an instance that was updated with a resident mesh in the meantime
+        void cancelDeferredEntity(uint32_t instance_id) { m_deferred_entities.erase(instance_id); }
+        void cancelDeferredEntities(GObjectID gobject_id);
+        void clearDeferredEntities() { m_deferred_entities.clear(); }
+
+        // uploads decoded assets until the budget is spent, meshes first since entities wait for them; at least one
+        // asset per call so an asset larger than the budget still makes progress. Appends the entities that can
+        // enter the scene now
+        void uploadCompletedAssets(std::shared_ptr<RHI> rhi, std::vector<RenderEntity>& out_ready_entities);
+
+        void   setUploadBudget(size_t bytes_per_frame) { m_upload_budget = bytes_per_frame; }
+        size_t getUploadBudget() const { return m_upload_budget; }
+
+    private:
+        struct LoadedMesh
+        {
+            size_t         m_asset_id {0};
+            RenderMeshData m_mesh_data;
+            AxisAlignedBox m_bounding_box;
+        };
+
+        struct LoadedMaterial
+        {
+            size_t             m_asset_id {0};
+            RenderMaterialData m_material_data;
+        };
+
+        struct DeferredEntity
+        {
+            GObjectID    m_gobject_id;
+            RenderEntity m_entity;
+        };
+
+        std::shared_ptr<RenderResourceBase> m_render_resource;
+
+        // written by the workers
+        std::mutex                 m_completed_mutex;
+        std::deque<LoadedMesh>     m_completed_meshes;
+        std::deque<LoadedMaterial> m_completed_materials;
+
+        // render thread only
+        std::deque<LoadedMesh>                       m_meshes_to_upload;
+        std::deque<LoadedMaterial>                   m_materials_to_upload;
+        std::unordered_set<size_t>                   m_pending_mesh_asset_ids;
+        size_t                                       m_pending_material_count {0};
+        std::unordered_map<uint32_t, DeferredEntity> m_deferred_entities;
+        size_t                                       m_upload_budget {k_default_asset_upload_budget};
+
+        std::atomic<bool> m_is_stopping {false};
+        // declared last so it is joined first, while the queues above are still alive
+        ThreadPool m_worker_pool;
+    };
+} // namespace Sammi
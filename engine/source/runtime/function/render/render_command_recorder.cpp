@@ -0,0 +1,127 @@
+#include "runtime/function/render/render_command_recorder.h"
+
+#include "runtime/core/base/thread_pool.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Sammi
+{
+    RenderCommandRecorder::RenderCommandRecorder(std::shared_ptr<RHI> rhi, ThreadPool* thread_pool) :
+        m_rhi(rhi), m_thread_pool(thread_pool)
+    {
+        m_context_count = (m_thread_pool ? m_thread_pool->getThreadCount() : 0) + 1;
+
+        RHICommandPoolCreateInfo command_pool_create_info {};
+        command_pool_create_info.sType            = RHI_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        command_pool_create_info.pNext            = NULL;
+        command_pool_create_info.flags            = RHI_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        command_pool_create_info.queueFamilyIndex = m_rhi->getQueueFamilyIndices().graphics_family.value();
+
+        m_contexts.resize(m_rhi->getMaxFramesInFlight());
+        for (std::vector<RecordingContext>& frame_contexts : m_contexts)
+        {
+            frame_contexts.resize(m_context_count);
+            for (RecordingContext& context : frame_contexts)
+            {
+                if (!m_rhi->createCommandPool(&command_pool_create_info, context.command_pool))
+                {
+                    throw std::runtime_error("create recording command pool");
+                }
+            }
+        }
+    }
+
+    void RenderCommandRecorder::beginFrame()
+    {
+        for (RecordingContext& context : m_contexts[m_rhi->getCurrentFrameIndex()])
+        {
+            if (context.used_command_buffer_count == 0)
+                continue;
+
+            m_rhi->resetCommandPoolPFN(context.command_pool, 0);
+            context.used_command_buffer_count = 0;
+        }
+    }
+
+    RHICommandBuffer* RenderCommandRecorder::acquireCommandBuffer(RecordingContext& context)
+    {
+        if (context.used_command_buffer_count == context.command_buffers.size())
+        {
+            RHICommandBufferAllocateInfo command_buffer_allocate_info {};
+            command_buffer_allocate_info.sType              = RHI_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            command_buffer_allocate_info.commandPool        = context.command_pool;
+            command_buffer_allocate_info.level              = RHI_COMMAND_BUFFER_LEVEL_SECONDARY;
+            command_buffer_allocate_info.commandBufferCount = 1;
+
+            RHICommandBuffer* command_buffer = nullptr;
+            if (!m_rhi->allocateCommandBuffers(&command_buffer_allocate_info, command_buffer))
+            {
+                throw std::runtime_error("allocate secondary command buffer");
+            }
+            context.command_buffers.push_back(command_buffer);
+        }
+        return context.command_buffers[context.used_command_buffer_count++];
+    }
+
+    void RenderCommandRecorder::record(RHIRenderPass*             render_pass,
+                                       uint32_t                   subpass,
+                                       RHIFramebuffer*            framebuffer,
+                                       size_t                     item_count,
+                                       size_t                     min_chunk_size,
+                                       const RecordChunkFunction& record_chunk)
+    {
+        if (item_count == 0)
+            return;
+
+        min_chunk_size          = std::max<size_t>(min_chunk_size, 1);
+        size_t chunk_count      = std::min(m_context_count, (item_count + min_chunk_size - 1) / min_chunk_size);
+        const size_t chunk_size = (item_count + chunk_count - 1) / chunk_count;
+        chunk_count             = (item_count + chunk_size - 1) / chunk_size;
+
+        std::vector<RecordingContext>& frame_contexts = m_contexts[m_rhi->getCurrentFrameIndex()];
+
+        // acquired on this thread, the workers only record into their own buffer
+        m_chunk_command_buffers.resize(chunk_count);
+        for (size_t chunk = 0; chunk < chunk_count; ++chunk)
+        {
+            m_chunk_command_buffers[chunk] = acquireCommandBuffer(frame_contexts[chunk]);
+        }
+
+        RHICommandBufferInheritanceInfo inheritance_info {};
+        inheritance_info.sType       = RHI_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance_info.renderPass  = render_pass;
+        inheritance_info.subpass     = subpass;
+        inheritance_info.framebuffer = framebuffer;
+
+        RHICommandBufferBeginInfo command_buffer_begin_info {};
+        command_buffer_begin_info.sType = RHI_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        command_buffer_begin_info.flags =
+            RHI_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | RHI_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        command_buffer_begin_info.pInheritanceInfo = &inheritance_info;
+
+        auto record_chunks = [&](size_t chunk_begin, size_t chunk_end) {
+            for (size_t chunk = chunk_begin; chunk < chunk_end; ++chunk)
+            {
+                RHICommandBuffer* command_buffer = m_chunk_command_buffers[chunk];
+                m_rhi->beginCommandBufferPFN(command_buffer, &command_buffer_begin_info);
+                record_chunk(command_buffer,
+                             chunk * chunk_size,
+                             std::min(chunk * chunk_size + chunk_size, item_count));
+                m_rhi->endCommandBufferPFN(command_buffer);
+            }
+        };
+
+        if (m_thread_pool && chunk_count > 1)
+        {
+            m_thread_pool->parallelFor(chunk_count, 1, record_chunks);
+        }
+        else
+        {
+            record_chunks(0, chunk_count);
+        }
+
+        m_rhi->cmdExecuteCommands(
+            m_rhi->getCurrentCommandBuffer(), static_cast<uint32_t>(chunk_count), m_chunk_command_buffers.data());
+    }
+} // namespace Sammi
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "runtime/function/render/interface/rhi.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Sammi
+{
+    class ThreadPool;
+
+    // a chunk with fewer batches does not pay for its secondary command buffer and bindings
+    constexpr size_t k_min_command_chunk_draw_count {16};
+
+    /// Records the draws of a subpass on several threads into secondary command buffers.
+    /// The draws are split into at most one chunk per recording context (the render thread and each worker of the
+    /// pool). Every context owns one command pool per frame in flight, and a record call gives each chunk its own
+    /// context, so a pool is never used by two threads at once. The secondaries are executed in chunk order, which
+    /// keeps the draw order of inline recording.
+    class RenderCommandRecorder
+    {
+    public:
+        // record_chunk(command_buffer, begin, end) records the items [begin, end)
+        using RecordChunkFunction = std::function<void(RHICommandBuffer*, size_t, size_t)>;
+
+        RenderCommandRecorder(std::shared_ptr<RHI> rhi, ThreadPool* thread_pool);
+
+        RenderCommandRecorder(const RenderCommandRecorder&)            = delete;
+        RenderCommandRecorder& operator=(const RenderCommandRecorder&) = delete;
+
+        // resets the command pools of the current frame, the fence of the frame must have been waited on
+        void beginFrame();
+
+        // records [0, item_count) in chunks of at least min_chunk_size items and executes them from the current
+        // command buffer, whose subpass must have been begun with RHI_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+        // The chunks run concurrently and inherit no state: each one binds its pipeline, descriptor sets, buffers
+        // and dynamic state
+        void record(RHIRenderPass*             render_pass,
+                    uint32_t                   subpass,
+                    RHIFramebuffer*            framebuffer,
+                    size_t                     item_count,
+                    size_t                     min_chunk_size,
+                    const RecordChunkFunction& record_chunk);
+
+        size_t getContextCount() const { return m_context_count; }
+
+    private:
+        struct RecordingContext
+        {
+            RHICommandPool*                command_pool {nullptr};
+            std::vector<RHICommandBuffer*> command_buffers;
+            size_t                         used_command_buffer_count {0};
+        };
+
+        // a reset buffer of the context, allocated when all of them are used in this frame
+        RHICommandBuffer* acquireCommandBuffer(RecordingContext& context);
+
+        std::shared_ptr<RHI> m_rhi;
+        ThreadPool*          m_thread_pool {nullptr};
+        size_t               m_context_count {1};
+
+        // [frame index][context index]
+        std::vector<std::vector<RecordingContext>> m_contexts;
+        std::vector<RHICommandBuffer*>             m_chunk_command_buffers;
+    };
+} // namespace Sammi
@@ -3,6 +3,7 @@
 #include "runtime/core/math/matrix4.h"
 #include "runtime/core/math/vector3.h"
 #include "runtime/core/math/vector4.h"
+#include "runtime/function/render/render_geometry_allocator.h"
 #include "runtime/function/render/render_type.h"
 #include "interface/rhi.h"
 
@@ -65,7 +66,7 @@ namespace Sammi
     struct VulkanMeshInstance
     {
         float     enable_vertex_blending;
-        float     _padding_enable_vertex_blending_1;
+        int32_t   joint_binding_index_offset; // added to gl_VertexIndex to index the joint bindings
         float     _padding_enable_vertex_blending_2;
         float     _padding_enable_vertex_blending_3;
         Matrix4x4 model_matrix;
@@ -81,6 +82,50 @@ namespace Sammi
         Matrix4x4 joint_matrices[s_mesh_vertex_blending_max_joint_count * s_mesh_per_drawcall_max_instance_count];
     };
 
+    // gpu driven mesh draws, see MeshCullingPass
+    struct MeshCullingInstance
+    {
+        Matrix4x4 model_matrix;
+        Vector4   bounding_box_min; // world space, w unused
+        Vector4   bounding_box_max;
+        uint32_t  batch_index; // ~0u for a free slot
+        uint32_t  joint_matrix_offset;
+        int32_t   joint_binding_index_offset;
+        float     enable_vertex_blending;
+    };
+
+    // one batch per (material, mesh) pair, the batches of a material are contiguous
+    struct MeshCullingBatch
+    {
+        uint32_t index_count;
+        uint32_t first_index;
+        int32_t  vertex_offset;
+        uint32_t first_instance; // first slot of the batch in the visible instance buffer
+        uint32_t instance_count; // zeroed on the cpu, counted by the culling shader
+        uint32_t material_index;
+        uint32_t first_command; // first batch of the material
+        uint32_t _padding_first_command;
+    };
+
+    struct MeshCullingParameters
+    {
+        Vector4  frustum_planes[6];
+        uint32_t instance_count;
+        uint32_t batch_count;
+        uint32_t compact_draw_commands;
+        uint32_t _padding_compact_draw_commands;
+    };
+
+    // layout of VkDrawIndexedIndirectCommand
+    struct MeshCullingDrawCommand
+    {
+        uint32_t index_count;
+        uint32_t instance_count;
+        uint32_t first_index;
+        int32_t  vertex_offset;
+        uint32_t first_instance;
+    };
+
     struct MeshPerMaterialUniformBufferObject
     {
         Vector4 baseColorFactor {0.0f, 0.0f, 0.0f, 0.0f};
@@ -174,6 +219,7 @@ namespace Sammi
         Matrix4x4 model_matrices[s_mesh_per_drawcall_max_instance_count];
         uint32_t  node_ids[s_mesh_per_drawcall_max_instance_count];
         float     enable_vertex_blendings[s_mesh_per_drawcall_max_instance_count];
+        int32_t   joint_binding_index_offsets[s_mesh_per_drawcall_max_instance_count];
     };
 
     struct MeshInefficientPickPerdrawcallVertexBlendingStorageBufferObject
@@ -182,32 +228,32 @@ namespace Sammi
     };
 
     // mesh
+    // ranges of the mesh in the geometry buffer of the global render resource, the buffers are shared by all meshes
     struct VulkanMesh
     {
-        bool enable_vertex_blending;
-
-        uint32_t mesh_vertex_count;
-
-        RHIBuffer*    mesh_vertex_position_buffer;
-        VmaAllocation mesh_vertex_position_buffer_allocation;
+        bool enable_vertex_blending {false};
 
-        RHIBuffer*    mesh_vertex_varying_enable_blending_buffer;
-        VmaAllocation mesh_vertex_varying_enable_blending_buffer_allocation;
+        uint32_t mesh_vertex_count {0};
+        uint32_t mesh_vertex_offset {s_invalid_geometry_offset};
 
-        RHIBuffer*    mesh_vertex_joint_binding_buffer;
-        VmaAllocation mesh_vertex_joint_binding_buffer_allocation;
+        // s_invalid_geometry_offset without vertex blending
+        uint32_t mesh_joint_binding_offset {s_invalid_geometry_offset};
 
-        RHIDescriptorSet* mesh_vertex_blending_descriptor_set;
+        uint32_t mesh_index_count {0};
+        uint32_t mesh_first_index {s_invalid_geometry_offset};
 
-        RHIBuffer*    mesh_vertex_varying_buffer;
-        VmaAllocation mesh_vertex_varying_buffer_allocation;
-
-        uint32_t mesh_index_count;
-
-        RHIBuffer*    mesh_index_buffer;
-        VmaAllocation mesh_index_buffer_allocation;
+        // slot part of the mesh asset guid, unique among the loaded meshes, see RenderQueue
+        uint32_t sort_id {0};
     };
 
+    // gl_VertexIndex includes the vertex offset of the draw, the joint bindings live in their own buffer
+    inline int32_t getJointBindingIndexOffset(const VulkanMesh& mesh)
+    {
+        return mesh.enable_vertex_blending ?
+                   static_cast<int32_t>(mesh.mesh_joint_binding_offset) - static_cast<int32_t>(mesh.mesh_vertex_offset) :
+                   0;
+    }
+
     // material
     struct VulkanPBRMaterial
     {
@@ -235,6 +281,9 @@ namespace Sammi
         VmaAllocation   material_uniform_buffer_allocation;
 
         RHIDescriptorSet* material_descriptor_set;
+
+        // slot part of the material asset guid, unique among the loaded materials, see RenderQueue
+        uint32_t sort_id {0};
     };
 
     // nodes
@@ -247,6 +296,9 @@ namespace Sammi
         VulkanPBRMaterial* ref_material {nullptr};
         uint32_t           node_id;
         bool               enable_vertex_blending {false};
+        // world space, read by the gpu culling
+        Vector3 bounding_box_min;
+        Vector3 bounding_box_max;
     };
 
     struct RenderAxisNode
@@ -263,22 +315,27 @@ namespace Sammi
         uint32_t           base_color_image_width;
         uint32_t           base_color_image_height;
         RHIFormat base_color_image_format;
+        uint32_t           base_color_image_mip_levels;
         void*              metallic_roughness_image_pixels;
         uint32_t           metallic_roughness_image_width;
         uint32_t           metallic_roughness_image_height;
         RHIFormat metallic_roughness_image_format;
+        uint32_t           metallic_roughness_image_mip_levels;
         void*              normal_roughness_image_pixels;
         uint32_t           normal_roughness_image_width;
         uint32_t           normal_roughness_image_height;
         RHIFormat normal_roughness_image_format;
+        uint32_t           normal_roughness_image_mip_levels;
         void*              occlusion_image_pixels;
         uint32_t           occlusion_image_width;
         uint32_t           occlusion_image_height;
         RHIFormat occlusion_image_format;
+        uint32_t           occlusion_image_mip_levels;
         void*              emissive_image_pixels;
         uint32_t           emissive_image_width;
         uint32_t           emissive_image_height;
         RHIFormat emissive_image_format;
+        uint32_t           emissive_image_mip_levels;
         VulkanPBRMaterial* now_material;
     };
 }
@@ -0,0 +1,967 @@
+#include "runtime/function/render/render_culling.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define PICCOLO_CULLING_SSE
+#include <emmintrin.h>
+#endif
+
+namespace Piccolo
+{
+    namespace
+    {
+        // enlarge leaves so objects that only move a little don't restructure the tree
+        constexpr float k_bvh_leaf_margin {0.1f};
+
+        enum class CullingResult
+        {
+            outside,
+            intersecting,
+            inside
+        };
+
+        struct CullingPlane
+        {
+            float x, y, z, w;
+            float abs_x, abs_y, abs_z;
+        };
+
+        CullingPlane makeCullingPlane(const Vector4& plane)
+        {
+            return {plane.x, plane.y, plane.z, plane.w, std::fabs(plane.x), std::fabs(plane.y), std::fabs(plane.z)};
+        }
+
+        void makeCullingPlanes(const ClusterFrustum& frustum, CullingPlane (&out_planes)[6])
+        {
+            out_planes[0] = makeCullingPlane(frustum.m_plane_right);
+            out_planes[1] = makeCullingPlane(frustum.m_plane_left);
+            out_planes[2] = makeCullingPlane(frustum.m_plane_top);
+            out_planes[3] = makeCullingPlane(frustum.m_plane_bottom);
+            out_planes[4] = makeCullingPlane(frustum.m_plane_near);
+            out_planes[5] = makeCullingPlane(frustum.m_plane_far);
+        }
+
+        // same test as TiledFrustumIntersectBox, additionally tells when the box is inside every plane
+        CullingResult classifyBox(const CullingPlane (&planes)[6], const BoundingBox& box)
+        {
+            const float center_x = (box.max_bound.x + box.min_bound.x) * 0.5f;
+            const float center_y = (box.max_bound.y + box.min_bound.y) * 0.5f;
+            const float center_z = (box.max_bound.z + box.min_bound.z) * 0.5f;
+            const float extent_x = (box.max_bound.x - box.min_bound.x) * 0.5f;
+            const float extent_y = (box.max_bound.y - box.min_bound.y) * 0.5f;
+            const float extent_z = (box.max_bound.z - box.min_bound.z) * 0.5f;
+
+            CullingResult result = CullingResult::inside;
+            for (const CullingPlane& plane : planes)
+            {
+                const float signed_distance = plane.x * center_x + plane.y * center_y + plane.z * center_z + plane.w;
+                const float radius          = plane.abs_x * extent_x + plane.abs_y * extent_y + plane.abs_z * extent_z;
+                if (!(signed_distance < radius))
+                {
+                    return CullingResult::outside;
+                }
+                if (signed_distance > -radius)
+                {
+                    result = CullingResult::intersecting;
+                }
+            }
+            return result;
+        }
+
+        bool boxIntersectsSpheres(const std::vector<BoundingSphere>& spheres, const BoundingBox& box)
+        {
+            for (const BoundingSphere& sphere : spheres)
+            {
+                if (!BoxIntersectsWithSphere(box, sphere))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+#ifdef PICCOLO_CULLING_SSE
+        __m128 gatherBounds(const std::vector<float>& component, const uint32_t (&entity_indices)[4])
+        {
+            return _mm_setr_ps(component[entity_indices[0]],
+                               component[entity_indices[1]],
+                               component[entity_indices[2]],
+                               component[entity_indices[3]]);
+        }
+#endif
+
+        // exact tests of one box, or of four boxes at once where bit i of the result is set when box i is visible
+        struct FrustumLeafTest
+        {
+            const CullingPlane (&m_planes)[6];
+
+            bool testBox(const BoundingBox& box) const { return classifyBox(m_planes, box) != CullingResult::outside; }
+
+#ifdef PICCOLO_CULLING_SSE
+            int testBoxes(__m128 min_x, __m128 min_y, __m128 min_z, __m128 max_x, __m128 max_y, __m128 max_z) const
+            {
+                const __m128 half     = _mm_set1_ps(0.5f);
+                const __m128 center_x = _mm_mul_ps(_mm_add_ps(max_x, min_x), half);
+                const __m128 center_y = _mm_mul_ps(_mm_add_ps(max_y, min_y), half);
+                const __m128 center_z = _mm_mul_ps(_mm_add_ps(max_z, min_z), half);
+                const __m128 extent_x = _mm_mul_ps(_mm_sub_ps(max_x, min_x), half);
+                const __m128 extent_y = _mm_mul_ps(_mm_sub_ps(max_y, min_y), half);
+                const __m128 extent_z = _mm_mul_ps(_mm_sub_ps(max_z, min_z), half);
+
+                __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (const CullingPlane& plane : m_planes)
+                {
+                    __m128 signed_distance = _mm_mul_ps(_mm_set1_ps(plane.x), center_x);
+                    signed_distance        = _mm_add_ps(signed_distance, _mm_mul_ps(_mm_set1_ps(plane.y), center_y));
+                    signed_distance        = _mm_add_ps(signed_distance, _mm_mul_ps(_mm_set1_ps(plane.z), center_z));
+                    signed_distance        = _mm_add_ps(signed_distance, _mm_set1_ps(plane.w));
+
+                    __m128 radius = _mm_mul_ps(_mm_set1_ps(plane.abs_x), extent_x);
+                    radius        = _mm_add_ps(radius, _mm_mul_ps(_mm_set1_ps(plane.abs_y), extent_y));
+                    radius        = _mm_add_ps(radius, _mm_mul_ps(_mm_set1_ps(plane.abs_z), extent_z));
+
+                    visible = _mm_and_ps(visible, _mm_cmplt_ps(signed_distance, radius));
+                }
+                return _mm_movemask_ps(visible);
+            }
+#endif
+        };
+
+        struct SphereLeafTest
+        {
+            const std::vector<BoundingSphere>& m_spheres;
+
+            bool testBox(const BoundingBox& box) const { return boxIntersectsSpheres(m_spheres, box); }
+
+#ifdef PICCOLO_CULLING_SSE
+            int testBoxes(__m128 min_x, __m128 min_y, __m128 min_z, __m128 max_x, __m128 max_y, __m128 max_z) const
+            {
+                __m128 outside = _mm_setzero_ps();
+                for (const BoundingSphere& sphere : m_spheres)
+                {
+                    const __m128 center_x = _mm_set1_ps(sphere.m_center.x);
+                    const __m128 center_y = _mm_set1_ps(sphere.m_center.y);
+                    const __m128 center_z = _mm_set1_ps(sphere.m_center.z);
+                    const __m128 radius   = _mm_set1_ps(sphere.m_radius);
+
+                    outside = _mm_or_ps(outside, _mm_cmpgt_ps(_mm_sub_ps(min_x, center_x), radius));
+                    outside = _mm_or_ps(outside, _mm_cmpgt_ps(_mm_sub_ps(center_x, max_x), radius));
+                    outside = _mm_or_ps(outside, _mm_cmpgt_ps(_mm_sub_ps(min_y, center_y), radius));
+                    outside = _mm_or_ps(outside, _mm_cmpgt_ps(_mm_sub_ps(center_y, max_y), radius));
+                    outside = _mm_or_ps(outside, _mm_cmpgt_ps(_mm_sub_ps(min_z, center_z), radius));
+                    outside = _mm_or_ps(outside, _mm_cmpgt_ps(_mm_sub_ps(center_z, max_z), radius));
+                }
+                return ~_mm_movemask_ps(outside) & 0xF;
+            }
+#endif
+        };
+
+        // four scattered entities, the tree leaves
+        template<typename LeafTest>
+        int testLeaves(const LeafTest& test, const RenderEntityBounds& bounds, const uint32_t (&entity_indices)[4])
+        {
+#ifdef PICCOLO_CULLING_SSE
+            return test.testBoxes(gatherBounds(bounds.m_min_x, entity_indices),
+                                  gatherBounds(bounds.m_min_y, entity_indices),
+                                  gatherBounds(bounds.m_min_z, entity_indices),
+                                  gatherBounds(bounds.m_max_x, entity_indices),
+                                  gatherBounds(bounds.m_max_y, entity_indices),
+                                  gatherBounds(bounds.m_max_z, entity_indices));
+#else
+            int visible_mask = 0;
+            for (int lane = 0; lane < 4; lane++)
+            {
+                if (test.testBox(bounds.getBoundingBox(entity_indices[lane])))
+                {
+                    visible_mask |= 1 << lane;
+                }
+            }
+            return visible_mask;
+#endif
+        }
+
+        // consecutive entities, loaded straight from the SoA arrays; every index of a block is written and only
+        // the visible ones advance the output, so the loop has no unpredictable branches
+        template<typename LeafTest>
+        void cullRange(const LeafTest&           test,
+                       const RenderEntityBounds& bounds,
+                       size_t                    begin,
+                       size_t                    end,
+                       std::vector<uint32_t>&    out_entity_indices)
+        {
+            constexpr size_t k_block_size {256};
+
+            for (size_t block_begin = begin; block_begin < end; block_begin += k_block_size)
+            {
+                const size_t block_end    = std::min(end, block_begin + k_block_size);
+                const size_t first_output = out_entity_indices.size();
+                out_entity_indices.resize(first_output + (block_end - block_begin));
+                uint32_t* output       = out_entity_indices.data() + first_output;
+                size_t    output_count = 0;
+
+                size_t index = block_begin;
+#ifdef PICCOLO_CULLING_SSE
+                for (; index + 4 <= block_end; index += 4)
+                {
+                    const int visible_mask = test.testBoxes(_mm_loadu_ps(bounds.m_min_x.data() + index),
+                                                            _mm_loadu_ps(bounds.m_min_y.data() + index),
+                                                            _mm_loadu_ps(bounds.m_min_z.data() + index),
+                                                            _mm_loadu_ps(bounds.m_max_x.data() + index),
+                                                            _mm_loadu_ps(bounds.m_max_y.data() + index),
+                                                            _mm_loadu_ps(bounds.m_max_z.data() + index));
+                    for (int lane = 0; lane < 4; lane++)
+                    {
+                        output[output_count] = static_cast<uint32_t>(index + lane);
+                        output_count += (visible_mask >> lane) & 1;
+                    }
+                }
+#endif
+                for (; index < block_end; index++)
+                {
+                    output[output_count] = static_cast<uint32_t>(index);
+                    output_count += test.testBox(bounds.getBoundingBox(index)) ? 1 : 0;
+                }
+                out_entity_indices.resize(first_output + output_count);
+            }
+        }
+
+        // share of every stride-th entity the test accepts
+        template<typename LeafTest>
+        float sampleRange(const LeafTest& test, const RenderEntityBounds& bounds, size_t stride)
+        {
+            size_t sample_count  = 0;
+            size_t visible_count = 0;
+            for (size_t index = 0; index < bounds.size(); index += stride)
+            {
+                sample_count++;
+                visible_count += test.testBox(bounds.getBoundingBox(index)) ? 1 : 0;
+            }
+            return sample_count == 0 ? 0.0f : static_cast<float>(visible_count) / sample_count;
+        }
+
+        // leaves that reach the exact test are queued and tested four at a time against the SoA bounds
+        template<typename LeafTest>
+        class LeafBatch
+        {
+        public:
+            LeafBatch(const LeafTest& test, const RenderEntityBounds& bounds, std::vector<uint32_t>& out_entity_indices) :
+                m_test(test), m_bounds(bounds), m_out_entity_indices(out_entity_indices)
+            {}
+
+            void push(uint32_t entity_index)
+            {
+                m_entity_indices[m_count++] = entity_index;
+                if (m_count == 4)
+                {
+                    flush();
+                }
+            }
+
+            void flush()
+            {
+                if (m_count == 0)
+                {
+                    return;
+                }
+
+                // unused lanes repeat the first entity and are masked out
+                for (size_t lane = m_count; lane < 4; lane++)
+                {
+                    m_entity_indices[lane] = m_entity_indices[0];
+                }
+                const int visible_mask = testLeaves(m_test, m_bounds, m_entity_indices) & ((1 << m_count) - 1);
+                for (size_t lane = 0; lane < m_count; lane++)
+                {
+                    if (visible_mask & (1 << lane))
+                    {
+                        m_out_entity_indices.push_back(m_entity_indices[lane]);
+                    }
+                }
+                m_count = 0;
+            }
+
+        private:
+            const LeafTest&           m_test;
+            const RenderEntityBounds& m_bounds;
+            std::vector<uint32_t>&    m_out_entity_indices;
+            uint32_t                  m_entity_indices[4] {};
+            size_t                    m_count {0};
+        };
+
+        bool boxesOverlap(const BoundingBox& lhs, const BoundingBox& rhs)
+        {
+            return lhs.min_bound.x <= rhs.max_bound.x && lhs.max_bound.x >= rhs.min_bound.x &&
+                   lhs.min_bound.y <= rhs.max_bound.y && lhs.max_bound.y >= rhs.min_bound.y &&
+                   lhs.min_bound.z <= rhs.max_bound.z && lhs.max_bound.z >= rhs.min_bound.z;
+        }
+
+        bool boxContains(const BoundingBox& outer, const BoundingBox& inner)
+        {
+            return outer.min_bound.x <= inner.min_bound.x && outer.min_bound.y <= inner.min_bound.y &&
+                   outer.min_bound.z <= inner.min_bound.z && outer.max_bound.x >= inner.max_bound.x &&
+                   outer.max_bound.y >= inner.max_bound.y && outer.max_bound.z >= inner.max_bound.z;
+        }
+
+        // BoxIntersectsWithSphere compares per axis, so a box inside the cube around every sphere passes with all
+        // the boxes it contains
+        bool boxInsideSpheres(const std::vector<BoundingSphere>& spheres, const BoundingBox& box)
+        {
+            for (const BoundingSphere& sphere : spheres)
+            {
+                const Vector3 radius(sphere.m_radius, sphere.m_radius, sphere.m_radius);
+                if (!boxContains(BoundingBox(sphere.m_center - radius, sphere.m_center + radius), box))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        BoundingBox mergeBoxes(const BoundingBox& lhs, const BoundingBox& rhs)
+        {
+            BoundingBox result = lhs;
+            result.merge(rhs);
+            return result;
+        }
+
+        float surfaceArea(const BoundingBox& box)
+        {
+            const Vector3 size = box.max_bound - box.min_bound;
+            return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+        }
+
+        // slab test, returns the entry distance or a negative value when the ray misses
+        float rayIntersectsBox(const Vector3&     origin,
+                               const Vector3&     inverse_direction,
+                               float              max_distance,
+                               const BoundingBox& box)
+        {
+            float t_min = 0.0f;
+            float t_max = max_distance;
+            for (size_t axis = 0; axis < 3; axis++)
+            {
+                float t0 = (box.min_bound[axis] - origin[axis]) * inverse_direction[axis];
+                float t1 = (box.max_bound[axis] - origin[axis]) * inverse_direction[axis];
+                if (t0 > t1)
+                {
+                    std::swap(t0, t1);
+                }
+                t_min = std::max(t_min, t0);
+                t_max = std::min(t_max, t1);
+                if (t_min > t_max)
+                {
+                    return -1.0f;
+                }
+            }
+            return t_min;
+        }
+    } // namespace
+
+    class RenderEntityBvh::NodeStack
+    {
+    public:
+        // the rotations keep the tree balanced, a depth first walk never holds more than height + 1 nodes
+        static constexpr size_t k_capacity {128};
+
+        explicit NodeStack(int32_t node) { push(node); }
+
+        bool    empty() const { return m_size == 0; }
+        size_t  size() const { return m_size; }
+        int32_t pop() { return m_nodes[--m_size]; }
+        void    push(int32_t node)
+        {
+            ASSERT(m_size < k_capacity);
+            m_nodes[m_size++] = node;
+        }
+
+    private:
+        int32_t m_nodes[k_capacity];
+        size_t  m_size {0};
+    };
+
+    void RenderEntityBounds::clear()
+    {
+        m_min_x.clear();
+        m_min_y.clear();
+        m_min_z.clear();
+        m_max_x.clear();
+        m_max_y.clear();
+        m_max_z.clear();
+    }
+
+    void RenderEntityBounds::setBounds(size_t                index,
+                                       const AxisAlignedBox& local_bounding_box,
+                                       const Matrix4x4&      model_matrix)
+    {
+        if (index == size())
+        {
+            m_min_x.emplace_back();
+            m_min_y.emplace_back();
+            m_min_z.emplace_back();
+            m_max_x.emplace_back();
+            m_max_y.emplace_back();
+            m_max_z.emplace_back();
+        }
+
+        // model matrices are affine, so the world box is the transformed center
+        // plus the half extent projected on each world axis
+        const Vector3& center      = local_bounding_box.getCenter();
+        const Vector3& half_extent = local_bounding_box.getHalfExtent();
+
+        float world_center[3];
+        float world_extent[3];
+        for (size_t row = 0; row < 3; row++)
+        {
+            const float* m    = model_matrix.m_mat[row];
+            world_center[row] = m[0] * center.x + m[1] * center.y + m[2] * center.z + m[3];
+            world_extent[row] =
+                std::fabs(m[0]) * half_extent.x + std::fabs(m[1]) * half_extent.y + std::fabs(m[2]) * half_extent.z;
+        }
+
+        m_min_x[index] = world_center[0] - world_extent[0];
+        m_min_y[index] = world_center[1] - world_extent[1];
+        m_min_z[index] = world_center[2] - world_extent[2];
+        m_max_x[index] = world_center[0] + world_extent[0];
+        m_max_y[index] = world_center[1] + world_extent[1];
+        m_max_z[index] = world_center[2] + world_extent[2];
+    }
+
+    void RenderEntityBounds::swapRemove(size_t index)
+    {
+        for (std::vector<float>* component : {&m_min_x, &m_min_y, &m_min_z, &m_max_x, &m_max_y, &m_max_z})
+        {
+            (*component)[index] = component->back();
+            component->pop_back();
+        }
+    }
+
+    BoundingBox RenderEntityBounds::getBoundingBox(size_t index) const
+    {
+        return BoundingBox(Vector3(m_min_x[index], m_min_y[index], m_min_z[index]),
+                           Vector3(m_max_x[index], m_max_y[index], m_max_z[index]));
+    }
+
+    void RenderEntityBounds::cullFrustum(ClusterFrustum const&  frustum,
+                                         size_t                 begin,
+                                         size_t                 end,
+                                         std::vector<uint32_t>& out_entity_indices) const
+    {
+        CullingPlane planes[6];
+        makeCullingPlanes(frustum, planes);
+        cullRange(FrustumLeafTest {planes}, *this, begin, end, out_entity_indices);
+    }
+
+    void RenderEntityBounds::cullSpheres(std::vector<BoundingSphere> const& spheres,
+                                         size_t                             begin,
+                                         size_t                             end,
+                                         std::vector<uint32_t>&             out_entity_indices) const
+    {
+        cullRange(SphereLeafTest {spheres}, *this, begin, end, out_entity_indices);
+    }
+
+    float RenderEntityBounds::sampleFrustumVisibility(ClusterFrustum const& frustum, size_t stride) const
+    {
+        CullingPlane planes[6];
+        makeCullingPlanes(frustum, planes);
+        return sampleRange(FrustumLeafTest {planes}, *this, stride);
+    }
+
+    float RenderEntityBounds::sampleSpheresVisibility(std::vector<BoundingSphere> const& spheres, size_t stride) const
+    {
+        return sampleRange(SphereLeafTest {spheres}, *this, stride);
+    }
+
+    int32_t RenderEntityBvh::insertLeaf(const BoundingBox& bounds, uint32_t entity_index)
+    {
+        const Vector3 margin(k_bvh_leaf_margin, k_bvh_leaf_margin, k_bvh_leaf_margin);
+
+        const int32_t leaf          = allocateNode();
+        m_nodes[leaf].m_bounds       = BoundingBox(bounds.min_bound - margin, bounds.max_bound + margin);
+        m_nodes[leaf].m_entity_index = entity_index;
+        insertLeafNode(leaf);
+        return leaf;
+    }
+
+    void RenderEntityBvh::removeLeaf(int32_t leaf)
+    {
+        removeLeafNode(leaf);
+        freeNode(leaf);
+    }
+
+    void RenderEntityBvh::updateLeaf(int32_t leaf, const BoundingBox& bounds)
+    {
+        if (boxContains(m_nodes[leaf].m_bounds, bounds))
+        {
+            return;
+        }
+
+        const Vector3 margin(k_bvh_leaf_margin, k_bvh_leaf_margin, k_bvh_leaf_margin);
+        removeLeafNode(leaf);
+        m_nodes[leaf].m_bounds = BoundingBox(bounds.min_bound - margin, bounds.max_bound + margin);
+        insertLeafNode(leaf);
+    }
+
+    void RenderEntityBvh::clear()
+    {
+        m_nodes.clear();
+        m_root      = k_null_node;
+        m_free_list = k_null_node;
+    }
+
+    int32_t RenderEntityBvh::allocateNode()
+    {
+        if (m_free_list == k_null_node)
+        {
+            m_nodes.emplace_back();
+            return static_cast<int32_t>(m_nodes.size() - 1);
+        }
+
+        const int32_t node = m_free_list;
+        m_free_list        = m_nodes[node].m_parent;
+        m_nodes[node]      = Node {};
+        return node;
+    }
+
+    void RenderEntityBvh::freeNode(int32_t node)
+    {
+        m_nodes[node].m_parent = m_free_list;
+        m_nodes[node].m_height = -1;
+        m_free_list            = node;
+    }
+
+    void RenderEntityBvh::insertLeafNode(int32_t leaf)
+    {
+        if (m_root == k_null_node)
+        {
+            m_root                  = leaf;
+            m_nodes[leaf].m_parent  = k_null_node;
+            return;
+        }
+
+        // walk down to the sibling with the lowest surface area cost
+        const BoundingBox leaf_bounds = m_nodes[leaf].m_bounds;
+        int32_t           index       = m_root;
+        while (!m_nodes[index].isLeaf())
+        {
+            const Node& node          = m_nodes[index];
+            const float area          = surfaceArea(node.m_bounds);
+            const float combined_area = surfaceArea(mergeBoxes(node.m_bounds, leaf_bounds));
+
+            // cost of creating a new parent for this node and the leaf
+            const float cost = 2.0f * combined_area;
+            // minimum cost of pushing the leaf further down the tree
+            const float inheritance_cost = 2.0f * (combined_area - area);
+
+            auto descend_cost = [&](int32_t child) {
+                const float merged_area = surfaceArea(mergeBoxes(leaf_bounds, m_nodes[child].m_bounds));
+                if (m_nodes[child].isLeaf())
+                {
+                    return merged_area + inheritance_cost;
+                }
+                return merged_area - surfaceArea(m_nodes[child].m_bounds) + inheritance_cost;
+            };
+            const float left_cost  = descend_cost(node.m_left);
+            const float right_cost = descend_cost(node.m_right);
+
+            if (cost < left_cost && cost < right_cost)
+            {
+                break;
+            }
+            index = left_cost < right_cost ? node.m_left : node.m_right;
+        }
+
+        const int32_t sibling    = index;
+        const int32_t old_parent = m_nodes[sibling].m_parent;
+        const int32_t new_parent = allocateNode();
+
+        m_nodes[new_parent].m_parent = old_parent;
+        m_nodes[new_parent].m_bounds = mergeBoxes(leaf_bounds, m_nodes[sibling].m_bounds);
+        m_nodes[new_parent].m_height = m_nodes[sibling].m_height + 1;
+        m_nodes[new_parent].m_left   = sibling;
+        m_nodes[new_parent].m_right  = leaf;
+        m_nodes[sibling].m_parent    = new_parent;
+        m_nodes[leaf].m_parent       = new_parent;
+
+        if (old_parent == k_null_node)
+        {
+            m_root = new_parent;
+        }
+        else if (m_nodes[old_parent].m_left == sibling)
+        {
+            m_nodes[old_parent].m_left = new_parent;
+        }
+        else
+        {
+            m_nodes[old_parent].m_right = new_parent;
+        }
+
+        refitAncestors(m_nodes[leaf].m_parent);
+    }
+
+    void RenderEntityBvh::removeLeafNode(int32_t leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = k_null_node;
+            return;
+        }
+
+        const int32_t parent       = m_nodes[leaf].m_parent;
+        const int32_t grand_parent = m_nodes[parent].m_parent;
+        const int32_t sibling = m_nodes[parent].m_left == leaf ? m_nodes[parent].m_right : m_nodes[parent].m_left;
+
+        freeNode(parent);
+        m_nodes[sibling].m_parent = grand_parent;
+        if (grand_parent == k_null_node)
+        {
+            m_root = sibling;
+            return;
+        }
+
+        if (m_nodes[grand_parent].m_left == parent)
+        {
+            m_nodes[grand_parent].m_left = sibling;
+        }
+        else
+        {
+            m_nodes[grand_parent].m_right = sibling;
+        }
+        refitAncestors(grand_parent);
+    }
+
+    void RenderEntityBvh::refitAncestors(int32_t node)
+    {
+        while (node != k_null_node)
+        {
+            node = balance(node);
+
+            Node&       current = m_nodes[node];
+            const Node& left    = m_nodes[current.m_left];
+            const Node& right   = m_nodes[current.m_right];
+            current.m_height    = 1 + std::max(left.m_height, right.m_height);
+            current.m_bounds    = mergeBoxes(left.m_bounds, right.m_bounds);
+
+            node = current.m_parent;
+        }
+    }
+
+    // rotate the higher child up when the subtree heights differ by more than one, returns the new subtree root
+    int32_t RenderEntityBvh::balance(int32_t index_a)
+    {
+        Node& a = m_nodes[index_a];
+        if (a.isLeaf() || a.m_height < 2)
+        {
+            return index_a;
+        }
+
+        const int32_t index_b = a.m_left;
+        const int32_t index_c = a.m_right;
+        Node&         b       = m_nodes[index_b];
+        Node&         c       = m_nodes[index_c];
+
+        auto replace_child = [&](int32_t parent, int32_t old_child, int32_t new_child) {
+            if (parent == k_null_node)
+            {
+                m_root = new_child;
+            }
+            else if (m_nodes[parent].m_left == old_child)
+            {
+                m_nodes[parent].m_left = new_child;
+            }
+            else
+            {
+                m_nodes[parent].m_right = new_child;
+            }
+        };
+
+        const int32_t height_difference = c.m_height - b.m_height;
+        if (height_difference > 1)
+        {
+            // rotate c up
+            const int32_t index_f = c.m_left;
+            const int32_t index_g = c.m_right;
+            Node&         f       = m_nodes[index_f];
+            Node&         g       = m_nodes[index_g];
+
+            c.m_left   = index_a;
+            c.m_parent = a.m_parent;
+            a.m_parent = index_c;
+            replace_child(c.m_parent, index_a, index_c);
+
+            if (f.m_height > g.m_height)
+            {
+                c.m_right  = index_f;
+                a.m_right  = index_g;
+                g.m_parent = index_a;
+                a.m_bounds = mergeBoxes(b.m_bounds, g.m_bounds);
+                c.m_bounds = mergeBoxes(a.m_bounds, f.m_bounds);
+                a.m_height = 1 + std::max(b.m_height, g.m_height);
+                c.m_height = 1 + std::max(a.m_height, f.m_height);
+            }
+            else
+            {
+                c.m_right  = index_g;
+                a.m_right  = index_f;
+                f.m_parent = index_a;
+                a.m_bounds = mergeBoxes(b.m_bounds, f.m_bounds);
+                c.m_bounds = mergeBoxes(a.m_bounds, g.m_bounds);
+                a.m_height = 1 + std::max(b.m_height, f.m_height);
+                c.m_height = 1 + std::max(a.m_height, g.m_height);
+            }
+            return index_c;
+        }
+
+        if (height_difference < -1)
+        {
+            // rotate b up
+            const int32_t index_d = b.m_left;
+            const int32_t index_e = b.m_right;
+            Node&         d       = m_nodes[index_d];
+            Node&         e       = m_nodes[index_e];
+
+            b.m_left   = index_a;
+            b.m_parent = a.m_parent;
+            a.m_parent = index_b;
+            replace_child(b.m_parent, index_a, index_b);
+
+            if (d.m_height > e.m_height)
+            {
+                b.m_right  = index_d;
+                a.m_left   = index_e;
+                e.m_parent = index_a;
+                a.m_bounds = mergeBoxes(c.m_bounds, e.m_bounds);
+                b.m_bounds = mergeBoxes(a.m_bounds, d.m_bounds);
+                a.m_height = 1 + std::max(c.m_height, e.m_height);
+                b.m_height = 1 + std::max(a.m_height, d.m_height);
+            }
+            else
+            {
+                b.m_right  = index_e;
+                a.m_left   = index_d;
+                d.m_parent = index_a;
+                a.m_bounds = mergeBoxes(c.m_bounds, d.m_bounds);
+                b.m_bounds = mergeBoxes(a.m_bounds, e.m_bounds);
+                a.m_height = 1 + std::max(c.m_height, d.m_height);
+                b.m_height = 1 + std::max(a.m_height, e.m_height);
+            }
+            return index_b;
+        }
+
+        return index_a;
+    }
+
+    void RenderEntityBvh::appendSubtreeEntities(int32_t                node,
+                                                NodeStack&             stack,
+                                                std::vector<uint32_t>& out_entity_indices) const
+    {
+        // shares the stack of the query, the entries below stack_base are left for it
+        const size_t stack_base = stack.size();
+        stack.push(node);
+        while (stack.size() > stack_base)
+        {
+            const Node& current = m_nodes[stack.pop()];
+            if (current.isLeaf())
+            {
+                out_entity_indices.push_back(current.m_entity_index);
+                continue;
+            }
+            stack.push(current.m_left);
+            stack.push(current.m_right);
+        }
+    }
+
+    void RenderEntityBvh::getSubtrees(size_t subtree_count, std::vector<int32_t>& out_subtree_roots) const
+    {
+        out_subtree_roots.clear();
+        if (m_root == k_null_node)
+        {
+            return;
+        }
+
+        // split the highest subtree until there are enough, heights stand in for the work below a node
+        out_subtree_roots.push_back(m_root);
+        while (out_subtree_roots.size() < subtree_count)
+        {
+            auto highest = std::max_element(
+                out_subtree_roots.begin(), out_subtree_roots.end(), [this](int32_t lhs, int32_t rhs) {
+                    return m_nodes[lhs].m_height < m_nodes[rhs].m_height;
+                });
+            if (m_nodes[*highest].isLeaf())
+            {
+                break;
+            }
+
+            const Node& node = m_nodes[*highest];
+            *highest         = node.m_left;
+            out_subtree_roots.push_back(node.m_right);
+        }
+    }
+
+    void RenderEntityBvh::queryFrustum(ClusterFrustum const&     frustum,
+                                       RenderEntityBounds const& bounds,
+                                       std::vector<uint32_t>&    out_entity_indices,
+                                       int32_t                   subtree_root) const
+    {
+        const int32_t root = subtree_root == k_null_node ? m_root : subtree_root;
+        if (root == k_null_node)
+        {
+            return;
+        }
+
+        CullingPlane planes[6];
+        makeCullingPlanes(frustum, planes);
+
+        const FrustumLeafTest      leaf_test {planes};
+        LeafBatch<FrustumLeafTest> leaf_batch(leaf_test, bounds, out_entity_indices);
+
+        NodeStack stack(root);
+        while (!stack.empty())
+        {
+            const int32_t index = stack.pop();
+
+            const Node&         node   = m_nodes[index];
+            const CullingResult result = classifyBox(planes, node.m_bounds);
+            if (result == CullingResult::outside)
+            {
+                continue;
+            }
+
+            if (result == CullingResult::inside)
+            {
+                // everything below is inside too, no more plane tests
+                appendSubtreeEntities(index, stack, out_entity_indices);
+            }
+            else if (node.isLeaf())
+            {
+                leaf_batch.push(node.m_entity_index);
+            }
+            else
+            {
+                stack.push(node.m_left);
+                stack.push(node.m_right);
+            }
+        }
+        leaf_batch.flush();
+    }
+
+    void RenderEntityBvh::querySpheres(std::vector<BoundingSphere> const& spheres,
+                                       RenderEntityBounds const&          bounds,
+                                       std::vector<uint32_t>&             out_entity_indices,
+                                       int32_t                            subtree_root) const
+    {
+        const int32_t root = subtree_root == k_null_node ? m_root : subtree_root;
+        if (root == k_null_node)
+        {
+            return;
+        }
+
+        const SphereLeafTest      leaf_test {spheres};
+        LeafBatch<SphereLeafTest> leaf_batch(leaf_test, bounds, out_entity_indices);
+
+        NodeStack stack(root);
+        while (!stack.empty())
+        {
+            const int32_t index = stack.pop();
+
+            // a larger box always passes when a smaller one does, so the node boxes are conservative
+            const Node& node = m_nodes[index];
+            if (!boxIntersectsSpheres(spheres, node.m_bounds))
+            {
+                continue;
+            }
+
+            if (boxInsideSpheres(spheres, node.m_bounds))
+            {
+                appendSubtreeEntities(index, stack, out_entity_indices);
+            }
+            else if (node.isLeaf())
+            {
+                leaf_batch.push(node.m_entity_index);
+            }
+            else
+            {
+                stack.push(node.m_left);
+                stack.push(node.m_right);
+            }
+        }
+        leaf_batch.flush();
+    }
+
+    void RenderEntityBvh::queryBox(BoundingBox const&        box,
+                                   RenderEntityBounds const& bounds,
+                                   std::vector<uint32_t>&    out_entity_indices) const
+    {
+        if (m_root == k_null_node)
+        {
+            return;
+        }
+
+        NodeStack stack(m_root);
+        while (!stack.empty())
+        {
+            const Node& node = m_nodes[stack.pop()];
+
+            if (!boxesOverlap(box, node.m_bounds))
+            {
+                continue;
+            }
+
+            if (node.isLeaf())
+            {
+                if (boxesOverlap(box, bounds.getBoundingBox(node.m_entity_index)))
+                {
+                    out_entity_indices.push_back(node.m_entity_index);
+                }
+                continue;
+            }
+            stack.push(node.m_left);
+            stack.push(node.m_right);
+        }
+    }
+
+    void RenderEntityBvh::queryRay(Vector3 const&                           origin,
+                                   Vector3 const&                           direction,
+                                   float                                    max_distance,
+                                   RenderEntityBounds const&                bounds,
+                                   std::vector<std::pair<float, uint32_t>>& out_hits) const
+    {
+        if (m_root == k_null_node)
+        {
+            return;
+        }
+
+        const Vector3 inverse_direction(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+        const size_t  first_hit = out_hits.size();
+
+        NodeStack stack(m_root);
+        while (!stack.empty())
+        {
+            const Node& node = m_nodes[stack.pop()];
+
+            if (rayIntersectsBox(origin, inverse_direction, max_distance, node.m_bounds) < 0.0f)
+            {
+                continue;
+            }
+
+            if (node.isLeaf())
+            {
+                const float distance =
+                    rayIntersectsBox(origin, inverse_direction, max_distance, bounds.getBoundingBox(node.m_entity_index));
+                if (distance >= 0.0f)
+                {
+                    out_hits.emplace_back(distance, node.m_entity_index);
+                }
+                continue;
+            }
+            stack.push(node.m_left);
+            stack.push(node.m_right);
+        }
+
+        std::sort(out_hits.begin() + first_hit, out_hits.end());
+    }
+} // namespace Piccolo
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "runtime/function/render/render_helper.h"
+
+#include "runtime/core/math/axis_aligned.h"
+#include "runtime/core/math/matrix4.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Piccolo
+{
+    /// World space bounds of the render entities as structure of arrays, index i belongs to
+    /// RenderScene::m_render_entities[i]. Bounds are only recomputed when an entity is updated.
+    class RenderEntityBounds
+    {
+    public:
+        size_t size() const { return m_min_x.size(); }
+        void   clear();
+
+        // transform the local box and store it at index, index may be size() to append
+        void setBounds(size_t index, const AxisAlignedBox& local_bounding_box, const Matrix4x4& model_matrix);
+        // move the last bounds into index and drop the last, same as the entity swap-remove
+        void swapRemove(size_t index);
+
+        BoundingBox getBoundingBox(size_t index) const;
+
+        // linear four-wide tests of the entities [begin, end), appending the visible indices in order; for views
+        // that see most of the scene, where walking the tree costs more than it skips
+        void cullFrustum(ClusterFrustum const&  frustum,
+                         size_t                 begin,
+                         size_t                 end,
+                         std::vector<uint32_t>& out_entity_indices) const;
+        void cullSpheres(std::vector<BoundingSphere> const& spheres,
+                         size_t                             begin,
+                         size_t                             end,
+                         std::vector<uint32_t>&             out_entity_indices) const;
+
+        // share of every stride-th entity the view accepts, a cheap estimate of how much of the scene it sees
+        float sampleFrustumVisibility(ClusterFrustum const& frustum, size_t stride) const;
+        float sampleSpheresVisibility(std::vector<BoundingSphere> const& spheres, size_t stride) const;
+
+        std::vector<float> m_min_x;
+        std::vector<float> m_min_y;
+        std::vector<float> m_min_z;
+        std::vector<float> m_max_x;
+        std::vector<float> m_max_y;
+        std::vector<float> m_max_z;
+    };
+
+    /// Dynamic AABB tree over the render entities. Leaves hold bounds enlarged by a margin, so small moves only
+    /// update the exact bounds; a leaf is reinserted once it leaves its enlarged box, and the tree is kept
+    /// balanced with rotations. Queries test inner nodes hierarchically and leaves against the exact bounds,
+    /// so they return exactly the entities TiledFrustumIntersectBox / BoxIntersectsWithSphere accept.
+    class RenderEntityBvh
+    {
+    public:
+        static constexpr int32_t k_null_node {-1};
+
+        int32_t insertLeaf(const BoundingBox& bounds, uint32_t entity_index);
+        void    removeLeaf(int32_t leaf);
+        void    updateLeaf(int32_t leaf, const BoundingBox& bounds);
+        // entity indices change when the scene swap-removes an entity
+        void setLeafEntityIndex(int32_t leaf, uint32_t entity_index) { m_nodes[leaf].m_entity_index = entity_index; }
+        void clear();
+
+        int32_t getHeight() const { return m_root == k_null_node ? 0 : m_nodes[m_root].m_height; }
+
+        // disjoint subtrees covering every leaf, about subtree_count of them unless the tree has fewer leaves;
+        // the frustum and sphere queries of the subtrees together return what the query of the root does
+        void getSubtrees(size_t subtree_count, std::vector<int32_t>& out_subtree_roots) const;
+
+        // queries append the entity indices they accept, below subtree_root or in the whole tree for k_null_node;
+        // the leaves that need an exact test are batched and tested four at a time against the SoA bounds
+        void queryFrustum(ClusterFrustum const&     frustum,
+                          RenderEntityBounds const& bounds,
+                          std::vector<uint32_t>&    out_entity_indices,
+                          int32_t                   subtree_root = k_null_node) const;
+        // an entity is accepted only if it touches every sphere, like the point light shadow pass expects
+        void querySpheres(std::vector<BoundingSphere> const& spheres,
+                          RenderEntityBounds const&          bounds,
+                          std::vector<uint32_t>&             out_entity_indices,
+                          int32_t                            subtree_root = k_null_node) const;
+        void queryBox(BoundingBox const&        box,
+                      RenderEntityBounds const& bounds,
+                      std::vector<uint32_t>&    out_entity_indices) const;
+        // (distance, entity index) of every entity box hit within max_distance, nearest first
+        void queryRay(Vector3 const&                             origin,
+                      Vector3 const&                             direction,
+                      float                                      max_distance,
+                      RenderEntityBounds const&                  bounds,
+                      std::vector<std::pair<float, uint32_t>>&   out_hits) const;
+
+    private:
+        struct Node
+        {
+            BoundingBox m_bounds;
+            // next free node while the node is in the free list
+            int32_t  m_parent {k_null_node};
+            int32_t  m_left {k_null_node};
+            int32_t  m_right {k_null_node};
+            int32_t  m_height {0};
+            uint32_t m_entity_index {0};
+
+            bool isLeaf() const { return m_left == k_null_node; }
+        };
+
+        // fixed size traversal stack, so queries don't allocate
+        class NodeStack;
+
+        int32_t allocateNode();
+        void    freeNode(int32_t node);
+        void    insertLeafNode(int32_t leaf);
+        void    removeLeafNode(int32_t leaf);
+        int32_t balance(int32_t node);
+        void    refitAncestors(int32_t node);
+        void    appendSubtreeEntities(int32_t node, NodeStack& stack, std::vector<uint32_t>& out_entity_indices) const;
+
+        std::vector<Node> m_nodes;
+        int32_t           m_root {k_null_node};
+        int32_t           m_free_list {k_null_node};
+    };
+} // namespace Piccolo
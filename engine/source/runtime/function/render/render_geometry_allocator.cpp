@@ -0,0 +1,30 @@
+#include "runtime/function/render/render_geometry_allocator.h"
+
+namespace Sammi
+{
+    void GeometryRangeAllocator::reset(uint32_t capacity)
+    {
+        m_capacity   = capacity;
+        m_used_count = 0;
+    }
+
+    uint32_t GeometryRangeAllocator::allocate(uint32_t count)
+    {
+        if (count == 0 || m_capacity - m_used_count < count)
+        {
+            return s_invalid_geometry_offset;
+        }
+
+        const uint32_t offset = m_used_count;
+        m_used_count += count;
+        return offset;
+    }
+
+    void GeometryRangeAllocator::grow(uint32_t new_capacity)
+    {
+        if (new_capacity > m_capacity)
+        {
+            m_capacity = new_capacity;
+        }
+    }
+} // namespace Sammi
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Sammi
+{
+    static const uint32_t s_invalid_geometry_offset = UINT32_MAX;
+
+    /// Sub-allocates element ranges of a geometry mega buffer. Uploaded meshes stay for the lifetime of the render
+    /// resource, so ranges are appended and never freed; growing keeps every offset, the owner only copies the used
+    /// front of the old buffer into the new one.
+    class GeometryRangeAllocator
+    {
+    public:
+        void reset(uint32_t capacity);
+
+        // returns s_invalid_geometry_offset when the rest of the capacity is too small
+        uint32_t allocate(uint32_t count);
+        // the capacity never shrinks
+        void grow(uint32_t new_capacity);
+
+        uint32_t getCapacity() const { return m_capacity; }
+        uint32_t getUsedCount() const { return m_used_count; }
+
+    private:
+        uint32_t m_capacity {0};
+        uint32_t m_used_count {0};
+    };
+} // namespace Sammi
@@ -1,16 +1,24 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <unordered_map>
+#include <vector>
 
 namespace Piccolo
 {
     static const size_t s_invalid_guid = 0;
 
+    /// Guids are (generation << 24) | (slot index + 1), they fit in the 32 bit instance ids written by the pick pass.
+    /// Freed slots are recycled through a free list and bump their generation, so a stale guid never finds
+    /// the element that reused its slot.
     template<typename T>
     class GuidAllocator
     {
     public:
         static bool isValidGuid(size_t guid) { return guid != s_invalid_guid; }
+        // dense index of a valid guid, unique while the guid lives and reused once it is freed
+        static uint32_t getGuidIndex(size_t guid) { return getSlotIndex(guid); }
 
         size_t allocGuid(const T& t)
         {
@@ -20,26 +28,37 @@ namespace Piccolo
                 return find_it->second;
             }
 
-            for (size_t i = 0; i < m_guid_elements_map.size() + 1; i++)
+            uint32_t slot_index;
+            if (!m_free_slots.empty())
             {
-                size_t guid = i + 1;
-                if (m_guid_elements_map.find(guid) == m_guid_elements_map.end())
+                slot_index = m_free_slots.back();
+                m_free_slots.pop_back();
+            }
+            else
+            {
+                if (m_slots.size() >= s_max_slot_count)
                 {
-                    m_guid_elements_map.insert(std::make_pair(guid, t));
-                    m_elements_guid_map.insert(std::make_pair(t, guid));
-                    return guid;
+                    return s_invalid_guid;
                 }
+                slot_index = static_cast<uint32_t>(m_slots.size());
+                m_slots.emplace_back();
             }
 
-            return s_invalid_guid;
+            Slot& slot     = m_slots[slot_index];
+            slot.m_element = t;
+            slot.m_is_used = true;
+
+            const size_t guid = makeGuid(slot_index, slot.m_generation);
+            m_elements_guid_map.insert(std::make_pair(t, guid));
+            return guid;
         }
 
         bool getGuidRelatedElement(size_t guid, T& t)
         {
-            auto find_it = m_guid_elements_map.find(guid);
-            if (find_it != m_guid_elements_map.end())
+            const Slot* slot = findSlot(guid);
+            if (slot)
             {
-                t = find_it->second;
+                t = slot->m_element;
                 return true;
             }
             return false;
@@ -60,12 +79,9 @@ namespace Piccolo
 
         void freeGuid(size_t guid)
         {
-            auto find_it = m_guid_elements_map.find(guid);
-            if (find_it != m_guid_elements_map.end())
+            if (findSlot(guid))
             {
-                const auto& ele = find_it->second;
-                m_elements_guid_map.erase(ele);
-                m_guid_elements_map.erase(guid);
+                releaseSlot(getSlotIndex(guid));
             }
         }
 
@@ -74,18 +90,20 @@ namespace Piccolo
             auto find_it = m_elements_guid_map.find(t);
             if (find_it != m_elements_guid_map.end())
             {
-                const auto& guid = find_it->second;
-                m_elements_guid_map.erase(t);
-                m_guid_elements_map.erase(guid);
+                releaseSlot(getSlotIndex(find_it->second));
             }
         }
 
         std::vector<size_t> getAllocatedGuids() const
         {
             std::vector<size_t> allocated_guids;
-            for (const auto& ele : m_guid_elements_map)
+            allocated_guids.reserve(m_elements_guid_map.size());
+            for (uint32_t slot_index = 0; slot_index < m_slots.size(); slot_index++)
             {
-                allocated_guids.push_back(ele.first);
+                if (m_slots[slot_index].m_is_used)
+                {
+                    allocated_guids.push_back(makeGuid(slot_index, m_slots[slot_index].m_generation));
+                }
             }
             return allocated_guids;
         }
@@ -93,12 +111,58 @@ namespace Piccolo
         void clear()
         {
             m_elements_guid_map.clear();
-            m_guid_elements_map.clear();
+            m_slots.clear();
+            m_free_slots.clear();
         }
 
     private:
+        struct Slot
+        {
+            T        m_element {};
+            uint32_t m_generation {0};
+            bool     m_is_used {false};
+        };
+
+        static constexpr uint32_t s_slot_index_bits {24};
+        static constexpr uint32_t s_max_slot_count {(1u << s_slot_index_bits) - 1};
+        static constexpr uint32_t s_generation_mask {0xFF};
+
+        static size_t makeGuid(uint32_t slot_index, uint32_t generation)
+        {
+            return (static_cast<size_t>(generation) << s_slot_index_bits) | (slot_index + 1);
+        }
+        static uint32_t getSlotIndex(size_t guid) { return static_cast<uint32_t>((guid & s_max_slot_count) - 1); }
+        static uint32_t getGeneration(size_t guid) { return static_cast<uint32_t>(guid >> s_slot_index_bits); }
+
+        const Slot* findSlot(size_t guid) const
+        {
+            if ((guid & s_max_slot_count) == 0)
+            {
+                return nullptr;
+            }
+            const uint32_t slot_index = getSlotIndex(guid);
+            if (slot_index >= m_slots.size())
+            {
+                return nullptr;
+            }
+            const Slot& slot = m_slots[slot_index];
+            return (slot.m_is_used && slot.m_generation == getGeneration(guid)) ? &slot : nullptr;
+        }
+
+        void releaseSlot(uint32_t slot_index)
+        {
+            Slot& slot = m_slots[slot_index];
+            m_elements_guid_map.erase(slot.m_element);
+            slot.m_element    = T {};
+            slot.m_is_used    = false;
+            slot.m_generation = (slot.m_generation + 1) & s_generation_mask;
+            m_free_slots.push_back(slot_index);
+        }
+
         std::unordered_map<T, size_t> m_elements_guid_map;
-        std::unordered_map<size_t, T> m_guid_elements_map;
+        // indexed by slot index, never shrinks so guids stay stable
+        std::vector<Slot>     m_slots;
+        std::vector<uint32_t> m_free_slots;
     };
 
 } // namespace Piccolo
@@ -305,14 +305,11 @@ namespace Piccolo
             scene_bounding_box.min_bound = Vector3(FLT_MAX, FLT_MAX, FLT_MAX);
             scene_bounding_box.max_bound = Vector3(FLT_MIN, FLT_MIN, FLT_MIN);
 
-            for (const RenderEntity& entity : scene.m_render_entities)
+            // world bounds are cached by the scene, no need to transform every entity again
+            const RenderEntityBounds& entity_bounds = scene.m_render_entity_bounds;
+            for (size_t i = 0; i < entity_bounds.size(); i++)
             {
-                BoundingBox mesh_asset_bounding_box {entity.m_bounding_box.getMinCorner(),
-                                                     entity.m_bounding_box.getMaxCorner()};
-
-                BoundingBox mesh_bounding_box_world =
-                    BoundingBoxTransform(mesh_asset_bounding_box, entity.m_model_matrix);
-                scene_bounding_box.merge(mesh_bounding_box_world);
+                scene_bounding_box.merge(entity_bounds.getBoundingBox(i));
             }
         }
 
@@ -0,0 +1,369 @@
+#include "runtime/function/render/render_ibl_file.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+namespace Sammi
+{
+    namespace
+    {
+        static_assert(std::is_trivially_copyable<IBLFileHeader>::value, "ibl file header is written as raw bytes");
+        static_assert(sizeof(IBLFileHeader) == 72, "ibl file header must not contain padding");
+
+        // the largest cube face a corrupted header may claim before the size arithmetic could overflow
+        constexpr uint32_t k_ibl_max_cubemap_size {16384};
+
+        uint32_t getMipLevelCount(uint32_t size)
+        {
+            return static_cast<uint32_t>(std::floor(std::log2(std::max(size, 1u)))) + 1;
+        }
+
+        size_t getTexelSize(RHIFormat format) { return format == RHI_FORMAT_R16G16B16A16_SFLOAT ? 8 : 4; }
+
+        uint64_t getFaceSize(RHIFormat format, uint32_t size, uint32_t mip_levels)
+        {
+            uint64_t face_size = 0;
+            for (uint32_t level = 0; level < mip_levels; level++)
+            {
+                const uint64_t level_size = std::max(size >> level, 1u);
+                face_size += level_size * level_size * getTexelSize(format);
+            }
+            return face_size;
+        }
+
+        uint64_t alignDataOffset(uint64_t offset)
+        {
+            return (offset + k_ibl_file_data_alignment - 1) & ~(k_ibl_file_data_alignment - 1);
+        }
+
+        uint16_t packHalf(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            const uint32_t sign     = (bits >> 16) & 0x8000u;
+            const int32_t  exponent = static_cast<int32_t>((bits >> 23) & 0xFFu) - 127 + 15;
+            uint32_t       mantissa = bits & 0x7FFFFFu;
+
+            if (((bits >> 23) & 0xFFu) == 0xFFu)
+            {
+                // inf stays inf, nan stays nan
+                return static_cast<uint16_t>(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+            }
+            if (exponent >= 31)
+            {
+                return static_cast<uint16_t>(sign | 0x7C00u);
+            }
+            if (exponent <= 0)
+            {
+                if (exponent < -10)
+                    return static_cast<uint16_t>(sign);
+                // denormal, round to nearest even
+                mantissa |= 0x800000u;
+                const uint32_t shift   = static_cast<uint32_t>(14 - exponent);
+                uint32_t       half    = mantissa >> shift;
+                const uint32_t rest    = mantissa & ((1u << shift) - 1);
+                const uint32_t halfway = 1u << (shift - 1);
+                if (rest > halfway || (rest == halfway && (half & 1u)))
+                    half++;
+                return static_cast<uint16_t>(sign | half);
+            }
+
+            uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+            const uint32_t rest = mantissa & 0x1FFFu;
+            if (rest > 0x1000u || (rest == 0x1000u && (half & 1u)))
+                half++; // may carry into the exponent, which rounds up to the next power of two or to inf
+            return static_cast<uint16_t>(half);
+        }
+
+        // shared exponent packing as specified for VK_FORMAT_E5B9G9R9_UFLOAT_PACK32
+        uint32_t packE5B9G9R9(const float* rgb)
+        {
+            constexpr int   mantissa_bits = 9;
+            constexpr int   exponent_bias = 15;
+            constexpr int   max_exponent  = 31;
+            constexpr float max_value     = 511.0f / 512.0f * 65536.0f;
+
+            float clamped[3];
+            for (int c = 0; c < 3; c++)
+            {
+                // also maps nan to 0
+                clamped[c] = rgb[c] > 0.0f ? std::min(rgb[c], max_value) : 0.0f;
+            }
+
+            const float max_component = std::max(std::max(clamped[0], clamped[1]), clamped[2]);
+            if (max_component <= 0.0f)
+                return 0;
+
+            int shared_exponent =
+                std::max(-exponent_bias - 1, static_cast<int>(std::floor(std::log2(max_component)))) + 1 + exponent_bias;
+            const float max_mantissa =
+                std::floor(max_component / std::ldexp(1.0f, shared_exponent - exponent_bias - mantissa_bits) + 0.5f);
+            if (max_mantissa == static_cast<float>(1 << mantissa_bits))
+                shared_exponent++;
+            shared_exponent = std::min(shared_exponent, max_exponent);
+
+            const float scale  = std::ldexp(1.0f, shared_exponent - exponent_bias - mantissa_bits);
+            uint32_t    packed = static_cast<uint32_t>(shared_exponent) << 27;
+            for (int c = 0; c < 3; c++)
+            {
+                const uint32_t mantissa = std::min(static_cast<uint32_t>(std::floor(clamped[c] / scale + 0.5f)), 511u);
+                packed |= mantissa << (9 * c);
+            }
+            return packed;
+        }
+
+        // 2x2 box filter of a square RGBA32F level, like the linear blit of the GPU mip generation
+        std::vector<float> downsampleLevel(const std::vector<float>& source, uint32_t source_size)
+        {
+            const uint32_t     size = std::max(source_size / 2, 1u);
+            std::vector<float> level(static_cast<size_t>(size) * size * 4);
+            for (uint32_t y = 0; y < size; y++)
+            {
+                for (uint32_t x = 0; x < size; x++)
+                {
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        float sum = 0.0f;
+                        for (uint32_t sample = 0; sample < 4; sample++)
+                        {
+                            const uint32_t source_x = std::min(x * 2 + (sample & 1u), source_size - 1);
+                            const uint32_t source_y = std::min(y * 2 + (sample >> 1), source_size - 1);
+                            sum += source[(static_cast<size_t>(source_y) * source_size + source_x) * 4 + c];
+                        }
+                        level[(static_cast<size_t>(y) * size + x) * 4 + c] = sum * 0.25f;
+                    }
+                }
+            }
+            return level;
+        }
+
+        void writeLevel(const std::vector<float>& level, RHIFormat format, uint8_t* out)
+        {
+            const size_t texel_count = level.size() / 4;
+            for (size_t i = 0; i < texel_count; i++)
+            {
+                const float* texel = level.data() + i * 4;
+                if (format == RHI_FORMAT_R16G16B16A16_SFLOAT)
+                {
+                    uint16_t half[4];
+                    for (int c = 0; c < 4; c++)
+                        half[c] = packHalf(texel[c]);
+                    std::memcpy(out + i * 8, half, sizeof(half));
+                }
+                else
+                {
+                    const uint32_t packed = packE5B9G9R9(texel);
+                    std::memcpy(out + i * 4, &packed, sizeof(packed));
+                }
+            }
+        }
+
+        bool isValidCubemap(const std::array<std::shared_ptr<TextureData>, 6>& faces)
+        {
+            for (const auto& face : faces)
+            {
+                if (!face || !face->isValid() || face->m_format != RHI_FORMAT_R32G32B32A32_SFLOAT ||
+                    face->m_width != face->m_height || face->m_width != faces[0]->m_width)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void writeCubemap(const std::array<std::shared_ptr<TextureData>, 6>& faces,
+                          RHIFormat                                          format,
+                          uint32_t                                           mip_levels,
+                          uint8_t*                                           out)
+        {
+            const uint32_t size = faces[0]->m_width;
+            for (const auto& face : faces)
+            {
+                const float*       pixels = static_cast<const float*>(face->m_pixels);
+                std::vector<float> level(pixels, pixels + static_cast<size_t>(size) * size * 4);
+                for (uint32_t mip = 0; mip < mip_levels; mip++)
+                {
+                    const uint32_t level_size = std::max(size >> mip, 1u);
+                    if (mip > 0)
+                    {
+                        level = downsampleLevel(level, std::max(size >> (mip - 1), 1u));
+                    }
+                    writeLevel(level, format, out);
+                    out += static_cast<size_t>(level_size) * level_size * getTexelSize(format);
+                }
+            }
+        }
+
+        bool readCubemap(uint8_t*        data,
+                         size_t          file_size,
+                         RHIFormat       format,
+                         uint32_t        size,
+                         uint32_t        mip_levels,
+                         uint64_t        offset,
+                         uint64_t        face_size,
+                         IBLCubemapData& out_cubemap)
+        {
+            if (size == 0 || size > k_ibl_max_cubemap_size || mip_levels == 0 || mip_levels > getMipLevelCount(size) ||
+                face_size != getFaceSize(format, size, mip_levels) || offset > file_size ||
+                face_size * 6 > file_size - offset)
+            {
+                return false;
+            }
+
+            out_cubemap.m_size       = size;
+            out_cubemap.m_mip_levels = mip_levels;
+            for (size_t face = 0; face < out_cubemap.m_faces.size(); face++)
+            {
+                out_cubemap.m_faces[face] = data + offset + face_size * face;
+            }
+            return true;
+        }
+    } // namespace
+
+    std::array<std::string, 12> getIBLSourceUrls(const LevelIBLResourceDesc& ibl_resource_desc)
+    {
+        const SkyBoxIrradianceMap& irradiance = ibl_resource_desc.m_skybox_irradiance_map;
+        const SkyBoxSpecularMap&   specular   = ibl_resource_desc.m_skybox_specular_map;
+        return {irradiance.m_positive_x_map,
+                irradiance.m_negative_x_map,
+                irradiance.m_positive_z_map,
+                irradiance.m_negative_z_map,
+                irradiance.m_positive_y_map,
+                irradiance.m_negative_y_map,
+                specular.m_positive_x_map,
+                specular.m_negative_x_map,
+                specular.m_positive_z_map,
+                specular.m_negative_z_map,
+                specular.m_positive_y_map,
+                specular.m_negative_y_map};
+    }
+
+    uint64_t getIBLSourceHash(const LevelIBLResourceDesc& ibl_resource_desc)
+    {
+        // FNV-1a, stable across runs unlike std::hash, the urls are separated by a zero byte
+        uint64_t hash = 14695981039346656037ull;
+        for (const std::string& url : getIBLSourceUrls(ibl_resource_desc))
+        {
+            for (const char c : url)
+            {
+                hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+            }
+            hash = hash * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool saveIBLFile(const std::filesystem::path&                       path,
+                     uint64_t                                           source_hash,
+                     const std::array<std::shared_ptr<TextureData>, 6>& irradiance_faces,
+                     const std::array<std::shared_ptr<TextureData>, 6>& specular_faces,
+                     IBLCookFormat                                      format)
+    {
+        if (!isValidCubemap(irradiance_faces) || !isValidCubemap(specular_faces))
+        {
+            LOG_ERROR("cook ibl {} failed, the faces must be square RGBA32F images of one size", path.generic_string());
+            return false;
+        }
+
+        const RHIFormat rhi_format =
+            format == IBLCookFormat::rgba16f ? RHI_FORMAT_R16G16B16A16_SFLOAT : RHI_FORMAT_E5B9G9R9_UFLOAT_PACK32;
+
+        IBLFileHeader header {};
+        header.m_magic                 = k_ibl_file_magic;
+        header.m_version               = k_ibl_file_version;
+        header.m_format                = static_cast<uint32_t>(rhi_format);
+        header.m_source_hash           = source_hash;
+        header.m_irradiance_size       = irradiance_faces[0]->m_width;
+        header.m_irradiance_mip_levels = getMipLevelCount(header.m_irradiance_size);
+        header.m_specular_size         = specular_faces[0]->m_width;
+        header.m_specular_mip_levels   = getMipLevelCount(header.m_specular_size);
+        header.m_irradiance_face_size =
+            getFaceSize(rhi_format, header.m_irradiance_size, header.m_irradiance_mip_levels);
+        header.m_specular_face_size = getFaceSize(rhi_format, header.m_specular_size, header.m_specular_mip_levels);
+        header.m_irradiance_offset  = alignDataOffset(sizeof(IBLFileHeader));
+        header.m_specular_offset    = alignDataOffset(header.m_irradiance_offset + header.m_irradiance_face_size * 6);
+
+        std::vector<uint8_t> file_data(header.m_specular_offset + header.m_specular_face_size * 6, 0);
+        std::memcpy(file_data.data(), &header, sizeof(header));
+        writeCubemap(
+            irradiance_faces, rhi_format, header.m_irradiance_mip_levels, file_data.data() + header.m_irradiance_offset);
+        writeCubemap(
+            specular_faces, rhi_format, header.m_specular_mip_levels, file_data.data() + header.m_specular_offset);
+
+        std::ofstream ibl_file(path, std::ios::binary);
+        if (!ibl_file)
+        {
+            LOG_ERROR("failed to open {}", path.generic_string());
+            return false;
+        }
+        ibl_file.write(reinterpret_cast<const char*>(file_data.data()), file_data.size());
+        return ibl_file.good();
+    }
+
+    bool loadIBLFile(const std::shared_ptr<AssetFile>& ibl_file,
+                     const std::string&                ibl_url,
+                     uint64_t                          source_hash,
+                     IBLData&                          out_ibl_data)
+    {
+        if (!ibl_file)
+        {
+            LOG_ERROR("failed to open ibl file {}", ibl_url);
+            return false;
+        }
+        const size_t file_size = ibl_file->getSize();
+
+        IBLFileHeader header;
+        if (file_size < sizeof(header))
+        {
+            LOG_ERROR("ibl file {} is truncated", ibl_url);
+            return false;
+        }
+        std::memcpy(&header, ibl_file->getData(), sizeof(header));
+        if (header.m_magic != k_ibl_file_magic || header.m_version != k_ibl_file_version)
+        {
+            LOG_ERROR("ibl file {} has an unknown format or version {}", ibl_url, header.m_version);
+            return false;
+        }
+        if (header.m_source_hash != source_hash)
+        {
+            // cooked from another skybox, not an error
+            return false;
+        }
+
+        const RHIFormat format = static_cast<RHIFormat>(header.m_format);
+        // the upload path only reads the faces
+        uint8_t* data = const_cast<uint8_t*>(ibl_file->getData());
+        if ((format != RHI_FORMAT_R16G16B16A16_SFLOAT && format != RHI_FORMAT_E5B9G9R9_UFLOAT_PACK32) ||
+            !readCubemap(data,
+                         file_size,
+                         format,
+                         header.m_irradiance_size,
+                         header.m_irradiance_mip_levels,
+                         header.m_irradiance_offset,
+                         header.m_irradiance_face_size,
+                         out_ibl_data.m_irradiance) ||
+            !readCubemap(data,
+                         file_size,
+                         format,
+                         header.m_specular_size,
+                         header.m_specular_mip_levels,
+                         header.m_specular_offset,
+                         header.m_specular_face_size,
+                         out_ibl_data.m_specular))
+        {
+            LOG_ERROR("ibl file {} is corrupted", ibl_url);
+            return false;
+        }
+
+        out_ibl_data.m_format = format;
+        out_ibl_data.m_owner  = ibl_file;
+        return true;
+    }
+} // namespace Sammi
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "runtime/function/render/render_swap_context.h"
+#include "runtime/function/render/render_type.h"
+
+#include "runtime/resource/asset_manager/asset_file.h"
+
+#include <array>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace Sammi
+{
+    /// Cooked IBL container, little endian:
+    ///   IBLFileHeader | irradiance cubemap | specular cubemap
+    /// A cubemap is six faces in upload order (+X, -X, +Z, -Z, +Y, -Y), each face is its mip chain tightly packed
+    /// from the largest mip. The mips are the 2x2 box filtered chain the GPU used to generate at load time, so
+    /// shading is unchanged while the level load becomes one read and one copy per cubemap.
+    struct IBLFileHeader
+    {
+        uint32_t m_magic;
+        uint32_t m_version;
+        uint32_t m_format; // RHIFormat of both cubemaps
+        uint32_t m_reserved;
+        uint64_t m_source_hash;
+        uint32_t m_irradiance_size;
+        uint32_t m_irradiance_mip_levels;
+        uint32_t m_specular_size;
+        uint32_t m_specular_mip_levels;
+        uint64_t m_irradiance_offset;
+        uint64_t m_irradiance_face_size;
+        uint64_t m_specular_offset;
+        uint64_t m_specular_face_size;
+    };
+
+    constexpr uint32_t k_ibl_file_magic {0x4C424950}; // "PIBL"
+    constexpr uint32_t k_ibl_file_version {1};
+    constexpr uint64_t k_ibl_file_data_alignment {16};
+
+    enum class IBLCookFormat : uint8_t
+    {
+        rgba16f,  // 8 bytes per texel
+        e5b9g9r9, // shared exponent, 4 bytes per texel, no alpha
+    };
+
+    struct IBLCubemapData
+    {
+        uint32_t             m_size {0};
+        uint32_t             m_mip_levels {0};
+        std::array<void*, 6> m_faces {}; // upload order, each points at the mip chain of the face
+    };
+
+    struct IBLData
+    {
+        RHIFormat                   m_format {RHI_FORMAT_MAX_ENUM};
+        IBLCubemapData              m_irradiance;
+        IBLCubemapData              m_specular;
+        std::shared_ptr<const void> m_owner;
+    };
+
+    // the twelve face urls in upload order, irradiance first
+    std::array<std::string, 12> getIBLSourceUrls(const LevelIBLResourceDesc& ibl_resource_desc);
+    // identifies the face urls a cooked file was built from
+    uint64_t getIBLSourceHash(const LevelIBLResourceDesc& ibl_resource_desc);
+
+    // the faces are square RGBA32F images of one size per cubemap, in upload order
+    bool saveIBLFile(const std::filesystem::path&                       path,
+                     uint64_t                                           source_hash,
+                     const std::array<std::shared_ptr<TextureData>, 6>& irradiance_faces,
+                     const std::array<std::shared_ptr<TextureData>, 6>& specular_faces,
+                     IBLCookFormat                                      format);
+
+    // out_ibl_data points into the asset file and keeps it alive, fails when the file was cooked from other faces
+    bool loadIBLFile(const std::shared_ptr<AssetFile>& ibl_file,
+                     const std::string&                ibl_url,
+                     uint64_t                          source_hash,
+                     IBLData&                          out_ibl_data);
+} // namespace Sammi
@@ -0,0 +1,143 @@
+#include "runtime/function/render/render_mesh_file.h"
+
+#include "runtime/core/base/macro.h"
+
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <type_traits>
+
+namespace Sammi
+{
+    namespace
+    {
+        static_assert(std::is_trivially_copyable<MeshFileHeader>::value, "mesh file header is written as raw bytes");
+        static_assert(sizeof(MeshFileHeader) == 88, "mesh file header must not contain padding");
+
+        uint64_t alignBlobOffset(uint64_t offset)
+        {
+            return (offset + k_mesh_file_blob_alignment - 1) & ~(k_mesh_file_blob_alignment - 1);
+        }
+
+        size_t getBufferSize(const std::shared_ptr<BufferData>& buffer) { return buffer ? buffer->m_size : 0; }
+
+        bool isBlobInFile(uint64_t offset, uint64_t size, size_t file_size)
+        {
+            return offset % k_mesh_file_blob_alignment == 0 && offset <= file_size && size <= file_size - offset;
+        }
+    } // namespace
+
+    bool saveMeshFile(const std::filesystem::path& path,
+                      const RenderMeshData&        mesh_data,
+                      const AxisAlignedBox&        bounding_box)
+    {
+        const StaticMeshData& static_mesh_data = mesh_data.m_static_mesh_data;
+        const size_t          vertex_size      = getBufferSize(static_mesh_data.m_vertex_buffer);
+        const size_t          index_size       = getBufferSize(static_mesh_data.m_index_buffer);
+        const size_t          binding_size     = getBufferSize(mesh_data.m_skeleton_binding_buffer);
+
+        MeshFileHeader header {};
+        header.m_magic          = k_mesh_file_magic;
+        header.m_version        = k_mesh_file_version;
+        header.m_flags          = mesh_data.m_skeleton_binding_buffer ? k_mesh_file_flag_skinned : 0;
+        header.m_vertex_stride  = sizeof(MeshVertexDataDefinition);
+        header.m_vertex_count   = static_cast<uint32_t>(vertex_size / sizeof(MeshVertexDataDefinition));
+        header.m_index_stride   = getIndexTypeSize(static_mesh_data.m_index_type);
+        header.m_index_count    = static_cast<uint32_t>(index_size / header.m_index_stride);
+        header.m_binding_stride = sizeof(MeshVertexBindingDataDefinition);
+        header.m_binding_count  = static_cast<uint32_t>(binding_size / sizeof(MeshVertexBindingDataDefinition));
+        for (size_t i = 0; i < 3; i++)
+        {
+            header.m_bounds_min[i] = bounding_box.getMinCorner()[i];
+            header.m_bounds_max[i] = bounding_box.getMaxCorner()[i];
+        }
+        header.m_vertex_offset  = alignBlobOffset(sizeof(MeshFileHeader));
+        header.m_index_offset   = alignBlobOffset(header.m_vertex_offset + vertex_size);
+        header.m_binding_offset = alignBlobOffset(header.m_index_offset + index_size);
+
+        std::vector<uint8_t> file_data(header.m_binding_offset + binding_size, 0);
+        std::memcpy(file_data.data(), &header, sizeof(header));
+        if (vertex_size > 0)
+        {
+            std::memcpy(file_data.data() + header.m_vertex_offset, static_mesh_data.m_vertex_buffer->m_data, vertex_size);
+        }
+        if (index_size > 0)
+        {
+            std::memcpy(file_data.data() + header.m_index_offset, static_mesh_data.m_index_buffer->m_data, index_size);
+        }
+        if (binding_size > 0)
+        {
+            std::memcpy(
+                file_data.data() + header.m_binding_offset, mesh_data.m_skeleton_binding_buffer->m_data, binding_size);
+        }
+
+        std::ofstream mesh_file(path, std::ios::binary);
+        if (!mesh_file)
+        {
+            LOG_ERROR("failed to open {}", path.generic_string());
+            return false;
+        }
+        mesh_file.write(reinterpret_cast<const char*>(file_data.data()), file_data.size());
+        return mesh_file.good();
+    }
+
+    bool loadMeshFile(const std::shared_ptr<AssetFile>& mesh_file,
+                      const std::string&                mesh_url,
+                      RenderMeshData&                   out_mesh_data,
+                      AxisAlignedBox&                   out_bounding_box)
+    {
+        if (!mesh_file)
+        {
+            LOG_ERROR("failed to open mesh file {}", mesh_url);
+            return false;
+        }
+        const size_t file_size = mesh_file->getSize();
+
+        MeshFileHeader header;
+        if (file_size < sizeof(header))
+        {
+            LOG_ERROR("mesh file {} is truncated", mesh_url);
+            return false;
+        }
+        std::memcpy(&header, mesh_file->getData(), sizeof(header));
+        if (header.m_magic != k_mesh_file_magic || header.m_version != k_mesh_file_version)
+        {
+            LOG_ERROR("mesh file {} has an unknown format or version {}", mesh_url, header.m_version);
+            return false;
+        }
+
+        const uint64_t vertex_size  = static_cast<uint64_t>(header.m_vertex_count) * header.m_vertex_stride;
+        const uint64_t index_size   = static_cast<uint64_t>(header.m_index_count) * header.m_index_stride;
+        const uint64_t binding_size = static_cast<uint64_t>(header.m_binding_count) * header.m_binding_stride;
+        if (header.m_vertex_stride != sizeof(MeshVertexDataDefinition) || (header.m_index_stride != sizeof(uint16_t) && header.m_index_stride != sizeof(uint32_t)) ||
+            header.m_binding_stride != sizeof(MeshVertexBindingDataDefinition) ||
+            !isBlobInFile(header.m_vertex_offset, vertex_size, file_size) ||
+            !isBlobInFile(header.m_index_offset, index_size, file_size) ||
+            !isBlobInFile(header.m_binding_offset, binding_size, file_size))
+        {
+            LOG_ERROR("mesh file {} is corrupted", mesh_url);
+            return false;
+        }
+
+        // the buffers are only read by the upload path
+        uint8_t*                    data  = const_cast<uint8_t*>(mesh_file->getData());
+        std::shared_ptr<const void> owner = mesh_file;
+        out_mesh_data.m_static_mesh_data.m_vertex_buffer =
+            std::make_shared<BufferData>(data + header.m_vertex_offset, vertex_size, owner);
+        out_mesh_data.m_static_mesh_data.m_index_buffer =
+            std::make_shared<BufferData>(data + header.m_index_offset, index_size, owner);
+        out_mesh_data.m_static_mesh_data.m_index_type =
+            header.m_index_stride == sizeof(uint32_t) ? RHI_INDEX_TYPE_UINT32 : RHI_INDEX_TYPE_UINT16;
+        out_mesh_data.m_skeleton_binding_buffer =
+            (header.m_flags & k_mesh_file_flag_skinned) ?
+                std::make_shared<BufferData>(data + header.m_binding_offset, binding_size, owner) :
+                nullptr;
+
+        if (header.m_vertex_count > 0)
+        {
+            out_bounding_box.merge(Vector3(header.m_bounds_min[0], header.m_bounds_min[1], header.m_bounds_min[2]));
+            out_bounding_box.merge(Vector3(header.m_bounds_max[0], header.m_bounds_max[1], header.m_bounds_max[2]));
+        }
+        return true;
+    }
+} // namespace Sammi
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "runtime/function/render/render_type.h"
+
+#include "runtime/core/math/axis_aligned.h"
+#include "runtime/resource/asset_manager/asset_file.h"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace Sammi
+{
+    /// Cooked mesh container, little endian:
+    ///   MeshFileHeader | vertex blob | index blob | skeleton binding blob
+    /// Every blob starts at a multiple of k_mesh_file_blob_alignment and holds exactly the data the renderer
+    /// consumes (MeshVertexDataDefinition, 16 or 32 bit indices, MeshVertexBindingDataDefinition), so a mapped
+    /// file is handed to the upload path without any per-vertex conversion.
+    struct MeshFileHeader
+    {
+        uint32_t m_magic;
+        uint32_t m_version;
+        uint32_t m_flags;
+        uint32_t m_reserved;
+        uint32_t m_vertex_count;
+        uint32_t m_vertex_stride;
+        uint32_t m_index_count;
+        uint32_t m_index_stride;
+        uint32_t m_binding_count;
+        uint32_t m_binding_stride;
+        float    m_bounds_min[3];
+        float    m_bounds_max[3];
+        uint64_t m_vertex_offset;
+        uint64_t m_index_offset;
+        uint64_t m_binding_offset;
+    };
+
+    constexpr uint32_t k_mesh_file_magic {0x48534D50}; // "PMSH"
+    constexpr uint32_t k_mesh_file_version {1};
+    constexpr uint64_t k_mesh_file_blob_alignment {16};
+    // the mesh uploads skeleton bindings and is drawn with vertex blending
+    constexpr uint32_t k_mesh_file_flag_skinned {1u << 0};
+
+    bool saveMeshFile(const std::filesystem::path& path,
+                      const RenderMeshData&        mesh_data,
+                      const AxisAlignedBox&        bounding_box);
+
+    // the returned buffers point into the asset file (the mapped loose file or the pak), which is kept alive until the
+    // last of them is released
+    bool loadMeshFile(const std::shared_ptr<AssetFile>& mesh_file,
+                      const std::string&                mesh_url,
+                      RenderMeshData&                   out_mesh_data,
+                      AxisAlignedBox&                   out_bounding_box);
+} // namespace Sammi
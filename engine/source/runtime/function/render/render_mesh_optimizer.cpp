@@ -0,0 +1,357 @@
+#include "runtime/function/render/render_mesh_optimizer.h"
+
+#include "runtime/core/math/vector3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Sammi
+{
+    namespace
+    {
+        // Forsyth, "Linear-Speed Vertex Cache Optimisation", with his suggested constants
+        constexpr size_t k_forsyth_cache_size {32};
+        constexpr float  k_forsyth_cache_decay_power {1.5f};
+        constexpr float  k_forsyth_last_triangle_score {0.75f};
+        constexpr float  k_forsyth_valence_boost_scale {2.0f};
+        constexpr float  k_forsyth_valence_boost_power {0.5f};
+
+        constexpr uint32_t k_unmapped_vertex {std::numeric_limits<uint32_t>::max()};
+
+        float calculateVertexScore(int32_t cache_position, uint32_t remaining_triangle_count)
+        {
+            if (remaining_triangle_count == 0)
+            {
+                return -1.0f;
+            }
+
+            float score = 0.0f;
+            if (cache_position >= 0)
+            {
+                // the vertices of the last triangle get a fixed score so it is not reused right away
+                if (cache_position < 3)
+                {
+                    score = k_forsyth_last_triangle_score;
+                }
+                else
+                {
+                    const float scale = 1.0f / static_cast<float>(k_forsyth_cache_size - 3);
+                    score = std::pow(1.0f - static_cast<float>(cache_position - 3) * scale, k_forsyth_cache_decay_power);
+                }
+            }
+
+            // favor vertices with few triangles left, so they leave the working set early
+            score += k_forsyth_valence_boost_scale *
+                     std::pow(static_cast<float>(remaining_triangle_count), -k_forsyth_valence_boost_power);
+            return score;
+        }
+
+        std::vector<uint32_t> optimizeVertexCacheOrder(const std::vector<uint32_t>& indices, size_t vertex_count)
+        {
+            const size_t triangle_count = indices.size() / 3;
+
+            // triangles of each vertex, the first live_triangle_counts[v] entries are not emitted yet
+            std::vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+            for (uint32_t index : indices)
+            {
+                adjacency_offsets[index + 1]++;
+            }
+            for (size_t i = 0; i < vertex_count; i++)
+            {
+                adjacency_offsets[i + 1] += adjacency_offsets[i];
+            }
+            std::vector<uint32_t> adjacency(indices.size());
+            std::vector<uint32_t> live_triangle_counts(vertex_count, 0);
+            for (size_t triangle = 0; triangle < triangle_count; triangle++)
+            {
+                for (size_t corner = 0; corner < 3; corner++)
+                {
+                    const uint32_t vertex = indices[triangle * 3 + corner];
+                    adjacency[adjacency_offsets[vertex] + live_triangle_counts[vertex]++] = static_cast<uint32_t>(triangle);
+                }
+            }
+
+            std::vector<int32_t> cache_positions(vertex_count, -1);
+            std::vector<float>   vertex_scores(vertex_count);
+            for (size_t vertex = 0; vertex < vertex_count; vertex++)
+            {
+                vertex_scores[vertex] = calculateVertexScore(-1, live_triangle_counts[vertex]);
+            }
+
+            auto triangle_score = [&](size_t triangle) {
+                return vertex_scores[indices[triangle * 3 + 0]] + vertex_scores[indices[triangle * 3 + 1]] +
+                       vertex_scores[indices[triangle * 3 + 2]];
+            };
+
+            std::vector<bool>     emitted(triangle_count, false);
+            std::vector<uint32_t> cache;
+            std::vector<uint32_t> new_cache;
+            std::vector<uint32_t> result;
+            cache.reserve(k_forsyth_cache_size + 3);
+            new_cache.reserve(k_forsyth_cache_size + 3);
+            result.reserve(triangle_count * 3);
+
+            size_t  input_cursor  = 0;
+            int64_t best_triangle = -1;
+            for (size_t emitted_count = 0; emitted_count < triangle_count; emitted_count++)
+            {
+                if (best_triangle < 0)
+                {
+                    // nothing in the cache has triangles left, continue with the next one in input order
+                    while (emitted[input_cursor])
+                    {
+                        input_cursor++;
+                    }
+                    best_triangle = static_cast<int64_t>(input_cursor);
+                }
+
+                const uint32_t* triangle_indices = &indices[static_cast<size_t>(best_triangle) * 3];
+                result.insert(result.end(), triangle_indices, triangle_indices + 3);
+                emitted[static_cast<size_t>(best_triangle)] = true;
+
+                // the emitted vertices move to the front of the cache
+                new_cache.clear();
+                for (size_t corner = 0; corner < 3; corner++)
+                {
+                    const uint32_t vertex = triangle_indices[corner];
+                    if (std::find(new_cache.begin(), new_cache.end(), vertex) == new_cache.end())
+                    {
+                        new_cache.push_back(vertex);
+                    }
+
+                    auto live_begin = adjacency.begin() + adjacency_offsets[vertex];
+                    auto live_end   = live_begin + live_triangle_counts[vertex];
+                    auto found      = std::find(live_begin, live_end, static_cast<uint32_t>(best_triangle));
+                    std::iter_swap(found, live_end - 1);
+                    live_triangle_counts[vertex]--;
+                }
+                for (uint32_t vertex : cache)
+                {
+                    if (std::find(new_cache.begin(), new_cache.end(), vertex) == new_cache.end())
+                    {
+                        new_cache.push_back(vertex);
+                    }
+                }
+
+                // vertices pushed past the cache size get their out of cache score back
+                for (size_t i = 0; i < new_cache.size(); i++)
+                {
+                    const uint32_t vertex   = new_cache[i];
+                    cache_positions[vertex] = i < k_forsyth_cache_size ? static_cast<int32_t>(i) : -1;
+                    vertex_scores[vertex]   = calculateVertexScore(cache_positions[vertex], live_triangle_counts[vertex]);
+                }
+                if (new_cache.size() > k_forsyth_cache_size)
+                {
+                    new_cache.resize(k_forsyth_cache_size);
+                }
+                cache.swap(new_cache);
+
+                // only triangles touching the cache changed their score
+                best_triangle    = -1;
+                float best_score = -std::numeric_limits<float>::max();
+                for (uint32_t vertex : cache)
+                {
+                    const uint32_t* live_triangles = &adjacency[adjacency_offsets[vertex]];
+                    for (uint32_t i = 0; i < live_triangle_counts[vertex]; i++)
+                    {
+                        const float score = triangle_score(live_triangles[i]);
+                        if (score > best_score)
+                        {
+                            best_score    = score;
+                            best_triangle = live_triangles[i];
+                        }
+                    }
+                }
+            }
+
+            return result;
+        }
+
+        // clusters start where the simulated cache misses all three vertices, they are then sorted so that
+        // clusters facing away from the mesh center, which tend to occlude the rest, are drawn first
+        std::vector<uint32_t> optimizeOverdrawOrder(const std::vector<uint32_t>&    indices,
+                                                    const MeshVertexDataDefinition* vertices,
+                                                    size_t                          vertex_count)
+        {
+            const size_t triangle_count = indices.size() / 3;
+
+            std::vector<size_t>   cluster_starts;
+            std::vector<uint32_t> cache_timestamps(vertex_count, 0);
+            uint32_t              timestamp = k_mesh_statistics_cache_size + 1;
+            for (size_t triangle = 0; triangle < triangle_count; triangle++)
+            {
+                uint32_t misses = 0;
+                for (size_t corner = 0; corner < 3; corner++)
+                {
+                    const uint32_t vertex = indices[triangle * 3 + corner];
+                    if (timestamp - cache_timestamps[vertex] > k_mesh_statistics_cache_size)
+                    {
+                        cache_timestamps[vertex] = timestamp++;
+                        misses++;
+                    }
+                }
+                if (triangle == 0 || misses == 3)
+                {
+                    cluster_starts.push_back(triangle);
+                }
+            }
+            if (cluster_starts.size() < 2)
+            {
+                return indices;
+            }
+            cluster_starts.push_back(triangle_count);
+
+            auto position = [&](uint32_t vertex) {
+                return Vector3(vertices[vertex].x, vertices[vertex].y, vertices[vertex].z);
+            };
+
+            // area weighted centroids and normals
+            const size_t         cluster_count = cluster_starts.size() - 1;
+            std::vector<Vector3> cluster_centroids(cluster_count, Vector3::ZERO);
+            std::vector<Vector3> cluster_normals(cluster_count, Vector3::ZERO);
+            Vector3              mesh_centroid = Vector3::ZERO;
+            float                mesh_area     = 0.0f;
+            for (size_t cluster = 0; cluster < cluster_count; cluster++)
+            {
+                float cluster_area = 0.0f;
+                for (size_t triangle = cluster_starts[cluster]; triangle < cluster_starts[cluster + 1]; triangle++)
+                {
+                    const Vector3 p0 = position(indices[triangle * 3 + 0]);
+                    const Vector3 p1 = position(indices[triangle * 3 + 1]);
+                    const Vector3 p2 = position(indices[triangle * 3 + 2]);
+
+                    const Vector3 face_axis = (p1 - p0).crossProduct(p2 - p0);
+                    const float   area      = 0.5f * face_axis.length();
+
+                    cluster_centroids[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+                    cluster_normals[cluster] += face_axis;
+                    cluster_area += area;
+                }
+                mesh_centroid += cluster_centroids[cluster];
+                mesh_area += cluster_area;
+                if (cluster_area > 0.0f)
+                {
+                    cluster_centroids[cluster] /= cluster_area;
+                }
+            }
+            if (mesh_area > 0.0f)
+            {
+                mesh_centroid /= mesh_area;
+            }
+
+            std::vector<float>  cluster_sort_keys(cluster_count);
+            std::vector<size_t> cluster_order(cluster_count);
+            for (size_t cluster = 0; cluster < cluster_count; cluster++)
+            {
+                const float normal_length   = cluster_normals[cluster].length();
+                cluster_sort_keys[cluster] = normal_length > 0.0f ? (cluster_centroids[cluster] - mesh_centroid)
+                                                                          .dotProduct(cluster_normals[cluster]) /
+                                                                      normal_length :
+                                                                  0.0f;
+                cluster_order[cluster] = cluster;
+            }
+            std::stable_sort(cluster_order.begin(), cluster_order.end(), [&](size_t lhs, size_t rhs) {
+                return cluster_sort_keys[lhs] > cluster_sort_keys[rhs];
+            });
+
+            std::vector<uint32_t> result;
+            result.reserve(indices.size());
+            for (size_t cluster : cluster_order)
+            {
+                result.insert(result.end(),
+                              indices.begin() + cluster_starts[cluster] * 3,
+                              indices.begin() + cluster_starts[cluster + 1] * 3);
+            }
+            return result;
+        }
+
+        template<typename T>
+        void permuteVertices(T* data, const std::vector<uint32_t>& remap)
+        {
+            std::vector<T> source(data, data + remap.size());
+            for (size_t vertex = 0; vertex < remap.size(); vertex++)
+            {
+                data[remap[vertex]] = source[vertex];
+            }
+        }
+    } // namespace
+
+    void analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertex_count, float& out_acmr, float& out_atvr)
+    {
+        std::vector<uint32_t> cache_timestamps(vertex_count, 0);
+        uint32_t              timestamp = k_mesh_statistics_cache_size + 1;
+        size_t                misses    = 0;
+        for (uint32_t vertex : indices)
+        {
+            if (timestamp - cache_timestamps[vertex] > k_mesh_statistics_cache_size)
+            {
+                cache_timestamps[vertex] = timestamp++;
+                misses++;
+            }
+        }
+
+        const size_t triangle_count = indices.size() / 3;
+        out_acmr = triangle_count > 0 ? static_cast<float>(misses) / static_cast<float>(triangle_count) : 0.0f;
+        out_atvr = vertex_count > 0 ? static_cast<float>(misses) / static_cast<float>(vertex_count) : 0.0f;
+    }
+
+    MeshOptimizationReport optimizeMesh(std::vector<uint32_t>&           indices,
+                                        MeshVertexDataDefinition*        vertices,
+                                        MeshVertexBindingDataDefinition* bindings,
+                                        size_t                           vertex_count,
+                                        const MeshOptimizationSettings&  settings)
+    {
+        MeshOptimizationReport report;
+        analyzeVertexCache(indices, vertex_count, report.m_acmr_before, report.m_atvr_before);
+
+        if (settings.m_enable_vertex_cache_optimization)
+        {
+            indices = optimizeVertexCacheOrder(indices, vertex_count);
+        }
+
+        if (settings.m_enable_overdraw_optimization)
+        {
+            std::vector<uint32_t> overdraw_indices = optimizeOverdrawOrder(indices, vertices, vertex_count);
+
+            float cache_acmr, overdraw_acmr, atvr;
+            analyzeVertexCache(indices, vertex_count, cache_acmr, atvr);
+            analyzeVertexCache(overdraw_indices, vertex_count, overdraw_acmr, atvr);
+            if (overdraw_acmr <= cache_acmr * settings.m_overdraw_acmr_threshold)
+            {
+                indices.swap(overdraw_indices);
+            }
+        }
+
+        if (settings.m_enable_vertex_fetch_optimization)
+        {
+            // number the vertices in first use order, unreferenced ones go to the end
+            std::vector<uint32_t> remap(vertex_count, k_unmapped_vertex);
+            uint32_t              next_vertex = 0;
+            for (uint32_t& index : indices)
+            {
+                if (remap[index] == k_unmapped_vertex)
+                {
+                    remap[index] = next_vertex++;
+                }
+                index = remap[index];
+            }
+            for (uint32_t& mapped_vertex : remap)
+            {
+                if (mapped_vertex == k_unmapped_vertex)
+                {
+                    mapped_vertex = next_vertex++;
+                }
+            }
+
+            permuteVertices(vertices, remap);
+            if (bindings)
+            {
+                permuteVertices(bindings, remap);
+            }
+        }
+
+        analyzeVertexCache(indices, vertex_count, report.m_acmr_after, report.m_atvr_after);
+        return report;
+    }
+} // namespace Sammi
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "runtime/function/render/render_type.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Sammi
+{
+    struct MeshOptimizationSettings
+    {
+        bool m_enable_vertex_cache_optimization {true};
+        bool m_enable_vertex_fetch_optimization {true};
+        // sort triangle clusters front to back from the outside, costs a little cache efficiency
+        bool m_enable_overdraw_optimization {false};
+        // the overdraw order is dropped if it raises the ACMR above this factor of the cache optimized order
+        float m_overdraw_acmr_threshold {1.05f};
+    };
+
+    /// Post-transform cache statistics, simulated with a FIFO cache of k_mesh_statistics_cache_size entries.
+    /// ACMR is transformed vertices per triangle (0.5 is ideal for large regular grids, 3 is the worst),
+    /// ATVR is transformed vertices per vertex (1 is ideal).
+    struct MeshOptimizationReport
+    {
+        float m_acmr_before {0.0f};
+        float m_acmr_after {0.0f};
+        float m_atvr_before {0.0f};
+        float m_atvr_after {0.0f};
+    };
+
+    constexpr size_t k_mesh_statistics_cache_size {16};
+
+    void analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertex_count, float& out_acmr, float& out_atvr);
+
+    /// Reorders the triangles for post-transform cache reuse (Forsyth), optionally regroups them for less
+    /// overdraw (Tipsify-style clusters), then renumbers the vertices in first use order for fetch locality.
+    /// vertices and bindings (may be null) hold vertex_count entries and are permuted in place.
+    MeshOptimizationReport optimizeMesh(std::vector<uint32_t>&           indices,
+                                        MeshVertexDataDefinition*        vertices,
+                                        MeshVertexBindingDataDefinition* bindings,
+                                        size_t                           vertex_count,
+                                        const MeshOptimizationSettings&  settings);
+} // namespace Sammi
@@ -53,4 +53,41 @@ namespace Sammi
         }
         return layouts;
     }
+
+    void RenderPass::bindGeometryBuffer(RHIPipelineLayout* pipeline_layout, uint32_t vertex_stream_count)
+    {
+        bindGeometryBuffer(m_rhi->getCurrentCommandBuffer(), pipeline_layout, vertex_stream_count);
+    }
+
+    void RenderPass::bindGeometryBuffer(RHICommandBuffer*  command_buffer,
+                                        RHIPipelineLayout* pipeline_layout,
+                                        uint32_t           vertex_stream_count)
+    {
+        const GeometryBuffer& geometry_buffer = m_global_render_resource->_geometry_buffer;
+        // 尚未上传任何网格时几何缓冲区还未创建，此时也没有需要绘制的网格
+        if (geometry_buffer._index._buffer == nullptr)
+        {
+            return;
+        }
+
+        if (pipeline_layout != nullptr)
+        {
+            m_rhi->cmdBindDescriptorSetsPFN(command_buffer,
+                                            RHI_PIPELINE_BIND_POINT_GRAPHICS,
+                                            pipeline_layout,
+                                            1,
+                                            1,
+                                            &geometry_buffer._joint_binding_descriptor_set,
+                                            0,
+                                            NULL);
+        }
+
+        RHIBuffer*    vertex_buffers[] = {geometry_buffer._vertex_position._buffer,
+                                       geometry_buffer._vertex_varying_enable_blending._buffer,
+                                       geometry_buffer._vertex_varying._buffer};
+        RHIDeviceSize offsets[]        = {0, 0, 0};
+        assert(vertex_stream_count <= (sizeof(vertex_buffers) / sizeof(vertex_buffers[0])));
+        m_rhi->cmdBindVertexBuffersPFN(command_buffer, 0, vertex_stream_count, vertex_buffers, offsets);
+        m_rhi->cmdBindIndexBufferPFN(command_buffer, geometry_buffer._index._buffer, 0, RHI_INDEX_TYPE_UINT32);
+    }
 }
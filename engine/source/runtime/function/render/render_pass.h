@@ -133,6 +133,13 @@ namespace Sammi
         // 获取所有描述符集布局的列表（用于动态绑定资源）
         virtual std::vector<RHIDescriptorSetLayout*> getDescriptorSetLayouts() const;
 
+        // ============================== 几何缓冲区绑定 ==============================
+        // 绑定所有网格共享的前vertex_stream_count个顶点流（位置、法线切线、纹理坐标）、32位索引缓冲区
+        // 和关节绑定描述符集（set 1，pipeline_layout为空时不绑定），每个通道只需绑定一次，网格之间以firstIndex/vertexOffset区分
+        void bindGeometryBuffer(RHIPipelineLayout* pipeline_layout, uint32_t vertex_stream_count);
+        // 同上，录制到指定的命令缓冲区（并行录制的次级命令缓冲区不继承绑定，每个都需要绑定一次）
+        void bindGeometryBuffer(RHICommandBuffer* command_buffer, RHIPipelineLayout* pipeline_layout, uint32_t vertex_stream_count);
+
         // ============================== 静态成员 ==============================
         // 静态可见节点容器（全局可访问，存储当前帧可见对象）
         static VisiableNodes m_visiable_nodes;
@@ -9,6 +9,7 @@ namespace Sammi
     {
         m_rhi             = common_info.rhi;
         m_render_resource = common_info.render_resource;
+        m_command_recorder = common_info.command_recorder;
     }
 
     void RenderPassBase::preparePassData(std::shared_ptr<RenderResourceBase> render_resource) {}
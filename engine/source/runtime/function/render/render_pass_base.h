@@ -5,6 +5,7 @@
 namespace Sammi
 {
     class RHI;
+    class RenderCommandRecorder;
     class RenderResourceBase;
     class WindowUI;
 
@@ -18,6 +19,8 @@ namespace Sammi
     {
         std::shared_ptr<RHI>                rhi;
         std::shared_ptr<RenderResourceBase> render_resource;
+        // 多线程命令录制器，网格绘制较多的通道用它在次级命令缓冲区中并行录制
+        std::shared_ptr<RenderCommandRecorder> command_recorder;
     };
 
     // ============================== 渲染通道基类（抽象接口） ==============================
@@ -48,5 +51,6 @@ namespace Sammi
     protected:
         std::shared_ptr<RHI>                m_rhi;
         std::shared_ptr<RenderResourceBase> m_render_resource;
+        std::shared_ptr<RenderCommandRecorder> m_command_recorder;
     };
 }
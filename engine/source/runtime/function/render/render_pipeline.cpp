@@ -1,9 +1,11 @@
 #include "runtime/function/render/render_pipeline.h"
+#include "runtime/function/render/render_command_recorder.h"
 #include "runtime/function/render/interface/vulkan/vulkan_rhi.h"
 #include "runtime/function/render/passes/color_grading_pass.h"
 #include "runtime/function/render/passes/combine_ui_pass.h"
 #include "runtime/function/render/passes/directional_light_pass.h"
 #include "runtime/function/render/passes/main_camera_pass.h"
+#include "runtime/function/render/passes/mesh_culling_pass.h"
 #include "runtime/function/render/passes/pick_pass.h"
 #include "runtime/function/render/passes/point_light_pass.h"
 #include "runtime/function/render/passes/tone_mapping_pass.h"
@@ -11,6 +13,7 @@
 #include "runtime/function/render/passes/particle_pass.h"
 #include "runtime/function/render/debugdraw/debug_draw_manager.h"
 #include "runtime/core/base/macro.h"
+#include "runtime/core/base/thread_pool.h"
 
 namespace Sammi
 {
@@ -27,11 +30,16 @@ namespace Sammi
         m_pick_pass               = std::make_shared<PickPass>();                    // ʰȡͨ⣩
         m_fxaa_pass               = std::make_shared<FXAAPass>();                    // FXAAͨ
         m_particle_pass           = std::make_shared<ParticlePass>();                // ϵͳͨ
+        m_mesh_culling_pass       = std::make_shared<MeshCullingPass>();             // ޳ͨGPUƣ
+
+        // ߳¼¼߳ΪȾ߳ȫ̳߳صĹ߳
+        m_command_recorder = std::make_shared<RenderCommandRecorder>(m_rhi, g_runtime_global_context.m_thread_pool.get());
 
         // ȾͨϢͨĻã
         RenderPassCommonInfo pass_common_info;
         pass_common_info.rhi = m_rhi;                                  // ȾӲӿڣʵײAPI
         pass_common_info.render_resource = init_info.render_resource;  // ȾԴ/
+        pass_common_info.command_recorder = m_command_recorder;        // ߳¼μ
 
         // ΪȾͨùϢ
         m_point_light_shadow_pass->setCommonInfo(pass_common_info);
@@ -44,10 +52,13 @@ namespace Sammi
         m_pick_pass->setCommonInfo(pass_common_info);
         m_fxaa_pass->setCommonInfo(pass_common_info);
         m_particle_pass->setCommonInfo(pass_common_info);
+        m_mesh_culling_pass->setCommonInfo(pass_common_info);
 
         // ʼӰȾͨ޶
         m_point_light_shadow_pass->initialize(nullptr);
         m_directional_light_pass->initialize(nullptr);
+        // ͨGPUʱҪ޳ͨʵ֣ȳʼ
+        m_mesh_culling_pass->initialize(nullptr);
 
         // תȡͨľָ룩
         std::shared_ptr<MainCameraPass> main_camera_pass = std::static_pointer_cast<MainCameraPass>(m_main_camera_pass);
@@ -72,6 +83,7 @@ namespace Sammi
         main_camera_init_info.enble_fxaa = init_info.enable_fxaa;
         // ͨãȾӣ
         main_camera_pass->setParticlePass(particle_pass);
+        main_camera_pass->setMeshCullingPass(std::static_pointer_cast<MeshCullingPass>(m_mesh_culling_pass));
         // ִͨʼȡ֡塢ȾͨԴ
         m_main_camera_pass->initialize(&main_camera_init_info);
 
@@ -130,10 +142,13 @@ namespace Sammi
         RenderResource* vulkan_resource = static_cast<RenderResource*>(render_resource.get());
 
         vulkan_resource->resetRingBufferOffset(vulkan_rhi->m_current_frame_index);
+        vulkan_resource->releaseRetiredGeometryBuffers(rhi);
 
         vulkan_rhi->waitForFences();
 
         vulkan_rhi->resetCommandPool();
+        // ֡դѵȴ¼̵߳ؿ
+        m_command_recorder->beginFrame();
 
         bool recreate_swapchain =
             vulkan_rhi->prepareBeforePass(std::bind(&RenderPipeline::passUpdateAfterRecreateSwapchain, this));
@@ -146,6 +161,9 @@ namespace Sammi
 
         static_cast<PointLightShadowPass*>(m_point_light_shadow_pass.get())->draw();
 
+        // Ⱦͨʼǰ޳ɼӻ
+        static_cast<MeshCullingPass*>(m_mesh_culling_pass.get())->draw();
+
         ColorGradingPass& color_grading_pass = *(static_cast<ColorGradingPass*>(m_color_grading_pass.get()));
         FXAAPass&         fxaa_pass          = *(static_cast<FXAAPass*>(m_fxaa_pass.get()));
         ToneMappingPass&  tone_mapping_pass  = *(static_cast<ToneMappingPass*>(m_tone_mapping_pass.get()));
@@ -180,10 +198,13 @@ namespace Sammi
         RenderResource* vulkan_resource = static_cast<RenderResource*>(render_resource.get());
 
         vulkan_resource->resetRingBufferOffset(vulkan_rhi->m_current_frame_index);
+        vulkan_resource->releaseRetiredGeometryBuffers(rhi);
 
         vulkan_rhi->waitForFences();
 
         vulkan_rhi->resetCommandPool();
+        // ֡դѵȴ¼̵߳ؿ
+        m_command_recorder->beginFrame();
 
         bool recreate_swapchain =
             vulkan_rhi->prepareBeforePass(std::bind(&RenderPipeline::passUpdateAfterRecreateSwapchain, this));
@@ -196,6 +217,9 @@ namespace Sammi
 
         static_cast<PointLightShadowPass*>(m_point_light_shadow_pass.get())->draw();
 
+        // Ⱦͨʼǰ޳ɼӻ
+        static_cast<MeshCullingPass*>(m_mesh_culling_pass.get())->draw();
+
         ColorGradingPass& color_grading_pass = *(static_cast<ColorGradingPass*>(m_color_grading_pass.get()));
         FXAAPass&         fxaa_pass          = *(static_cast<FXAAPass*>(m_fxaa_pass.get()));
         ToneMappingPass&  tone_mapping_pass  = *(static_cast<ToneMappingPass*>(m_tone_mapping_pass.get()));
@@ -264,4 +288,19 @@ namespace Sammi
         MainCameraPass& main_camera_pass = *(static_cast<MainCameraPass*>(m_main_camera_pass.get()));
         main_camera_pass.m_selected_axis = selected_axis;
     }
+
+    void RenderPipeline::setGpuDrivenMeshDrawEnabled(bool enabled)
+    {
+        static_cast<MeshCullingPass*>(m_mesh_culling_pass.get())->setEnabled(enabled);
+    }
+
+    bool RenderPipeline::isGpuDrivenMeshDrawActive() const
+    {
+        return static_cast<const MeshCullingPass*>(m_mesh_culling_pass.get())->isActive();
+    }
+
+    void RenderPipeline::updateMeshInstances(const RenderScene& render_scene, RenderResource& render_resource)
+    {
+        static_cast<MeshCullingPass*>(m_mesh_culling_pass.get())->updateInstances(render_scene, render_resource);
+    }
 }
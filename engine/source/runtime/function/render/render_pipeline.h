@@ -4,6 +4,9 @@
 
 namespace Sammi
 {
+    class RenderResource;
+    class RenderScene;
+
     /**
      * @brief Ⱦʵ̳ࣨRenderPipelineBase
      *
@@ -75,5 +78,26 @@ namespace Sammi
          * ͨUIؼû
          */
         void setSelectedAxis(size_t selected_axis);
+
+        /**
+         * @brief GPU
+         * @param enabled true=GPU׶޳ӻƣfalse=CPU޳λƣڶԱȣ
+         * 豸֧drawIndirectFirstInstanceʱʼʹCPU·
+         */
+        void setGpuDrivenMeshDrawEnabled(bool enabled);
+
+        /**
+         * @brief ǰǷGPU
+         * ΪtrueʱCPU޳ɼ壬޳ͨɡ
+         */
+        bool isGpuDrivenMeshDrawActive() const;
+
+        /**
+         * @brief ѳ֡仯ʵ彻޳ͨ
+         * @param render_scene Ⱦֻȡ޸Ļɾʵ
+         * @param render_resource ȾԴṩʵͲʣ
+         * ʵGPUϳ־ñ棬ֻϴ仯ʵʵɾ񡢲ʱؽΡ
+         */
+        void updateMeshInstances(const RenderScene& render_scene, RenderResource& render_resource);
     };
 }
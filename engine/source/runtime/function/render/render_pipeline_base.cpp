@@ -22,6 +22,9 @@ namespace Sammi
         // ׼ϵͳȾͨݣλáڡʲȣ
         m_particle_pass->preparePassData(render_resource);
 
+        // ׼޳ͨݣ׶壩
+        m_mesh_culling_pass->preparePassData(render_resource);
+
         // ȫֵԻƹ׼ĻƲ
         g_runtime_global_context.m_debugdraw_manager->preparePassData(render_resource);
     }
@@ -12,6 +12,7 @@ namespace Sammi
     class RHI;// ȾӲӿڣײAPIVulkan/DirectX
     class RenderResourceBase;// ȾԴࣨԴ
     class WindowUI;// UIȾࣨUIƣ
+    class RenderCommandRecorder;// ߳¼ڴμв¼ƻƣ
 
     /**
      * @brief Ⱦ߳ʼϢṹ
@@ -97,6 +98,9 @@ namespace Sammi
     protected:
         std::shared_ptr<RHI> m_rhi;  // ȾӲӿʵʵײAPIĺľ
 
+        // ߳¼ͨĴμÿ֡ÿ¼̵߳أ
+        std::shared_ptr<RenderCommandRecorder> m_command_recorder;
+
         // Ⱦͨϣ׶Ⱦִߣ
         std::shared_ptr<RenderPassBase> m_directional_light_pass;   // ȾͨӰ/գ
         std::shared_ptr<RenderPassBase> m_point_light_shadow_pass;  // ԴӰȾͨɵԴӰͼ
@@ -108,5 +112,6 @@ namespace Sammi
         std::shared_ptr<RenderPassBase> m_combine_ui_pass;          // UIϳͨϲUIϷ棩
         std::shared_ptr<RenderPassBase> m_pick_pass;                // ʰȡȾͨʰȡ/ID
         std::shared_ptr<RenderPassBase> m_particle_pass;            // ϵͳȾͨЧ
+        std::shared_ptr<RenderPassBase> m_mesh_culling_pass;        // ޳ͨGPU޳ɼӻ
     };
 }
@@ -0,0 +1,125 @@
+#include "runtime/function/render/render_queue.h"
+
+#include <algorithm>
+
+namespace Sammi
+{
+    uint64_t RenderQueue::makeSortKey(uint32_t material_sort_id, uint32_t mesh_sort_id, uint32_t depth)
+    {
+        const uint64_t material_bits = material_sort_id & ((1u << s_material_bits) - 1);
+        const uint64_t mesh_bits     = mesh_sort_id & ((1u << s_mesh_bits) - 1);
+        const uint64_t depth_bits    = depth & ((1u << s_depth_bits) - 1);
+        return (material_bits << (s_mesh_bits + s_depth_bits)) | (mesh_bits << s_depth_bits) | depth_bits;
+    }
+
+    void RenderQueue::build(const std::vector<RenderMeshNode>& nodes,
+                            bool                               sort_by_material,
+                            const Matrix4x4*                   proj_view_matrix)
+    {
+        clear();
+        m_nodes = &nodes;
+        m_items.reserve(nodes.size());
+
+        const float max_depth = static_cast<float>((1u << s_depth_bits) - 1);
+        for (size_t node_index = 0; node_index < nodes.size(); ++node_index)
+        {
+            const RenderMeshNode& node = nodes[node_index];
+
+            uint32_t depth = 0;
+            if (proj_view_matrix)
+            {
+                const Vector4 clip_position = (*proj_view_matrix) * Vector4(node.model_matrix->getTrans(), 1.0f);
+                if (clip_position.w > 0.0f)
+                {
+                    const float ndc_depth = std::clamp(clip_position.z / clip_position.w, 0.0f, 1.0f);
+                    depth                 = static_cast<uint32_t>(ndc_depth * max_depth);
+                }
+            }
+
+            const uint32_t material_sort_id = sort_by_material ? node.ref_material->sort_id : 0;
+            push(makeSortKey(material_sort_id, node.ref_mesh->sort_id, depth), static_cast<uint32_t>(node_index));
+        }
+
+        sort();
+    }
+
+    void RenderQueue::clear()
+    {
+        m_items.clear();
+        m_nodes = nullptr;
+    }
+
+    void RenderQueue::push(uint64_t sort_key, uint32_t node_index) { m_items.push_back({sort_key, node_index}); }
+
+    void RenderQueue::sort()
+    {
+        const size_t item_count = m_items.size();
+        if (item_count < 2)
+            return;
+
+        // the histograms of all digits in one pass over the keys
+        constexpr uint32_t digit_count = sizeof(uint64_t);
+        uint32_t           histograms[digit_count][256] = {};
+        for (const RenderQueueItem& item : m_items)
+        {
+            for (uint32_t digit = 0; digit < digit_count; ++digit)
+            {
+                ++histograms[digit][(item.m_sort_key >> (digit * 8)) & 0xFF];
+            }
+        }
+
+        m_sort_buffer.resize(item_count);
+        RenderQueueItem* src = m_items.data();
+        RenderQueueItem* dst = m_sort_buffer.data();
+        for (uint32_t digit = 0; digit < digit_count; ++digit)
+        {
+            const uint32_t shift     = digit * 8;
+            uint32_t*      histogram = histograms[digit];
+
+            // every key has the same digit, the pass would not move anything
+            if (histogram[(src[0].m_sort_key >> shift) & 0xFF] == item_count)
+                continue;
+
+            uint32_t offset = 0;
+            for (uint32_t bucket = 0; bucket < 256; ++bucket)
+            {
+                const uint32_t count = histogram[bucket];
+                histogram[bucket]    = offset;
+                offset += count;
+            }
+
+            for (size_t i = 0; i < item_count; ++i)
+            {
+                dst[histogram[(src[i].m_sort_key >> shift) & 0xFF]++] = src[i];
+            }
+            std::swap(src, dst);
+        }
+
+        if (src != m_items.data())
+        {
+            m_items.swap(m_sort_buffer);
+        }
+    }
+
+    RenderQueueRun RenderQueue::getRun(size_t begin, uint64_t mask) const
+    {
+        const uint64_t run_key = m_items[begin].m_sort_key & mask;
+
+        size_t end = begin + 1;
+        while (end < m_items.size() && (m_items[end].m_sort_key & mask) == run_key)
+        {
+            ++end;
+        }
+        return RenderQueueRun(*this, begin, end);
+    }
+
+    void RenderQueue::getRuns(uint64_t mask, std::vector<RenderQueueRun>& runs) const
+    {
+        runs.clear();
+        for (size_t begin = 0; begin < m_items.size();)
+        {
+            runs.push_back(getRun(begin, mask));
+            begin = runs.back().getEnd();
+        }
+    }
+} // namespace Sammi
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "runtime/function/render/render_common.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Sammi
+{
+    struct RenderQueueItem
+    {
+        uint64_t m_sort_key {0};
+        uint32_t m_node_index {0};
+    };
+
+    class RenderQueue;
+
+    /// Consecutive items of a sorted queue sharing the masked key, indexed like a node list.
+    class RenderQueueRun
+    {
+    public:
+        RenderQueueRun(const RenderQueue& queue, size_t begin, size_t end) : m_queue(&queue), m_begin(begin), m_end(end) {}
+
+        const RenderMeshNode& operator[](size_t index) const;
+
+        size_t size() const { return m_end - m_begin; }
+        size_t getBegin() const { return m_begin; }
+        size_t getEnd() const { return m_end; }
+
+    private:
+        const RenderQueue* m_queue {nullptr};
+        size_t             m_begin {0};
+        size_t             m_end {0};
+    };
+
+    /// Draw order of the visible mesh nodes of one view. Every node gets a packed 64-bit sort key
+    /// (material | mesh | depth), the keys are radix sorted once so the nodes sharing a material and a mesh form
+    /// one run that becomes one instanced draw. The arrays keep their capacity, a warmed up queue does not allocate.
+    class RenderQueue
+    {
+    public:
+        static constexpr uint32_t s_depth_bits {16};
+        // sort ids are the slot part of the asset guids (24 bits)
+        static constexpr uint32_t s_mesh_bits {24};
+        static constexpr uint32_t s_material_bits {24};
+
+        // the items of a run share key & mask
+        static constexpr uint64_t s_material_key_mask {~((uint64_t(1) << (s_mesh_bits + s_depth_bits)) - 1)};
+        static constexpr uint64_t s_mesh_key_mask {~((uint64_t(1) << s_depth_bits) - 1)};
+
+        static uint64_t makeSortKey(uint32_t material_sort_id, uint32_t mesh_sort_id, uint32_t depth);
+
+        // passes that do not bind materials leave sort_by_material false so a mesh batches across its materials,
+        // with a proj_view_matrix the nodes of a batch are ordered near to far by the depth of their origin
+        void build(const std::vector<RenderMeshNode>& nodes,
+                   bool                               sort_by_material,
+                   const Matrix4x4*                   proj_view_matrix);
+
+        void clear();
+        void push(uint64_t sort_key, uint32_t node_index);
+        // stable LSD radix sort on 8-bit digits, digits shared by all keys are skipped
+        void sort();
+
+        size_t getItemCount() const { return m_items.size(); }
+        // the run starting at begin, begin must be below getItemCount
+        RenderQueueRun getRun(size_t begin, uint64_t mask) const;
+        // all runs for mask in draw order, runs is cleared first
+        void getRuns(uint64_t mask, std::vector<RenderQueueRun>& runs) const;
+
+        const RenderMeshNode& getNode(size_t item_index) const { return (*m_nodes)[m_items[item_index].m_node_index]; }
+
+    private:
+        std::vector<RenderQueueItem> m_items;
+        std::vector<RenderQueueItem> m_sort_buffer;
+
+        const std::vector<RenderMeshNode>* m_nodes {nullptr};
+    };
+
+    inline const RenderMeshNode& RenderQueueRun::operator[](size_t index) const { return m_queue->getNode(m_begin + index); }
+} // namespace Sammi
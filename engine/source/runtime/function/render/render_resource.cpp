@@ -11,10 +11,19 @@
 
 #include "runtime/core/base/macro.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 namespace Sammi
 {
+    // δ󻺳ĳʼԪΪλʱ
+    static const uint32_t s_geometry_buffer_initial_vertex_capacity        = 1 << 18;
+    static const uint32_t s_geometry_buffer_initial_index_capacity         = 1 << 20;
+    static const uint32_t s_geometry_buffer_initial_joint_binding_capacity = 1 << 16;
+
+    // ԴGUIDĵ24λǲλţGuidAllocatorѼصͬԴΨһȾеID
+    static uint32_t getAssetSortId(size_t asset_guid) { return static_cast<uint32_t>(asset_guid & 0xFFFFFF); }
+
     void RenderResource::clear()
     {
     }
@@ -24,65 +33,121 @@ namespace Sammi
         // ӳȫִ洢ڴ洢ȾͳһԴݣʲõȣ
         createAndMapStorageBuffer(rhi);
 
-        // -------------------------- պзնȣIBLնȣԴ --------------------------
-        // ӹؿԴȡպзնԴϢ
-        SkyBoxIrradianceMap skybox_irradiance_map = level_resource_desc.m_ibl_resource_desc.m_skybox_irradiance_map;
-        // HDRնͼ棩
-        // X/Y/ZӦպе棬ģ⻷乱
-        std::shared_ptr<TextureData> irradiace_pos_x_map = loadTextureHDR(skybox_irradiance_map.m_positive_x_map);  // ң+X
-        std::shared_ptr<TextureData> irradiace_neg_x_map = loadTextureHDR(skybox_irradiance_map.m_negative_x_map);  // -X
-        std::shared_ptr<TextureData> irradiace_pos_y_map = loadTextureHDR(skybox_irradiance_map.m_positive_y_map);  // ϣ+Y
-        std::shared_ptr<TextureData> irradiace_neg_y_map = loadTextureHDR(skybox_irradiance_map.m_negative_y_map);  // £-Y
-        std::shared_ptr<TextureData> irradiace_pos_z_map = loadTextureHDR(skybox_irradiance_map.m_positive_z_map);  // ǰ+Z
-        std::shared_ptr<TextureData> irradiace_neg_z_map = loadTextureHDR(skybox_irradiance_map.m_negative_z_map);  // -Z
-
-        // -------------------------- պи߹⣨IBL߹⣩Դ --------------------------
-        // ӹؿԴȡպи߹ԴϢھ淴㣩
-        SkyBoxSpecularMap skybox_specular_map = level_resource_desc.m_ibl_resource_desc.m_skybox_specular_map;
-        // HDR߹ͼ棩
-        // ߹ͨ洢Ԥгϵ򻷾ڱϢڿټ㾵淴
-        std::shared_ptr<TextureData> specular_pos_x_map  = loadTextureHDR(skybox_specular_map.m_positive_x_map);
-        std::shared_ptr<TextureData> specular_neg_x_map  = loadTextureHDR(skybox_specular_map.m_negative_x_map);
-        std::shared_ptr<TextureData> specular_pos_y_map  = loadTextureHDR(skybox_specular_map.m_positive_y_map);
-        std::shared_ptr<TextureData> specular_neg_y_map  = loadTextureHDR(skybox_specular_map.m_negative_y_map);
-        std::shared_ptr<TextureData> specular_pos_z_map  = loadTextureHDR(skybox_specular_map.m_positive_z_map);
-        std::shared_ptr<TextureData> specular_neg_z_map  = loadTextureHDR(skybox_specular_map.m_negative_z_map);
+        // ڵϴϲΪһύ
+        rhi->beginUploadBatch();
 
-        // -------------------------- BRDFұLUTԴ --------------------------
-        // BRDFԤұ2DڿٲѯֲͬڶȺµBRDFֵ
-        // ɫʵʱ㸴ӵĻ֣Ⱦ
-        std::shared_ptr<TextureData> brdf_map = loadTextureHDR(level_resource_desc.m_ibl_resource_desc.m_brdf_map);
+        // -------------------------- IBLԴ --------------------------
+        // ʮBRDFͼ·ΪؿлʱIBLδ仯ϴ
+        std::vector<std::string> ibl_source_urls;
+        for (const std::string& source_url : getIBLSourceUrls(level_resource_desc.m_ibl_resource_desc))
+        {
+            ibl_source_urls.push_back(source_url);
+        }
+        ibl_source_urls.push_back(level_resource_desc.m_ibl_resource_desc.m_brdf_map);
+
+        if (ibl_source_urls != m_uploaded_ibl_source_urls)
+        {
+            uploadIBLResource(rhi, level_resource_desc.m_ibl_resource_desc);
+            m_uploaded_ibl_source_urls = std::move(ibl_source_urls);
+        }
 
-        // -------------------------- IBL --------------------------
-        // IBLĲ˷ʽѰַģʽȣȷΪ
-        createIBLSamplers(rhi);
+        // ɫּͼͬ·
+        const std::string& color_grading_url = level_resource_desc.m_color_grading_resource_desc.m_color_grading_map;
+        if (color_grading_url != m_uploaded_color_grading_url)
+        {
+            // -------------------------- ɫּColor GradingԴ --------------------------
+            // ɫּLUTڵɫԱȶȡͶȵȣ
+            std::shared_ptr<TextureData> color_grading_map = loadTexture(level_resource_desc.m_color_grading_resource_desc.m_color_grading_map);
+
+            // -------------------------- ɫּLUT --------------------------
+            // GPUϴɫּұȫͼԴͼͼڴ䣩
+            // ںڴ׶ΣջɫУ
+            rhi->createGlobalImage(
+                m_global_render_resource._color_grading_resource._color_grading_LUT_texture_image,
+                m_global_render_resource._color_grading_resource._color_grading_LUT_texture_image_view,
+                m_global_render_resource._color_grading_resource._color_grading_LUT_texture_image_allocation,
+                color_grading_map->m_width,
+                color_grading_map->m_height,
+                color_grading_map->m_pixels,
+                color_grading_map->m_format);
+
+            m_uploaded_color_grading_url = color_grading_url;
+        }
+
+        rhi->endUploadBatch();
+    }
 
-        // -------------------------- IBLͼ --------------------------
-        // ע⣺ͼҪض˳УȡڵײAPIҪVulkanVK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT
-        // ն [, , ǰ, , , ] ˳УĳЩAPIͼ˳Ҫ
-        std::array<std::shared_ptr<TextureData>, 6> irradiance_maps =
+    void RenderResource::uploadIBLResource(std::shared_ptr<RHI> rhi, const LevelIBLResourceDesc& ibl_resource_desc)
+    {
+        // ӳ決IBLļһζȡͼMIPԤȼ㣬ʽΪRGBA16FE5B9G9R9
+        IBLData ibl_data;
+        if (loadIBLData(ibl_resource_desc, ibl_data))
         {
-            irradiace_pos_x_map,
-            irradiace_neg_x_map,
-            irradiace_pos_z_map,
-            irradiace_neg_z_map,
-            irradiace_pos_y_map,
-            irradiace_neg_y_map
-        };
-        // ߹ [, , ǰ, , , ] ˳Уնȱһµ˳
-        std::array<std::shared_ptr<TextureData>, 6> specular_maps =
+            createIBLSamplers(rhi);
+            createIBLTextures(rhi, ibl_data);
+        }
+        else
         {
-            specular_pos_x_map,
-            specular_neg_x_map,
-            specular_pos_z_map,
-            specular_neg_z_map,
-            specular_pos_y_map,
-            specular_neg_y_map
-        };
-
-        // IBL󣨰ͼͼͼڴ䣩صHDRϴGPU
-        // ЩΪȫԴɫʹ
-        createIBLTextures(rhi, irradiance_maps, specular_maps);
+            // -------------------------- պзնȣIBLնȣԴ --------------------------
+            // ӹؿԴȡպзնԴϢ
+            SkyBoxIrradianceMap skybox_irradiance_map = ibl_resource_desc.m_skybox_irradiance_map;
+            // HDRնͼ棩
+            // X/Y/ZӦպе棬ģ⻷乱
+            std::shared_ptr<TextureData> irradiace_pos_x_map = loadTextureHDR(skybox_irradiance_map.m_positive_x_map);  // ң+X
+            std::shared_ptr<TextureData> irradiace_neg_x_map = loadTextureHDR(skybox_irradiance_map.m_negative_x_map);  // -X
+            std::shared_ptr<TextureData> irradiace_pos_y_map = loadTextureHDR(skybox_irradiance_map.m_positive_y_map);  // ϣ+Y
+            std::shared_ptr<TextureData> irradiace_neg_y_map = loadTextureHDR(skybox_irradiance_map.m_negative_y_map);  // £-Y
+            std::shared_ptr<TextureData> irradiace_pos_z_map = loadTextureHDR(skybox_irradiance_map.m_positive_z_map);  // ǰ+Z
+            std::shared_ptr<TextureData> irradiace_neg_z_map = loadTextureHDR(skybox_irradiance_map.m_negative_z_map);  // -Z
+
+            // -------------------------- պи߹⣨IBL߹⣩Դ --------------------------
+            // ӹؿԴȡպи߹ԴϢھ淴㣩
+            SkyBoxSpecularMap skybox_specular_map = ibl_resource_desc.m_skybox_specular_map;
+            // HDR߹ͼ棩
+            // ߹ͨ洢Ԥгϵ򻷾ڱϢڿټ㾵淴
+            std::shared_ptr<TextureData> specular_pos_x_map  = loadTextureHDR(skybox_specular_map.m_positive_x_map);
+            std::shared_ptr<TextureData> specular_neg_x_map  = loadTextureHDR(skybox_specular_map.m_negative_x_map);
+            std::shared_ptr<TextureData> specular_pos_y_map  = loadTextureHDR(skybox_specular_map.m_positive_y_map);
+            std::shared_ptr<TextureData> specular_neg_y_map  = loadTextureHDR(skybox_specular_map.m_negative_y_map);
+            std::shared_ptr<TextureData> specular_pos_z_map  = loadTextureHDR(skybox_specular_map.m_positive_z_map);
+            std::shared_ptr<TextureData> specular_neg_z_map  = loadTextureHDR(skybox_specular_map.m_negative_z_map);
+
+            // -------------------------- IBL --------------------------
+            // IBLĲ˷ʽѰַģʽȣȷΪ
+            createIBLSamplers(rhi);
+
+            // -------------------------- IBLͼ --------------------------
+            // ע⣺ͼҪض˳УȡڵײAPIҪVulkanVK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT
+            // ն [, , ǰ, , , ] ˳УĳЩAPIͼ˳Ҫ
+            std::array<std::shared_ptr<TextureData>, 6> irradiance_maps =
+            {
+                irradiace_pos_x_map,
+                irradiace_neg_x_map,
+                irradiace_pos_z_map,
+                irradiace_neg_z_map,
+                irradiace_pos_y_map,
+                irradiace_neg_y_map
+            };
+            // ߹ [, , ǰ, , , ] ˳Уնȱһµ˳
+            std::array<std::shared_ptr<TextureData>, 6> specular_maps =
+            {
+                specular_pos_x_map,
+                specular_neg_x_map,
+                specular_pos_z_map,
+                specular_neg_z_map,
+                specular_pos_y_map,
+                specular_neg_y_map
+            };
+
+            // IBL󣨰ͼͼͼڴ䣩صHDRϴGPU
+            // ЩΪȫԴɫʹ
+            createIBLTextures(rhi, irradiance_maps, specular_maps);
+        }
+
+        // -------------------------- BRDFұLUTԴ --------------------------
+        // BRDFԤұ2DڿٲѯֲͬڶȺµBRDFֵ
+        // ɫʵʱ㸴ӵĻ֣Ⱦ
+        std::shared_ptr<TextureData> brdf_map = loadTextureHDR(ibl_resource_desc.m_brdf_map);
 
         // -------------------------- BRDF LUT --------------------------
         // GPUϴBRDFұȫͼԴͼͼڴ䣩
@@ -95,38 +160,29 @@ namespace Sammi
             brdf_map->m_height,
             brdf_map->m_pixels,
             brdf_map->m_format);
-
-        // -------------------------- ɫּColor GradingԴ --------------------------
-        // ɫּLUTڵɫԱȶȡͶȵȣ
-        std::shared_ptr<TextureData> color_grading_map = loadTexture(level_resource_desc.m_color_grading_resource_desc.m_color_grading_map);
-
-        // -------------------------- ɫּLUT --------------------------
-        // GPUϴɫּұȫͼԴͼͼڴ䣩
-        // ںڴ׶ΣջɫУ
-        rhi->createGlobalImage(
-            m_global_render_resource._color_grading_resource._color_grading_LUT_texture_image,
-            m_global_render_resource._color_grading_resource._color_grading_LUT_texture_image_view,
-            m_global_render_resource._color_grading_resource._color_grading_LUT_texture_image_allocation,
-            color_grading_map->m_width,
-            color_grading_map->m_height,
-            color_grading_map->m_pixels,
-            color_grading_map->m_format);
     }
 
+    // ϴ¼ϴУͳһύһΣʱÿεύһ
     void RenderResource::uploadGameObjectRenderResource(std::shared_ptr<RHI> rhi, RenderEntity render_entity, RenderMeshData mesh_data, RenderMaterialData material_data)
     {
+        rhi->beginUploadBatch();
         getOrCreateVulkanMesh(rhi, render_entity, mesh_data);
         getOrCreateVulkanMaterial(rhi, render_entity, material_data);
+        rhi->endUploadBatch();
     }
 
     void RenderResource::uploadGameObjectRenderResource(std::shared_ptr<RHI> rhi, RenderEntity render_entity, RenderMeshData mesh_data)
     {
+        rhi->beginUploadBatch();
         getOrCreateVulkanMesh(rhi, render_entity, mesh_data);
+        rhi->endUploadBatch();
     }
 
     void RenderResource::uploadGameObjectRenderResource(std::shared_ptr<RHI> rhi, RenderEntity render_entity, RenderMaterialData material_data)
     {
+        rhi->beginUploadBatch();
         getOrCreateVulkanMaterial(rhi, render_entity, material_data);
+        rhi->endUploadBatch();
     }
 
     void RenderResource::updatePerFrameBuffer(std::shared_ptr<RenderScene> render_scene, std::shared_ptr<RenderCamera> camera)
@@ -319,6 +375,32 @@ namespace Sammi
             specular_cubemap_miplevels);
     }
 
+    void RenderResource::createIBLTextures(std::shared_ptr<RHI> rhi, const IBLData& ibl_data)
+    {
+        // ÿMIPϴGPUMIP
+        rhi->createCubeMap(
+            m_global_render_resource._ibl_resource._irradiance_texture_image,
+            m_global_render_resource._ibl_resource._irradiance_texture_image_view,
+            m_global_render_resource._ibl_resource._irradiance_texture_image_allocation,
+            ibl_data.m_irradiance.m_size,
+            ibl_data.m_irradiance.m_size,
+            ibl_data.m_irradiance.m_faces,
+            ibl_data.m_format,
+            ibl_data.m_irradiance.m_mip_levels,
+            ibl_data.m_irradiance.m_mip_levels);
+
+        rhi->createCubeMap(
+            m_global_render_resource._ibl_resource._specular_texture_image,
+            m_global_render_resource._ibl_resource._specular_texture_image_view,
+            m_global_render_resource._ibl_resource._specular_texture_image_allocation,
+            ibl_data.m_specular.m_size,
+            ibl_data.m_specular.m_size,
+            ibl_data.m_specular.m_faces,
+            ibl_data.m_format,
+            ibl_data.m_specular.m_mip_levels,
+            ibl_data.m_specular.m_mip_levels);
+    }
+
     VulkanMesh& RenderResource::getOrCreateVulkanMesh(std::shared_ptr<RHI> rhi, RenderEntity entity, RenderMeshData mesh_data)
     {
         size_t assetid = entity.m_mesh_asset_id;  // ԴΨһʶʲID
@@ -344,6 +426,7 @@ namespace Sammi
 
             // -------------------------- ȡǰ´Դ --------------------------
             VulkanMesh& now_mesh = res.first->second;
+            now_mesh.sort_id     = getAssetSortId(assetid);  // ȾеID
 
             // -------------------------- ݣУ --------------------------
             if (mesh_data.m_skeleton_binding_buffer)  // ڹ󶨻ɫģ͵ĹȨ/
@@ -356,6 +439,7 @@ namespace Sammi
                                true,
                                index_buffer_size,
                                index_buffer_data,
+                               mesh_data.m_static_mesh_data.m_index_type,
                                vertex_buffer_size,
                                vertex_buffer_data,
                                joint_binding_buffer_size,
@@ -369,6 +453,7 @@ namespace Sammi
                                false,
                                index_buffer_size,
                                index_buffer_data,
+                               mesh_data.m_static_mesh_data.m_index_type,
                                vertex_buffer_size,
                                vertex_buffer_data,
                                0,
@@ -413,6 +498,7 @@ namespace Sammi
             uint32_t  base_color_image_width  = 1;            // ȣĬ 1
             uint32_t  base_color_image_height = 1;            // ߶ȣĬ 1
             RHIFormat base_color_image_format = RHIFormat::RHI_FORMAT_R8G8B8A8_SRGB;  // ʽĬ SRGB
+            uint32_t  base_color_image_mip_levels = 1;
             if (material_data.m_base_color_texture)           // ڻɫ
             {
                 // ʹʵݸĬֵ
@@ -420,6 +506,7 @@ namespace Sammi
                 base_color_image_width  = static_cast<uint32_t>(material_data.m_base_color_texture->m_width);
                 base_color_image_height = static_cast<uint32_t>(material_data.m_base_color_texture->m_height);
                 base_color_image_format = material_data.m_base_color_texture->m_format;
+                base_color_image_mip_levels = material_data.m_base_color_texture->m_mip_levels;
             }
 
             // -ֲڶƻɫĴ߼
@@ -427,12 +514,14 @@ namespace Sammi
             uint32_t  metallic_roughness_width        = 1;
             uint32_t  metallic_roughness_height       = 1;
             RHIFormat metallic_roughness_format       = RHIFormat::RHI_FORMAT_R8G8B8A8_UNORM;
+            uint32_t  metallic_roughness_mip_levels   = 1;
             if (material_data.m_metallic_roughness_texture)
             {
                 metallic_roughness_image_pixels = material_data.m_metallic_roughness_texture->m_pixels;
                 metallic_roughness_width        = static_cast<uint32_t>(material_data.m_metallic_roughness_texture->m_width);
                 metallic_roughness_height       = static_cast<uint32_t>(material_data.m_metallic_roughness_texture->m_height);
                 metallic_roughness_format       = material_data.m_metallic_roughness_texture->m_format;
+                metallic_roughness_mip_levels   = material_data.m_metallic_roughness_texture->m_mip_levels;
             }
 
             // -ֲڶע⣺˴ΪͨʽΪ RGB߼
@@ -440,12 +529,14 @@ namespace Sammi
             uint32_t           normal_roughness_width = 1;
             uint32_t           normal_roughness_height = 1;
             RHIFormat normal_roughness_format = RHIFormat::RHI_FORMAT_R8G8B8A8_UNORM;
+            uint32_t normal_roughness_mip_levels = 1;
             if (material_data.m_normal_texture)
             {
                 normal_roughness_image_pixels = material_data.m_normal_texture->m_pixels;
                 normal_roughness_width = static_cast<uint32_t>(material_data.m_normal_texture->m_width);
                 normal_roughness_height = static_cast<uint32_t>(material_data.m_normal_texture->m_height);
                 normal_roughness_format = material_data.m_normal_texture->m_format;
+                normal_roughness_mip_levels = material_data.m_normal_texture->m_mip_levels;
             }
 
             // ڵ
@@ -453,12 +544,14 @@ namespace Sammi
             uint32_t           occlusion_image_width = 1;
             uint32_t           occlusion_image_height = 1;
             RHIFormat occlusion_image_format = RHIFormat::RHI_FORMAT_R8G8B8A8_UNORM;
+            uint32_t occlusion_image_mip_levels = 1;
             if (material_data.m_occlusion_texture)
             {
                 occlusion_image_pixels = material_data.m_occlusion_texture->m_pixels;
                 occlusion_image_width = static_cast<uint32_t>(material_data.m_occlusion_texture->m_width);
                 occlusion_image_height = static_cast<uint32_t>(material_data.m_occlusion_texture->m_height);
                 occlusion_image_format = material_data.m_occlusion_texture->m_format;
+                occlusion_image_mip_levels = material_data.m_occlusion_texture->m_mip_levels;
             }
 
             // Է
@@ -466,15 +559,18 @@ namespace Sammi
             uint32_t           emissive_image_width = 1;
             uint32_t           emissive_image_height = 1;
             RHIFormat emissive_image_format = RHIFormat::RHI_FORMAT_R8G8B8A8_UNORM;
+            uint32_t emissive_image_mip_levels = 1;
             if (material_data.m_emissive_texture)
             {
                 emissive_image_pixels = material_data.m_emissive_texture->m_pixels;
                 emissive_image_width  = static_cast<uint32_t>(material_data.m_emissive_texture->m_width);
                 emissive_image_height = static_cast<uint32_t>(material_data.m_emissive_texture->m_height);
                 emissive_image_format = material_data.m_emissive_texture->m_format;
+                emissive_image_mip_levels = material_data.m_emissive_texture->m_mip_levels;
             }
 
             VulkanPBRMaterial& now_material = res.first->second;
+            now_material.sort_id            = getAssetSortId(assetid);  // ȾеĲID
 
             // --------------------  4ʼͳһUniform Buffer --------------------
             // ͳһڴ洢ʲϱ־˫Ⱦɫӵȣɫ
@@ -482,25 +578,11 @@ namespace Sammi
                 // ͳһС MeshPerMaterialUniformBufferObject ṹС
                 RHIDeviceSize buffer_size = sizeof(MeshPerMaterialUniformBufferObject);
 
-                // ʱݴ滺ڽݴڴ渴Ƶ GPU ڴ棩
-                // ʹ HOST_VISIBLE  HOST_COHERENT ԣֱӶдֶˢ»
-                RHIBuffer* inefficient_staging_buffer = RHI_NULL_HANDLE;
-                RHIDeviceMemory* inefficient_staging_buffer_memory = RHI_NULL_HANDLE;
-                rhi->createBuffer(
-                    buffer_size,
-                    RHI_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                    RHI_MEMORY_PROPERTY_HOST_VISIBLE_BIT | RHI_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                    inefficient_staging_buffer,
-                    inefficient_staging_buffer_memory);
-
-                // ӳݴ滺ڴ浽ַռ䣨ȡָдݣ
-                void* staging_buffer_data = nullptr;
-                rhi->mapMemory(
-                    inefficient_staging_buffer_memory,
-                    0,
-                    buffer_size,
-                    0,
-                    &staging_buffer_data);
+                // ϴݴ滺䣨פӳɼڴ棩浱ǰϴһύ
+                RHIBuffer*    staging_buffer        = RHI_NULL_HANDLE;
+                RHIDeviceSize staging_buffer_offset = 0;
+                void*         staging_buffer_data =
+                    rhi->allocateStagingMemory(buffer_size, 16, staging_buffer, staging_buffer_offset);
                 
                 // ͳһݣڲʵԣ
                 MeshPerMaterialUniformBufferObject& material_uniform_buffer_info = (*static_cast<MeshPerMaterialUniformBufferObject*>(staging_buffer_data));
@@ -513,9 +595,6 @@ namespace Sammi
                 material_uniform_buffer_info.occlusionStrength = entity.m_occlusion_strength;// ڵǿ
                 material_uniform_buffer_info.emissiveFactor = entity.m_emissive_factor;// Է
 
-                // ڴӳ䣨ͷָ룬ͬ GPU
-                rhi->unmapMemory(inefficient_staging_buffer_memory);
-
                 //  GPU רͳһʹ VMA ڴ䣩
                 // ;UNIFORM_BUFFERɫͳһ + TRANSFER_DSTմݣ
                 RHIBufferCreateInfo bufferInfo = { RHI_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
@@ -537,11 +616,7 @@ namespace Sammi
                     NULL);
 
                 // use the data from staging buffer
-                rhi->copyBuffer(inefficient_staging_buffer, now_material.material_uniform_buffer, 0, 0, buffer_size);
-
-                // release staging buffer
-                rhi->destroyBuffer(inefficient_staging_buffer);
-                rhi->freeMemory(inefficient_staging_buffer_memory);
+                rhi->copyBuffer(staging_buffer, now_material.material_uniform_buffer, staging_buffer_offset, 0, buffer_size);
             }
 
             TextureDataToUpdate update_texture_data;
@@ -549,22 +624,27 @@ namespace Sammi
             update_texture_data.base_color_image_width          = base_color_image_width;
             update_texture_data.base_color_image_height         = base_color_image_height;
             update_texture_data.base_color_image_format         = base_color_image_format;
+            update_texture_data.base_color_image_mip_levels     = base_color_image_mip_levels;
             update_texture_data.metallic_roughness_image_pixels = metallic_roughness_image_pixels;
             update_texture_data.metallic_roughness_image_width  = metallic_roughness_width;
             update_texture_data.metallic_roughness_image_height = metallic_roughness_height;
             update_texture_data.metallic_roughness_image_format = metallic_roughness_format;
+            update_texture_data.metallic_roughness_image_mip_levels = metallic_roughness_mip_levels;
             update_texture_data.normal_roughness_image_pixels   = normal_roughness_image_pixels;
             update_texture_data.normal_roughness_image_width    = normal_roughness_width;
             update_texture_data.normal_roughness_image_height   = normal_roughness_height;
             update_texture_data.normal_roughness_image_format   = normal_roughness_format;
+            update_texture_data.normal_roughness_image_mip_levels = normal_roughness_mip_levels;
             update_texture_data.occlusion_image_pixels          = occlusion_image_pixels;
             update_texture_data.occlusion_image_width           = occlusion_image_width;
             update_texture_data.occlusion_image_height          = occlusion_image_height;
             update_texture_data.occlusion_image_format          = occlusion_image_format;
+            update_texture_data.occlusion_image_mip_levels      = occlusion_image_mip_levels;
             update_texture_data.emissive_image_pixels           = emissive_image_pixels;
             update_texture_data.emissive_image_width            = emissive_image_width;
             update_texture_data.emissive_image_height           = emissive_image_height;
             update_texture_data.emissive_image_format           = emissive_image_format;
+            update_texture_data.emissive_image_mip_levels       = emissive_image_mip_levels;
             update_texture_data.now_material                    = &now_material;
 
             updateTextureImageData(rhi, update_texture_data);
@@ -662,12 +742,19 @@ namespace Sammi
                                         bool                                   enable_vertex_blending,
                                         uint32_t                               index_buffer_size,
                                         void*                                  index_buffer_data,
+                                        RHIIndexType                           index_type,
                                         uint32_t                               vertex_buffer_size,
                                         MeshVertexDataDefinition const*        vertex_buffer_data,
                                         uint32_t                               joint_binding_buffer_size,
                                         MeshVertexBindingDataDefinition const* joint_binding_buffer_data,
                                         VulkanMesh&                            now_mesh)
     {
+        // δ󻺳ڵһϴʱ
+        if (m_global_render_resource._geometry_buffer._index._buffer == nullptr)
+        {
+            createGeometryBuffer(rhi);
+        }
+
         now_mesh.enable_vertex_blending = enable_vertex_blending;
         assert(0 == (vertex_buffer_size % sizeof(MeshVertexDataDefinition)));
         now_mesh.mesh_vertex_count = vertex_buffer_size / sizeof(MeshVertexDataDefinition);
@@ -677,12 +764,10 @@ namespace Sammi
                            vertex_buffer_data,
                            joint_binding_buffer_size,
                            joint_binding_buffer_data,
-                           index_buffer_size,
-                           reinterpret_cast<uint16_t*>(index_buffer_data),
                            now_mesh);
-        assert(0 == (index_buffer_size % sizeof(uint16_t)));
-        now_mesh.mesh_index_count = index_buffer_size / sizeof(uint16_t);
-        updateIndexBuffer(rhi, index_buffer_size, index_buffer_data, now_mesh);
+        assert(0 == (index_buffer_size % getIndexTypeSize(index_type)));
+        now_mesh.mesh_index_count = index_buffer_size / getIndexTypeSize(index_type);
+        updateIndexBuffer(rhi, index_buffer_size, index_buffer_data, index_type, now_mesh);
     }
 
     void RenderResource::updateVertexBuffer(std::shared_ptr<RHI>                   rhi,
@@ -691,433 +776,415 @@ namespace Sammi
                                             MeshVertexDataDefinition const*        vertex_buffer_data,
                                             uint32_t                               joint_binding_buffer_size,
                                             MeshVertexBindingDataDefinition const* joint_binding_buffer_data,
-                                            uint32_t                               index_buffer_size,
-                                            uint16_t*                              index_buffer_data,
                                             VulkanMesh&                            now_mesh)
     {
-        VulkanRHI* vulkan_context = static_cast<VulkanRHI*>(rhi.get());
+        GeometryBuffer& geometry_buffer = m_global_render_resource._geometry_buffer;
+
+        assert(0 == (vertex_buffer_size % sizeof(MeshVertexDataDefinition)));
+        uint32_t vertex_count = vertex_buffer_size / sizeof(MeshVertexDataDefinition);
+
+        // the vertex streams share one range of the geometry buffer, the joint bindings have their own
+        now_mesh.mesh_vertex_offset = allocateGeometryRange(rhi,
+                                                            geometry_buffer._vertex_allocator,
+                                                            {&geometry_buffer._vertex_position,
+                                                             &geometry_buffer._vertex_varying_enable_blending,
+                                                             &geometry_buffer._vertex_varying},
+                                                            vertex_count);
+        now_mesh.mesh_joint_binding_offset = s_invalid_geometry_offset;
+        if (enable_vertex_blending)
+        {
+            assert(joint_binding_buffer_size == sizeof(MeshVertexBindingDataDefinition) * vertex_count);
+            now_mesh.mesh_joint_binding_offset = allocateGeometryRange(rhi,
+                                                                       geometry_buffer._joint_binding_allocator,
+                                                                       {&geometry_buffer._joint_binding},
+                                                                       vertex_count);
+        }
+
+        RHIDeviceSize vertex_position_buffer_size = sizeof(MeshVertex::VulkanMeshVertexPostition) * vertex_count;
+        RHIDeviceSize vertex_varying_enable_blending_buffer_size =
+            sizeof(MeshVertex::VulkanMeshVertexVaryingEnableBlending) * vertex_count;
+        RHIDeviceSize vertex_varying_buffer_size = sizeof(MeshVertex::VulkanMeshVertexVarying) * vertex_count;
+        RHIDeviceSize vertex_joint_binding_buffer_size =
+            enable_vertex_blending ? sizeof(MeshVertex::VulkanMeshVertexJointBinding) * vertex_count : 0;
+
+        RHIDeviceSize vertex_position_buffer_offset = 0;
+        RHIDeviceSize vertex_varying_enable_blending_buffer_offset =
+            vertex_position_buffer_offset + vertex_position_buffer_size;
+        RHIDeviceSize vertex_varying_buffer_offset =
+            vertex_varying_enable_blending_buffer_offset + vertex_varying_enable_blending_buffer_size;
+        RHIDeviceSize vertex_joint_binding_buffer_offset = vertex_varying_buffer_offset + vertex_varying_buffer_size;
+
+        // staging memory from the upload ring, the copies are submitted with the current upload batch
+        RHIDeviceSize staging_buffer_size = vertex_position_buffer_size + vertex_varying_enable_blending_buffer_size +
+                                            vertex_varying_buffer_size + vertex_joint_binding_buffer_size;
+        RHIBuffer*    staging_buffer        = RHI_NULL_HANDLE;
+        RHIDeviceSize staging_buffer_offset = 0;
+        void*         staging_buffer_data =
+            rhi->allocateStagingMemory(staging_buffer_size, 16, staging_buffer, staging_buffer_offset);
+
+        MeshVertex::VulkanMeshVertexPostition* mesh_vertex_positions =
+            reinterpret_cast<MeshVertex::VulkanMeshVertexPostition*>(
+                reinterpret_cast<uintptr_t>(staging_buffer_data) + vertex_position_buffer_offset);
+        MeshVertex::VulkanMeshVertexVaryingEnableBlending* mesh_vertex_blending_varyings =
+            reinterpret_cast<MeshVertex::VulkanMeshVertexVaryingEnableBlending*>(
+                reinterpret_cast<uintptr_t>(staging_buffer_data) + vertex_varying_enable_blending_buffer_offset);
+        MeshVertex::VulkanMeshVertexVarying* mesh_vertex_varyings =
+            reinterpret_cast<MeshVertex::VulkanMeshVertexVarying*>(
+                reinterpret_cast<uintptr_t>(staging_buffer_data) + vertex_varying_buffer_offset);
+
+        for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+        {
+            Vector3 normal = Vector3(vertex_buffer_data[vertex_index].nx,
+                vertex_buffer_data[vertex_index].ny,
+                vertex_buffer_data[vertex_index].nz);
+            Vector3 tangent = Vector3(vertex_buffer_data[vertex_index].tx,
+                vertex_buffer_data[vertex_index].ty,
+                vertex_buffer_data[vertex_index].tz);
+
+            mesh_vertex_positions[vertex_index].position = Vector3(vertex_buffer_data[vertex_index].x,
+                vertex_buffer_data[vertex_index].y,
+                vertex_buffer_data[vertex_index].z);
+
+            mesh_vertex_blending_varyings[vertex_index].normal = normal;
+            mesh_vertex_blending_varyings[vertex_index].tangent = tangent;
+
+            mesh_vertex_varyings[vertex_index].texcoord =
+                Vector2(vertex_buffer_data[vertex_index].u, vertex_buffer_data[vertex_index].v);
+        }
+
+        // copy the streams into their ranges of the geometry buffer
+        rhi->copyBuffer(staging_buffer,
+                        geometry_buffer._vertex_position._buffer,
+                        staging_buffer_offset + vertex_position_buffer_offset,
+                        static_cast<RHIDeviceSize>(geometry_buffer._vertex_position._stride) * now_mesh.mesh_vertex_offset,
+                        vertex_position_buffer_size);
+        rhi->copyBuffer(staging_buffer,
+                        geometry_buffer._vertex_varying_enable_blending._buffer,
+                        staging_buffer_offset + vertex_varying_enable_blending_buffer_offset,
+                        static_cast<RHIDeviceSize>(geometry_buffer._vertex_varying_enable_blending._stride) *
+                            now_mesh.mesh_vertex_offset,
+                        vertex_varying_enable_blending_buffer_size);
+        rhi->copyBuffer(staging_buffer,
+                        geometry_buffer._vertex_varying._buffer,
+                        staging_buffer_offset + vertex_varying_buffer_offset,
+                        static_cast<RHIDeviceSize>(geometry_buffer._vertex_varying._stride) * now_mesh.mesh_vertex_offset,
+                        vertex_varying_buffer_size);
 
         if (enable_vertex_blending)
         {
-            assert(0 == (vertex_buffer_size % sizeof(MeshVertexDataDefinition)));
-            uint32_t vertex_count = vertex_buffer_size / sizeof(MeshVertexDataDefinition);
-            assert(0 == (index_buffer_size % sizeof(uint16_t)));
-            uint32_t index_count = index_buffer_size / sizeof(uint16_t);
-
-            RHIDeviceSize vertex_position_buffer_size = sizeof(MeshVertex::VulkanMeshVertexPostition) * vertex_count;
-            RHIDeviceSize vertex_varying_enable_blending_buffer_size =
-                sizeof(MeshVertex::VulkanMeshVertexVaryingEnableBlending) * vertex_count;
-            RHIDeviceSize vertex_varying_buffer_size = sizeof(MeshVertex::VulkanMeshVertexVarying) * vertex_count;
-            RHIDeviceSize vertex_joint_binding_buffer_size =
-                sizeof(MeshVertex::VulkanMeshVertexJointBinding) * index_count;
-
-            RHIDeviceSize vertex_position_buffer_offset = 0;
-            RHIDeviceSize vertex_varying_enable_blending_buffer_offset =
-                vertex_position_buffer_offset + vertex_position_buffer_size;
-            RHIDeviceSize vertex_varying_buffer_offset =
-                vertex_varying_enable_blending_buffer_offset + vertex_varying_enable_blending_buffer_size;
-            RHIDeviceSize vertex_joint_binding_buffer_offset = vertex_varying_buffer_offset + vertex_varying_buffer_size;
-
-            // temporary staging buffer
-            RHIDeviceSize inefficient_staging_buffer_size =
-                vertex_position_buffer_size + vertex_varying_enable_blending_buffer_size + vertex_varying_buffer_size +
-                vertex_joint_binding_buffer_size;
-            RHIBuffer* inefficient_staging_buffer = RHI_NULL_HANDLE;
-            RHIDeviceMemory* inefficient_staging_buffer_memory = RHI_NULL_HANDLE;
-            rhi->createBuffer(inefficient_staging_buffer_size,
-                              RHI_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                              RHI_MEMORY_PROPERTY_HOST_VISIBLE_BIT | RHI_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                              inefficient_staging_buffer,
-                              inefficient_staging_buffer_memory);
-
-            void* inefficient_staging_buffer_data;
-            rhi->mapMemory(inefficient_staging_buffer_memory,
-                           0,
-                           RHI_WHOLE_SIZE,
-                           0,
-                           &inefficient_staging_buffer_data);
-
-            MeshVertex::VulkanMeshVertexPostition* mesh_vertex_positions =
-                reinterpret_cast<MeshVertex::VulkanMeshVertexPostition*>(
-                    reinterpret_cast<uintptr_t>(inefficient_staging_buffer_data) + vertex_position_buffer_offset);
-            MeshVertex::VulkanMeshVertexVaryingEnableBlending* mesh_vertex_blending_varyings =
-                reinterpret_cast<MeshVertex::VulkanMeshVertexVaryingEnableBlending*>(
-                    reinterpret_cast<uintptr_t>(inefficient_staging_buffer_data) +
-                    vertex_varying_enable_blending_buffer_offset);
-            MeshVertex::VulkanMeshVertexVarying* mesh_vertex_varyings =
-                reinterpret_cast<MeshVertex::VulkanMeshVertexVarying*>(
-                    reinterpret_cast<uintptr_t>(inefficient_staging_buffer_data) + vertex_varying_buffer_offset);
             MeshVertex::VulkanMeshVertexJointBinding* mesh_vertex_joint_binding =
                 reinterpret_cast<MeshVertex::VulkanMeshVertexJointBinding*>(
-                    reinterpret_cast<uintptr_t>(inefficient_staging_buffer_data) + vertex_joint_binding_buffer_offset);
+                    reinterpret_cast<uintptr_t>(staging_buffer_data) + vertex_joint_binding_buffer_offset);
 
+            // the shader reads the bindings with gl_VertexIndex, so they are stored per vertex
             for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
             {
-                Vector3 normal = Vector3(vertex_buffer_data[vertex_index].nx,
-                    vertex_buffer_data[vertex_index].ny,
-                    vertex_buffer_data[vertex_index].nz);
-                Vector3 tangent = Vector3(vertex_buffer_data[vertex_index].tx,
-                    vertex_buffer_data[vertex_index].ty,
-                    vertex_buffer_data[vertex_index].tz);
-
-                mesh_vertex_positions[vertex_index].position = Vector3(vertex_buffer_data[vertex_index].x,
-                    vertex_buffer_data[vertex_index].y,
-                    vertex_buffer_data[vertex_index].z);
-
-                mesh_vertex_blending_varyings[vertex_index].normal = normal;
-                mesh_vertex_blending_varyings[vertex_index].tangent = tangent;
-
-                mesh_vertex_varyings[vertex_index].texcoord =
-                    Vector2(vertex_buffer_data[vertex_index].u, vertex_buffer_data[vertex_index].v);
-            }
-
-            for (uint32_t index_index = 0; index_index < index_count; ++index_index)
-            {
-                uint32_t vertex_buffer_index = index_buffer_data[index_index];
+                const MeshVertexBindingDataDefinition& joint_binding = joint_binding_buffer_data[vertex_index];
 
-                // TODO: move to assets loading process
+                mesh_vertex_joint_binding[vertex_index].indices[0] = joint_binding.m_index0;
+                mesh_vertex_joint_binding[vertex_index].indices[1] = joint_binding.m_index1;
+                mesh_vertex_joint_binding[vertex_index].indices[2] = joint_binding.m_index2;
+                mesh_vertex_joint_binding[vertex_index].indices[3] = joint_binding.m_index3;
 
-                mesh_vertex_joint_binding[index_index].indices[0] = joint_binding_buffer_data[vertex_buffer_index].m_index0;
-                mesh_vertex_joint_binding[index_index].indices[1] = joint_binding_buffer_data[vertex_buffer_index].m_index1;
-                mesh_vertex_joint_binding[index_index].indices[2] = joint_binding_buffer_data[vertex_buffer_index].m_index2;
-                mesh_vertex_joint_binding[index_index].indices[3] = joint_binding_buffer_data[vertex_buffer_index].m_index3;
-
-                float inv_total_weight = joint_binding_buffer_data[vertex_buffer_index].m_weight0 +
-                                         joint_binding_buffer_data[vertex_buffer_index].m_weight1 +
-                                         joint_binding_buffer_data[vertex_buffer_index].m_weight2 +
-                                         joint_binding_buffer_data[vertex_buffer_index].m_weight3;
+                float inv_total_weight = joint_binding.m_weight0 + joint_binding.m_weight1 +
+                                         joint_binding.m_weight2 + joint_binding.m_weight3;
 
                 inv_total_weight = (inv_total_weight != 0.0) ? 1 / inv_total_weight : 1.0;
 
-                mesh_vertex_joint_binding[index_index].weights =
-                    Vector4(joint_binding_buffer_data[vertex_buffer_index].m_weight0 * inv_total_weight,
-                        joint_binding_buffer_data[vertex_buffer_index].m_weight1 * inv_total_weight,
-                        joint_binding_buffer_data[vertex_buffer_index].m_weight2 * inv_total_weight,
-                        joint_binding_buffer_data[vertex_buffer_index].m_weight3 * inv_total_weight);
+                mesh_vertex_joint_binding[vertex_index].weights = Vector4(joint_binding.m_weight0 * inv_total_weight,
+                                                                          joint_binding.m_weight1 * inv_total_weight,
+                                                                          joint_binding.m_weight2 * inv_total_weight,
+                                                                          joint_binding.m_weight3 * inv_total_weight);
             }
 
-            rhi->unmapMemory(inefficient_staging_buffer_memory);
-
-            // use the vmaAllocator to allocate asset vertex buffer
-            RHIBufferCreateInfo bufferInfo = { RHI_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-
-            VmaAllocationCreateInfo allocInfo = {};
-            allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
-
-            bufferInfo.usage = RHI_BUFFER_USAGE_VERTEX_BUFFER_BIT | RHI_BUFFER_USAGE_TRANSFER_DST_BIT;
-            bufferInfo.size = vertex_position_buffer_size;
-            rhi->createBufferVMA(vulkan_context->m_assets_allocator,
-                                 &bufferInfo,
-                                 &allocInfo,
-                                 now_mesh.mesh_vertex_position_buffer,
-                                 &now_mesh.mesh_vertex_position_buffer_allocation,
-                                 NULL);
-            bufferInfo.size = vertex_varying_enable_blending_buffer_size;
-            rhi->createBufferVMA(vulkan_context->m_assets_allocator,
-                                 &bufferInfo,
-                                 &allocInfo,
-                                 now_mesh.mesh_vertex_varying_enable_blending_buffer,
-                                 &now_mesh.mesh_vertex_varying_enable_blending_buffer_allocation,
-                                 NULL);
-            bufferInfo.size = vertex_varying_buffer_size;
-            rhi->createBufferVMA(vulkan_context->m_assets_allocator,
-                                 &bufferInfo,
-                                 &allocInfo,
-                                 now_mesh.mesh_vertex_varying_buffer,
-                                 &now_mesh.mesh_vertex_varying_buffer_allocation,
-                                 NULL);
-
-            bufferInfo.usage = RHI_BUFFER_USAGE_STORAGE_BUFFER_BIT | RHI_BUFFER_USAGE_TRANSFER_DST_BIT;
-            bufferInfo.size = vertex_joint_binding_buffer_size;
-            rhi->createBufferVMA(vulkan_context->m_assets_allocator,
-                                 &bufferInfo,
-                                 &allocInfo,
-                                 now_mesh.mesh_vertex_joint_binding_buffer,
-                                 &now_mesh.mesh_vertex_joint_binding_buffer_allocation,
-                                 NULL);
-
-            // use the data from staging buffer
-            rhi->copyBuffer(inefficient_staging_buffer,
-                            now_mesh.mesh_vertex_position_buffer,
-                            vertex_position_buffer_offset,
-                            0,
-                            vertex_position_buffer_size);
-            rhi->copyBuffer(inefficient_staging_buffer,
-                            now_mesh.mesh_vertex_varying_enable_blending_buffer,
-                            vertex_varying_enable_blending_buffer_offset,
-                            0,
-                            vertex_varying_enable_blending_buffer_size);
-            rhi->copyBuffer(inefficient_staging_buffer,
-                            now_mesh.mesh_vertex_varying_buffer,
-                            vertex_varying_buffer_offset,
-                            0,
-                            vertex_varying_buffer_size);
-            rhi->copyBuffer(inefficient_staging_buffer,
-                            now_mesh.mesh_vertex_joint_binding_buffer,
-                            vertex_joint_binding_buffer_offset,
-                            0,
+            rhi->copyBuffer(staging_buffer,
+                            geometry_buffer._joint_binding._buffer,
+                            staging_buffer_offset + vertex_joint_binding_buffer_offset,
+                            static_cast<RHIDeviceSize>(geometry_buffer._joint_binding._stride) *
+                                now_mesh.mesh_joint_binding_offset,
                             vertex_joint_binding_buffer_size);
+        }
+    }
+
+    void RenderResource::updateIndexBuffer(std::shared_ptr<RHI> rhi,
+                                           uint32_t             index_buffer_size,
+                                           void*                index_buffer_data,
+                                           RHIIndexType         index_type,
+                                           VulkanMesh&          now_mesh)
+    {
+        GeometryBuffer& geometry_buffer = m_global_render_resource._geometry_buffer;
 
-            // release staging buffer
-            rhi->destroyBuffer(inefficient_staging_buffer);
-            rhi->freeMemory(inefficient_staging_buffer_memory);
+        now_mesh.mesh_first_index = allocateGeometryRange(rhi,
+                                                          geometry_buffer._index_allocator,
+                                                          {&geometry_buffer._index},
+                                                          now_mesh.mesh_index_count);
 
-            // update descriptor set
-            RHIDescriptorSetAllocateInfo mesh_vertex_blending_per_mesh_descriptor_set_alloc_info;
-            mesh_vertex_blending_per_mesh_descriptor_set_alloc_info.sType =
-                RHI_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-            mesh_vertex_blending_per_mesh_descriptor_set_alloc_info.pNext = NULL;
-            mesh_vertex_blending_per_mesh_descriptor_set_alloc_info.descriptorPool = vulkan_context->m_descriptor_pool;
-            mesh_vertex_blending_per_mesh_descriptor_set_alloc_info.descriptorSetCount = 1;
-            mesh_vertex_blending_per_mesh_descriptor_set_alloc_info.pSetLayouts        = m_mesh_descriptor_set_layout;
+        // staging memory from the upload ring, all meshes share one 32 bit index buffer
+        RHIDeviceSize buffer_size = sizeof(uint32_t) * now_mesh.mesh_index_count;
 
-            if (RHI_SUCCESS != rhi->allocateDescriptorSets(
-                &mesh_vertex_blending_per_mesh_descriptor_set_alloc_info,
-                now_mesh.mesh_vertex_blending_descriptor_set))
+        RHIBuffer*    staging_buffer        = RHI_NULL_HANDLE;
+        RHIDeviceSize staging_buffer_offset = 0;
+        void*         staging_buffer_data =
+            rhi->allocateStagingMemory(buffer_size, 16, staging_buffer, staging_buffer_offset);
+        if (index_type == RHI_INDEX_TYPE_UINT32)
+        {
+            memcpy(staging_buffer_data, index_buffer_data, (size_t)index_buffer_size);
+        }
+        else
+        {
+            const uint16_t* src_indices = static_cast<const uint16_t*>(index_buffer_data);
+            uint32_t*       dst_indices = static_cast<uint32_t*>(staging_buffer_data);
+            for (uint32_t index = 0; index < now_mesh.mesh_index_count; ++index)
             {
-                throw std::runtime_error("allocate mesh vertex blending per mesh descriptor set");
+                dst_indices[index] = src_indices[index];
             }
+        }
 
-            RHIDescriptorBufferInfo mesh_vertex_Joint_binding_storage_buffer_info = {};
-            mesh_vertex_Joint_binding_storage_buffer_info.offset = 0;
-            mesh_vertex_Joint_binding_storage_buffer_info.range = vertex_joint_binding_buffer_size;
-            mesh_vertex_Joint_binding_storage_buffer_info.buffer = now_mesh.mesh_vertex_joint_binding_buffer;
-            assert(mesh_vertex_Joint_binding_storage_buffer_info.range <
-                m_global_render_resource._storage_buffer._max_storage_buffer_range);
-
-            RHIDescriptorSet* descriptor_set_to_write = now_mesh.mesh_vertex_blending_descriptor_set;
-
-            RHIWriteDescriptorSet descriptor_writes[1];
-
-            RHIWriteDescriptorSet& mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info =
-                descriptor_writes[0];
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.sType =
-                RHI_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.pNext = NULL;
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.dstSet = descriptor_set_to_write;
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.dstBinding = 0;
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.dstArrayElement = 0;
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.descriptorType =
-                RHI_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.descriptorCount = 1;
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.pBufferInfo =
-                &mesh_vertex_Joint_binding_storage_buffer_info;
-
-            rhi->updateDescriptorSets((sizeof(descriptor_writes) / sizeof(descriptor_writes[0])),
-                                      descriptor_writes,
-                                      0,
-                                      NULL);
+        rhi->copyBuffer(staging_buffer,
+                        geometry_buffer._index._buffer,
+                        staging_buffer_offset,
+                        static_cast<RHIDeviceSize>(geometry_buffer._index._stride) * now_mesh.mesh_first_index,
+                        buffer_size);
+    }
+
+    void RenderResource::createGeometryBuffer(std::shared_ptr<RHI> rhi)
+    {
+        GeometryBuffer& geometry_buffer = m_global_render_resource._geometry_buffer;
+
+        geometry_buffer._vertex_position._stride = sizeof(MeshVertex::VulkanMeshVertexPostition);
+        geometry_buffer._vertex_position._usage  = RHI_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+        geometry_buffer._vertex_varying_enable_blending._stride =
+            sizeof(MeshVertex::VulkanMeshVertexVaryingEnableBlending);
+        geometry_buffer._vertex_varying_enable_blending._usage = RHI_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+        geometry_buffer._vertex_varying._stride                = sizeof(MeshVertex::VulkanMeshVertexVarying);
+        geometry_buffer._vertex_varying._usage                 = RHI_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+        geometry_buffer._index._stride                         = sizeof(uint32_t);
+        geometry_buffer._index._usage                          = RHI_BUFFER_USAGE_INDEX_BUFFER_BIT;
+        geometry_buffer._joint_binding._stride = sizeof(MeshVertex::VulkanMeshVertexJointBinding);
+        geometry_buffer._joint_binding._usage  = RHI_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+        geometry_buffer._vertex_allocator.reset(s_geometry_buffer_initial_vertex_capacity);
+        geometry_buffer._index_allocator.reset(s_geometry_buffer_initial_index_capacity);
+        geometry_buffer._joint_binding_allocator.reset(s_geometry_buffer_initial_joint_binding_capacity);
+
+        resizeGeometryStreams(rhi,
+                              {&geometry_buffer._vertex_position,
+                               &geometry_buffer._vertex_varying_enable_blending,
+                               &geometry_buffer._vertex_varying},
+                              s_geometry_buffer_initial_vertex_capacity,
+                              0);
+        resizeGeometryStreams(rhi, {&geometry_buffer._index}, s_geometry_buffer_initial_index_capacity, 0);
+        resizeGeometryStreams(
+            rhi, {&geometry_buffer._joint_binding}, s_geometry_buffer_initial_joint_binding_capacity, 0);
+
+        updateJointBindingDescriptorSet(rhi);
+    }
+
+    uint32_t RenderResource::allocateGeometryRange(std::shared_ptr<RHI>               rhi,
+                                                   GeometryRangeAllocator&            allocator,
+                                                   std::vector<GeometryStreamBuffer*> streams,
+                                                   uint32_t                           count)
+    {
+        if (count == 0)
+        {
+            return s_invalid_geometry_offset;
         }
-        else
+
+        uint32_t offset = allocator.allocate(count);
+        if (offset != s_invalid_geometry_offset)
         {
-            assert(0 == (vertex_buffer_size % sizeof(MeshVertexDataDefinition)));
-            uint32_t vertex_count = vertex_buffer_size / sizeof(MeshVertexDataDefinition);
-
-            RHIDeviceSize vertex_position_buffer_size = sizeof(MeshVertex::VulkanMeshVertexPostition) * vertex_count;
-            RHIDeviceSize vertex_varying_enable_blending_buffer_size =
-                sizeof(MeshVertex::VulkanMeshVertexVaryingEnableBlending) * vertex_count;
-            RHIDeviceSize vertex_varying_buffer_size = sizeof(MeshVertex::VulkanMeshVertexVarying) * vertex_count;
-
-            RHIDeviceSize vertex_position_buffer_offset = 0;
-            RHIDeviceSize vertex_varying_enable_blending_buffer_offset =
-                vertex_position_buffer_offset + vertex_position_buffer_size;
-            RHIDeviceSize vertex_varying_buffer_offset =
-                vertex_varying_enable_blending_buffer_offset + vertex_varying_enable_blending_buffer_size;
-
-            // temporary staging buffer
-            RHIDeviceSize inefficient_staging_buffer_size =
-                vertex_position_buffer_size + vertex_varying_enable_blending_buffer_size + vertex_varying_buffer_size;
-            RHIBuffer* inefficient_staging_buffer = RHI_NULL_HANDLE;
-            RHIDeviceMemory* inefficient_staging_buffer_memory = RHI_NULL_HANDLE;
-            rhi->createBuffer(inefficient_staging_buffer_size,
-                              RHI_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                              RHI_MEMORY_PROPERTY_HOST_VISIBLE_BIT | RHI_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                              inefficient_staging_buffer,
-                              inefficient_staging_buffer_memory);
-
-            void* inefficient_staging_buffer_data;
-            rhi->mapMemory(inefficient_staging_buffer_memory,
-                           0,
-                           RHI_WHOLE_SIZE,
-                           0,
-                           &inefficient_staging_buffer_data);
-
-            MeshVertex::VulkanMeshVertexPostition* mesh_vertex_positions =
-                reinterpret_cast<MeshVertex::VulkanMeshVertexPostition*>(
-                    reinterpret_cast<uintptr_t>(inefficient_staging_buffer_data) + vertex_position_buffer_offset);
-            MeshVertex::VulkanMeshVertexVaryingEnableBlending* mesh_vertex_blending_varyings =
-                reinterpret_cast<MeshVertex::VulkanMeshVertexVaryingEnableBlending*>(
-                    reinterpret_cast<uintptr_t>(inefficient_staging_buffer_data) +
-                    vertex_varying_enable_blending_buffer_offset);
-            MeshVertex::VulkanMeshVertexVarying* mesh_vertex_varyings =
-                reinterpret_cast<MeshVertex::VulkanMeshVertexVarying*>(
-                    reinterpret_cast<uintptr_t>(inefficient_staging_buffer_data) + vertex_varying_buffer_offset);
+            return offset;
+        }
 
-            for (uint32_t vertex_index = 0; vertex_index < vertex_count; ++vertex_index)
+        // ռ䲻㣺ݣòԭƵ»еƫƲ
+        uint64_t new_capacity = std::max<uint64_t>(allocator.getCapacity(), 1);
+        while (new_capacity - allocator.getUsedCount() < count)
+        {
+            new_capacity *= 2;
+        }
+        if (new_capacity > UINT32_MAX)
+        {
+            throw std::runtime_error("geometry buffer capacity exceeded");
+        }
+
+        allocator.grow(static_cast<uint32_t>(new_capacity));
+        resizeGeometryStreams(rhi, streams, static_cast<uint32_t>(new_capacity), allocator.getUsedCount());
+
+        if (&allocator == &m_global_render_resource._geometry_buffer._joint_binding_allocator)
+        {
+            updateJointBindingDescriptorSet(rhi);
+        }
+
+        offset = allocator.allocate(count);
+        assert(offset != s_invalid_geometry_offset);
+        return offset;
+    }
+
+    void RenderResource::resizeGeometryStreams(std::shared_ptr<RHI>               rhi,
+                                               std::vector<GeometryStreamBuffer*> streams,
+                                               uint32_t                           new_capacity,
+                                               uint32_t                           copy_count)
+    {
+        VulkanRHI* vulkan_context = static_cast<VulkanRHI*>(rhi.get());
+
+        RHICommandBuffer* command_buffer = nullptr;
+        if (copy_count > 0)
+        {
+            // ǰϴοܸдɻǰȴЩ
+            command_buffer = rhi->beginSingleTimeCommands();
+
+            RHIMemoryBarrier transfer_barrier {};
+            transfer_barrier.sType         = RHI_STRUCTURE_TYPE_MEMORY_BARRIER;
+            transfer_barrier.srcAccessMask = RHI_ACCESS_TRANSFER_WRITE_BIT;
+            transfer_barrier.dstAccessMask = RHI_ACCESS_TRANSFER_READ_BIT;
+            rhi->cmdPipelineBarrier(command_buffer,
+                                    RHI_PIPELINE_STAGE_TRANSFER_BIT,
+                                    RHI_PIPELINE_STAGE_TRANSFER_BIT,
+                                    0,
+                                    1,
+                                    &transfer_barrier,
+                                    0,
+                                    nullptr,
+                                    0,
+                                    nullptr);
+        }
+
+        for (GeometryStreamBuffer* stream : streams)
+        {
+            RHIBufferCreateInfo buffer_info = {RHI_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+            buffer_info.size                = static_cast<RHIDeviceSize>(stream->_stride) * new_capacity;
+            buffer_info.usage = stream->_usage | RHI_BUFFER_USAGE_TRANSFER_SRC_BIT | RHI_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+            VmaAllocationCreateInfo alloc_info = {};
+            alloc_info.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+
+            RHIBuffer*    new_buffer     = nullptr;
+            VmaAllocation new_allocation = nullptr;
+            if (!rhi->createBufferVMA(
+                    vulkan_context->m_assets_allocator, &buffer_info, &alloc_info, new_buffer, &new_allocation, NULL))
             {
-                Vector3 normal = Vector3(vertex_buffer_data[vertex_index].nx,
-                    vertex_buffer_data[vertex_index].ny,
-                    vertex_buffer_data[vertex_index].nz);
-                Vector3 tangent = Vector3(vertex_buffer_data[vertex_index].tx,
-                    vertex_buffer_data[vertex_index].ty,
-                    vertex_buffer_data[vertex_index].tz);
-
-                mesh_vertex_positions[vertex_index].position = Vector3(vertex_buffer_data[vertex_index].x,
-                    vertex_buffer_data[vertex_index].y,
-                    vertex_buffer_data[vertex_index].z);
-
-                mesh_vertex_blending_varyings[vertex_index].normal = normal;
-                mesh_vertex_blending_varyings[vertex_index].tangent = tangent;
-
-                mesh_vertex_varyings[vertex_index].texcoord =
-                    Vector2(vertex_buffer_data[vertex_index].u, vertex_buffer_data[vertex_index].v);
+                throw std::runtime_error("create geometry buffer");
             }
 
-            rhi->unmapMemory(inefficient_staging_buffer_memory);
-
-            // use the vmaAllocator to allocate asset vertex buffer
-            RHIBufferCreateInfo bufferInfo = { RHI_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-            bufferInfo.usage = RHI_BUFFER_USAGE_VERTEX_BUFFER_BIT | RHI_BUFFER_USAGE_TRANSFER_DST_BIT;
-
-            VmaAllocationCreateInfo allocInfo = {};
-            allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
-
-            bufferInfo.size = vertex_position_buffer_size;
-            rhi->createBufferVMA(vulkan_context->m_assets_allocator,
-                                 &bufferInfo,
-                                 &allocInfo,
-                                 now_mesh.mesh_vertex_position_buffer,
-                                 &now_mesh.mesh_vertex_position_buffer_allocation,
-                                 NULL);
-            bufferInfo.size = vertex_varying_enable_blending_buffer_size;
-            rhi->createBufferVMA(vulkan_context->m_assets_allocator,
-                                 &bufferInfo,
-                                 &allocInfo,
-                                 now_mesh.mesh_vertex_varying_enable_blending_buffer,
-                                 &now_mesh.mesh_vertex_varying_enable_blending_buffer_allocation,
-                                 NULL);
-            bufferInfo.size = vertex_varying_buffer_size;
-            rhi->createBufferVMA(vulkan_context->m_assets_allocator,
-                                 &bufferInfo,
-                                 &allocInfo,
-                                 now_mesh.mesh_vertex_varying_buffer,
-                                 &now_mesh.mesh_vertex_varying_buffer_allocation,
-                                 NULL);
-
-            // use the data from staging buffer
-            rhi->copyBuffer(inefficient_staging_buffer,
-                            now_mesh.mesh_vertex_position_buffer,
-                            vertex_position_buffer_offset,
-                            0,
-                            vertex_position_buffer_size);
-            rhi->copyBuffer(inefficient_staging_buffer,
-                            now_mesh.mesh_vertex_varying_enable_blending_buffer,
-                            vertex_varying_enable_blending_buffer_offset,
-                            0,
-                            vertex_varying_enable_blending_buffer_size);
-            rhi->copyBuffer(inefficient_staging_buffer,
-                            now_mesh.mesh_vertex_varying_buffer,
-                            vertex_varying_buffer_offset,
-                            0,
-                            vertex_varying_buffer_size);
-
-            // release staging buffer
-            rhi->destroyBuffer(inefficient_staging_buffer);
-            rhi->freeMemory(inefficient_staging_buffer_memory);
-
-            // update descriptor set
-            RHIDescriptorSetAllocateInfo mesh_vertex_blending_per_mesh_descriptor_set_alloc_info;
-            mesh_vertex_blending_per_mesh_descriptor_set_alloc_info.sType =
-                RHI_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-            mesh_vertex_blending_per_mesh_descriptor_set_alloc_info.pNext = NULL;
-            mesh_vertex_blending_per_mesh_descriptor_set_alloc_info.descriptorPool = vulkan_context->m_descriptor_pool;
-            mesh_vertex_blending_per_mesh_descriptor_set_alloc_info.descriptorSetCount = 1;
-            mesh_vertex_blending_per_mesh_descriptor_set_alloc_info.pSetLayouts        = m_mesh_descriptor_set_layout;
-
-            if (RHI_SUCCESS != rhi->allocateDescriptorSets(
-                &mesh_vertex_blending_per_mesh_descriptor_set_alloc_info,
-                now_mesh.mesh_vertex_blending_descriptor_set))
+            if (stream->_buffer != nullptr)
             {
-                throw std::runtime_error("allocate mesh vertex blending per mesh descriptor set");
+                if (command_buffer != nullptr)
+                {
+                    RHIBufferCopy copy_region {};
+                    copy_region.srcOffset = 0;
+                    copy_region.dstOffset = 0;
+                    copy_region.size      = static_cast<RHIDeviceSize>(stream->_stride) * copy_count;
+                    rhi->cmdCopyBuffer(command_buffer, stream->_buffer, new_buffer, 1, &copy_region);
+                }
+
+                // ;֡δύĸڶȡɻ
+                RetiredGeometryBuffer retired_buffer;
+                retired_buffer.buffer           = stream->_buffer;
+                retired_buffer.allocation       = stream->_allocation;
+                retired_buffer.remaining_frames = VulkanRHI::k_max_frames_in_flight + 1;
+                m_retired_geometry_buffers.push_back(retired_buffer);
             }
 
-            RHIDescriptorBufferInfo mesh_vertex_Joint_binding_storage_buffer_info = {};
-            mesh_vertex_Joint_binding_storage_buffer_info.offset = 0;
-            mesh_vertex_Joint_binding_storage_buffer_info.range = 1;
-            mesh_vertex_Joint_binding_storage_buffer_info.buffer =
-                m_global_render_resource._storage_buffer._global_null_descriptor_storage_buffer;
-            assert(mesh_vertex_Joint_binding_storage_buffer_info.range <
-                m_global_render_resource._storage_buffer._max_storage_buffer_range);
-
-            RHIDescriptorSet* descriptor_set_to_write = now_mesh.mesh_vertex_blending_descriptor_set;
-
-            RHIWriteDescriptorSet descriptor_writes[1];
-
-            RHIWriteDescriptorSet& mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info =
-                descriptor_writes[0];
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.sType =
-                RHI_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.pNext = NULL;
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.dstSet = descriptor_set_to_write;
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.dstBinding = 0;
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.dstArrayElement = 0;
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.descriptorType =
-                RHI_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.descriptorCount = 1;
-            mesh_vertex_blending_vertex_Joint_binding_storage_buffer_write_info.pBufferInfo =
-                &mesh_vertex_Joint_binding_storage_buffer_info;
-
-            rhi->updateDescriptorSets((sizeof(descriptor_writes) / sizeof(descriptor_writes[0])),
-                                      descriptor_writes,
-                                      0,
-                                      NULL);
+            stream->_buffer     = new_buffer;
+            stream->_allocation = new_allocation;
+        }
+
+        if (command_buffer != nullptr)
+        {
+            rhi->endSingleTimeCommands(command_buffer);
+        }
+    }
+
+    void RenderResource::updateJointBindingDescriptorSet(std::shared_ptr<RHI> rhi)
+    {
+        VulkanRHI*      vulkan_context  = static_cast<VulkanRHI*>(rhi.get());
+        GeometryBuffer& geometry_buffer = m_global_render_resource._geometry_buffer;
+
+        // زֵ֧ͷţ;֡Żؿб´ʱ
+        if (geometry_buffer._joint_binding_descriptor_set != nullptr)
+        {
+            RetiredDescriptorSet retired_descriptor_set;
+            retired_descriptor_set.descriptor_set   = geometry_buffer._joint_binding_descriptor_set;
+            retired_descriptor_set.remaining_frames = VulkanRHI::k_max_frames_in_flight + 1;
+            m_retired_joint_binding_descriptor_sets.push_back(retired_descriptor_set);
+            geometry_buffer._joint_binding_descriptor_set = nullptr;
+        }
+
+        if (!m_free_joint_binding_descriptor_sets.empty())
+        {
+            geometry_buffer._joint_binding_descriptor_set = m_free_joint_binding_descriptor_sets.back();
+            m_free_joint_binding_descriptor_sets.pop_back();
         }
+        else
+        {
+            RHIDescriptorSetAllocateInfo joint_binding_descriptor_set_alloc_info;
+            joint_binding_descriptor_set_alloc_info.sType              = RHI_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+            joint_binding_descriptor_set_alloc_info.pNext              = NULL;
+            joint_binding_descriptor_set_alloc_info.descriptorPool     = vulkan_context->m_descriptor_pool;
+            joint_binding_descriptor_set_alloc_info.descriptorSetCount = 1;
+            joint_binding_descriptor_set_alloc_info.pSetLayouts        = m_mesh_descriptor_set_layout;
+
+            if (RHI_SUCCESS != rhi->allocateDescriptorSets(&joint_binding_descriptor_set_alloc_info,
+                                                           geometry_buffer._joint_binding_descriptor_set))
+            {
+                throw std::runtime_error("allocate mesh joint binding descriptor set");
+            }
+        }
+
+        RHIDescriptorBufferInfo joint_binding_storage_buffer_info = {};
+        joint_binding_storage_buffer_info.offset                  = 0;
+        joint_binding_storage_buffer_info.range                   = static_cast<RHIDeviceSize>(
+            geometry_buffer._joint_binding._stride) * geometry_buffer._joint_binding_allocator.getCapacity();
+        joint_binding_storage_buffer_info.buffer = geometry_buffer._joint_binding._buffer;
+        assert(joint_binding_storage_buffer_info.range <=
+               m_global_render_resource._storage_buffer._max_storage_buffer_range);
+
+        RHIWriteDescriptorSet descriptor_writes[1];
+
+        RHIWriteDescriptorSet& joint_binding_storage_buffer_write_info = descriptor_writes[0];
+        joint_binding_storage_buffer_write_info.sType                  = RHI_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        joint_binding_storage_buffer_write_info.pNext                  = NULL;
+        joint_binding_storage_buffer_write_info.dstSet          = geometry_buffer._joint_binding_descriptor_set;
+        joint_binding_storage_buffer_write_info.dstBinding      = 0;
+        joint_binding_storage_buffer_write_info.dstArrayElement = 0;
+        joint_binding_storage_buffer_write_info.descriptorType  = RHI_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        joint_binding_storage_buffer_write_info.descriptorCount = 1;
+        joint_binding_storage_buffer_write_info.pBufferInfo     = &joint_binding_storage_buffer_info;
+
+        rhi->updateDescriptorSets(
+            (sizeof(descriptor_writes) / sizeof(descriptor_writes[0])), descriptor_writes, 0, NULL);
     }
 
-    void RenderResource::updateIndexBuffer(std::shared_ptr<RHI> rhi,
-                                           uint32_t             index_buffer_size,
-                                           void*                index_buffer_data,
-                                           VulkanMesh&          now_mesh)
+    void RenderResource::releaseRetiredGeometryBuffers(std::shared_ptr<RHI> rhi)
     {
         VulkanRHI* vulkan_context = static_cast<VulkanRHI*>(rhi.get());
 
-        // temp staging buffer
-        RHIDeviceSize buffer_size = index_buffer_size;
+        for (auto it = m_retired_geometry_buffers.begin(); it != m_retired_geometry_buffers.end();)
+        {
+            if (it->remaining_frames > 0)
+            {
+                --it->remaining_frames;
+                ++it;
+                continue;
+            }
 
-        RHIBuffer* inefficient_staging_buffer;
-        RHIDeviceMemory* inefficient_staging_buffer_memory;
-        rhi->createBuffer(buffer_size,
-                          RHI_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                          RHI_MEMORY_PROPERTY_HOST_VISIBLE_BIT | RHI_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                          inefficient_staging_buffer,
-                          inefficient_staging_buffer_memory);
-
-        void* staging_buffer_data;
-        rhi->mapMemory(inefficient_staging_buffer_memory, 0, buffer_size, 0, &staging_buffer_data);
-        memcpy(staging_buffer_data, index_buffer_data, (size_t)buffer_size);
-        rhi->unmapMemory(inefficient_staging_buffer_memory);
-
-        // use the vmaAllocator to allocate asset index buffer
-        RHIBufferCreateInfo bufferInfo = { RHI_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-        bufferInfo.size = buffer_size;
-        bufferInfo.usage = RHI_BUFFER_USAGE_INDEX_BUFFER_BIT | RHI_BUFFER_USAGE_TRANSFER_DST_BIT;
-
-        VmaAllocationCreateInfo allocInfo = {};
-        allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
-
-        rhi->createBufferVMA(vulkan_context->m_assets_allocator,
-                             &bufferInfo,
-                             &allocInfo,
-                             now_mesh.mesh_index_buffer,
-                             &now_mesh.mesh_index_buffer_allocation,
-                             NULL);
-
-        // use the data from staging buffer
-        rhi->copyBuffer( inefficient_staging_buffer, now_mesh.mesh_index_buffer, 0, 0, buffer_size);
-
-        // release temp staging buffer
-        rhi->destroyBuffer(inefficient_staging_buffer);
-        rhi->freeMemory(inefficient_staging_buffer_memory);
+            rhi->destroyBufferVMA(vulkan_context->m_assets_allocator, it->buffer, it->allocation);
+            it = m_retired_geometry_buffers.erase(it);
+        }
+
+        for (auto it = m_retired_joint_binding_descriptor_sets.begin();
+             it != m_retired_joint_binding_descriptor_sets.end();)
+        {
+            if (it->remaining_frames > 0)
+            {
+                --it->remaining_frames;
+                ++it;
+                continue;
+            }
+
+            m_free_joint_binding_descriptor_sets.push_back(it->descriptor_set);
+            it = m_retired_joint_binding_descriptor_sets.erase(it);
+        }
     }
 
     void RenderResource::updateTextureImageData(std::shared_ptr<RHI> rhi, const TextureDataToUpdate& texture_data)
@@ -1129,7 +1196,9 @@ namespace Sammi
             texture_data.base_color_image_width,
             texture_data.base_color_image_height,
             texture_data.base_color_image_pixels,
-            texture_data.base_color_image_format);
+            texture_data.base_color_image_format,
+            0,
+            texture_data.base_color_image_mip_levels);
 
         rhi->createGlobalImage(
             texture_data.now_material->metallic_roughness_texture_image,
@@ -1138,7 +1207,9 @@ namespace Sammi
             texture_data.metallic_roughness_image_width,
             texture_data.metallic_roughness_image_height,
             texture_data.metallic_roughness_image_pixels,
-            texture_data.metallic_roughness_image_format);
+            texture_data.metallic_roughness_image_format,
+            0,
+            texture_data.metallic_roughness_image_mip_levels);
 
         rhi->createGlobalImage(
             texture_data.now_material->normal_texture_image,
@@ -1147,7 +1218,9 @@ namespace Sammi
             texture_data.normal_roughness_image_width,
             texture_data.normal_roughness_image_height,
             texture_data.normal_roughness_image_pixels,
-            texture_data.normal_roughness_image_format);
+            texture_data.normal_roughness_image_format,
+            0,
+            texture_data.normal_roughness_image_mip_levels);
 
         rhi->createGlobalImage(
             texture_data.now_material->occlusion_texture_image,
@@ -1156,7 +1229,9 @@ namespace Sammi
             texture_data.occlusion_image_width,
             texture_data.occlusion_image_height,
             texture_data.occlusion_image_pixels,
-            texture_data.occlusion_image_format);
+            texture_data.occlusion_image_format,
+            0,
+            texture_data.occlusion_image_mip_levels);
 
         rhi->createGlobalImage(
             texture_data.now_material->emissive_texture_image,
@@ -1165,10 +1240,12 @@ namespace Sammi
             texture_data.emissive_image_width,
             texture_data.emissive_image_height,
             texture_data.emissive_image_pixels,
-            texture_data.emissive_image_format);
+            texture_data.emissive_image_format,
+            0,
+            texture_data.emissive_image_mip_levels);
     }
 
-    VulkanMesh& RenderResource::getEntityMesh(RenderEntity entity)
+    VulkanMesh& RenderResource::getEntityMesh(const RenderEntity& entity)
     {
         size_t assetid = entity.m_mesh_asset_id;
 
@@ -1183,11 +1260,16 @@ namespace Sammi
         }
     }
 
-    VulkanPBRMaterial& RenderResource::getEntityMaterial(RenderEntity entity)
+    VulkanPBRMaterial& RenderResource::getEntityMaterial(const RenderEntity& entity)
     {
         size_t assetid = entity.m_material_asset_id;
 
         auto it = m_vulkan_pbr_materials.find(assetid);
+        if (it == m_vulkan_pbr_materials.end())
+        {
+            // δϴ
+            it = m_vulkan_pbr_materials.find(m_placeholder_material_asset_id);
+        }
         if (it != m_vulkan_pbr_materials.end())
         {
             return it->second;
@@ -1204,6 +1286,17 @@ namespace Sammi
             m_global_render_resource._storage_buffer._global_upload_ringbuffers_begin[current_frame_index];
     }
 
+    uint32_t StorageBuffer::allocateUploadRingbuffer(uint8_t frame_index, uint32_t size)
+    {
+        std::lock_guard<std::mutex> lock(_global_upload_ringbuffer_mutex);
+
+        uint32_t offset = roundUp(_global_upload_ringbuffers_end[frame_index], _min_storage_buffer_offset_alignment);
+        _global_upload_ringbuffers_end[frame_index] = offset + size;
+        assert(_global_upload_ringbuffers_end[frame_index] <=
+               (_global_upload_ringbuffers_begin[frame_index] + _global_upload_ringbuffers_size[frame_index]));
+        return offset;
+    }
+
     void RenderResource::createAndMapStorageBuffer(std::shared_ptr<RHI> rhi)
     {
         VulkanRHI* raw_rhi = static_cast<VulkanRHI*>(rhi.get());
@@ -5,6 +5,7 @@
 #include "runtime/function/render/interface/rhi.h"
 
 #include "runtime/function/render/render_common.h"
+#include "runtime/function/render/render_geometry_allocator.h"
 
 #include <vk_mem_alloc.h>
 #include <vulkan/vulkan.h>
@@ -12,6 +13,8 @@
 #include <array>
 #include <cstdint>
 #include <map>
+#include <mutex>
+#include <string>
 #include <vector>
 #include <cmath>
 
@@ -97,6 +100,11 @@ namespace Sammi
         std::vector<uint32_t> _global_upload_ringbuffers_begin;
         std::vector<uint32_t> _global_upload_ringbuffers_end;
         std::vector<uint32_t> _global_upload_ringbuffers_size;
+        // ¼ʱ߳ͬʱڻλз
+        std::mutex _global_upload_ringbuffer_mutex;
+
+        /// ָ֡Ļλзsizeֽڣ洢ƫƶ룩ƫƣڶ߳ͬʱ
+        uint32_t allocateUploadRingbuffer(uint8_t frame_index, uint32_t size);
 
         // 洢Ҫǿհ󶨵ɫԴ
         RHIBuffer* _global_null_descriptor_storage_buffer;               // մ洢
@@ -108,6 +116,36 @@ namespace Sammi
         void* _axis_inefficient_storage_buffer_memory_pointer;     // ڴָ
     };
 
+    // -------------------------- λṹ --------------------------
+    /// һGPUԪشС̶ʱ廻ɸĻ
+    struct GeometryStreamBuffer
+    {
+        RHIBuffer*          _buffer {nullptr};      // 
+        VmaAllocation       _allocation {nullptr};  // VMAڴ
+        uint32_t            _stride {0};            // ԪشСֽڣ
+        RHIBufferUsageFlags _usage {0};             // ;ӴԴ/Ŀ꣩
+    };
+
+    /// Ķؽڰ󶨴󻺳ֻ¼Եƫ
+    /// ÿֻͨһζfirstIndex/vertexOffset
+    struct GeometryBuffer
+    {
+        // һƫԶΪλ
+        GeometryRangeAllocator _vertex_allocator;
+        GeometryStreamBuffer   _vertex_position;                 // λ
+        GeometryStreamBuffer   _vertex_varying_enable_blending;  // ߣ붥ϣ
+        GeometryStreamBuffer   _vertex_varying;                  // 
+
+        // ͳһΪ32λƫΪλ
+        GeometryRangeAllocator _index_allocator;
+        GeometryStreamBuffer   _index;
+
+        // ؽڰǴ洢ɫgl_VertexIndexʵеƫƶȡƫԶΪλ
+        GeometryRangeAllocator _joint_binding_allocator;
+        GeometryStreamBuffer   _joint_binding;
+        RHIDescriptorSet*      _joint_binding_descriptor_set {nullptr};  // ãʱһ
+    };
+
     // -------------------------- ȫȾԴṹ --------------------------
     /// ȫֹȾԴIBLɫּ洢
     struct GlobalRenderResource
@@ -115,6 +153,7 @@ namespace Sammi
         IBLResource          _ibl_resource;            // IBLԴ
         ColorGradingResource _color_grading_resource;  // ɫּԴ
         StorageBuffer        _storage_buffer;          // 洢
+        GeometryBuffer       _geometry_buffer;         // 񼸺δ󻺳
     };
 
     // -------------------------- ȾԴ --------------------------
@@ -165,14 +204,17 @@ namespace Sammi
         virtual void updatePerFrameBuffer(std::shared_ptr<RenderScene> render_scene, std::shared_ptr<RenderCamera> camera) override final;
 
         /// ȡʵVulkan󣨻أ
-        VulkanMesh& getEntityMesh(RenderEntity entity);
+        VulkanMesh& getEntityMesh(const RenderEntity& entity);
 
-        /// ȡʵVulkan PBRʶ󣨻أ
-        VulkanPBRMaterial& getEntityMaterial(RenderEntity entity);
+        /// ȡʵVulkan PBRʶ󣨻أʽʱռλ
+        VulkanPBRMaterial& getEntityMaterial(const RenderEntity& entity);
 
         /// ָ֡Ļλƫһ֡ϴ
         void resetRingBufferOffset(uint8_t current_frame_index);
 
+        /// ѱļλ滻Ҳٱ;֡ʹõľɻվɵĹؽڰÿ֡һ
+        void releaseRetiredGeometryBuffers(std::shared_ptr<RHI> rhi);
+
         // ȫȾԴᴩȾ̵ĺԴ
         GlobalRenderResource m_global_render_resource;
 
@@ -188,6 +230,8 @@ namespace Sammi
         // Ͳʣظ
         std::map<size_t, VulkanMesh>        m_vulkan_meshes;         // ʵϣֵVulkan
         std::map<size_t, VulkanPBRMaterial> m_vulkan_pbr_materials;  // ʵϣֵVulkan PBRʶ
+        // ռλʣ1x1ɫԴIDڲϴǰ
+        size_t m_placeholder_material_asset_id {0};
 
         // ָ루ԴϴʱĲְ󶨣
         RHIDescriptorSetLayout* const* m_mesh_descriptor_set_layout {nullptr};      // 
@@ -206,6 +250,13 @@ namespace Sammi
          */
         void createIBLSamplers(std::shared_ptr<RHI> rhi);
 
+        /**
+         * @brief زϴIBLԴնȡ߹ͼBRDFұʹú決IBLļ
+         * @param rhi ȾӲӿʵ
+         * @param ibl_resource_desc ؿIBLԴ
+         */
+        void uploadIBLResource(std::shared_ptr<RHI> rhi, const LevelIBLResourceDesc& ibl_resource_desc);
+
         /**
          * @brief IBLϴݵGPU
          * @param rhi ȾӲӿʵ
@@ -214,6 +265,13 @@ namespace Sammi
          */
         void createIBLTextures(std::shared_ptr<RHI> rhi, std::array<std::shared_ptr<TextureData>, 6> irradiance_maps, std::array<std::shared_ptr<TextureData>, 6> specular_maps);
 
+        /**
+         * @brief ɺ決IBLļIBLMIPֱϴGPU
+         * @param rhi ȾӲӿʵ
+         * @param ibl_data 決ļеķն߹ͼ
+         */
+        void createIBLTextures(std::shared_ptr<RHI> rhi, const IBLData& ibl_data);
+
         /**
          * @brief ȡ򴴽Vulkan󣨻ƣ
          * @param rhi ȾӲӿʵ
@@ -238,6 +296,7 @@ namespace Sammi
          * @param enable_vertex_blending Ƿöϣ
          * @param index_buffer_size Сֽڣ
          * @param index_buffer_data ָ
+         * @param index_type ͣ16λ32λ
          * @param vertex_buffer_size 㻺Сֽڣ
          * @param vertex_buffer_data ָ
          * @param joint_binding_buffer_size ؽڰ󶨻С
@@ -248,6 +307,7 @@ namespace Sammi
                             bool                                          enable_vertex_blending,
                             uint32_t                                      index_buffer_size,
                             void*                                         index_buffer_data,
+                            RHIIndexType                                  index_type,
                             uint32_t                                      vertex_buffer_size,
                             struct MeshVertexDataDefinition const*        vertex_buffer_data,
                             uint32_t                                      joint_binding_buffer_size,
@@ -262,8 +322,6 @@ namespace Sammi
          * @param vertex_buffer_data ָ
          * @param joint_binding_buffer_size ؽڰ󶨻С
          * @param joint_binding_buffer_data ؽڰָ
-         * @param index_buffer_size С
-         * @param index_buffer_data ָ루uint16_tͣ
          * @param now_mesh Ŀ
          */
         void updateVertexBuffer(std::shared_ptr<RHI>                          rhi,
@@ -272,27 +330,87 @@ namespace Sammi
                                 struct MeshVertexDataDefinition const*        vertex_buffer_data,
                                 uint32_t                                      joint_binding_buffer_size,
                                 struct MeshVertexBindingDataDefinition const* joint_binding_buffer_data,
-                                uint32_t                                      index_buffer_size,
-                                uint16_t*                                     index_buffer_data,
                                 VulkanMesh&                                   now_mesh);
 
         /**
-         * @brief 
+         * @brief ݣ16λдݴڴʱչΪ32λ
          * @param rhi ȾӲӿʵ
          * @param index_buffer_size Сֽڣ
-         * @param index_buffer_data ָ루uint16_tͣ
+         * @param index_buffer_data ָ
+         * @param index_type ͣ16λ32λ
          * @param now_mesh Ŀ
          */
         void updateIndexBuffer(std::shared_ptr<RHI> rhi,
                                uint32_t             index_buffer_size,
                                void*                index_buffer_data,
+                               RHIIndexType         index_type,
                                VulkanMesh&          now_mesh);
 
+        /**
+         * @brief δ󻺳ĳʼؽڰ
+         * @param rhi ȾӲӿʵ
+         */
+        void createGeometryBuffer(std::shared_ptr<RHI> rhi);
+
+        /**
+         * @brief ڼĩβһԪأռ䲻ʱݣѷƫƱֲ䣩
+         * @param rhi ȾӲӿʵ
+         * @param allocator ķ
+         * @param streams ø÷ļ
+         * @param count Ԫ
+         * @return uint32_t 䵽ƫƣԪΪλ
+         */
+        uint32_t allocateGeometryRange(std::shared_ptr<RHI>               rhi,
+                                       GeometryRangeAllocator&            allocator,
+                                       std::vector<GeometryStreamBuffer*> streams,
+                                       uint32_t                           count);
+
+        /**
+         * @brief µؽĻѾɻǰõԪظƹȥɻӳ
+         * @param rhi ȾӲӿʵ
+         * @param streams Ҫؽļ
+         * @param new_capacity ԪΪλ
+         * @param copy_count ҪƵԪƫ0ʼ
+         */
+        void resizeGeometryStreams(std::shared_ptr<RHI>               rhi,
+                                   std::vector<GeometryStreamBuffer*> streams,
+                                   uint32_t                           new_capacity,
+                                   uint32_t                           copy_count);
+
+        /**
+         * @brief ΪǰĹؽڰ󶨻һд루Ա;֡ʹãԭظ£
+         *        ;֡ոã
+         * @param rhi ȾӲӿʵ
+         */
+        void updateJointBindingDescriptorSet(std::shared_ptr<RHI> rhi);
+
         /**
          * @brief ͼݣCPUϴGPU
          * @param rhi ȾӲӿʵ
          * @param texture_data ݺԪϢĽṹ
          */
         void updateTextureImageData(std::shared_ptr<RHI> rhi, const TextureDataToUpdate& texture_data);
+
+        // ϴȫԴӦԴļʮIBLBRDFͼɫּͼؿлʱԴļͬ¼
+        std::vector<std::string> m_uploaded_ibl_source_urls;
+        std::string              m_uploaded_color_grading_url;
+
+        // 滻ļλȴ;֡ϴν
+        struct RetiredGeometryBuffer
+        {
+            RHIBuffer*    buffer {nullptr};
+            VmaAllocation allocation {nullptr};
+            uint32_t      remaining_frames {0};
+        };
+        std::vector<RetiredGeometryBuffer> m_retired_geometry_buffers;
+
+        // 滻Ĺؽڰ;֡б
+        struct RetiredDescriptorSet
+        {
+            RHIDescriptorSet* descriptor_set {nullptr};
+            uint32_t          remaining_frames {0};
+        };
+        std::vector<RetiredDescriptorSet> m_retired_joint_binding_descriptor_sets;
+        std::vector<RHIDescriptorSet*>    m_free_joint_binding_descriptor_sets;
     };
 }
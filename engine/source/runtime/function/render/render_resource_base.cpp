@@ -1,5 +1,10 @@
 ﻿#include "runtime/function/render/render_resource_base.h"
+#include "runtime/core/base/hash.h"
 #include "runtime/core/base/macro.h"
+#include "runtime/function/render/render_ibl_file.h"
+#include "runtime/function/render/render_mesh_file.h"
+#include "runtime/function/render/render_mesh_optimizer.h"
+#include "runtime/function/render/render_texture_file.h"
 #include "runtime/resource/asset_manager/asset_manager.h"
 #include "runtime/resource/config_manager/config_manager.h"
 #include "runtime/resource/res_type/data/mesh_data.h"
@@ -12,11 +17,87 @@
 #include "tiny_obj_loader.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <filesystem>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace Sammi
 {
+    namespace
+    {
+        // skybox_specular_X+.hdr等十二个面烘焙为skybox_specular_X+.ibl
+        std::string getCookedIBLUrl(const LevelIBLResourceDesc& ibl_resource_desc)
+        {
+            return std::filesystem::path(ibl_resource_desc.m_skybox_specular_map.m_positive_x_map)
+                .replace_extension(".ibl")
+                .generic_string();
+        }
+
+        // 按顶点数选择索引类型：不超过65535个顶点用16位索引，否则用32位索引（0xFFFF保留给图元重启）
+        std::shared_ptr<BufferData> createIndexBuffer(const std::vector<uint32_t>& indices,
+                                                      size_t                       vertex_count,
+                                                      RHIIndexType&                out_index_type)
+        {
+            if (vertex_count <= std::numeric_limits<uint16_t>::max())
+            {
+                out_index_type = RHI_INDEX_TYPE_UINT16;
+                auto      index_buffer = std::make_shared<BufferData>(indices.size() * sizeof(uint16_t));
+                uint16_t* index_data   = static_cast<uint16_t*>(index_buffer->m_data);
+                for (size_t i = 0; i < indices.size(); i++)
+                {
+                    index_data[i] = static_cast<uint16_t>(indices[i]);
+                }
+                return index_buffer;
+            }
+
+            out_index_type    = RHI_INDEX_TYPE_UINT32;
+            auto index_buffer = std::make_shared<BufferData>(indices.size() * sizeof(uint32_t));
+            if (!indices.empty())
+            {
+                std::memcpy(index_buffer->m_data, indices.data(), indices.size() * sizeof(uint32_t));
+            }
+            return index_buffer;
+        }
+
+        void logMeshOptimizationReport(const std::string& mesh_file, const MeshOptimizationReport& report)
+        {
+            LOG_INFO("optimized mesh {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+                     mesh_file,
+                     report.m_acmr_before,
+                     report.m_acmr_after,
+                     report.m_atvr_before,
+                     report.m_atvr_after);
+        }
+
+        // OBJ顶点去重键：位置、法线、UV的位模式完全相同才合并为同一顶点
+        struct ObjVertexKey
+        {
+            float m_values[8];
+
+            bool operator==(const ObjVertexKey& rhs) const
+            {
+                return std::memcmp(m_values, rhs.m_values, sizeof(m_values)) == 0;
+            }
+        };
+
+        struct ObjVertexKeyHash
+        {
+            size_t operator()(const ObjVertexKey& key) const
+            {
+                size_t hash = 0;
+                for (float value : key.m_values)
+                {
+                    hash_combine(hash, value);
+                }
+                return hash;
+            }
+        };
+    } // namespace
+
     // ------------------------- 加载HDR纹理 -------------------------
     std::shared_ptr<TextureData> RenderResourceBase::loadTextureHDR(std::string file, int desired_channels)
     {
@@ -30,10 +111,14 @@ namespace Sammi
         int iw, ih, n;
         // 使用stb_image加载HDR浮点纹理
         // 参数说明：
-        // - asset_manager->getFullPath(file).generic_string().c_str()：资源的完整路径（转换为通用字符串）
+        // - texture_file：资源文件内容（资源包中的条目或散文件）
         // - &iw/&ih/&n：输出图像宽度、高度、通道数
         // - desired_channels：期望的通道数（如4表示RGBA）
-        texture->m_pixels = stbi_loadf(asset_manager->getFullPath(file).generic_string().c_str(), &iw, &ih, &n, desired_channels);
+        std::shared_ptr<AssetFile> texture_file = asset_manager->openAssetFile(file);
+        if (!texture_file)
+            return nullptr;
+        texture->m_pixels = stbi_loadf_from_memory(
+            texture_file->getData(), static_cast<int>(texture_file->getSize()), &iw, &ih, &n, desired_channels);
 
         if (!texture->m_pixels)
             return nullptr;
@@ -66,6 +151,62 @@ namespace Sammi
         return texture;
     }
 
+    // ------------------------- 加载烘焙的IBL立方体贴图 -------------------------
+    bool RenderResourceBase::loadIBLData(const LevelIBLResourceDesc& ibl_resource_desc, IBLData& out_ibl_data)
+    {
+        std::shared_ptr<AssetManager> asset_manager = g_runtime_global_context.m_asset_manager;
+        ASSERT(asset_manager);
+
+        if (!isIBLDataUpToDate(ibl_resource_desc))
+            return false;
+
+        const std::string cooked_url = getCookedIBLUrl(ibl_resource_desc);
+        return loadIBLFile(asset_manager->openAssetFile(cooked_url),
+                           cooked_url,
+                           getIBLSourceHash(ibl_resource_desc),
+                           out_ibl_data);
+    }
+
+    bool RenderResourceBase::isIBLDataUpToDate(const LevelIBLResourceDesc& ibl_resource_desc)
+    {
+        std::shared_ptr<AssetManager> asset_manager = g_runtime_global_context.m_asset_manager;
+        ASSERT(asset_manager);
+
+        const std::string cooked_url = getCookedIBLUrl(ibl_resource_desc);
+        if (!asset_manager->hasAssetFile(cooked_url))
+            return false;
+
+        // 任一源面在烘焙之后被修改都视为过期
+        for (const std::string& source_url : getIBLSourceUrls(ibl_resource_desc))
+        {
+            if (!asset_manager->isDerivedAssetUpToDate(source_url, cooked_url))
+                return false;
+        }
+        return true;
+    }
+
+    bool RenderResourceBase::cookIBLData(const LevelIBLResourceDesc& ibl_resource_desc, IBLCookFormat format)
+    {
+        std::shared_ptr<AssetManager> asset_manager = g_runtime_global_context.m_asset_manager;
+        ASSERT(asset_manager);
+
+        const std::array<std::string, 12> source_urls = getIBLSourceUrls(ibl_resource_desc);
+
+        std::array<std::shared_ptr<TextureData>, 6> irradiance_faces;
+        std::array<std::shared_ptr<TextureData>, 6> specular_faces;
+        for (size_t i = 0; i < 6; i++)
+        {
+            irradiance_faces[i] = loadTextureHDR(source_urls[i]);
+            specular_faces[i]   = loadTextureHDR(source_urls[i + 6]);
+        }
+
+        return saveIBLFile(asset_manager->getFullPath(getCookedIBLUrl(ibl_resource_desc)),
+                           getIBLSourceHash(ibl_resource_desc),
+                           irradiance_faces,
+                           specular_faces,
+                           format);
+    }
+
     // ------------------------- 加载普通纹理（LDR） -------------------------
     std::shared_ptr<TextureData> RenderResourceBase::loadTexture(std::string file, bool is_srgb)
     {
@@ -74,13 +215,32 @@ namespace Sammi
 
         std::shared_ptr<TextureData> texture = std::make_shared<TextureData>();
 
+        // 优先映射烘焙后的纹理，完整MIP链直接上传；设备不支持其块压缩格式时回退到源图像
+        const std::string cooked_url =
+            std::filesystem::path(file).extension() == ".tex" ? file : getCookedTextureUrl(file);
+        if (asset_manager->isDerivedAssetUpToDate(file, cooked_url) &&
+            loadTextureFile(asset_manager->openAssetFile(cooked_url), cooked_url, *texture))
+        {
+            if (!isBlockCompressedFormat(texture->m_format) || m_is_texture_compression_supported)
+            {
+                // 烘焙时的颜色空间只影响MIP滤波，采样方式以调用方为准
+                texture->m_format = getTextureFormatInColorSpace(texture->m_format, is_srgb);
+                return texture;
+            }
+            texture = std::make_shared<TextureData>();
+        }
+
         int iw, ih, n;
         // 使用stb_image加载8位无符号整数纹理（LDR）
         // 参数说明：
-        // - asset_manager->getFullPath(file).generic_string().c_str()：资源完整路径
+        // - texture_file：资源文件内容
         // - &iw/&ih/&n：输出宽度、高度、实际通道数（stb_image会自动检测）
         // - 4：强制读取4个通道（RGBA）
-        texture->m_pixels = stbi_load(asset_manager->getFullPath(file).generic_string().c_str(), &iw, &ih, &n, 4);
+        std::shared_ptr<AssetFile> texture_file = asset_manager->openAssetFile(file);
+        if (!texture_file)
+            return nullptr;
+        texture->m_pixels = stbi_load_from_memory(
+            texture_file->getData(), static_cast<int>(texture_file->getSize()), &iw, &ih, &n, 4);
 
         if (!texture->m_pixels)
             return nullptr;
@@ -99,6 +259,74 @@ namespace Sammi
         return texture;
     }
 
+    std::string RenderResourceBase::getCookedTextureUrl(const std::string& texture_url)
+    {
+        // brick.png烘焙为brick.tex
+        return std::filesystem::path(texture_url).replace_extension(".tex").generic_string();
+    }
+
+    bool RenderResourceBase::cookTextureData(const std::string& file, const TextureCookSettings& settings)
+    {
+        std::shared_ptr<AssetManager> asset_manager = g_runtime_global_context.m_asset_manager;
+        ASSERT(asset_manager);
+
+        std::shared_ptr<AssetFile> texture_file = asset_manager->openAssetFile(file);
+        if (!texture_file)
+        {
+            LOG_ERROR("cook texture {} failed, file not found", file);
+            return false;
+        }
+
+        int      iw, ih, n;
+        stbi_uc* pixels = stbi_load_from_memory(
+            texture_file->getData(), static_cast<int>(texture_file->getSize()), &iw, &ih, &n, 4);
+        if (!pixels)
+        {
+            LOG_ERROR("cook texture {} failed, unsupported source format", file);
+            return false;
+        }
+
+        // 块编码耗时较长，按块行分摊到线程池
+        const bool is_saved = saveTextureFile(asset_manager->getFullPath(getCookedTextureUrl(file)),
+                                              pixels,
+                                              static_cast<uint32_t>(iw),
+                                              static_cast<uint32_t>(ih),
+                                              settings,
+                                              g_runtime_global_context.m_thread_pool.get());
+        stbi_image_free(pixels);
+        return is_saved;
+    }
+
+    bool RenderResourceBase::cookMaterialData(const MaterialSourceDesc& source)
+    {
+        TextureCookSettings color_settings;
+        color_settings.m_is_srgb = true;
+
+        // 着色器按xyz读取法线，BC5只保存两个通道，因此默认同样使用BC7
+        TextureCookSettings normal_settings;
+        normal_settings.m_is_normal_map = true;
+
+        const TextureCookSettings data_settings;
+
+        const std::pair<const std::string*, const TextureCookSettings*> textures[] = {
+            {&source.m_base_color_file, &color_settings},
+            {&source.m_metallic_roughness_file, &data_settings},
+            {&source.m_normal_file, &normal_settings},
+            {&source.m_occlusion_file, &data_settings},
+            {&source.m_emissive_file, &data_settings},
+        };
+
+        bool is_cooked = true;
+        for (const auto& texture : textures)
+        {
+            if (!texture.first->empty())
+            {
+                is_cooked = cookTextureData(*texture.first, *texture.second) && is_cooked;
+            }
+        }
+        return is_cooked;
+    }
+
     RenderMeshData RenderResourceBase::loadMeshData(const MeshSourceDesc& source, AxisAlignedBox& bounding_box)
     {
         std::shared_ptr<AssetManager> asset_manager = g_runtime_global_context.m_asset_manager;
@@ -106,6 +334,57 @@ namespace Sammi
 
         RenderMeshData ret;
 
+        // 优先映射烘焙后的二进制网格，数据可直接交给上传流程，无需逐顶点转换
+        // 烘焙文件存在且不早于源文件时才使用，源文件修改后自动回退到源格式
+        const std::string cooked_url = std::filesystem::path(source.m_mesh_file).extension() == ".mesh" ?
+                                           source.m_mesh_file :
+                                           getCookedMeshUrl(source.m_mesh_file);
+        if (!asset_manager->isDerivedAssetUpToDate(source.m_mesh_file, cooked_url) ||
+            !loadMeshFile(asset_manager->openAssetFile(cooked_url), cooked_url, ret, bounding_box))
+        {
+            ret = loadSourceMeshData(source, bounding_box);
+        }
+
+        // 将当前网格的包围盒缓存（避免重复计算），流式加载时在工作线程调用，需加锁
+        std::lock_guard<std::mutex> lock(m_bounding_box_cache_mutex);
+        m_bounding_box_cache_map.insert(std::make_pair(source, bounding_box));
+
+        return ret;
+    }
+
+    std::string RenderResourceBase::getCookedMeshUrl(const std::string& mesh_url)
+    {
+        // fence.obj烘焙为fence.mesh，robot.mesh.json烘焙为robot.mesh，扩展名不与其他烘焙格式共用
+        std::filesystem::path cooked_url(mesh_url);
+        if (cooked_url.extension() == ".json")
+        {
+            cooked_url.replace_extension();
+        }
+        return cooked_url.replace_extension(".mesh").generic_string();
+    }
+
+    bool RenderResourceBase::cookMeshData(const MeshSourceDesc& source)
+    {
+        std::shared_ptr<AssetManager> asset_manager = g_runtime_global_context.m_asset_manager;
+        ASSERT(asset_manager);
+
+        AxisAlignedBox bounding_box;
+        RenderMeshData mesh_data = loadSourceMeshData(source, bounding_box);
+        if (!mesh_data.m_static_mesh_data.m_vertex_buffer)
+        {
+            LOG_ERROR("cook mesh {} failed, unsupported source format", source.m_mesh_file);
+            return false;
+        }
+        return saveMeshFile(asset_manager->getFullPath(getCookedMeshUrl(source.m_mesh_file)), mesh_data, bounding_box);
+    }
+
+    RenderMeshData RenderResourceBase::loadSourceMeshData(const MeshSourceDesc& source, AxisAlignedBox& bounding_box)
+    {
+        std::shared_ptr<AssetManager> asset_manager = g_runtime_global_context.m_asset_manager;
+        ASSERT(asset_manager);
+
+        RenderMeshData ret;
+
         // 根据文件扩展名判断网格格式
         if (std::filesystem::path(source.m_mesh_file).extension() == ".obj")
         {
@@ -141,15 +420,6 @@ namespace Sammi
                 bounding_box.merge(Vector3(vertex[i].x, vertex[i].y, vertex[i].z));
             }
 
-            // ------------------------- 索引缓冲区 -------------------------
-            size_t index_size = bind_data->index_buffer.size() * sizeof(uint16_t);
-            ret.m_static_mesh_data.m_index_buffer = std::make_shared<BufferData>(index_size);
-            uint16_t* index = (uint16_t*)ret.m_static_mesh_data.m_index_buffer->m_data;
-            for (size_t i = 0; i < bind_data->index_buffer.size(); i++)
-            {
-                index[i] = static_cast<uint16_t>(bind_data->index_buffer[i]);
-            }
-
             // ------------------------- 骨骼绑定缓冲区（可选） -------------------------
             size_t data_size = bind_data->bind.size() * sizeof(MeshVertexBindingDataDefinition);
             ret.m_skeleton_binding_buffer = std::make_shared<BufferData>(data_size);
@@ -165,10 +435,27 @@ namespace Sammi
                 binding_data[i].m_weight2 = bind_data->bind[i].weight2;
                 binding_data[i].m_weight3 = bind_data->bind[i].weight3;
             }
-        }
 
-        // 将当前网格的包围盒缓存（避免重复计算）
-        m_bounding_box_cache_map.insert(std::make_pair(source, bounding_box));
+            // ------------------------- 顶点缓存优化 -------------------------
+            // 骨骼绑定与顶点一一对应时随顶点一起重排，否则不重排顶点
+            std::vector<uint32_t>    indices(bind_data->index_buffer.begin(), bind_data->index_buffer.end());
+            MeshOptimizationSettings optimization_settings = m_mesh_optimization_settings;
+            const bool               binding_per_vertex    = bind_data->bind.size() == bind_data->vertex_buffer.size();
+            if (!binding_per_vertex)
+            {
+                optimization_settings.m_enable_vertex_fetch_optimization = false;
+            }
+            logMeshOptimizationReport(source.m_mesh_file,
+                                      optimizeMesh(indices,
+                                                   vertex,
+                                                   binding_per_vertex ? binding_data : nullptr,
+                                                   bind_data->vertex_buffer.size(),
+                                                   optimization_settings));
+
+            // ------------------------- 索引缓冲区 -------------------------
+            ret.m_static_mesh_data.m_index_buffer = createIndexBuffer(
+                indices, bind_data->vertex_buffer.size(), ret.m_static_mesh_data.m_index_type);
+        }
 
         return ret;
     }
@@ -189,6 +476,7 @@ namespace Sammi
     AxisAlignedBox RenderResourceBase::getCachedBoudingBox(const MeshSourceDesc& source) const
     {
         // 在包围盒缓存中查找对应资源的包围盒
+        std::lock_guard<std::mutex> lock(m_bounding_box_cache_mutex);
         auto find_it = m_bounding_box_cache_map.find(source);
         if (find_it != m_bounding_box_cache_map.end())
         {
@@ -205,9 +493,14 @@ namespace Sammi
         tinyobj::ObjReader       reader;
         tinyobj::ObjReaderConfig reader_config;
         reader_config.vertex_color = false;  // 不加载顶点颜色（假设材质已处理）
-
-        // 解析OBJ文件
-        if (!reader.ParseFromFile(filename, reader_config))
+        reader_config.triangulate  = true;   // 多边形面由tinyobj三角化，未能三角化的面下面按扇形拆分
+
+        // 解析OBJ文件：文件内容经由资源管理器读取（资源包或散文件），材质不参与网格构建，不加载mtl
+        std::shared_ptr<AssetFile> obj_file = g_runtime_global_context.m_asset_manager->openAssetFile(filename);
+        const std::string          obj_text =
+            obj_file ? std::string(reinterpret_cast<const char*>(obj_file->getData()), obj_file->getSize()) :
+                       std::string();
+        if (!obj_file || !reader.ParseFromString(obj_text, std::string(), reader_config))
         {
             if (!reader.Error().empty())
             {
@@ -224,8 +517,11 @@ namespace Sammi
         auto& attrib = reader.GetAttrib();  // 顶点属性（位置、法线、纹理坐标）
         auto& shapes = reader.GetShapes();  // 网格形状（面、索引）
 
-        // 存储最终顶点数据
-        std::vector<MeshVertexDataDefinition> mesh_vertices;
+        // 去重后的顶点、每个顶点累加的切线，以及三角形索引
+        std::vector<MeshVertexDataDefinition>                        mesh_vertices;
+        std::vector<Vector3>                                         vertex_tangents;
+        std::vector<uint32_t>                                        mesh_indices;
+        std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHash> vertex_index_map;
 
         // 遍历所有形状（通常一个OBJ文件包含多个子网格）
         for (size_t s = 0; s < shapes.size(); s++)
@@ -235,149 +531,172 @@ namespace Sammi
             {
                 size_t fv = size_t(shapes[s].mesh.num_face_vertices[f]);
 
-                bool with_normal   = true;  // 是否包含法线
-                bool with_texcoord = true;  // 是否包含纹理坐标
-                
-                Vector3 vertex[3];  // 三角形的三个顶点位置
-                Vector3 normal[3];  // 三角形的三个法线
-                Vector2 uv[3];      // 三角形的三个纹理坐标
-
-                // 仅处理三角形面（OBJ标准支持任意多边形，但渲染通常需要三角化）
-                if (fv != 3)
+                // 点和线不参与渲染
+                if (fv < 3)
                 {
-                    continue;  // 非三角形面跳过（实际项目中可能需要三角化）
+                    index_offset += fv;
+                    continue;
                 }
 
-                // 展开顶点属性（OBJ索引可能共享顶点属性）
-                for (size_t v = 0; v < fv; v++)
+                // 多边形按扇形拆分为(0, i, i + 1)三角形
+                for (size_t corner = 1; corner + 1 < fv; corner++)
                 {
-                    auto idx = shapes[s].mesh.indices[index_offset + v];
-                    auto vx  = attrib.vertices[3 * size_t(idx.vertex_index) + 0];
-                    auto vy  = attrib.vertices[3 * size_t(idx.vertex_index) + 1];
-                    auto vz  = attrib.vertices[3 * size_t(idx.vertex_index) + 2];
+                    const tinyobj::index_t triangle[3] = {shapes[s].mesh.indices[index_offset],
+                                                          shapes[s].mesh.indices[index_offset + corner],
+                                                          shapes[s].mesh.indices[index_offset + corner + 1]};
 
-                    vertex[v].x = static_cast<float>(vx);
-                    vertex[v].y = static_cast<float>(vy);
-                    vertex[v].z = static_cast<float>(vz);
+                    bool with_normal   = true;  // 是否包含法线
+                    bool with_texcoord = true;  // 是否包含纹理坐标
 
-                    // 更新包围盒
-                    bounding_box.merge(Vector3(vertex[v].x, vertex[v].y, vertex[v].z));
+                    Vector3 vertex[3];  // 三角形的三个顶点位置
+                    Vector3 normal[3];  // 三角形的三个法线
+                    Vector2 uv[3];      // 三角形的三个纹理坐标
 
-                    // 法线（如果有）
-                    if (idx.normal_index >= 0)
+                    for (size_t v = 0; v < 3; v++)
                     {
-                        auto nx = attrib.normals[3 * size_t(idx.normal_index) + 0];
-                        auto ny = attrib.normals[3 * size_t(idx.normal_index) + 1];
-                        auto nz = attrib.normals[3 * size_t(idx.normal_index) + 2];
-
-                        normal[v].x = static_cast<float>(nx);
-                        normal[v].y = static_cast<float>(ny);
-                        normal[v].z = static_cast<float>(nz);
+                        const tinyobj::index_t& idx = triangle[v];
+
+                        vertex[v].x = static_cast<float>(attrib.vertices[3 * size_t(idx.vertex_index) + 0]);
+                        vertex[v].y = static_cast<float>(attrib.vertices[3 * size_t(idx.vertex_index) + 1]);
+                        vertex[v].z = static_cast<float>(attrib.vertices[3 * size_t(idx.vertex_index) + 2]);
+
+                        // 更新包围盒
+                        bounding_box.merge(vertex[v]);
+
+                        // 法线（如果有）
+                        if (idx.normal_index >= 0)
+                        {
+                            normal[v].x = static_cast<float>(attrib.normals[3 * size_t(idx.normal_index) + 0]);
+                            normal[v].y = static_cast<float>(attrib.normals[3 * size_t(idx.normal_index) + 1]);
+                            normal[v].z = static_cast<float>(attrib.normals[3 * size_t(idx.normal_index) + 2]);
+                        }
+                        else
+                        {
+                            with_normal = false;
+                        }
+
+                        // 纹理坐标（如果有）
+                        if (idx.texcoord_index >= 0)
+                        {
+                            uv[v].x = static_cast<float>(attrib.texcoords[2 * size_t(idx.texcoord_index) + 0]);
+                            uv[v].y = static_cast<float>(attrib.texcoords[2 * size_t(idx.texcoord_index) + 1]);
+                        }
+                        else
+                        {
+                            with_texcoord = false;
+                        }
                     }
-                    else
+
+                    Vector3 edge1     = vertex[1] - vertex[0];
+                    Vector3 edge2     = vertex[2] - vertex[1];
+                    Vector3 face_axis = edge1.crossProduct(edge2);
+
+                    // 若缺少法线，自动生成面法线（所有顶点共享同一法线）
+                    if (!with_normal)
                     {
-                        with_normal = false;
+                        normal[0] = face_axis.normalisedCopy();
+                        normal[1] = normal[0];
+                        normal[2] = normal[0];
                     }
 
-                    // 纹理坐标（如果有）
-                    if (idx.texcoord_index >= 0)
+                    // 若缺少纹理坐标，使用默认UV（中心点）
+                    if (!with_texcoord)
                     {
-                        auto tx = attrib.texcoords[2 * size_t(idx.texcoord_index) + 0];
-                        auto ty = attrib.texcoords[2 * size_t(idx.texcoord_index) + 1];
-
-                        uv[v].x = static_cast<float>(tx);
-                        uv[v].y = static_cast<float>(ty);
+                        uv[0] = Vector2(0.5f, 0.5f);
+                        uv[1] = Vector2(0.5f, 0.5f);
+                        uv[2] = Vector2(0.5f, 0.5f);
                     }
-                    else
+
+                    // 计算面切线，按三角形面积加权累加到共享该面的顶点上
+                    Vector3 tangent;
                     {
-                        with_texcoord = false;
+                        Vector2 deltaUV1 = uv[1] - uv[0];
+                        Vector2 deltaUV2 = uv[2] - uv[1];
+
+                        auto divide = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
+                        if (divide >= 0.0f && divide < 0.000001f)
+                            divide = 0.000001f;
+                        else if (divide < 0.0f && divide > -0.000001f)
+                            divide = -0.000001f;
+
+                        float df  = 1.0f / divide;
+                        tangent.x = df * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
+                        tangent.y = df * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
+                        tangent.z = df * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
+                        tangent   = tangent.normalisedCopy() * (0.5f * face_axis.length());
                     }
-                }
-                index_offset += fv;
-
-                // 若缺少法线，自动生成面法线（所有顶点共享同一法线）
-                if (!with_normal)
-                {
-                    Vector3 v0 = vertex[1] - vertex[0];
-                    Vector3 v1 = vertex[2] - vertex[1];
-                    normal[0]  = v0.crossProduct(v1).normalisedCopy();
-                    normal[1]  = normal[0];
-                    normal[2]  = normal[0];
-                }
 
-                // 若缺少纹理坐标，使用默认UV（中心点）
-                if (!with_texcoord)
-                {
-                    uv[0] = Vector2(0.5f, 0.5f);
-                    uv[1] = Vector2(0.5f, 0.5f);
-                    uv[2] = Vector2(0.5f, 0.5f);
-                }
-
-                // 计算切线空间（用于法线贴图）
-                Vector3 tangent {1, 0, 0};
-                {
-                    Vector3 edge1    = vertex[1] - vertex[0];
-                    Vector3 edge2    = vertex[2] - vertex[1];
-                    Vector2 deltaUV1 = uv[1] - uv[0];
-                    Vector2 deltaUV2 = uv[2] - uv[1];
-
-                    auto divide = deltaUV1.x * deltaUV2.y - deltaUV2.x * deltaUV1.y;
-                    if (divide >= 0.0f && divide < 0.000001f)
-                        divide = 0.000001f;
-                    else if (divide < 0.0f && divide > -0.000001f)
-                        divide = -0.000001f;
-
-                    float df  = 1.0f / divide;
-                    tangent.x = df * (deltaUV2.y * edge1.x - deltaUV1.y * edge2.x);
-                    tangent.y = df * (deltaUV2.y * edge1.y - deltaUV1.y * edge2.y);
-                    tangent.z = df * (deltaUV2.y * edge1.z - deltaUV1.y * edge2.z);
-                    tangent   = (tangent).normalisedCopy();
-                }
+                    // 相同(位置, 法线, UV)的顶点只保留一份
+                    for (size_t i = 0; i < 3; i++)
+                    {
+                        const ObjVertexKey key {
+                            {vertex[i].x, vertex[i].y, vertex[i].z, normal[i].x, normal[i].y, normal[i].z, uv[i].x, uv[i].y}};
 
-                // 填充顶点数据（合并位置、法线、UV、切线）
-                for (size_t i = 0; i < 3; i++)
-                {
-                    MeshVertexDataDefinition mesh_vert {};
+                        auto insert_result =
+                            vertex_index_map.insert(std::make_pair(key, static_cast<uint32_t>(mesh_vertices.size())));
+                        if (insert_result.second)
+                        {
+                            MeshVertexDataDefinition mesh_vert {};
 
-                    mesh_vert.x = vertex[i].x;
-                    mesh_vert.y = vertex[i].y;
-                    mesh_vert.z = vertex[i].z;
+                            mesh_vert.x = vertex[i].x;
+                            mesh_vert.y = vertex[i].y;
+                            mesh_vert.z = vertex[i].z;
 
-                    mesh_vert.nx = normal[i].x;
-                    mesh_vert.ny = normal[i].y;
-                    mesh_vert.nz = normal[i].z;
+                            mesh_vert.nx = normal[i].x;
+                            mesh_vert.ny = normal[i].y;
+                            mesh_vert.nz = normal[i].z;
 
-                    mesh_vert.u = uv[i].x;
-                    mesh_vert.v = uv[i].y;
+                            mesh_vert.u = uv[i].x;
+                            mesh_vert.v = uv[i].y;
 
-                    mesh_vert.tx = tangent.x;
-                    mesh_vert.ty = tangent.y;
-                    mesh_vert.tz = tangent.z;
+                            mesh_vertices.push_back(mesh_vert);
+                            vertex_tangents.push_back(Vector3::ZERO);
+                        }
 
-                    mesh_vertices.push_back(mesh_vert);
+                        const uint32_t vertex_index = insert_result.first->second;
+                        vertex_tangents[vertex_index] += tangent;
+                        mesh_indices.push_back(vertex_index);
+                    }
                 }
+                index_offset += fv;
             }
         }
 
-        // 创建顶点缓冲区（分配显存并复制数据）
-        uint32_t stride = sizeof(MeshVertexDataDefinition);  // 顶点步长（每个顶点的字节大小）
-        mesh_data.m_vertex_buffer = std::make_shared<BufferData>(mesh_vertices.size() * stride);
-        // 将顶点数据复制到显存
-        mesh_data.m_index_buffer = std::make_shared<BufferData>(mesh_vertices.size() * sizeof(uint16_t));
+        // 累加的切线对法线做Gram-Schmidt正交化后归一化，退化时取任一垂直于法线的方向
+        for (size_t i = 0; i < mesh_vertices.size(); i++)
+        {
+            MeshVertexDataDefinition& mesh_vert = mesh_vertices[i];
 
-        // 断言确保索引数量在uint16_t范围内（Vulkan等API通常限制索引为16位）
-        assert(mesh_vertices.size() <= std::numeric_limits<uint16_t>::max());
+            Vector3 normal(mesh_vert.nx, mesh_vert.ny, mesh_vert.nz);
+            Vector3 tangent = vertex_tangents[i] - normal * normal.dotProduct(vertex_tangents[i]);
+            if (tangent.squaredLength() < 1e-12f)
+            {
+                tangent = normal.crossProduct(std::abs(normal.x) < 0.9f ? Vector3::UNIT_X : Vector3::UNIT_Y);
+            }
+            tangent = tangent.normalisedCopy();
 
-        // 填充索引缓冲区（三角形面的顶点索引）
-        uint16_t* indices = (uint16_t*)mesh_data.m_index_buffer->m_data;
-        for (size_t i = 0; i < mesh_vertices.size(); i++)
+            mesh_vert.tx = tangent.x;
+            mesh_vert.ty = tangent.y;
+            mesh_vert.tz = tangent.z;
+        }
+
+        // 重排三角形与顶点以提高顶点缓存命中率和取数局部性
+        logMeshOptimizationReport(
+            filename,
+            optimizeMesh(mesh_indices, mesh_vertices.data(), nullptr, mesh_vertices.size(), m_mesh_optimization_settings));
+
+        // 创建顶点缓冲区
+        mesh_data.m_vertex_buffer = std::make_shared<BufferData>(mesh_vertices.size() * sizeof(MeshVertexDataDefinition));
+        if (!mesh_vertices.empty())
         {
-            // 复制顶点数据
-            ((MeshVertexDataDefinition*)(mesh_data.m_vertex_buffer->m_data))[i] = mesh_vertices[i];
-            // 索引为顶点数组的顺序索引
-            indices[i] = static_cast<uint16_t>(i);
+            std::memcpy(mesh_data.m_vertex_buffer->m_data,
+                        mesh_vertices.data(),
+                        mesh_vertices.size() * sizeof(MeshVertexDataDefinition));
         }
 
+        // 创建索引缓冲区（按顶点数选择16位或32位索引）
+        mesh_data.m_index_buffer = createIndexBuffer(mesh_indices, mesh_vertices.size(), mesh_data.m_index_type);
+
         // 返回加载的静态网格数据
         return mesh_data;
     }
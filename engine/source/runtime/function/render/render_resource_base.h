@@ -1,10 +1,14 @@
 ﻿#pragma once
 
+#include "runtime/function/render/render_ibl_file.h"
+#include "runtime/function/render/render_mesh_optimizer.h"
 #include "runtime/function/render/render_scene.h"
 #include "runtime/function/render/render_swap_context.h"
+#include "runtime/function/render/render_texture_file.h"
 #include "runtime/function/render/render_type.h"
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 
@@ -100,8 +104,34 @@ namespace Sammi
          */
         std::shared_ptr<TextureData> loadTextureHDR(std::string file, int desired_channels = 4);
 
+        /**
+         * @brief 映射烘焙后的IBL文件（辐照度与高光立方体贴图，含完整MIP链）
+         *
+         * 烘焙文件不存在、早于任一源面或由其他源面烘焙时返回false，调用方回退到逐面解码HDR。
+         * @param ibl_resource_desc 关卡IBL资源描述
+         * @param out_ibl_data 输出参数：指向文件内容的立方体贴图数据
+         * @return 是否加载成功
+         */
+        bool loadIBLData(const LevelIBLResourceDesc& ibl_resource_desc, IBLData& out_ibl_data);
+
+        /**
+         * @brief 将十二个HDR面烘焙为一个IBL文件（与高光+X面同名，扩展名为.ibl），预先计算两张立方体贴图的MIP链
+         * @param ibl_resource_desc 关卡IBL资源描述
+         * @param format 存储格式（RGBA16F或共享指数E5B9G9R9）
+         * @return 是否烘焙成功
+         */
+        bool cookIBLData(const LevelIBLResourceDesc& ibl_resource_desc,
+                         IBLCookFormat               format = IBLCookFormat::e5b9g9r9);
+
+        /**
+         * @brief IBL烘焙文件是否存在且不早于十二个源面（烘焙工具据此跳过未过期的IBL）
+         */
+        static bool isIBLDataUpToDate(const LevelIBLResourceDesc& ibl_resource_desc);
+
         /**
          * @brief 加载普通纹理（支持sRGB格式）
+         *
+         * 优先映射烘焙后的纹理文件（包含完整MIP链，可为块压缩格式），否则解码源图像，MIP由RHI在上传时生成。
          * @param file 纹理文件路径
          * @param is_srgb 是否为sRGB颜色空间（默认false）
          * @return 纹理数据指针（加载失败返回空）
@@ -109,7 +139,35 @@ namespace Sammi
         std::shared_ptr<TextureData> loadTexture(std::string file, bool is_srgb = false);
 
         /**
-         * @brief 加载网格数据并计算包围盒
+         * @brief 将源图像烘焙为纹理文件（与源文件同名，扩展名为.tex），预先计算全部MIP并按设置编码为BC1/BC3/BC5/BC7或不压缩
+         *
+         * 之后loadTexture会直接映射该文件；源文件更新后需重新烘焙，否则回退到源图像加载。
+         * @param file 源图像路径
+         * @param settings 烘焙格式及滤波选项
+         * @return 是否烘焙成功
+         */
+        bool cookTextureData(const std::string& file, const TextureCookSettings& settings);
+
+        /**
+         * @brief 纹理烘焙文件的路径（烘焙工具据此跳过未过期的纹理）
+         */
+        static std::string getCookedTextureUrl(const std::string& texture_url);
+
+        /**
+         * @brief 按各纹理槽的默认设置烘焙材质引用的全部纹理（均为BC7，基础颜色为sRGB，法线按单位向量生成MIP）
+         * @param source 材质资源描述
+         * @return 全部纹理是否烘焙成功
+         */
+        bool cookMaterialData(const MaterialSourceDesc& source);
+
+        /**
+         * @brief 设置设备是否支持块压缩纹理，不支持时块压缩的烘焙纹理被忽略，回退到源图像
+         */
+        void setTextureCompressionSupported(bool is_supported) { m_is_texture_compression_supported = is_supported; }
+        bool isTextureCompressionSupported() const { return m_is_texture_compression_supported; }
+
+        /**
+         * @brief 加载网格数据并计算包围盒（可在资源流式加载的工作线程中调用）
          * @param source 网格资源描述（包含文件路径、加载参数等）
          * @param bounding_box 输出参数：网格的轴对齐包围盒（AABB）
          * @return 网格数据（包含顶点、索引、细分信息等）
@@ -117,7 +175,21 @@ namespace Sammi
         RenderMeshData loadMeshData(const MeshSourceDesc& source, AxisAlignedBox& bounding_box);
 
         /**
-         * @brief 加载材质数据
+         * @brief 将.obj/.json源网格烘焙为二进制网格文件（与源文件同名，扩展名为.mesh）
+         *
+         * 之后loadMeshData会直接映射该文件；源文件更新后需重新烘焙，否则回退到源格式加载。
+         * @param source 网格资源描述
+         * @return 是否烘焙成功
+         */
+        bool cookMeshData(const MeshSourceDesc& source);
+
+        /**
+         * @brief 网格烘焙文件的路径（烘焙工具据此跳过未过期的网格）
+         */
+        static std::string getCookedMeshUrl(const std::string& mesh_url);
+
+        /**
+         * @brief 加载材质数据（可在资源流式加载的工作线程中调用）
          * @param source 材质资源描述（包含着色器路径、纹理绑定规则等）
          * @return 材质数据（包含着色器程序、纹理采样参数等）
          */
@@ -130,7 +202,22 @@ namespace Sammi
          */
         AxisAlignedBox getCachedBoudingBox(const MeshSourceDesc& source) const;
 
+        /**
+         * @brief 设置网格导入时的优化选项（顶点缓存、顶点取数、过度绘制），对之后加载或烘焙的源网格生效
+         * @param settings 网格优化选项
+         */
+        void setMeshOptimizationSettings(const MeshOptimizationSettings& settings) { m_mesh_optimization_settings = settings; }
+        const MeshOptimizationSettings& getMeshOptimizationSettings() const { return m_mesh_optimization_settings; }
+
     private:
+        /**
+         * @brief 从.obj/.json源文件加载网格数据（内部实现）
+         * @param source 网格资源描述
+         * @param bounding_box 输出参数：网格包围盒
+         * @return 网格数据（不支持的格式返回空数据）
+         */
+        RenderMeshData loadSourceMeshData(const MeshSourceDesc& source, AxisAlignedBox& bounding_box);
+
         /**
          * @brief 加载静态网格数据（内部实现）
          * @param mesh_file 网格文件路径
@@ -143,5 +230,13 @@ namespace Sammi
         // 键：网格资源描述（MeshSourceDesc）
         // 值：对应的轴对齐包围盒（AxisAlignedBox）
         std::unordered_map<MeshSourceDesc, AxisAlignedBox> m_bounding_box_cache_map;
+        // 保护包围盒缓存，loadMeshData可能在多个工作线程中并发执行
+        mutable std::mutex m_bounding_box_cache_mutex;
+
+        // 源网格导入时的优化选项
+        MeshOptimizationSettings m_mesh_optimization_settings;
+
+        // 设备是否支持BC块压缩纹理，在资源流式加载开始前设置
+        bool m_is_texture_compression_supported {false};
     };
 }
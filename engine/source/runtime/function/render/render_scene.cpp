@@ -1,24 +1,92 @@
-#include "runtime/function/render/render_scene.h"
+﻿#include "runtime/function/render/render_scene.h"
 #include "runtime/function/render/render_helper.h"
 #include "runtime/function/render/render_pass.h"
 #include "runtime/function/render/render_resource.h"
 
+#include "runtime/core/base/thread_pool.h"
+#include "runtime/function/global/global_context.h"
+
+#include <algorithm>
+
 namespace Sammi
 {
     void RenderScene::clear()
     {
     }
 
+    namespace
+    {
+        // mesh nodes filled per task
+        constexpr size_t k_mesh_node_chunk_size {1024};
+
+        // a view that accepts more than this share of the sampled entities is tested linearly: the linear pass
+        // costs the same for any view, while walking the tree grows with what it accepts
+        constexpr float  k_tree_culling_max_visible_share {0.02f};
+        constexpr size_t k_culling_sample_count {1024};
+
+        void parallelFor(size_t count, size_t grain_size, const std::function<void(size_t, size_t)>& task)
+        {
+            if (g_runtime_global_context.m_thread_pool)
+            {
+                g_runtime_global_context.m_thread_pool->parallelFor(count, grain_size, task);
+            }
+            else if (count > 0)
+            {
+                task(0, count);
+            }
+        }
+    } // namespace
+
     void RenderScene::updateVisibleObjects(std::shared_ptr<RenderResource> render_resource,
-                                           std::shared_ptr<RenderCamera>   camera)
+                                           std::shared_ptr<RenderCamera>   camera,
+                                           bool                            gpu_main_camera_culling)
     {
-        updateVisibleObjectsDirectionalLight(render_resource, camera);
-        updateVisibleObjectsPointLight(render_resource);
-        updateVisibleObjectsMainCamera(render_resource, camera);
+        Matrix4x4 directional_light_proj_view = CalculateDirectionalLightCamera(*this, *camera);
+
+        render_resource->m_mesh_perframe_storage_buffer_object.directional_light_proj_view =
+            directional_light_proj_view;
+        render_resource->m_mesh_directional_light_shadow_perframe_storage_buffer_object.light_proj_view =
+            directional_light_proj_view;
+
+        ClusterFrustum directional_light_frustum =
+            CreateClusterFrustumFromMatrix(directional_light_proj_view, -1.0, 1.0, -1.0, 1.0, 0.0, 1.0);
+
+        std::vector<BoundingSphere> point_lights_bounding_spheres(m_point_light_list.m_lights.size());
+        for (size_t i = 0; i < m_point_light_list.m_lights.size(); i++)
+        {
+            point_lights_bounding_spheres[i].m_center = m_point_light_list.m_lights[i].m_position;
+            point_lights_bounding_spheres[i].m_radius = m_point_light_list.m_lights[i].calculateRadius();
+        }
+
+        Matrix4x4      proj_view_matrix = camera->getPersProjMatrix() * camera->getViewMatrix();
+        ClusterFrustum main_camera_frustum =
+            CreateClusterFrustumFromMatrix(proj_view_matrix, -1.0, 1.0, -1.0, 1.0, 0.0, 1.0);
+
+        cullRenderEntities(
+            directional_light_frustum, point_lights_bounding_spheres, main_camera_frustum, gpu_main_camera_culling);
+
+        buildVisibleMeshNodes(
+            *render_resource, m_directional_light_visible_indices, m_directional_light_visible_mesh_nodes);
+        buildVisibleMeshNodes(*render_resource, m_point_lights_visible_indices, m_point_lights_visible_mesh_nodes);
+        // empty when the main camera is culled on the gpu
+        buildVisibleMeshNodes(*render_resource, m_main_camera_visible_indices, m_main_camera_visible_mesh_nodes);
+
         updateVisibleObjectsAxis(render_resource);
         updateVisibleObjectsParticle(render_resource);
     }
 
+    void RenderScene::updateMainCameraVisibleObjects(std::shared_ptr<RenderResource> render_resource,
+                                                     std::shared_ptr<RenderCamera>   camera)
+    {
+        Matrix4x4      proj_view_matrix = camera->getPersProjMatrix() * camera->getViewMatrix();
+        ClusterFrustum main_camera_frustum =
+            CreateClusterFrustumFromMatrix(proj_view_matrix, -1.0, 1.0, -1.0, 1.0, 0.0, 1.0);
+
+        m_main_camera_visible_indices.clear();
+        m_render_entity_bvh.queryFrustum(main_camera_frustum, m_render_entity_bounds, m_main_camera_visible_indices);
+        buildVisibleMeshNodes(*render_resource, m_main_camera_visible_indices, m_main_camera_visible_mesh_nodes);
+    }
+
     void RenderScene::setVisibleNodesReference()
     {
         RenderPass::m_visiable_nodes.p_directional_light_visible_mesh_nodes = &m_directional_light_visible_mesh_nodes;
@@ -38,189 +106,267 @@ namespace Sammi
 
     void RenderScene::addInstanceIdToMap(uint32_t instance_id, GObjectID go_id)
     {
-        m_mesh_object_id_map[instance_id] = go_id;
+        auto insert_result = m_mesh_object_id_map.insert(std::make_pair(instance_id, go_id));
+        if (insert_result.second)
+        {
+            m_object_instance_ids_map[go_id].push_back(instance_id);
+        }
     }
 
-    GObjectID RenderScene::getGObjectIDByMeshID(uint32_t mesh_id) const
+    void RenderScene::updateRenderEntity(const RenderEntity& render_entity)
     {
-        auto find_it = m_mesh_object_id_map.find(mesh_id);
-        if (find_it != m_mesh_object_id_map.end())
+        // world bounds are only recomputed here, when the entity actually changed
+        m_dirty_instance_ids.push_back(render_entity.m_instance_id);
+        auto find_it = m_instance_id_entity_index_map.find(render_entity.m_instance_id);
+        if (find_it != m_instance_id_entity_index_map.end())
         {
-            return find_it->second;
+            m_render_entities[find_it->second] = render_entity;
+            m_render_entity_bounds.setBounds(find_it->second, render_entity.m_bounding_box, render_entity.m_model_matrix);
+            // the leaf is only reinserted when the entity left its enlarged box
+            m_render_entity_bvh.updateLeaf(m_render_entity_bvh_leaves[find_it->second],
+                                           m_render_entity_bounds.getBoundingBox(find_it->second));
+            return;
         }
-        return GObjectID();
+
+        const size_t entity_index = m_render_entities.size();
+        m_instance_id_entity_index_map.insert(std::make_pair(render_entity.m_instance_id, entity_index));
+        m_render_entity_bounds.setBounds(entity_index, render_entity.m_bounding_box, render_entity.m_model_matrix);
+        m_render_entity_bvh_leaves.push_back(m_render_entity_bvh.insertLeaf(
+            m_render_entity_bounds.getBoundingBox(entity_index), static_cast<uint32_t>(entity_index)));
+        m_render_entities.push_back(render_entity);
     }
 
-    void RenderScene::deleteEntityByGObjectID(GObjectID go_id)
+    void RenderScene::removeRenderEntity(uint32_t instance_id)
     {
-        for (auto it = m_mesh_object_id_map.begin(); it != m_mesh_object_id_map.end(); it++)
+        auto find_it = m_instance_id_entity_index_map.find(instance_id);
+        if (find_it == m_instance_id_entity_index_map.end())
         {
-            if (it->second == go_id)
-            {
-                m_mesh_object_id_map.erase(it);
-                break;
-            }
+            return;
         }
 
-        GameObjectPartId part_id = {go_id, 0};
-        size_t           find_guid;
-        if (m_instance_id_allocator.getElementGuid(part_id, find_guid))
+        m_dirty_instance_ids.push_back(instance_id);
+        const size_t entity_index = find_it->second;
+        const size_t last_index   = m_render_entities.size() - 1;
+        m_render_entity_bvh.removeLeaf(m_render_entity_bvh_leaves[entity_index]);
+        if (entity_index != last_index)
         {
-            for (auto it = m_render_entities.begin(); it != m_render_entities.end(); it++)
-            {
-                if (it->m_instance_id == find_guid)
-                {
-                    m_render_entities.erase(it);
-                    break;
-                }
-            }
+            m_render_entities[entity_index] = std::move(m_render_entities[last_index]);
+            m_instance_id_entity_index_map[m_render_entities[entity_index].m_instance_id] = entity_index;
+            m_render_entity_bvh_leaves[entity_index] = m_render_entity_bvh_leaves[last_index];
+            m_render_entity_bvh.setLeafEntityIndex(m_render_entity_bvh_leaves[entity_index],
+                                                   static_cast<uint32_t>(entity_index));
         }
+        m_render_entities.pop_back();
+        m_render_entity_bvh_leaves.pop_back();
+        m_render_entity_bounds.swapRemove(entity_index);
+        m_instance_id_entity_index_map.erase(instance_id);
     }
 
-    void RenderScene::clearForLevelReloading()
+    const RenderEntity* RenderScene::findRenderEntity(uint32_t instance_id, BoundingBox& out_bounding_box) const
     {
-        m_instance_id_allocator.clear();
-        m_mesh_object_id_map.clear();
-        m_render_entities.clear();
+        auto find_it = m_instance_id_entity_index_map.find(instance_id);
+        if (find_it == m_instance_id_entity_index_map.end())
+        {
+            return nullptr;
+        }
+
+        out_bounding_box = m_render_entity_bounds.getBoundingBox(find_it->second);
+        return &m_render_entities[find_it->second];
     }
 
-    void RenderScene::updateVisibleObjectsDirectionalLight(std::shared_ptr<RenderResource> render_resource,
-                                                           std::shared_ptr<RenderCamera>   camera)
+    GObjectID RenderScene::getGObjectIDByMeshID(uint32_t mesh_id) const
     {
-        Matrix4x4 directional_light_proj_view = CalculateDirectionalLightCamera(*this, *camera);
-
-        render_resource->m_mesh_perframe_storage_buffer_object.directional_light_proj_view =
-            directional_light_proj_view;
-        render_resource->m_mesh_directional_light_shadow_perframe_storage_buffer_object.light_proj_view =
-            directional_light_proj_view;
-
-        m_directional_light_visible_mesh_nodes.clear();
-
-        ClusterFrustum frustum =
-            CreateClusterFrustumFromMatrix(directional_light_proj_view, -1.0, 1.0, -1.0, 1.0, 0.0, 1.0);
-
-        for (const RenderEntity& entity : m_render_entities)
+        auto find_it = m_mesh_object_id_map.find(mesh_id);
+        if (find_it != m_mesh_object_id_map.end())
         {
-            BoundingBox mesh_asset_bounding_box {entity.m_bounding_box.getMinCorner(),
-                                                 entity.m_bounding_box.getMaxCorner()};
-
-            if (TiledFrustumIntersectBox(frustum, BoundingBoxTransform(mesh_asset_bounding_box, entity.m_model_matrix)))
-            {
-                m_directional_light_visible_mesh_nodes.emplace_back();
-                RenderMeshNode& temp_node = m_directional_light_visible_mesh_nodes.back();
+            return find_it->second;
+        }
+        return GObjectID();
+    }
 
-                temp_node.model_matrix = &entity.m_model_matrix;
+    void RenderScene::queryInstanceIdsByRay(const Vector3&         origin,
+                                            const Vector3&         direction,
+                                            float                  max_distance,
+                                            std::vector<uint32_t>& out_instance_ids) const
+    {
+        std::vector<std::pair<float, uint32_t>> hits;
+        m_render_entity_bvh.queryRay(origin, direction, max_distance, m_render_entity_bounds, hits);
 
-                assert(entity.m_joint_matrices.size() <= s_mesh_vertex_blending_max_joint_count);
-                if (!entity.m_joint_matrices.empty())
-                {
-                    temp_node.joint_count    = static_cast<uint32_t>(entity.m_joint_matrices.size());
-                    temp_node.joint_matrices = entity.m_joint_matrices.data();
-                }
-                temp_node.node_id = entity.m_instance_id;
+        out_instance_ids.clear();
+        out_instance_ids.reserve(hits.size());
+        for (const std::pair<float, uint32_t>& hit : hits)
+        {
+            out_instance_ids.push_back(m_render_entities[hit.second].m_instance_id);
+        }
+    }
 
-                VulkanMesh& mesh_asset           = render_resource->getEntityMesh(entity);
-                temp_node.ref_mesh               = &mesh_asset;
-                temp_node.enable_vertex_blending = entity.m_enable_vertex_blending;
+    void RenderScene::queryInstanceIdsByBox(const BoundingBox& box, std::vector<uint32_t>& out_instance_ids) const
+    {
+        std::vector<uint32_t> entity_indices;
+        m_render_entity_bvh.queryBox(box, m_render_entity_bounds, entity_indices);
 
-                VulkanPBRMaterial& material_asset = render_resource->getEntityMaterial(entity);
-                temp_node.ref_material            = &material_asset;
-            }
+        out_instance_ids.clear();
+        out_instance_ids.reserve(entity_indices.size());
+        for (uint32_t entity_index : entity_indices)
+        {
+            out_instance_ids.push_back(m_render_entities[entity_index].m_instance_id);
         }
     }
 
-    void RenderScene::updateVisibleObjectsPointLight(std::shared_ptr<RenderResource> render_resource)
+    void RenderScene::deleteEntityByGObjectID(GObjectID go_id)
     {
-        m_point_lights_visible_mesh_nodes.clear();
+        auto find_it = m_object_instance_ids_map.find(go_id);
+        if (find_it == m_object_instance_ids_map.end())
+        {
+            return;
+        }
 
-        std::vector<BoundingSphere> point_lights_bounding_spheres;
-        uint32_t                    point_light_num = static_cast<uint32_t>(m_point_light_list.m_lights.size());
-        point_lights_bounding_spheres.resize(point_light_num);
-        for (size_t i = 0; i < point_light_num; i++)
+        for (uint32_t instance_id : find_it->second)
         {
-            point_lights_bounding_spheres[i].m_center = m_point_light_list.m_lights[i].m_position;
-            point_lights_bounding_spheres[i].m_radius = m_point_light_list.m_lights[i].calculateRadius();
+            m_mesh_object_id_map.erase(instance_id);
+            removeRenderEntity(instance_id);
+            // the part gets a new instance id if the object is added again
+            m_instance_id_allocator.freeGuid(instance_id);
         }
+        m_object_instance_ids_map.erase(find_it);
+    }
 
-        for (const RenderEntity& entity : m_render_entities)
+    void RenderScene::clearForLevelReloading()
+    {
+        // the instances of the old level are removed like deleted entities
+        for (const RenderEntity& render_entity : m_render_entities)
         {
-            BoundingBox mesh_asset_bounding_box {entity.m_bounding_box.getMinCorner(),
-                                                 entity.m_bounding_box.getMaxCorner()};
+            m_dirty_instance_ids.push_back(render_entity.m_instance_id);
+        }
 
-            bool intersect_with_point_lights = true;
-            for (size_t i = 0; i < point_light_num; i++)
-            {
-                if (!BoxIntersectsWithSphere(BoundingBoxTransform(mesh_asset_bounding_box, entity.m_model_matrix),
-                                             point_lights_bounding_spheres[i]))
-                {
-                    intersect_with_point_lights = false;
-                    break;
-                }
-            }
+        m_instance_id_allocator.clear();
+        m_mesh_object_id_map.clear();
+        m_instance_id_entity_index_map.clear();
+        m_object_instance_ids_map.clear();
+        m_render_entities.clear();
+        m_render_entity_bounds.clear();
+        m_render_entity_bvh.clear();
+        m_render_entity_bvh_leaves.clear();
+    }
 
-            if (intersect_with_point_lights)
+    void RenderScene::cullRenderEntities(const ClusterFrustum&              directional_light_frustum,
+                                         const std::vector<BoundingSphere>& point_lights_bounding_spheres,
+                                         const ClusterFrustum&              main_camera_frustum,
+                                         bool                               gpu_main_camera_culling)
+    {
+        m_directional_light_visible_indices.clear();
+        m_point_lights_visible_indices.clear();
+        m_main_camera_visible_indices.clear();
+
+        // every (view, subtree) pair is one task, so a single large view still spreads over the pool
+        const size_t thread_count =
+            g_runtime_global_context.m_thread_pool ? g_runtime_global_context.m_thread_pool->getThreadCount() + 1 : 1;
+        m_render_entity_bvh.getSubtrees(4 * thread_count, m_culling_subtree_roots);
+
+        const size_t view_count    = gpu_main_camera_culling ? 2 : 3;
+        const size_t subtree_count = m_culling_subtree_roots.size();
+        m_culling_task_visible_indices.resize(view_count * subtree_count);
+
+        // point light faces and wide shadow frusta see most of the scene, their tasks take entity ranges instead
+        const size_t entity_count  = m_render_entity_bounds.size();
+        const size_t sample_stride = std::max<size_t>(1, entity_count / k_culling_sample_count);
+        const bool   is_view_linear[3] = {
+            m_render_entity_bounds.sampleFrustumVisibility(directional_light_frustum, sample_stride) >
+                k_tree_culling_max_visible_share,
+            m_render_entity_bounds.sampleSpheresVisibility(point_lights_bounding_spheres, sample_stride) >
+                k_tree_culling_max_visible_share,
+            !gpu_main_camera_culling &&
+                m_render_entity_bounds.sampleFrustumVisibility(main_camera_frustum, sample_stride) >
+                    k_tree_culling_max_visible_share};
+
+        parallelFor(view_count * subtree_count, 1, [&](size_t begin, size_t end) {
+            for (size_t task_index = begin; task_index < end; task_index++)
             {
-                m_point_lights_visible_mesh_nodes.emplace_back();
-                RenderMeshNode& temp_node = m_point_lights_visible_mesh_nodes.back();
+                const size_t           view_index           = task_index / subtree_count;
+                const size_t           subtree_index        = task_index % subtree_count;
+                const int32_t          subtree_root         = m_culling_subtree_roots[subtree_index];
+                std::vector<uint32_t>& task_visible_indices = m_culling_task_visible_indices[task_index];
+                task_visible_indices.clear();
 
-                temp_node.model_matrix = &entity.m_model_matrix;
-
-                assert(entity.m_joint_matrices.size() <= s_mesh_vertex_blending_max_joint_count);
-                if (!entity.m_joint_matrices.empty())
+                if (is_view_linear[view_index])
                 {
-                    temp_node.joint_count    = static_cast<uint32_t>(entity.m_joint_matrices.size());
-                    temp_node.joint_matrices = entity.m_joint_matrices.data();
+                    const size_t range_begin = entity_count * subtree_index / subtree_count;
+                    const size_t range_end   = entity_count * (subtree_index + 1) / subtree_count;
+                    if (view_index == 1)
+                    {
+                        m_render_entity_bounds.cullSpheres(
+                            point_lights_bounding_spheres, range_begin, range_end, task_visible_indices);
+                    }
+                    else
+                    {
+                        m_render_entity_bounds.cullFrustum(view_index == 0 ? directional_light_frustum :
+                                                                             main_camera_frustum,
+                                                           range_begin,
+                                                           range_end,
+                                                           task_visible_indices);
+                    }
+                }
+                else if (view_index == 1)
+                {
+                    m_render_entity_bvh.querySpheres(
+                        point_lights_bounding_spheres, m_render_entity_bounds, task_visible_indices, subtree_root);
+                }
+                else
+                {
+                    m_render_entity_bvh.queryFrustum(view_index == 0 ? directional_light_frustum : main_camera_frustum,
+                                                     m_render_entity_bounds,
+                                                     task_visible_indices,
+                                                     subtree_root);
                 }
-                temp_node.node_id = entity.m_instance_id;
-
-                VulkanMesh& mesh_asset           = render_resource->getEntityMesh(entity);
-                temp_node.ref_mesh               = &mesh_asset;
-                temp_node.enable_vertex_blending = entity.m_enable_vertex_blending;
-
-                VulkanPBRMaterial& material_asset = render_resource->getEntityMaterial(entity);
-                temp_node.ref_material            = &material_asset;
             }
+        });
+
+        std::vector<uint32_t>* view_visible_indices[3] = {
+            &m_directional_light_visible_indices, &m_point_lights_visible_indices, &m_main_camera_visible_indices};
+        for (size_t task_index = 0; task_index < view_count * subtree_count; task_index++)
+        {
+            const std::vector<uint32_t>& task_visible_indices = m_culling_task_visible_indices[task_index];
+            std::vector<uint32_t>&       visible_indices      = *view_visible_indices[task_index / subtree_count];
+            visible_indices.insert(visible_indices.end(), task_visible_indices.begin(), task_visible_indices.end());
         }
     }
 
-    void RenderScene::updateVisibleObjectsMainCamera(std::shared_ptr<RenderResource> render_resource,
-                                                     std::shared_ptr<RenderCamera>   camera)
+    void RenderScene::buildVisibleMeshNodes(RenderResource&              render_resource,
+                                            const std::vector<uint32_t>& visible_entity_indices,
+                                            std::vector<RenderMeshNode>& out_visible_mesh_nodes)
     {
-        m_main_camera_visible_mesh_nodes.clear();
+        out_visible_mesh_nodes.clear();
+        out_visible_mesh_nodes.resize(visible_entity_indices.size());
 
-        Matrix4x4 view_matrix      = camera->getViewMatrix();
-        Matrix4x4 proj_matrix      = camera->getPersProjMatrix();
-        Matrix4x4 proj_view_matrix = proj_matrix * view_matrix;
-
-        ClusterFrustum f = CreateClusterFrustumFromMatrix(proj_view_matrix, -1.0, 1.0, -1.0, 1.0, 0.0, 1.0);
+        parallelFor(visible_entity_indices.size(), k_mesh_node_chunk_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                const RenderEntity& entity    = m_render_entities[visible_entity_indices[i]];
+                RenderMeshNode&     temp_node = out_visible_mesh_nodes[i];
 
-        for (const RenderEntity& entity : m_render_entities)
-        {
-            BoundingBox mesh_asset_bounding_box {entity.m_bounding_box.getMinCorner(),
-                                                 entity.m_bounding_box.getMaxCorner()};
+                temp_node.model_matrix = &entity.m_model_matrix;
 
-            if (TiledFrustumIntersectBox(f, BoundingBoxTransform(mesh_asset_bounding_box, entity.m_model_matrix)))
-            {
-                m_main_camera_visible_mesh_nodes.emplace_back();
-                RenderMeshNode& temp_node = m_main_camera_visible_mesh_nodes.back();
-                temp_node.model_matrix    = &entity.m_model_matrix;
+                const BoundingBox bounding_box = m_render_entity_bounds.getBoundingBox(visible_entity_indices[i]);
+                temp_node.bounding_box_min     = bounding_box.min_bound;
+                temp_node.bounding_box_max     = bounding_box.max_bound;
 
                 assert(entity.m_joint_matrices.size() <= s_mesh_vertex_blending_max_joint_count);
-                if (!entity.m_joint_matrices.empty())
+                // only vertex blended nodes carry joint matrices, the passes test joint_matrices alone
+                if (entity.m_enable_vertex_blending && !entity.m_joint_matrices.empty())
                 {
                     temp_node.joint_count    = static_cast<uint32_t>(entity.m_joint_matrices.size());
                     temp_node.joint_matrices = entity.m_joint_matrices.data();
                 }
                 temp_node.node_id = entity.m_instance_id;
 
-                VulkanMesh& mesh_asset           = render_resource->getEntityMesh(entity);
+                VulkanMesh& mesh_asset           = render_resource.getEntityMesh(entity);
                 temp_node.ref_mesh               = &mesh_asset;
                 temp_node.enable_vertex_blending = entity.m_enable_vertex_blending;
 
-                VulkanPBRMaterial& material_asset = render_resource->getEntityMaterial(entity);
+                VulkanPBRMaterial& material_asset = render_resource.getEntityMaterial(entity);
                 temp_node.ref_material            = &material_asset;
             }
-        }
+        });
     }
 
     void RenderScene::updateVisibleObjectsAxis(std::shared_ptr<RenderResource> render_resource)
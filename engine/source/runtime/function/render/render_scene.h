@@ -3,6 +3,7 @@
 #include "runtime/function/framework/object/object_id_allocator.h"
 #include "runtime/function/render/light.h"
 #include "runtime/function/render/render_common.h"
+#include "runtime/function/render/render_culling.h"
 #include "runtime/function/render/render_entity.h"
 #include "runtime/function/render/render_guid_allocator.h"
 #include "runtime/function/render/render_object.h"
@@ -35,7 +36,12 @@ namespace Sammi
         PointLightList    m_point_light_list;   // 点光源列表（存储多个点光源对象）
 
         // ====================== 渲染实体 ======================
+        // 稠密存储，删除时与末尾交换，顺序不固定；增删改请使用updateRenderEntity/deleteEntityByGObjectID
         std::vector<RenderEntity> m_render_entities;  // 场景中所有待渲染的实体集合
+        // 与m_render_entities一一对应的世界空间包围盒（SoA），仅在实体更新时重新计算
+        RenderEntityBounds m_render_entity_bounds;
+        // 基于m_render_entity_bounds的动态包围盒层次结构，用于层次化裁剪与空间查询
+        RenderEntityBvh m_render_entity_bvh;
 
         // ====================== 编辑器辅助对象 ======================
         std::optional<RenderEntity> m_render_axis;  // 可选渲染轴实体（编辑器模式下显示坐标轴）
@@ -58,9 +64,21 @@ namespace Sammi
          * @brief 更新当前帧可见对象（核心可见性计算函数）
          * @param render_resource 渲染资源管理器（提供网格/材质等资源访问）
          * @param camera 当前使用的相机（决定视图投影矩阵）
+         * @param gpu_main_camera_culling 主相机在GPU上裁剪：不做主相机的BVH查询，也不生成主相机节点
          * 内部会根据不同渲染阶段（光照可见性、相机可见性）调用具体实现
          */
-        void updateVisibleObjects(std::shared_ptr<RenderResource> render_resource, std::shared_ptr<RenderCamera> camera);
+        void updateVisibleObjects(std::shared_ptr<RenderResource> render_resource,
+                                  std::shared_ptr<RenderCamera>   camera,
+                                  bool                            gpu_main_camera_culling = false);
+
+        /**
+         * @brief 只在CPU上裁剪主相机并生成其可见节点
+         * GPU驱动绘制时每帧不生成主相机节点，拾取通道在拾取前通过此函数按需生成
+         * @param render_resource 渲染资源管理器
+         * @param camera 当前使用的相机
+         */
+        void updateMainCameraVisibleObjects(std::shared_ptr<RenderResource> render_resource,
+                                            std::shared_ptr<RenderCamera>   camera);
 
         /**
          * @brief 设置可见节点在渲染通道中的引用
@@ -95,6 +113,27 @@ namespace Sammi
          */
         void addInstanceIdToMap(uint32_t instance_id, GObjectID go_id);
 
+        /**
+         * @brief 按实例ID新增或覆盖渲染实体，O(1)
+         * @param render_entity 渲染实体（m_instance_id必须有效）
+         */
+        void updateRenderEntity(const RenderEntity& render_entity);
+
+        /**
+         * @brief 按实例ID查找渲染实体
+         * @param instance_id 渲染实例ID
+         * @param out_bounding_box 输出实体的世界空间包围盒（与裁剪使用的一致）
+         * @return 实体不存在（未加入或已删除）时返回nullptr
+         */
+        const RenderEntity* findRenderEntity(uint32_t instance_id, BoundingBox& out_bounding_box) const;
+
+        /**
+         * @brief 上次清空以来新增、修改或删除过的实例ID（可能重复，已删除的ID查不到实体）
+         * GPU驱动绘制据此只更新变化实体的实例数据，RenderSystem处理完交换数据后取走并清空
+         */
+        const std::vector<uint32_t>& getDirtyInstanceIds() const { return m_dirty_instance_ids; }
+        void                         clearDirtyInstanceIds() { m_dirty_instance_ids.clear(); }
+
         /**
          * @brief 通过网格ID查询对应的游戏对象ID
          * @param mesh_id 网格资源ID（对应MeshSourceDesc的唯一标识）
@@ -102,8 +141,28 @@ namespace Sammi
          */
         GObjectID getGObjectIDByMeshID(uint32_t mesh_id) const;
 
+        // ====================== 空间查询 ======================
+        /**
+         * @brief 查询射线命中包围盒的渲染实例（按包围盒命中距离由近到远排序）
+         * @param origin 射线起点（世界空间）
+         * @param direction 射线方向（世界空间，无需归一化，距离以其长度为单位）
+         * @param max_distance 最大命中距离
+         * @param out_instance_ids 输出的渲染实例ID
+         */
+        void queryInstanceIdsByRay(const Vector3&         origin,
+                                   const Vector3&         direction,
+                                   float                  max_distance,
+                                   std::vector<uint32_t>& out_instance_ids) const;
+
+        /**
+         * @brief 查询包围盒与给定包围盒相交的渲染实例
+         * @param box 查询包围盒（世界空间）
+         * @param out_instance_ids 输出的渲染实例ID
+         */
+        void queryInstanceIdsByBox(const BoundingBox& box, std::vector<uint32_t>& out_instance_ids) const;
+
         /**
-         * @brief 根据游戏对象ID删除对应实体
+         * @brief 根据游戏对象ID删除对应实体（包括该对象的所有部件）
          * @param go_id 需要删除的游戏对象ID
          */
         void deleteEntityByGObjectID(GObjectID go_id);
@@ -121,27 +180,52 @@ namespace Sammi
         GuidAllocator<MaterialSourceDesc> m_material_asset_id_allocator;  // 材质资源ID分配器（管理MaterialSourceDesc）
         // 网格ID到游戏对象ID的快速映射表
         std::unordered_map<uint32_t, GObjectID> m_mesh_object_id_map;
+        // 实例ID到m_render_entities下标的索引
+        std::unordered_map<uint32_t, size_t> m_instance_id_entity_index_map;
+        // 游戏对象ID到其所有部件实例ID的反向索引
+        std::unordered_map<GObjectID, std::vector<uint32_t>> m_object_instance_ids_map;
+        // 与m_render_entities一一对应的BVH叶节点
+        std::vector<int32_t> m_render_entity_bvh_leaves;
+        // 上次清空以来变化过的实例ID
+        std::vector<uint32_t> m_dirty_instance_ids;
 
-        // ====================== 可见性更新私有实现 ======================
         /**
-         * @brief 更新方向光可见的网格节点（基于阴影投射或视锥体裁剪）
-         * @param render_resource 渲染资源管理器
-         * @param camera 当前相机
+         * @brief 删除一个渲染实体：与末尾实体交换后弹出
+         * @param instance_id 渲染实例ID
          */
-        void updateVisibleObjectsDirectionalLight(std::shared_ptr<RenderResource> render_resource, std::shared_ptr<RenderCamera> camera);
+        void removeRenderEntity(uint32_t instance_id);
+
+        // ====================== 可见性更新私有实现 ======================
+        // 各视图的可见实体下标，跨帧复用以避免分配
+        std::vector<uint32_t> m_directional_light_visible_indices;
+        std::vector<uint32_t> m_point_lights_visible_indices;
+        std::vector<uint32_t> m_main_camera_visible_indices;
+        // 并行裁剪时每个(视图, 子树或实体区间)任务的根节点和输出，按任务顺序拼接
+        std::vector<int32_t>               m_culling_subtree_roots;
+        std::vector<std::vector<uint32_t>> m_culling_task_visible_indices;
 
         /**
-         * @brief 更新点光源可见的网格节点（通常结合光照探针或逐像素计算）
-         * @param render_resource 渲染资源管理器
+         * @brief 对方向光、点光源和主相机做裁剪，按视图和子树拆分到线程池；
+         *        抽样估计可见比例较大的视图（如点光源、远景阴影）不遍历BVH，改为按实体区间线性SIMD裁剪
+         * @param directional_light_frustum 方向光视锥体
+         * @param point_lights_bounding_spheres 点光源包围球（实体须与所有点光源相交）
+         * @param main_camera_frustum 主相机视锥体
+         * @param gpu_main_camera_culling 为true时主相机不做查询，主相机列表为空
          */
-        void updateVisibleObjectsPointLight(std::shared_ptr<RenderResource> render_resource);
+        void cullRenderEntities(const ClusterFrustum&              directional_light_frustum,
+                                const std::vector<BoundingSphere>& point_lights_bounding_spheres,
+                                const ClusterFrustum&              main_camera_frustum,
+                                bool                               gpu_main_camera_culling);
 
         /**
-         * @brief 更新主相机可见的网格节点（基于相机视锥体裁剪）
+         * @brief 根据可见实体下标并行填充网格节点
          * @param render_resource 渲染资源管理器
-         * @param camera 主相机对象
+         * @param visible_entity_indices 可见实体在m_render_entities中的下标
+         * @param out_visible_mesh_nodes 输出的可见网格节点
          */
-        void updateVisibleObjectsMainCamera(std::shared_ptr<RenderResource> render_resource, std::shared_ptr<RenderCamera> camera);
+        void buildVisibleMeshNodes(RenderResource&              render_resource,
+                                   const std::vector<uint32_t>& visible_entity_indices,
+                                   std::vector<RenderMeshNode>& out_visible_mesh_nodes);
 
         /**
          * @brief 更新轴对象的可见性（编辑器模式下始终可见或根据设置控制）
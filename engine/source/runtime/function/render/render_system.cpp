@@ -2,6 +2,7 @@
 #include "runtime/core/base/macro.h"
 #include "runtime/resource/asset_manager/asset_manager.h"
 #include "runtime/resource/config_manager/config_manager.h"
+#include "runtime/function/render/render_asset_streamer.h"
 #include "runtime/function/render/render_camera.h"
 #include "runtime/function/render/render_pass.h"
 #include "runtime/function/render/render_pipeline.h"
@@ -15,6 +16,8 @@
 #include "runtime/function/render/passes/particle_pass.h"
 #include "runtime/function/render/interface/vulkan/vulkan_rhi.h"
 
+#include <algorithm>
+
 namespace Sammi
 {
     RenderSystem::~RenderSystem()
@@ -56,6 +59,8 @@ namespace Sammi
         
         // 创建渲染资源管理器并上传全局资源到GPU
         m_render_resource = std::make_shared<RenderResource>();
+        // 设备支持BC块压缩时才使用块压缩格式的烘焙纹理
+        m_render_resource->setTextureCompressionSupported(m_rhi->isTextureCompressionBCSupported());
         m_render_resource->uploadGlobalRenderResource(m_rhi, level_resource_desc);
 
         // -------------------- 步骤3：初始化渲染相机 --------------------
@@ -92,12 +97,24 @@ namespace Sammi
         // 网格（Mesh）的描述符集布局（用于绑定顶点/索引缓冲区、统一缓冲区等）
         std::static_pointer_cast<RenderResource>(m_render_resource)->m_mesh_descriptor_set_layout     = &static_cast<RenderPass*>(m_render_pipeline->m_main_camera_pass.get())->m_descriptor_infos[MainCameraPass::LayoutType::_per_mesh].layout;
         std::static_pointer_cast<RenderResource>(m_render_resource)->m_material_descriptor_set_layout =&static_cast<RenderPass*>(m_render_pipeline->m_main_camera_pass.get())->m_descriptor_infos[MainCameraPass::LayoutType::_mesh_per_material].layout;
+
+        // -------------------- 步骤6：初始化资源流式加载 --------------------
+        // 占位材质：空材质数据会生成1x1灰色纹理，无需读盘；所有纹理路径为空的材质描述与其共用同一资源ID
+        RenderEntity placeholder_entity;
+        placeholder_entity.m_material_asset_id = m_render_scene->getMaterialAssetdAllocator().allocGuid(MaterialSourceDesc {});
+        m_render_resource->uploadGameObjectRenderResource(m_rhi, placeholder_entity, RenderMaterialData {});
+        std::static_pointer_cast<RenderResource>(m_render_resource)->m_placeholder_material_asset_id = placeholder_entity.m_material_asset_id;
+
+        m_asset_streamer = std::make_shared<RenderAssetStreamer>(m_render_resource);
     }
 
     void RenderSystem::tick(float delta_time)
     {
         // 处理逻辑与渲染上下文的交换数据（如加载新资源、删除旧对象）
+        // 本帧的所有资源上传记录在同一个上传批次中，只提交一次且不等待队列空闲
+        m_rhi->beginUploadBatch();
         processSwapData();
+        m_rhi->endUploadBatch();
 
         // 准备渲染命令上下文（开始命令缓冲区录制）
         m_rhi->prepareContext();
@@ -105,8 +122,10 @@ namespace Sammi
         // 更新每帧缓冲区（如相机的视图投影矩阵、光照参数等）
         m_render_resource->updatePerFrameBuffer(m_render_scene, m_render_camera);
 
-        // 更新当前帧可见的对象（基于相机视锥体裁剪）
-        m_render_scene->updateVisibleObjects(std::static_pointer_cast<RenderResource>(m_render_resource), m_render_camera);
+        // 更新当前帧可见的对象（基于相机视锥体裁剪），GPU驱动绘制时主相机的剔除交给网格剔除通道
+        bool gpu_driven_mesh_draw = std::static_pointer_cast<RenderPipeline>(m_render_pipeline)->isGpuDrivenMeshDrawActive();
+        m_render_scene->updateVisibleObjects(
+            std::static_pointer_cast<RenderResource>(m_render_resource), m_render_camera, gpu_driven_mesh_draw);
 
         // 准备渲染管线的各通道数据（如设置渲染目标、绑定描述符集等）
         m_render_pipeline->preparePassData(m_render_resource);
@@ -134,6 +153,9 @@ namespace Sammi
 
     void RenderSystem::clear()
     {
+        // 先停止工作线程，其任务仍引用渲染资源
+        m_asset_streamer.reset();
+
         if (m_rhi)
         {
             m_rhi->clear();
@@ -194,6 +216,12 @@ namespace Sammi
     // 获取被选中网格的GUID（全局唯一标识符）
     uint32_t RenderSystem::getGuidOfPickedMesh(const Vector2& picked_uv)
     {
+        // GPU驱动绘制时每帧不生成主相机节点，拾取前在CPU上按需生成
+        if (std::static_pointer_cast<RenderPipeline>(m_render_pipeline)->isGpuDrivenMeshDrawActive())
+        {
+            m_render_scene->updateMainCameraVisibleObjects(std::static_pointer_cast<RenderResource>(m_render_resource),
+                                                           m_render_camera);
+        }
         return m_render_pipeline->getGuidOfPickedMesh(picked_uv);
     }
 
@@ -203,6 +231,28 @@ namespace Sammi
         return m_render_scene->getGObjectIDByMeshID(mesh_id);
     }
 
+    // 在CPU端查询射线命中的游戏对象
+    void RenderSystem::queryGObjectIDsByRay(const Vector3&          origin,
+                                            const Vector3&          direction,
+                                            float                   max_distance,
+                                            std::vector<GObjectID>& out_object_ids) const
+    {
+        std::vector<uint32_t> instance_ids;
+        m_render_scene->queryInstanceIdsByRay(origin, direction, max_distance, instance_ids);
+
+        // 一个对象可能有多个部件命中，只保留最近的一次
+        out_object_ids.clear();
+        for (uint32_t instance_id : instance_ids)
+        {
+            GObjectID object_id = m_render_scene->getGObjectIDByMeshID(instance_id);
+            if (object_id != k_invalid_gobject_id &&
+                std::find(out_object_ids.begin(), out_object_ids.end(), object_id) == out_object_ids.end())
+            {
+                out_object_ids.push_back(object_id);
+            }
+        }
+    }
+
     // 创建坐标轴辅助对象（X/Y/Z轴可视化）
     void RenderSystem::createAxis(std::array<RenderEntity, 3> axis_entities, std::array<RenderMeshData, 3> mesh_datas)
     {
@@ -252,15 +302,30 @@ namespace Sammi
     // 清理关卡重新加载所需的数据（移除当前关卡所有对象）
     void RenderSystem::clearForLevelReloading()
     {
+        // 等待网格的实体属于旧关卡，已提交的资源请求继续完成（资源ID不随关卡重置）
+        m_asset_streamer->clearDeferredEntities();
         m_render_scene->clearForLevelReloading();
     }
 
+    std::shared_ptr<RenderAssetStreamer> RenderSystem::getAssetStreamer() const { return m_asset_streamer; }
+
     // 设置当前渲染管线类型（前向/延迟）
     void RenderSystem::setRenderPipelineType(RENDER_PIPELINE_TYPE pipeline_type)
     {
         m_render_pipeline_type = pipeline_type;
     }
 
+    // 开关主相机网格的GPU驱动绘制
+    void RenderSystem::setGpuDrivenMeshDrawEnabled(bool enabled)
+    {
+        std::static_pointer_cast<RenderPipeline>(m_render_pipeline)->setGpuDrivenMeshDrawEnabled(enabled);
+    }
+
+    bool RenderSystem::isGpuDrivenMeshDrawActive() const
+    {
+        return std::static_pointer_cast<RenderPipeline>(m_render_pipeline)->isGpuDrivenMeshDrawActive();
+    }
+
     // 初始化UI渲染后端（关联UI窗口）
     void RenderSystem::initializeUIRenderBackend(WindowUI* window_ui)
     {
@@ -301,9 +366,6 @@ namespace Sammi
                     // 部件唯一ID（对象ID+部件索引）
                     GameObjectPartId part_id = { gobject.getId(), part_index };
 
-                    // 检查该部件是否已在场景中存在（通过实例ID分配器判断）
-                    bool is_entity_in_scene = m_render_scene->getInstanceIdAllocator().hasElement(part_id);
-
                     // 渲染实体（存储渲染所需数据）
                     RenderEntity render_entity;
                     // 分配实例ID（若不存在则新建，若存在则复用）
@@ -320,22 +382,14 @@ namespace Sammi
                     // 检查网格是否已加载（通过场景的网格资产分配器）
                     bool is_mesh_loaded = m_render_scene->getMeshAssetIdAllocator().hasElement(mesh_source);
 
-                    // 网格渲染数据（顶点/索引缓冲区等）
-                    RenderMeshData mesh_data;
+                    // 分配网格资源ID（若未加载则新建，否则复用）
+                    render_entity.m_mesh_asset_id = m_render_scene->getMeshAssetIdAllocator().allocGuid(mesh_source);
                     if (!is_mesh_loaded)
                     {
-                        // 加载新网格（从文件读取并上传到GPU）
-                        mesh_data = m_render_resource->loadMeshData(mesh_source, render_entity.m_bounding_box);
-                    }
-                    else
-                    {
-                        // 已加载则获取缓存的包围盒（用于碰撞检测、视锥体裁剪）
-                        render_entity.m_bounding_box = m_render_resource->getCachedBoudingBox(mesh_source);
+                        // 新网格交给工作线程读取并解码，完成后按预算上传到GPU
+                        m_asset_streamer->requestMesh(mesh_source, render_entity.m_mesh_asset_id);
                     }
 
-                    // 分配网格资源ID（若未加载则新建，否则复用）
-                    render_entity.m_mesh_asset_id = m_render_scene->getMeshAssetIdAllocator().allocGuid(mesh_source);
-
                     // 设置顶点混合属性（若部件有关联的骨骼动画）
                     render_entity.m_enable_vertex_blending = game_object_part.m_skeleton_animation_result.m_transforms.size() > 1;
                     // 存储骨骼动画的变换矩阵（每帧更新）
@@ -371,47 +425,27 @@ namespace Sammi
                     // 检查材质是否已加载（通过场景的材质资产分配器）
                     bool is_material_loaded = m_render_scene->getMaterialAssetdAllocator().hasElement(material_source);
 
-                    // 材质渲染数据（着色器参数、采样器等）
-                    RenderMaterialData material_data;
-                    if (!is_material_loaded)
-                    {
-                        // 加载新材质（编译着色器、上传纹理到GPU）
-                        material_data = m_render_resource->loadMaterialData(material_source);
-                    }
-
                     // 分配材质资源ID（若未加载则新建，否则复用）
                     render_entity.m_material_asset_id = m_render_scene->getMaterialAssetdAllocator().allocGuid(material_source);
-
-                    // -------------------- 上传渲染实体到GPU --------------------
-                    // 若网格未加载：上传网格数据到GPU（创建缓冲区）
-                    if (!is_mesh_loaded)
-                    {
-                        m_render_resource->uploadGameObjectRenderResource(m_rhi, render_entity, mesh_data);
-                    }
-
-                    // 若材质未加载：上传材质数据到GPU（创建描述符集）
                     if (!is_material_loaded)
                     {
-                        m_render_resource->uploadGameObjectRenderResource(m_rhi, render_entity, material_data);
+                        // 新材质在工作线程解码纹理，上传前使用占位材质绘制
+                        m_asset_streamer->requestMaterial(material_source, render_entity.m_material_asset_id);
                     }
 
                     // -------------------- 更新场景中的渲染实体列表 --------------------
-                    // 若对象不在场景中：添加新实体到场景列表
-                    if (!is_entity_in_scene)
+                    if (m_asset_streamer->isMeshPending(render_entity.m_mesh_asset_id))
                     {
-                        m_render_scene->m_render_entities.push_back(render_entity);
+                        // 网格仍在加载：包围盒未知，实体暂不进入场景
+                        m_asset_streamer->deferEntity(gobject.getId(), render_entity);
                     }
                     else
                     {
-                        // 若对象已存在：更新现有实体的数据（如变换矩阵、材质等）
-                        for (auto& entity : m_render_scene->m_render_entities)
-                        {
-                            if (entity.m_instance_id == render_entity.m_instance_id)
-                            {
-                                entity = render_entity;
-                                break;
-                            }
-                        }
+                        // 获取缓存的包围盒（用于碰撞检测、视锥体裁剪）
+                        render_entity.m_bounding_box = m_render_resource->getCachedBoudingBox(mesh_source);
+                        // 按实例ID新增或覆盖现有实体（如变换矩阵、材质等），并丢弃其更早的等待状态
+                        m_asset_streamer->cancelDeferredEntity(render_entity.m_instance_id);
+                        m_render_scene->updateRenderEntity(render_entity);
                     }
                 }
                 // 处理完当前游戏对象的所有部件后，从交换数据中移除该对象
@@ -422,6 +456,14 @@ namespace Sammi
             m_swap_context.resetGameObjectResourceSwapData();
         }
 
+        // 上传工作线程已解码完成的资源（受每帧上传预算限制），网格就绪的实体进入场景
+        std::vector<RenderEntity> ready_entities;
+        m_asset_streamer->uploadCompletedAssets(m_rhi, ready_entities);
+        for (const RenderEntity& render_entity : ready_entities)
+        {
+            m_render_scene->updateRenderEntity(render_entity);
+        }
+
         // -------------------- 步骤3：删除不再需要的游戏对象 --------------------
         if (swap_data.m_game_object_to_delete.has_value())
         {
@@ -429,6 +471,8 @@ namespace Sammi
             while (!swap_data.m_game_object_to_delete->isEmpty())
             {
                 GameObjectDesc gobject = swap_data.m_game_object_to_delete->getNextProcessObject();
+                // 丢弃仍在等待网格的部件
+                m_asset_streamer->cancelDeferredEntities(gobject.getId());
                 // 从场景中删除该对象（移除所有相关实体）
                 m_render_scene->deleteEntityByGObjectID(gobject.getId());
                 swap_data.m_game_object_to_delete->pop();
@@ -437,6 +481,11 @@ namespace Sammi
             m_swap_context.resetGameObjectToDelete();
         }
 
+        // GPU驱动绘制的实例缓冲只更新本帧新增、修改或删除的实体
+        std::static_pointer_cast<RenderPipeline>(m_render_pipeline)
+            ->updateMeshInstances(*m_render_scene, *std::static_pointer_cast<RenderResource>(m_render_resource));
+        m_render_scene->clearDirtyInstanceIds();
+
         // -------------------- 步骤4：处理相机数据交换（更新相机参数） --------------------
         if (swap_data.m_camera_swap_data.has_value())
         {
@@ -8,6 +8,7 @@
 #include <array>
 #include <memory>
 #include <optional>
+#include <vector>
 
 namespace Sammi
 {
@@ -18,6 +19,7 @@ namespace Sammi
     class RenderPipelineBase;
     class RenderScene;
     class RenderCamera;
+    class RenderAssetStreamer;
     class WindowUI;
     class DebugDrawManager;
 
@@ -74,6 +76,13 @@ namespace Sammi
         // 参数：pipeline_type - 目标渲染管线类型（如延迟管线、前向管线）
         void setRenderPipelineType(RENDER_PIPELINE_TYPE pipeline_type);
 
+        // 开关主相机网格的GPU驱动绘制（GPU视锥剔除+间接绘制），关闭时使用CPU剔除路径便于对比
+        // 参数：enabled - true为GPU驱动，设备不支持时始终使用CPU路径
+        void setGpuDrivenMeshDrawEnabled(bool enabled);
+
+        // 主相机网格当前是否走GPU驱动绘制（已开启且设备支持）
+        bool isGpuDrivenMeshDrawActive() const;
+
         // 初始化UI渲染后端（为UI系统提供渲染支持）
         // 参数：window_ui - 窗口UI实例（需要绑定渲染后端）
         void initializeUIRenderBackend(WindowUI* window_ui);
@@ -95,6 +104,14 @@ namespace Sammi
         // 返回值：游戏对象ID（若不存在则可能为无效值）
         GObjectID getGObjectIDByMeshID(uint32_t mesh_id) const;
 
+        // 在CPU端用BVH查询射线命中包围盒的游戏对象（无需等待拾取通道回读）
+        // 参数：origin/direction - 世界空间射线，max_distance - 最大命中距离
+        // 输出：out_object_ids - 命中的游戏对象ID（由近到远，已去重）
+        void queryGObjectIDsByRay(const Vector3&          origin,
+                                  const Vector3&          direction,
+                                  float                   max_distance,
+                                  std::vector<GObjectID>& out_object_ids) const;
+
         // 获取当前引擎内容视口（包含位置和尺寸信息）
         // 返回值：引擎内容视口结构体（副本）
         EngineContentViewport getEngineContentViewport() const;
@@ -123,6 +140,9 @@ namespace Sammi
         // 清理关卡重新加载所需的资源（释放当前关卡相关的渲染资源，为重新加载做准备）
         void clearForLevelReloading();
 
+        // 获取资源流式加载器（可调整每帧GPU上传预算）
+        std::shared_ptr<RenderAssetStreamer> getAssetStreamer() const;
+
     private:
         // 当前渲染管线类型（默认使用延迟渲染管线）
         RENDER_PIPELINE_TYPE m_render_pipeline_type {RENDER_PIPELINE_TYPE::DEFERRED_PIPELINE};
@@ -139,6 +159,8 @@ namespace Sammi
         std::shared_ptr<RenderResourceBase> m_render_resource;
         // 渲染管线实例（根据m_render_pipeline_type创建的具体管线实现，如延迟渲染管线）
         std::shared_ptr<RenderPipelineBase> m_render_pipeline;
+        // 资源流式加载器（在工作线程解码网格和纹理，按每帧预算上传到GPU）
+        std::shared_ptr<RenderAssetStreamer> m_asset_streamer;
 
         // 处理交换的渲染数据（内部函数，可能用于将逻辑线程准备的数据传递给渲染线程执行）
         void processSwapData();
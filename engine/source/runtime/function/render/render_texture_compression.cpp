@@ -0,0 +1,592 @@
+#include "runtime/function/render/render_texture_compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Sammi
+{
+    namespace
+    {
+        constexpr uint32_t k_block_texel_count {16};
+
+        // bc7 4-bit index weights
+        constexpr int k_bc7_weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        struct Color565
+        {
+            uint16_t m_packed {0};
+            int      m_rgb[3] {0, 0, 0};
+        };
+
+        Color565 quantizeColor565(const float* rgb)
+        {
+            const int r = std::clamp(static_cast<int>(std::lround(rgb[0] * 31.0f / 255.0f)), 0, 31);
+            const int g = std::clamp(static_cast<int>(std::lround(rgb[1] * 63.0f / 255.0f)), 0, 63);
+            const int b = std::clamp(static_cast<int>(std::lround(rgb[2] * 31.0f / 255.0f)), 0, 31);
+
+            Color565 color;
+            color.m_packed = static_cast<uint16_t>((r << 11) | (g << 5) | b);
+            color.m_rgb[0] = (r << 3) | (r >> 2);
+            color.m_rgb[1] = (g << 2) | (g >> 4);
+            color.m_rgb[2] = (b << 3) | (b >> 2);
+            return color;
+        }
+
+        int getColorError(const int* a, const uint8_t* b, int channel_count)
+        {
+            int error = 0;
+            for (int c = 0; c < channel_count; ++c)
+            {
+                const int d = a[c] - static_cast<int>(b[c]);
+                error += d * d;
+            }
+            return error;
+        }
+
+        // principal axis of the texels by power iteration on the covariance, returns false for a constant block
+        bool getPrincipalAxis(const float (*texels)[4], uint32_t count, int channel_count, float* out_mean, float* out_axis)
+        {
+            for (int c = 0; c < channel_count; ++c)
+            {
+                out_mean[c] = 0.0f;
+                for (uint32_t i = 0; i < count; ++i)
+                    out_mean[c] += texels[i][c];
+                out_mean[c] /= static_cast<float>(count);
+            }
+
+            float covariance[4][4] = {};
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                for (int a = 0; a < channel_count; ++a)
+                {
+                    for (int b = 0; b < channel_count; ++b)
+                    {
+                        covariance[a][b] += (texels[i][a] - out_mean[a]) * (texels[i][b] - out_mean[b]);
+                    }
+                }
+            }
+
+            // start from the largest diagonal so the iteration does not begin orthogonal to the axis
+            int largest = 0;
+            for (int c = 1; c < channel_count; ++c)
+            {
+                if (covariance[c][c] > covariance[largest][largest])
+                    largest = c;
+            }
+            if (covariance[largest][largest] <= 0.0f)
+                return false;
+
+            float axis[4] = {};
+            for (int c = 0; c < channel_count; ++c)
+                axis[c] = covariance[largest][c];
+
+            for (int iteration = 0; iteration < 8; ++iteration)
+            {
+                float next[4]   = {};
+                float magnitude = 0.0f;
+                for (int a = 0; a < channel_count; ++a)
+                {
+                    for (int b = 0; b < channel_count; ++b)
+                        next[a] += covariance[a][b] * axis[b];
+                    magnitude = std::max(magnitude, std::fabs(next[a]));
+                }
+                if (magnitude <= 0.0f)
+                    return false;
+                for (int c = 0; c < channel_count; ++c)
+                    axis[c] = next[c] / magnitude;
+            }
+
+            for (int c = 0; c < channel_count; ++c)
+                out_axis[c] = axis[c];
+            return true;
+        }
+
+        // endpoints at the extreme projections of the texels onto the principal axis
+        void getAxisEndpoints(const float (*texels)[4], uint32_t count, int channel_count, float* out_min, float* out_max)
+        {
+            float mean[4] = {};
+            float axis[4] = {};
+            if (!getPrincipalAxis(texels, count, channel_count, mean, axis))
+            {
+                for (int c = 0; c < channel_count; ++c)
+                {
+                    out_min[c] = texels[0][c];
+                    out_max[c] = texels[0][c];
+                }
+                return;
+            }
+
+            float min_projection = 0.0f;
+            float max_projection = 0.0f;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                float projection = 0.0f;
+                for (int c = 0; c < channel_count; ++c)
+                    projection += (texels[i][c] - mean[c]) * axis[c];
+                min_projection = std::min(min_projection, projection);
+                max_projection = std::max(max_projection, projection);
+            }
+
+            for (int c = 0; c < channel_count; ++c)
+            {
+                out_min[c] = std::clamp(mean[c] + axis[c] * min_projection, 0.0f, 255.0f);
+                out_max[c] = std::clamp(mean[c] + axis[c] * max_projection, 0.0f, 255.0f);
+            }
+        }
+
+        // least squares endpoints for fixed texel weights, false when the weights do not span the endpoints
+        bool solveEndpoints(const float (*texels)[4],
+                            const float* weights,
+                            uint32_t     count,
+                            int          channel_count,
+                            float*       out_endpoint0,
+                            float*       out_endpoint1)
+        {
+            float alpha2      = 0.0f;
+            float beta2       = 0.0f;
+            float alpha_beta  = 0.0f;
+            float alpha_x[4]  = {};
+            float beta_x[4]   = {};
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const float beta  = weights[i];
+                const float alpha = 1.0f - beta;
+                alpha2 += alpha * alpha;
+                beta2 += beta * beta;
+                alpha_beta += alpha * beta;
+                for (int c = 0; c < channel_count; ++c)
+                {
+                    alpha_x[c] += alpha * texels[i][c];
+                    beta_x[c] += beta * texels[i][c];
+                }
+            }
+
+            const float determinant = alpha2 * beta2 - alpha_beta * alpha_beta;
+            if (std::fabs(determinant) < 1e-6f)
+                return false;
+
+            const float inverse = 1.0f / determinant;
+            for (int c = 0; c < channel_count; ++c)
+            {
+                out_endpoint0[c] = std::clamp((alpha_x[c] * beta2 - beta_x[c] * alpha_beta) * inverse, 0.0f, 255.0f);
+                out_endpoint1[c] = std::clamp((beta_x[c] * alpha2 - alpha_x[c] * alpha_beta) * inverse, 0.0f, 255.0f);
+            }
+            return true;
+        }
+
+        void writeUint16(uint8_t* out, uint16_t value)
+        {
+            out[0] = static_cast<uint8_t>(value & 0xFF);
+            out[1] = static_cast<uint8_t>(value >> 8);
+        }
+
+        void writeUint32(uint8_t* out, uint32_t value)
+        {
+            for (int i = 0; i < 4; ++i)
+                out[i] = static_cast<uint8_t>((value >> (8 * i)) & 0xFF);
+        }
+
+        /// bc1 ---------------------------------------------------------------------------------------------------
+
+        struct BC1Candidate
+        {
+            Color565 m_color0;
+            Color565 m_color1;
+            uint32_t m_indices {0};
+            int      m_error {0};
+        };
+
+        // 4-colour mode needs color0 > color1, the 3-colour mode color0 <= color1
+        void evaluateBC1(const uint8_t* rgba_block, bool is_transparent_mode, BC1Candidate& candidate)
+        {
+            if ((candidate.m_color0.m_packed < candidate.m_color1.m_packed) != is_transparent_mode &&
+                candidate.m_color0.m_packed != candidate.m_color1.m_packed)
+            {
+                std::swap(candidate.m_color0, candidate.m_color1);
+            }
+
+            int palette[4][3];
+            for (int c = 0; c < 3; ++c)
+            {
+                const int c0  = candidate.m_color0.m_rgb[c];
+                const int c1  = candidate.m_color1.m_rgb[c];
+                palette[0][c] = c0;
+                palette[1][c] = c1;
+                if (is_transparent_mode)
+                {
+                    palette[2][c] = (c0 + c1) / 2;
+                    palette[3][c] = 0;
+                }
+                else
+                {
+                    palette[2][c] = (2 * c0 + c1) / 3;
+                    palette[3][c] = (c0 + 2 * c1) / 3;
+                }
+            }
+
+            // equal endpoints decode in the 3-colour mode, only the first entries are meaningful then
+            const bool is_equal      = candidate.m_color0.m_packed == candidate.m_color1.m_packed;
+            const int  palette_count = (is_transparent_mode || is_equal) ? 3 : 4;
+
+            candidate.m_indices = 0;
+            candidate.m_error   = 0;
+            for (uint32_t i = 0; i < k_block_texel_count; ++i)
+            {
+                const uint8_t* texel = rgba_block + i * 4;
+                if (is_transparent_mode && texel[3] < 128)
+                {
+                    candidate.m_indices |= 3u << (2 * i);
+                    continue;
+                }
+
+                int best_index = 0;
+                int best_error = getColorError(palette[0], texel, 3);
+                for (int p = 1; p < palette_count; ++p)
+                {
+                    const int error = getColorError(palette[p], texel, 3);
+                    if (error < best_error)
+                    {
+                        best_error = error;
+                        best_index = p;
+                    }
+                }
+                candidate.m_indices |= static_cast<uint32_t>(best_index) << (2 * i);
+                candidate.m_error += best_error;
+            }
+        }
+
+        void encodeBC1Color(const uint8_t* rgba_block, bool is_alpha_allowed, uint8_t* out_block)
+        {
+            float    texels[k_block_texel_count][4];
+            uint32_t texel_count        = 0;
+            bool     is_transparent_mode = false;
+            for (uint32_t i = 0; i < k_block_texel_count; ++i)
+            {
+                const uint8_t* texel = rgba_block + i * 4;
+                if (is_alpha_allowed && texel[3] < 128)
+                {
+                    is_transparent_mode = true;
+                    continue;
+                }
+                for (int c = 0; c < 3; ++c)
+                    texels[texel_count][c] = texel[c];
+                ++texel_count;
+            }
+
+            BC1Candidate best;
+            if (texel_count == 0)
+            {
+                // fully transparent, all texels use the transparent index
+                float black[3] = {0.0f, 0.0f, 0.0f};
+                best.m_color0  = quantizeColor565(black);
+                best.m_color1  = best.m_color0;
+                best.m_indices = 0xFFFFFFFFu;
+            }
+            else
+            {
+                float endpoint_min[3];
+                float endpoint_max[3];
+                getAxisEndpoints(texels, texel_count, 3, endpoint_min, endpoint_max);
+
+                best.m_color0 = quantizeColor565(endpoint_max);
+                best.m_color1 = quantizeColor565(endpoint_min);
+                evaluateBC1(rgba_block, is_transparent_mode, best);
+
+                // one refinement pass with the endpoints fitted to the chosen indices
+                const float index_weights[2][4] = {{0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f}, {0.0f, 1.0f, 0.5f, 0.0f}};
+                float       weights[k_block_texel_count];
+                uint32_t    weight_count = 0;
+                for (uint32_t i = 0; i < k_block_texel_count; ++i)
+                {
+                    if (is_transparent_mode && rgba_block[i * 4 + 3] < 128)
+                        continue;
+                    const uint32_t index    = (best.m_indices >> (2 * i)) & 3u;
+                    weights[weight_count++] = index_weights[is_transparent_mode ? 1 : 0][index];
+                }
+
+                float refined0[4];
+                float refined1[4];
+                if (solveEndpoints(texels, weights, texel_count, 3, refined0, refined1))
+                {
+                    BC1Candidate refined;
+                    refined.m_color0 = quantizeColor565(refined0);
+                    refined.m_color1 = quantizeColor565(refined1);
+                    evaluateBC1(rgba_block, is_transparent_mode, refined);
+                    if (refined.m_error < best.m_error)
+                        best = refined;
+                }
+            }
+
+            writeUint16(out_block, best.m_color0.m_packed);
+            writeUint16(out_block + 2, best.m_color1.m_packed);
+            writeUint32(out_block + 4, best.m_indices);
+        }
+
+        /// bc4 ---------------------------------------------------------------------------------------------------
+
+        // single channel block with the 8 value mode, used for the alpha of bc3 and both channels of bc5
+        void encodeBC4Channel(const uint8_t* rgba_block, int channel, uint8_t* out_block)
+        {
+            int min_value = 255;
+            int max_value = 0;
+            for (uint32_t i = 0; i < k_block_texel_count; ++i)
+            {
+                min_value = std::min(min_value, static_cast<int>(rgba_block[i * 4 + channel]));
+                max_value = std::max(max_value, static_cast<int>(rgba_block[i * 4 + channel]));
+            }
+
+            out_block[0] = static_cast<uint8_t>(max_value);
+            out_block[1] = static_cast<uint8_t>(min_value);
+
+            uint64_t indices = 0;
+            if (max_value != min_value)
+            {
+                int palette[8];
+                palette[0] = max_value;
+                palette[1] = min_value;
+                for (int p = 2; p < 8; ++p)
+                    palette[p] = ((8 - p) * max_value + (p - 1) * min_value) / 7;
+
+                for (uint32_t i = 0; i < k_block_texel_count; ++i)
+                {
+                    const int value      = rgba_block[i * 4 + channel];
+                    int       best_index = 0;
+                    int       best_error = std::abs(palette[0] - value);
+                    for (int p = 1; p < 8; ++p)
+                    {
+                        const int error = std::abs(palette[p] - value);
+                        if (error < best_error)
+                        {
+                            best_error = error;
+                            best_index = p;
+                        }
+                    }
+                    indices |= static_cast<uint64_t>(best_index) << (3 * i);
+                }
+            }
+
+            for (int i = 0; i < 6; ++i)
+                out_block[2 + i] = static_cast<uint8_t>((indices >> (8 * i)) & 0xFF);
+        }
+
+        /// bc7 ---------------------------------------------------------------------------------------------------
+
+        struct BC7Endpoint
+        {
+            int m_value[4] {0, 0, 0, 0}; // 7-bit
+            int m_pbit {0};
+        };
+
+        // best 7-bit values for an endpoint given that all four channels share one p-bit
+        BC7Endpoint quantizeBC7Endpoint(const float* endpoint)
+        {
+            BC7Endpoint best;
+            float       best_error = -1.0f;
+            for (int pbit = 0; pbit < 2; ++pbit)
+            {
+                BC7Endpoint candidate;
+                candidate.m_pbit = pbit;
+                float error      = 0.0f;
+                for (int c = 0; c < 4; ++c)
+                {
+                    const int value       = static_cast<int>(std::lround((endpoint[c] - pbit) / 2.0f));
+                    candidate.m_value[c]  = std::clamp(value, 0, 127);
+                    const float d         = static_cast<float>((candidate.m_value[c] << 1) | pbit) - endpoint[c];
+                    error += d * d;
+                }
+                if (best_error < 0.0f || error < best_error)
+                {
+                    best       = candidate;
+                    best_error = error;
+                }
+            }
+            return best;
+        }
+
+        struct BC7Candidate
+        {
+            BC7Endpoint m_endpoint0;
+            BC7Endpoint m_endpoint1;
+            uint8_t     m_indices[k_block_texel_count] {};
+            int         m_error {0};
+        };
+
+        void evaluateBC7(const uint8_t* rgba_block, BC7Candidate& candidate)
+        {
+            int e0[4];
+            int e1[4];
+            for (int c = 0; c < 4; ++c)
+            {
+                e0[c] = (candidate.m_endpoint0.m_value[c] << 1) | candidate.m_endpoint0.m_pbit;
+                e1[c] = (candidate.m_endpoint1.m_value[c] << 1) | candidate.m_endpoint1.m_pbit;
+            }
+
+            int palette[16][4];
+            for (int p = 0; p < 16; ++p)
+            {
+                for (int c = 0; c < 4; ++c)
+                    palette[p][c] = ((64 - k_bc7_weights[p]) * e0[c] + k_bc7_weights[p] * e1[c] + 32) >> 6;
+            }
+
+            candidate.m_error = 0;
+            for (uint32_t i = 0; i < k_block_texel_count; ++i)
+            {
+                const uint8_t* texel      = rgba_block + i * 4;
+                int            best_index = 0;
+                int            best_error = getColorError(palette[0], texel, 4);
+                for (int p = 1; p < 16; ++p)
+                {
+                    const int error = getColorError(palette[p], texel, 4);
+                    if (error < best_error)
+                    {
+                        best_error = error;
+                        best_index = p;
+                    }
+                }
+                candidate.m_indices[i] = static_cast<uint8_t>(best_index);
+                candidate.m_error += best_error;
+            }
+        }
+
+        class BitWriter
+        {
+        public:
+            explicit BitWriter(uint8_t* out) : m_out(out) { std::memset(m_out, 0, 16); }
+
+            void write(uint32_t value, uint32_t bit_count)
+            {
+                for (uint32_t i = 0; i < bit_count; ++i, ++m_position)
+                {
+                    if ((value >> i) & 1u)
+                        m_out[m_position >> 3] |= static_cast<uint8_t>(1u << (m_position & 7));
+                }
+            }
+
+        private:
+            uint8_t* m_out;
+            uint32_t m_position {0};
+        };
+    } // namespace
+
+    size_t getTextureBlockSize(TextureBlockFormat format) { return format == TextureBlockFormat::bc1 ? 8 : 16; }
+
+    void encodeBC1Block(const uint8_t* rgba_block, uint8_t* out_block) { encodeBC1Color(rgba_block, true, out_block); }
+
+    void encodeBC3Block(const uint8_t* rgba_block, uint8_t* out_block)
+    {
+        encodeBC4Channel(rgba_block, 3, out_block);
+        // the colour block of bc3 always decodes in the 4-colour mode
+        encodeBC1Color(rgba_block, false, out_block + 8);
+    }
+
+    void encodeBC5Block(const uint8_t* rgba_block, uint8_t* out_block)
+    {
+        encodeBC4Channel(rgba_block, 0, out_block);
+        encodeBC4Channel(rgba_block, 1, out_block + 8);
+    }
+
+    void encodeBC7Block(const uint8_t* rgba_block, uint8_t* out_block)
+    {
+        float texels[k_block_texel_count][4];
+        for (uint32_t i = 0; i < k_block_texel_count; ++i)
+        {
+            for (int c = 0; c < 4; ++c)
+                texels[i][c] = rgba_block[i * 4 + c];
+        }
+
+        float endpoint_min[4];
+        float endpoint_max[4];
+        getAxisEndpoints(texels, k_block_texel_count, 4, endpoint_min, endpoint_max);
+
+        BC7Candidate best;
+        best.m_endpoint0 = quantizeBC7Endpoint(endpoint_min);
+        best.m_endpoint1 = quantizeBC7Endpoint(endpoint_max);
+        evaluateBC7(rgba_block, best);
+
+        float weights[k_block_texel_count];
+        for (uint32_t i = 0; i < k_block_texel_count; ++i)
+            weights[i] = k_bc7_weights[best.m_indices[i]] / 64.0f;
+
+        float refined0[4];
+        float refined1[4];
+        if (solveEndpoints(texels, weights, k_block_texel_count, 4, refined0, refined1))
+        {
+            BC7Candidate refined;
+            refined.m_endpoint0 = quantizeBC7Endpoint(refined0);
+            refined.m_endpoint1 = quantizeBC7Endpoint(refined1);
+            evaluateBC7(rgba_block, refined);
+            if (refined.m_error < best.m_error)
+                best = refined;
+        }
+
+        // the most significant index bit of texel 0 is implied zero, swap the endpoints to make it so
+        if (best.m_indices[0] >= 8)
+        {
+            std::swap(best.m_endpoint0, best.m_endpoint1);
+            for (uint8_t& index : best.m_indices)
+                index = static_cast<uint8_t>(15 - index);
+        }
+
+        BitWriter writer(out_block);
+        writer.write(1u << 6, 7); // mode 6
+        for (int c = 0; c < 4; ++c)
+        {
+            writer.write(static_cast<uint32_t>(best.m_endpoint0.m_value[c]), 7);
+            writer.write(static_cast<uint32_t>(best.m_endpoint1.m_value[c]), 7);
+        }
+        writer.write(static_cast<uint32_t>(best.m_endpoint0.m_pbit), 1);
+        writer.write(static_cast<uint32_t>(best.m_endpoint1.m_pbit), 1);
+        writer.write(best.m_indices[0], 3);
+        for (uint32_t i = 1; i < k_block_texel_count; ++i)
+            writer.write(best.m_indices[i], 4);
+    }
+
+    void encodeTextureBlockRows(const uint8_t*     rgba_pixels,
+                                uint32_t           width,
+                                uint32_t           height,
+                                TextureBlockFormat format,
+                                uint32_t           block_row_begin,
+                                uint32_t           block_row_end,
+                                uint8_t*           out_blocks)
+    {
+        const uint32_t block_count_x = (width + 3) / 4;
+        const size_t   block_size    = getTextureBlockSize(format);
+
+        uint8_t block[k_block_texel_count * 4];
+        for (uint32_t block_y = block_row_begin; block_y < block_row_end; ++block_y)
+        {
+            for (uint32_t block_x = 0; block_x < block_count_x; ++block_x)
+            {
+                for (uint32_t y = 0; y < 4; ++y)
+                {
+                    const uint32_t source_y = std::min(block_y * 4 + y, height - 1);
+                    for (uint32_t x = 0; x < 4; ++x)
+                    {
+                        const uint32_t source_x = std::min(block_x * 4 + x, width - 1);
+                        std::memcpy(block + (y * 4 + x) * 4,
+                                    rgba_pixels + (static_cast<size_t>(source_y) * width + source_x) * 4,
+                                    4);
+                    }
+                }
+
+                uint8_t* out_block = out_blocks + (static_cast<size_t>(block_y) * block_count_x + block_x) * block_size;
+                switch (format)
+                {
+                    case TextureBlockFormat::bc1:
+                        encodeBC1Block(block, out_block);
+                        break;
+                    case TextureBlockFormat::bc3:
+                        encodeBC3Block(block, out_block);
+                        break;
+                    case TextureBlockFormat::bc5:
+                        encodeBC5Block(block, out_block);
+                        break;
+                    case TextureBlockFormat::bc7:
+                        encodeBC7Block(block, out_block);
+                        break;
+                }
+            }
+        }
+    }
+} // namespace Sammi
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Sammi
+{
+    /// CPU block encoders for cooked textures. Every encoder takes one 4x4 block of RGBA8 texels in row order
+    /// (64 bytes) and writes the block in the layout the GPU samples directly.
+    enum class TextureBlockFormat : uint8_t
+    {
+        bc1, // RGB, 1-bit alpha, 8 bytes per block
+        bc3, // RGBA, 16 bytes per block
+        bc5, // RG, 16 bytes per block
+        bc7, // RGBA, 16 bytes per block, mode 6 only
+    };
+
+    size_t getTextureBlockSize(TextureBlockFormat format);
+
+    // bc1 switches to the 3-colour mode with transparent texels when a texel has alpha below 128
+    void encodeBC1Block(const uint8_t* rgba_block, uint8_t* out_block);
+    void encodeBC3Block(const uint8_t* rgba_block, uint8_t* out_block);
+    void encodeBC5Block(const uint8_t* rgba_block, uint8_t* out_block);
+    void encodeBC7Block(const uint8_t* rgba_block, uint8_t* out_block);
+
+    // encodes the rows of blocks [block_row_begin, block_row_end) of an image, texels past the right and bottom edge
+    // repeat the edge; out_blocks points at the first block of the image
+    void encodeTextureBlockRows(const uint8_t*     rgba_pixels,
+                                uint32_t           width,
+                                uint32_t           height,
+                                TextureBlockFormat format,
+                                uint32_t           block_row_begin,
+                                uint32_t           block_row_end,
+                                uint8_t*           out_blocks);
+} // namespace Sammi
@@ -0,0 +1,349 @@
+#include "runtime/function/render/render_texture_file.h"
+
+#include "runtime/core/base/macro.h"
+#include "runtime/core/base/thread_pool.h"
+#include "runtime/function/render/render_texture_compression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <vector>
+
+namespace Sammi
+{
+    namespace
+    {
+        static_assert(std::is_trivially_copyable<TextureFileHeader>::value, "texture file header is written as raw bytes");
+        static_assert(sizeof(TextureFileHeader) == 48, "texture file header must not contain padding");
+
+        // block rows encoded per task
+        constexpr size_t k_texture_block_row_chunk_size {16};
+
+        struct MipLevel
+        {
+            uint32_t             m_width {0};
+            uint32_t             m_height {0};
+            std::vector<uint8_t> m_pixels; // RGBA8
+        };
+
+        const std::array<float, 256>& getSrgbToLinearTable()
+        {
+            static const std::array<float, 256> table = [] {
+                std::array<float, 256> values {};
+                for (size_t i = 0; i < values.size(); i++)
+                {
+                    const float c = static_cast<float>(i) / 255.0f;
+                    values[i]     = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                }
+                return values;
+            }();
+            return table;
+        }
+
+        uint8_t encodeUnorm8(float value)
+        {
+            return static_cast<uint8_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+        }
+
+        uint8_t encodeSrgb8(float linear)
+        {
+            linear = std::clamp(linear, 0.0f, 1.0f);
+            const float c = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+            return encodeUnorm8(c);
+        }
+
+        // 2x2 box filter, the last row or column of an odd sized level is dropped
+        MipLevel downsampleMipLevel(const MipLevel& source, const TextureCookSettings& settings)
+        {
+            const std::array<float, 256>& srgb_to_linear = getSrgbToLinearTable();
+
+            MipLevel level;
+            level.m_width  = std::max(source.m_width / 2, 1u);
+            level.m_height = std::max(source.m_height / 2, 1u);
+            level.m_pixels.resize(static_cast<size_t>(level.m_width) * level.m_height * 4);
+
+            for (uint32_t y = 0; y < level.m_height; y++)
+            {
+                for (uint32_t x = 0; x < level.m_width; x++)
+                {
+                    float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+                    for (uint32_t sample = 0; sample < 4; sample++)
+                    {
+                        const uint32_t source_x = std::min(x * 2 + (sample & 1u), source.m_width - 1);
+                        const uint32_t source_y = std::min(y * 2 + (sample >> 1), source.m_height - 1);
+                        const uint8_t* texel =
+                            source.m_pixels.data() + (static_cast<size_t>(source_y) * source.m_width + source_x) * 4;
+                        for (int c = 0; c < 3; c++)
+                        {
+                            if (settings.m_is_normal_map)
+                                sum[c] += texel[c] / 255.0f * 2.0f - 1.0f;
+                            else if (settings.m_is_srgb)
+                                sum[c] += srgb_to_linear[texel[c]];
+                            else
+                                sum[c] += texel[c] / 255.0f;
+                        }
+                        sum[3] += texel[3] / 255.0f;
+                    }
+
+                    uint8_t* out = level.m_pixels.data() + (static_cast<size_t>(y) * level.m_width + x) * 4;
+                    if (settings.m_is_normal_map)
+                    {
+                        // averaged normals get shorter, keep them unit length
+                        float length = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+                        if (length <= 0.0f)
+                        {
+                            sum[0] = sum[1] = 0.0f;
+                            sum[2] = length = 1.0f;
+                        }
+                        for (int c = 0; c < 3; c++)
+                            out[c] = encodeUnorm8((sum[c] / length) * 0.5f + 0.5f);
+                    }
+                    else
+                    {
+                        for (int c = 0; c < 3; c++)
+                            out[c] = settings.m_is_srgb ? encodeSrgb8(sum[c] * 0.25f) : encodeUnorm8(sum[c] * 0.25f);
+                    }
+                    out[3] = encodeUnorm8(sum[3] * 0.25f);
+                }
+            }
+            return level;
+        }
+
+        RHIFormat getCookedFormat(const TextureCookSettings& settings)
+        {
+            switch (settings.m_format)
+            {
+                case TextureCookFormat::bc1:
+                    return settings.m_is_srgb ? RHI_FORMAT_BC1_RGBA_SRGB_BLOCK : RHI_FORMAT_BC1_RGBA_UNORM_BLOCK;
+                case TextureCookFormat::bc3:
+                    return settings.m_is_srgb ? RHI_FORMAT_BC3_SRGB_BLOCK : RHI_FORMAT_BC3_UNORM_BLOCK;
+                case TextureCookFormat::bc5:
+                    // two channel data has no colour space
+                    return RHI_FORMAT_BC5_UNORM_BLOCK;
+                case TextureCookFormat::bc7:
+                    return settings.m_is_srgb ? RHI_FORMAT_BC7_SRGB_BLOCK : RHI_FORMAT_BC7_UNORM_BLOCK;
+                default:
+                    return settings.m_is_srgb ? RHI_FORMAT_R8G8B8A8_SRGB : RHI_FORMAT_R8G8B8A8_UNORM;
+            }
+        }
+
+        TextureBlockFormat getBlockFormat(TextureCookFormat format)
+        {
+            switch (format)
+            {
+                case TextureCookFormat::bc1:
+                    return TextureBlockFormat::bc1;
+                case TextureCookFormat::bc3:
+                    return TextureBlockFormat::bc3;
+                case TextureCookFormat::bc5:
+                    return TextureBlockFormat::bc5;
+                default:
+                    return TextureBlockFormat::bc7;
+            }
+        }
+
+        void encodeMipLevel(const MipLevel&            level,
+                            const TextureCookSettings& settings,
+                            ThreadPool*                thread_pool,
+                            uint8_t*                   out_data)
+        {
+            if (settings.m_format == TextureCookFormat::uncompressed)
+            {
+                std::memcpy(out_data, level.m_pixels.data(), level.m_pixels.size());
+                return;
+            }
+
+            const TextureBlockFormat block_format    = getBlockFormat(settings.m_format);
+            const uint32_t           block_row_count = (level.m_height + 3) / 4;
+            auto                     encode_rows     = [&](size_t begin, size_t end) {
+                encodeTextureBlockRows(level.m_pixels.data(),
+                                       level.m_width,
+                                       level.m_height,
+                                       block_format,
+                                       static_cast<uint32_t>(begin),
+                                       static_cast<uint32_t>(end),
+                                       out_data);
+            };
+
+            if (thread_pool)
+            {
+                thread_pool->parallelFor(block_row_count, k_texture_block_row_chunk_size, encode_rows);
+            }
+            else
+            {
+                encode_rows(0, block_row_count);
+            }
+        }
+    } // namespace
+
+    bool isBlockCompressedFormat(RHIFormat format)
+    {
+        return format >= RHI_FORMAT_BC1_RGB_UNORM_BLOCK && format <= RHI_FORMAT_BC7_SRGB_BLOCK;
+    }
+
+    RHIFormat getTextureFormatInColorSpace(RHIFormat format, bool is_srgb)
+    {
+        switch (format)
+        {
+            case RHI_FORMAT_R8G8B8A8_UNORM:
+            case RHI_FORMAT_R8G8B8A8_SRGB:
+                return is_srgb ? RHI_FORMAT_R8G8B8A8_SRGB : RHI_FORMAT_R8G8B8A8_UNORM;
+            case RHI_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case RHI_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                return is_srgb ? RHI_FORMAT_BC1_RGBA_SRGB_BLOCK : RHI_FORMAT_BC1_RGBA_UNORM_BLOCK;
+            case RHI_FORMAT_BC3_UNORM_BLOCK:
+            case RHI_FORMAT_BC3_SRGB_BLOCK:
+                return is_srgb ? RHI_FORMAT_BC3_SRGB_BLOCK : RHI_FORMAT_BC3_UNORM_BLOCK;
+            case RHI_FORMAT_BC7_UNORM_BLOCK:
+            case RHI_FORMAT_BC7_SRGB_BLOCK:
+                return is_srgb ? RHI_FORMAT_BC7_SRGB_BLOCK : RHI_FORMAT_BC7_UNORM_BLOCK;
+            default:
+                return format;
+        }
+    }
+
+    size_t getTextureLevelSize(RHIFormat format, uint32_t width, uint32_t height)
+    {
+        const size_t block_count = static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4);
+        switch (format)
+        {
+            case RHI_FORMAT_R8G8B8A8_UNORM:
+            case RHI_FORMAT_R8G8B8A8_SRGB:
+                return static_cast<size_t>(width) * height * 4;
+            case RHI_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case RHI_FORMAT_BC1_RGB_SRGB_BLOCK:
+            case RHI_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case RHI_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                return block_count * 8;
+            case RHI_FORMAT_BC3_UNORM_BLOCK:
+            case RHI_FORMAT_BC3_SRGB_BLOCK:
+            case RHI_FORMAT_BC5_UNORM_BLOCK:
+            case RHI_FORMAT_BC5_SNORM_BLOCK:
+            case RHI_FORMAT_BC7_UNORM_BLOCK:
+            case RHI_FORMAT_BC7_SRGB_BLOCK:
+                return block_count * 16;
+            default:
+                return 0;
+        }
+    }
+
+    uint32_t getTextureMipLevelCount(uint32_t width, uint32_t height)
+    {
+        return static_cast<uint32_t>(std::floor(std::log2(std::max(std::max(width, height), 1u)))) + 1;
+    }
+
+    bool saveTextureFile(const std::filesystem::path& path,
+                         const uint8_t*               rgba_pixels,
+                         uint32_t                     width,
+                         uint32_t                     height,
+                         const TextureCookSettings&   settings,
+                         ThreadPool*                  thread_pool)
+    {
+        if (!rgba_pixels || width == 0 || height == 0)
+            return false;
+
+        std::vector<MipLevel> levels(1);
+        levels[0].m_width  = width;
+        levels[0].m_height = height;
+        levels[0].m_pixels.assign(rgba_pixels, rgba_pixels + static_cast<size_t>(width) * height * 4);
+
+        const uint32_t mip_levels = settings.m_is_mip_chain_generated ? getTextureMipLevelCount(width, height) : 1;
+        for (uint32_t i = 1; i < mip_levels; i++)
+        {
+            levels.push_back(downsampleMipLevel(levels.back(), settings));
+        }
+
+        TextureFileHeader header {};
+        header.m_magic       = k_texture_file_magic;
+        header.m_version     = k_texture_file_version;
+        header.m_format      = static_cast<uint32_t>(getCookedFormat(settings));
+        header.m_flags       = settings.m_is_normal_map ? k_texture_file_flag_normal_map : 0;
+        header.m_width       = width;
+        header.m_height      = height;
+        header.m_mip_levels  = mip_levels;
+        header.m_data_offset = (sizeof(TextureFileHeader) + k_texture_file_data_alignment - 1) &
+                               ~(k_texture_file_data_alignment - 1);
+        for (const MipLevel& level : levels)
+        {
+            header.m_data_size +=
+                getTextureLevelSize(static_cast<RHIFormat>(header.m_format), level.m_width, level.m_height);
+        }
+
+        std::vector<uint8_t> file_data(header.m_data_offset + header.m_data_size, 0);
+        std::memcpy(file_data.data(), &header, sizeof(header));
+        uint8_t* level_data = file_data.data() + header.m_data_offset;
+        for (const MipLevel& level : levels)
+        {
+            encodeMipLevel(level, settings, thread_pool, level_data);
+            level_data += getTextureLevelSize(static_cast<RHIFormat>(header.m_format), level.m_width, level.m_height);
+        }
+
+        std::ofstream texture_file(path, std::ios::binary);
+        if (!texture_file)
+        {
+            LOG_ERROR("failed to open {}", path.generic_string());
+            return false;
+        }
+        texture_file.write(reinterpret_cast<const char*>(file_data.data()), file_data.size());
+        return texture_file.good();
+    }
+
+    bool loadTextureFile(const std::shared_ptr<AssetFile>& texture_file,
+                         const std::string&                texture_url,
+                         TextureData&                      out_texture)
+    {
+        if (!texture_file)
+        {
+            LOG_ERROR("failed to open texture file {}", texture_url);
+            return false;
+        }
+        const size_t file_size = texture_file->getSize();
+
+        TextureFileHeader header;
+        if (file_size < sizeof(header))
+        {
+            LOG_ERROR("texture file {} is truncated", texture_url);
+            return false;
+        }
+        std::memcpy(&header, texture_file->getData(), sizeof(header));
+        if (header.m_magic != k_texture_file_magic || header.m_version != k_texture_file_version)
+        {
+            LOG_ERROR("texture file {} has an unknown format or version {}", texture_url, header.m_version);
+            return false;
+        }
+
+        const RHIFormat format    = static_cast<RHIFormat>(header.m_format);
+        uint64_t        data_size = 0;
+        uint32_t        width     = header.m_width;
+        uint32_t        height    = header.m_height;
+        for (uint32_t i = 0; i < header.m_mip_levels; i++)
+        {
+            data_size += getTextureLevelSize(format, width, height);
+            width  = std::max(width / 2, 1u);
+            height = std::max(height / 2, 1u);
+        }
+        if (header.m_width == 0 || header.m_height == 0 || header.m_mip_levels == 0 ||
+            header.m_mip_levels > getTextureMipLevelCount(header.m_width, header.m_height) ||
+            getTextureLevelSize(format, 1, 1) == 0 || data_size != header.m_data_size ||
+            header.m_data_offset > file_size || header.m_data_size > file_size - header.m_data_offset)
+        {
+            LOG_ERROR("texture file {} is corrupted", texture_url);
+            return false;
+        }
+
+        // the pixels are only read by the upload path
+        out_texture.m_pixels       = const_cast<uint8_t*>(texture_file->getData()) + header.m_data_offset;
+        out_texture.m_owner        = texture_file;
+        out_texture.m_width        = header.m_width;
+        out_texture.m_height       = header.m_height;
+        out_texture.m_depth        = 1;
+        out_texture.m_array_layers = 1;
+        out_texture.m_mip_levels   = header.m_mip_levels;
+        out_texture.m_format       = format;
+        out_texture.m_type         = SAMMI_IMAGE_TYPE::SAMMI_IMAGE_TYPE_2D;
+        return true;
+    }
+} // namespace Sammi
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "runtime/function/render/render_type.h"
+
+#include "runtime/resource/asset_manager/asset_file.h"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace Sammi
+{
+    class ThreadPool;
+
+    /// Cooked texture container, little endian:
+    ///   TextureFileHeader | mip 0 | mip 1 | ... | mip n-1
+    /// The mips are tightly packed from the largest to the smallest in the GPU format of the texture, so the whole
+    /// chain is uploaded as is and the RHI does not generate mips for it.
+    struct TextureFileHeader
+    {
+        uint32_t m_magic;
+        uint32_t m_version;
+        uint32_t m_format; // RHIFormat
+        uint32_t m_flags;
+        uint32_t m_width;
+        uint32_t m_height;
+        uint32_t m_mip_levels;
+        uint32_t m_reserved;
+        uint64_t m_data_offset;
+        uint64_t m_data_size;
+    };
+
+    constexpr uint32_t k_texture_file_magic {0x58455450}; // "PTEX"
+    constexpr uint32_t k_texture_file_version {1};
+    constexpr uint64_t k_texture_file_data_alignment {16};
+    // the mips were filtered as unit vectors
+    constexpr uint32_t k_texture_file_flag_normal_map {1u << 0};
+
+    enum class TextureCookFormat : uint8_t
+    {
+        uncompressed, // RGBA8
+        bc1,          // RGB with 1-bit alpha, 4 bits per texel
+        bc3,          // RGBA, 8 bits per texel
+        bc5,          // RG only, for data whose shader rebuilds the third channel
+        bc7,          // RGBA, 8 bits per texel, better colour than bc1/bc3
+    };
+
+    struct TextureCookSettings
+    {
+        TextureCookFormat m_format {TextureCookFormat::bc7};
+        // mips are filtered in linear space and the texture is sampled as sRGB
+        bool m_is_srgb {false};
+        bool m_is_normal_map {false};
+        bool m_is_mip_chain_generated {true};
+    };
+
+    bool isBlockCompressedFormat(RHIFormat format);
+    // the format sampled in the other colour space with the same memory layout, the format itself if there is none
+    RHIFormat getTextureFormatInColorSpace(RHIFormat format, bool is_srgb);
+    // byte size of one mip level, 0 for formats a texture file does not store
+    size_t getTextureLevelSize(RHIFormat format, uint32_t width, uint32_t height);
+    uint32_t getTextureMipLevelCount(uint32_t width, uint32_t height);
+
+    // rgba_pixels is the RGBA8 mip 0, block encoding is spread over the thread pool when one is given
+    bool saveTextureFile(const std::filesystem::path& path,
+                         const uint8_t*               rgba_pixels,
+                         uint32_t                     width,
+                         uint32_t                     height,
+                         const TextureCookSettings&   settings,
+                         ThreadPool*                  thread_pool = nullptr);
+
+    // out_texture points into the asset file and keeps it alive, m_mip_levels is the number of mips in m_pixels
+    bool loadTextureFile(const std::shared_ptr<AssetFile>& texture_file,
+                         const std::string&                texture_url,
+                         TextureData&                      out_texture);
+} // namespace Sammi
@@ -1713,15 +1713,26 @@ namespace Sammi
             m_data = malloc(size);
         }
 
+        // 引用外部内存（如映射的网格文件），不拷贝也不释放，owner负责保持其有效
+        BufferData(void* data, size_t size, std::shared_ptr<const void> owner)
+        {
+            m_size  = size;
+            m_data  = data;
+            m_owner = std::move(owner);
+        }
+
         ~BufferData()
         {
-            if (m_data)
+            if (m_data && !m_owner)
             {
                 free(m_data);
             }
         }
 
         bool isValid() const { return m_data != nullptr; }
+
+    private:
+        std::shared_ptr<const void> m_owner;
     };
 
     // 纹理数据类，管理纹理图像数据（如颜色/法线/金属度纹理）
@@ -1733,17 +1744,20 @@ namespace Sammi
         uint32_t m_depth {0};         // 纹理深度（3D纹理时使用，默认0表示2D）
         uint32_t m_mip_levels {0};    // MIP贴图级别数（多级渐远纹理，用于优化采样）
         uint32_t m_array_layers {0};  // 纹理数组层数（用于纹理数组）
-        void*    m_pixels {nullptr};  // 指向纹理像素数据的指针（RGBA等格式）
+        void*    m_pixels {nullptr};  // 指向纹理像素数据的指针（RGBA等格式），依次存放m_mip_levels级MIP
 
         // 纹理像素格式（如R8G8B8A8_UNORM）
         RHIFormat m_format = RHI_FORMAT_MAX_ENUM;
         SAMMI_IMAGE_TYPE m_type{ SAMMI_IMAGE_TYPE::SAMMI_IMAGE_TYPE_UNKNOWM };
 
+        // 非空时m_pixels指向外部内存（如映射的烘焙纹理文件），由owner保持其有效，析构时不释放
+        std::shared_ptr<const void> m_owner;
+
         TextureData() = default;
 
         ~TextureData()
         {
-            if (m_pixels)
+            if (m_pixels && !m_owner)
             {
                 free(m_pixels);
             }
@@ -1828,10 +1842,19 @@ namespace Sammi
         // 顶点缓冲区（存储MeshVertexDataDefinition）
         std::shared_ptr<BufferData> m_vertex_buffer;
 
-        // 索引缓冲区（存储三角形索引，uint32_t类型）
+        // 索引缓冲区（存储三角形索引，类型由m_index_type决定）
         std::shared_ptr<BufferData> m_index_buffer;
+
+        // 索引类型：顶点数不超过65535时为16位，否则为32位
+        RHIIndexType m_index_type {RHI_INDEX_TYPE_UINT16};
     };
 
+    // 单个索引的字节数
+    inline uint32_t getIndexTypeSize(RHIIndexType index_type)
+    {
+        return index_type == RHI_INDEX_TYPE_UINT32 ? sizeof(uint32_t) : sizeof(uint16_t);
+    }
+
     // 渲染网格数据结构体，扩展静态网格以支持骨骼动画
     struct RenderMeshData
     {
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace Sammi
+{
+    /// Read-only view of a whole file mapped into memory. Pages are copy-on-write, so callers may patch the
+    /// data in place without touching the file. The view stays valid until the MappedFile is closed or destroyed.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&)            = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::filesystem::path& path);
+        void close();
+
+        bool     isOpen() const { return m_data != nullptr; }
+        uint8_t* getData() const { return m_data; }
+        size_t   getSize() const { return m_size; }
+
+    private:
+        uint8_t* m_data {nullptr};
+        size_t   m_size {0};
+#if defined(_WIN32)
+        void* m_file_handle {nullptr};
+        void* m_mapping_handle {nullptr};
+#endif
+    };
+} // namespace Sammi
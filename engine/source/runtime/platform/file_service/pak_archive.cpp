@@ -0,0 +1,272 @@
+#include "runtime/platform/file_service/pak_archive.h"
+
+#include "runtime/core/base/block_compression.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace Sammi
+{
+    namespace
+    {
+        uint64_t alignUp(uint64_t value, uint64_t alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+        bool isRangeInFile(uint64_t offset, uint64_t size, uint64_t file_size)
+        {
+            return offset <= file_size && size <= file_size - offset;
+        }
+    } // namespace
+
+    uint64_t hashPakBytes(const void* data, size_t size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        uint64_t       hash  = 14695981039346656037ull;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    std::string normalizePakEntryPath(const std::filesystem::path& path)
+    {
+        std::string entry_path = path.lexically_normal().generic_string();
+        while (entry_path.compare(0, 2, "./") == 0)
+        {
+            entry_path.erase(0, 2);
+        }
+        return entry_path;
+    }
+
+    bool PakArchive::open(const std::filesystem::path& path)
+    {
+        close();
+
+        auto mapped_file = std::make_shared<MappedFile>();
+        if (!mapped_file->open(path))
+            return false;
+
+        const uint8_t* data = mapped_file->getData();
+        const uint64_t size = mapped_file->getSize();
+
+        PakHeader header;
+        if (size < sizeof(header))
+            return false;
+        std::memcpy(&header, data, sizeof(header));
+        if (header.m_magic != k_pak_magic || header.m_version != k_pak_version ||
+            header.m_toc_offset % alignof(PakEntry) != 0 ||
+            !isRangeInFile(header.m_toc_offset, uint64_t(header.m_entry_count) * sizeof(PakEntry), size) ||
+            !isRangeInFile(header.m_names_offset, header.m_names_size, size))
+        {
+            return false;
+        }
+
+        // validate every entry once here, reads afterwards only check the compression
+        const PakEntry* entries = reinterpret_cast<const PakEntry*>(data + header.m_toc_offset);
+        for (uint32_t index = 0; index < header.m_entry_count; ++index)
+        {
+            const PakEntry& entry = entries[index];
+            if (!isRangeInFile(entry.m_offset, entry.m_stored_size, size) ||
+                !isRangeInFile(entry.m_name_offset, entry.m_name_length, header.m_names_size) ||
+                (index > 0 && entries[index - 1].m_path_hash > entry.m_path_hash))
+            {
+                return false;
+            }
+        }
+
+        m_header      = header;
+        m_entries     = entries;
+        m_names       = reinterpret_cast<const char*>(data + header.m_names_offset);
+        m_mapped_file = std::move(mapped_file);
+        return true;
+    }
+
+    void PakArchive::close()
+    {
+        m_mapped_file.reset();
+        m_header  = PakHeader {};
+        m_entries = nullptr;
+        m_names   = nullptr;
+    }
+
+    const PakEntry* PakArchive::findEntry(const std::string& entry_path) const
+    {
+        if (!isOpen())
+            return nullptr;
+
+        const uint64_t  path_hash = hashPakBytes(entry_path.data(), entry_path.size());
+        const PakEntry* end       = m_entries + m_header.m_entry_count;
+        const PakEntry* entry     = std::lower_bound(
+            m_entries, end, path_hash, [](const PakEntry& lhs, uint64_t hash) { return lhs.m_path_hash < hash; });
+        for (; entry != end && entry->m_path_hash == path_hash; ++entry)
+        {
+            if (entry->m_name_length == entry_path.size() &&
+                std::memcmp(m_names + entry->m_name_offset, entry_path.data(), entry_path.size()) == 0)
+            {
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string PakArchive::getEntryName(const PakEntry& entry) const
+    {
+        return std::string(m_names + entry.m_name_offset, entry.m_name_length);
+    }
+
+    const uint8_t* PakArchive::getEntryView(const PakEntry& entry) const
+    {
+        if (entry.m_compression != static_cast<uint32_t>(PakCompression::none) || entry.m_stored_size != entry.m_size)
+            return nullptr;
+        return m_mapped_file->getData() + entry.m_offset;
+    }
+
+    bool PakArchive::readEntry(const PakEntry& entry, std::vector<uint8_t>& out_data) const
+    {
+        const uint8_t* stored_data = m_mapped_file->getData() + entry.m_offset;
+        switch (static_cast<PakCompression>(entry.m_compression))
+        {
+            case PakCompression::none:
+                if (entry.m_stored_size != entry.m_size)
+                    return false;
+                out_data.assign(stored_data, stored_data + entry.m_size);
+                return true;
+            case PakCompression::lz4:
+                out_data.resize(entry.m_size);
+                return decompressBlock(stored_data, entry.m_stored_size, out_data.data(), out_data.size());
+            default:
+                return false;
+        }
+    }
+
+    bool PakArchive::verifyEntry(const PakEntry& entry) const
+    {
+        if (const uint8_t* view = getEntryView(entry))
+        {
+            return hashPakBytes(view, entry.m_size) == entry.m_content_hash;
+        }
+
+        std::vector<uint8_t> data;
+        return readEntry(entry, data) && hashPakBytes(data.data(), data.size()) == entry.m_content_hash;
+    }
+
+    PakWriter::PakWriter(uint32_t alignment) : m_alignment(std::max<uint32_t>(alignment, alignof(PakEntry))) {}
+
+    void PakWriter::addEntry(const std::string& entry_path, const uint8_t* data, size_t size, PakCompression compression)
+    {
+        PendingEntry pending;
+        pending.m_path                 = normalizePakEntryPath(entry_path);
+        pending.m_entry.m_path_hash    = hashPakBytes(pending.m_path.data(), pending.m_path.size());
+        pending.m_entry.m_content_hash = hashPakBytes(data, size);
+        pending.m_entry.m_size         = size;
+
+        if (compression == PakCompression::lz4)
+        {
+            compressBlock(data, size, pending.m_data);
+            if (pending.m_data.size() > size - size / 8)
+            {
+                compression = PakCompression::none;
+            }
+        }
+        if (compression == PakCompression::none)
+        {
+            pending.m_data.assign(data, data + size);
+        }
+
+        pending.m_entry.m_compression = static_cast<uint32_t>(compression);
+        pending.m_entry.m_stored_size = pending.m_data.size();
+        m_entries.push_back(std::move(pending));
+    }
+
+    size_t PakWriter::getStoredSize() const
+    {
+        size_t stored_size = 0;
+        for (const PendingEntry& pending : m_entries)
+        {
+            stored_size += pending.m_data.size();
+        }
+        return stored_size;
+    }
+
+    size_t PakWriter::getOriginalSize() const
+    {
+        size_t original_size = 0;
+        for (const PendingEntry& pending : m_entries)
+        {
+            original_size += pending.m_entry.m_size;
+        }
+        return original_size;
+    }
+
+    bool PakWriter::write(const std::filesystem::path& path) const
+    {
+        // the table of contents is sorted by path hash for the binary search in PakArchive::findEntry
+        std::vector<const PendingEntry*> sorted_entries;
+        sorted_entries.reserve(m_entries.size());
+        for (const PendingEntry& pending : m_entries)
+        {
+            sorted_entries.push_back(&pending);
+        }
+        std::sort(sorted_entries.begin(), sorted_entries.end(), [](const PendingEntry* lhs, const PendingEntry* rhs) {
+            return lhs->m_entry.m_path_hash != rhs->m_entry.m_path_hash ?
+                       lhs->m_entry.m_path_hash < rhs->m_entry.m_path_hash :
+                       lhs->m_path < rhs->m_path;
+        });
+
+        PakHeader header;
+        header.m_entry_count = static_cast<uint32_t>(sorted_entries.size());
+        header.m_alignment   = m_alignment;
+
+        std::vector<PakEntry> toc;
+        std::string           names;
+        toc.reserve(sorted_entries.size());
+
+        uint64_t offset = alignUp(sizeof(PakHeader), m_alignment);
+        for (const PendingEntry* pending : sorted_entries)
+        {
+            PakEntry entry      = pending->m_entry;
+            entry.m_offset      = offset;
+            entry.m_name_offset = static_cast<uint32_t>(names.size());
+            entry.m_name_length = static_cast<uint32_t>(pending->m_path.size());
+            names += pending->m_path;
+            toc.push_back(entry);
+
+            offset = alignUp(offset + entry.m_stored_size, m_alignment);
+        }
+        header.m_names_offset = offset;
+        header.m_names_size   = names.size();
+        header.m_toc_offset   = alignUp(offset + names.size(), alignof(PakEntry));
+
+        std::ofstream pak_file(path, std::ios::binary | std::ios::trunc);
+        if (!pak_file)
+            return false;
+
+        uint64_t   written_size = 0;
+        const auto write_bytes  = [&](const void* data, size_t size) {
+            pak_file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            written_size += size;
+        };
+        const auto pad_to = [&](uint64_t target_offset) {
+            static const char zeros[256] {};
+            while (written_size < target_offset)
+            {
+                write_bytes(zeros, static_cast<size_t>(std::min<uint64_t>(sizeof(zeros), target_offset - written_size)));
+            }
+        };
+
+        write_bytes(&header, sizeof(header));
+        for (size_t index = 0; index < sorted_entries.size(); ++index)
+        {
+            pad_to(toc[index].m_offset);
+            write_bytes(sorted_entries[index]->m_data.data(), sorted_entries[index]->m_data.size());
+        }
+        pad_to(header.m_names_offset);
+        write_bytes(names.data(), names.size());
+        pad_to(header.m_toc_offset);
+        write_bytes(toc.data(), toc.size() * sizeof(PakEntry));
+
+        pak_file.flush();
+        return pak_file.good();
+    }
+} // namespace Sammi
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "runtime/platform/file_service/mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Sammi
+{
+    constexpr uint32_t k_pak_magic {0x4B415053}; // "SPAK"
+    constexpr uint32_t k_pak_version {1};
+    constexpr uint32_t k_pak_default_alignment {64};
+
+    enum class PakCompression : uint32_t
+    {
+        none = 0,
+        lz4  = 1, // LZ4 block format, see block_compression.h
+    };
+
+    // layout: header, entry data (each entry aligned), entry names, table of contents sorted by path hash
+    struct PakHeader
+    {
+        uint32_t m_magic {k_pak_magic};
+        uint32_t m_version {k_pak_version};
+        uint32_t m_entry_count {0};
+        uint32_t m_alignment {k_pak_default_alignment};
+        uint64_t m_toc_offset {0};
+        uint64_t m_names_offset {0};
+        uint64_t m_names_size {0};
+    };
+
+    struct PakEntry
+    {
+        uint64_t m_path_hash {0};
+        uint64_t m_content_hash {0}; // of the uncompressed bytes
+        uint64_t m_offset {0};
+        uint64_t m_stored_size {0};
+        uint64_t m_size {0};
+        uint32_t m_name_offset {0};
+        uint32_t m_name_length {0};
+        uint32_t m_compression {static_cast<uint32_t>(PakCompression::none)};
+        uint32_t m_reserved {0};
+    };
+
+    // 64 bit FNV-1a, used for the entry paths and the content hashes
+    uint64_t hashPakBytes(const void* data, size_t size);
+
+    // entry paths are relative to the asset root folder with '/' separators, e.g. "asset/texture/sky/skybox.hdr"
+    std::string normalizePakEntryPath(const std::filesystem::path& path);
+
+    /// Read-only view of a pak archive. The whole archive is mapped once and the table of contents is used in place,
+    /// opening costs no allocation per entry. Lookups and reads are const and can run on any thread.
+    class PakArchive
+    {
+    public:
+        bool open(const std::filesystem::path& path);
+        void close();
+
+        bool   isOpen() const { return m_mapped_file != nullptr; }
+        size_t getEntryCount() const { return m_header.m_entry_count; }
+
+        const PakEntry* findEntry(const std::string& entry_path) const;
+        const PakEntry& getEntry(size_t index) const { return m_entries[index]; }
+        std::string     getEntryName(const PakEntry& entry) const;
+
+        // bytes of an uncompressed entry inside the mapping, nullptr for a compressed entry
+        const uint8_t* getEntryView(const PakEntry& entry) const;
+        // decompresses or copies the entry
+        bool readEntry(const PakEntry& entry, std::vector<uint8_t>& out_data) const;
+        // recomputes the content hash, for the packer and for debugging corrupted installs
+        bool verifyEntry(const PakEntry& entry) const;
+
+        // keeps the mapping alive for views handed out by getEntryView
+        const std::shared_ptr<MappedFile>& getMappedFile() const { return m_mapped_file; }
+
+    private:
+        std::shared_ptr<MappedFile> m_mapped_file;
+        PakHeader                   m_header;
+        const PakEntry*             m_entries {nullptr};
+        const char*                 m_names {nullptr};
+    };
+
+    /// Builds a pak archive in memory and writes it in one go, used by the asset packer.
+    class PakWriter
+    {
+    public:
+        explicit PakWriter(uint32_t alignment = k_pak_default_alignment);
+
+        // lz4 is only kept when it saves at least an eighth of the entry, otherwise the entry is stored
+        void addEntry(const std::string& entry_path, const uint8_t* data, size_t size, PakCompression compression);
+
+        bool write(const std::filesystem::path& path) const;
+
+        size_t getEntryCount() const { return m_entries.size(); }
+        size_t getStoredSize() const;
+        size_t getOriginalSize() const;
+
+    private:
+        struct PendingEntry
+        {
+            std::string          m_path;
+            PakEntry             m_entry;
+            std::vector<uint8_t> m_data;
+        };
+
+        uint32_t                  m_alignment;
+        std::vector<PendingEntry> m_entries;
+    };
+} // namespace Sammi
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Sammi
+{
+    /// Read-only bytes of one asset as served by AssetManager::openAssetFile: a view into the mounted pak, the
+    /// decompressed copy of a pak entry or a mapped loose file. The owner keeps the bytes alive, it can be handed
+    /// to BufferData to upload the bytes without copying them.
+    class AssetFile
+    {
+    public:
+        AssetFile(const uint8_t* data, size_t size, std::shared_ptr<const void> owner) :
+            m_data(data), m_size(size), m_owner(std::move(owner))
+        {}
+
+        const uint8_t*                     getData() const { return m_data; }
+        size_t                             getSize() const { return m_size; }
+        const std::shared_ptr<const void>& getOwner() const { return m_owner; }
+
+    private:
+        const uint8_t*              m_data {nullptr};
+        size_t                      m_size {0};
+        std::shared_ptr<const void> m_owner;
+    };
+} // namespace Sammi
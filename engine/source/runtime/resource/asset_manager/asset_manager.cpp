@@ -3,6 +3,7 @@
 #include "runtime/resource/config_manager/config_manager.h"
 
 #include "runtime/function/global/global_context.h"
+#include "runtime/platform/file_service/mapped_file.h"
 
 #include <filesystem>
 
@@ -12,4 +13,252 @@ namespace Sammi
     {
         return std::filesystem::absolute(g_runtime_global_context.m_config_manager->getRootFolder() / relative_path);
     }
+
+    std::string AssetManager::getBinaryAssetUrl(const std::string& asset_url)
+    {
+        std::filesystem::path binary_url(asset_url);
+        // "x.level.json" -> "x.level.pbin", keep the inner extension so asset types stay distinguishable.
+        // .pbin is only used by archives, the cooked meshes, clips and textures have their own extensions
+        return binary_url.replace_extension(".pbin").generic_string();
+    }
+
+    bool AssetManager::isBinaryAssetUrl(const std::string& asset_url)
+    {
+        return std::filesystem::path(asset_url).extension() == ".pbin";
+    }
+
+    std::string AssetManager::getPreferredAssetUrl(const std::string& asset_url) const
+    {
+        if (isBinaryAssetUrl(asset_url))
+            return asset_url;
+
+        const std::string binary_url = getBinaryAssetUrl(asset_url);
+        return isDerivedAssetUpToDate(asset_url, binary_url) ? binary_url : asset_url;
+    }
+
+    bool AssetManager::mountPak(const std::filesystem::path& pak_path)
+    {
+        if (!m_pak_archive.open(pak_path))
+        {
+            LOG_WARN("mount asset pak {} failed, assets are read from loose files", pak_path.generic_string());
+            return false;
+        }
+        LOG_INFO("mounted asset pak {} with {} entries", pak_path.generic_string(), m_pak_archive.getEntryCount());
+        return true;
+    }
+
+    void AssetManager::unmountPak() { m_pak_archive.close(); }
+
+    std::string AssetManager::getPakEntryPath(const std::string& asset_url) const
+    {
+        const std::filesystem::path root_folder =
+            std::filesystem::absolute(g_runtime_global_context.m_config_manager->getRootFolder()).lexically_normal();
+        const std::string entry_path =
+            normalizePakEntryPath(getFullPath(asset_url).lexically_normal().lexically_relative(root_folder));
+        if (entry_path.empty() || entry_path.compare(0, 2, "..") == 0)
+            return std::string();
+        return entry_path;
+    }
+
+    const PakEntry* AssetManager::findPakEntry(const std::string& asset_url) const
+    {
+        if (!m_pak_archive.isOpen())
+            return nullptr;
+
+        const std::string entry_path = getPakEntryPath(asset_url);
+        if (entry_path.empty())
+            return nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_asset_cache_mutex);
+            if (m_loose_asset_paths.count(entry_path) != 0)
+                return nullptr;
+        }
+        return m_pak_archive.findEntry(entry_path);
+    }
+
+    std::shared_ptr<AssetFile> AssetManager::openAssetFile(const std::string& asset_url) const
+    {
+        if (const PakEntry* entry = findPakEntry(asset_url))
+        {
+            // stored entries are served from the mapping, the archive mapping is their owner
+            if (const uint8_t* entry_view = m_pak_archive.getEntryView(*entry))
+            {
+                return std::make_shared<AssetFile>(entry_view, entry->m_size, m_pak_archive.getMappedFile());
+            }
+
+            auto entry_data = std::make_shared<std::vector<uint8_t>>();
+            if (!m_pak_archive.readEntry(*entry, *entry_data))
+            {
+                LOG_ERROR("read pak entry {} failed!", asset_url);
+                return nullptr;
+            }
+            return std::make_shared<AssetFile>(entry_data->data(), entry_data->size(), entry_data);
+        }
+
+        auto mapped_file = std::make_shared<MappedFile>();
+        if (!mapped_file->open(getFullPath(asset_url)))
+        {
+            return nullptr;
+        }
+        return std::make_shared<AssetFile>(mapped_file->getData(), mapped_file->getSize(), mapped_file);
+    }
+
+    bool AssetManager::hasAssetFile(const std::string& asset_url) const
+    {
+        std::error_code error;
+        return findPakEntry(asset_url) != nullptr || std::filesystem::is_regular_file(getFullPath(asset_url), error);
+    }
+
+    bool AssetManager::isDerivedAssetUpToDate(const std::string& source_url, const std::string& derived_url) const
+    {
+        if (findPakEntry(derived_url) != nullptr)
+        {
+            // packed from one snapshot of the asset folder, stale only if the source was saved again since
+            return findPakEntry(source_url) != nullptr || !hasAssetFile(source_url);
+        }
+
+        std::error_code error;
+        const auto      derived_time = std::filesystem::last_write_time(getFullPath(derived_url), error);
+        if (error)
+            return false;
+        if (getFullPath(source_url) == getFullPath(derived_url))
+            return true;
+        const auto source_time = std::filesystem::last_write_time(getFullPath(source_url), error);
+
+        // a source edited after the derived file was written wins, the derived file is stale
+        return error || derived_time >= source_time;
+    }
+
+    bool AssetManager::loadBinaryAsset(const std::string&                        asset_url,
+                                       const std::function<bool(BinaryReader&)>& read_func) const
+    {
+        std::shared_ptr<AssetFile> asset_file = openAssetFile(asset_url);
+        if (!asset_file)
+        {
+            LOG_ERROR("open file: {} failed!", getFullPath(asset_url).generic_string());
+            return false;
+        }
+
+        BinaryReader reader(asset_file->getData(), asset_file->getSize());
+        if (!read_func(reader))
+        {
+            LOG_ERROR("read binary asset {} failed!", asset_url);
+            return false;
+        }
+        return true;
+    }
+
+    bool AssetManager::saveBinaryAsset(const std::string& asset_url, const BinaryWriter& writer) const
+    {
+        std::ofstream asset_file(getFullPath(asset_url), std::ios::binary | std::ios::trunc);
+        if (!asset_file)
+        {
+            LOG_ERROR("open file {} failed!", asset_url);
+            return false;
+        }
+
+        const std::vector<uint8_t>& buffer = writer.getBuffer();
+        asset_file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        asset_file.flush();
+        if (!asset_file)
+        {
+            LOG_ERROR("write file {} failed!", asset_url);
+            return false;
+        }
+
+        invalidateCachedAsset(asset_url);
+        return true;
+    }
+
+    bool AssetManager::loadAssetDocument(const std::string& asset_url,
+                                         JsonDocument&      out_document,
+                                         bool               is_retained) const
+    {
+        std::shared_ptr<AssetFile> asset_file = openAssetFile(asset_url);
+        if (!asset_file)
+        {
+            LOG_ERROR("open file: {} failed!", getFullPath(asset_url).generic_string());
+            return false;
+        }
+
+        const char* asset_text = reinterpret_cast<const char*>(asset_file->getData());
+        bool        is_parsed  = false;
+        if (is_retained)
+        {
+            // a cached document would keep a loose file mapped, and a mapped file can't be saved over on windows
+            auto asset_text_copy = std::make_shared<const std::string>(asset_text, asset_file->getSize());
+            is_parsed = out_document.parse(asset_text_copy->data(), asset_text_copy->size(), asset_text_copy);
+        }
+        else
+        {
+            // the document keeps the mapping alive, its strings point into it
+            is_parsed = out_document.parse(asset_text, asset_file->getSize(), asset_file);
+        }
+
+        if (!is_parsed)
+        {
+            LOG_ERROR("parse json file {} failed: {}", asset_url, out_document.getError());
+            return false;
+        }
+        return true;
+    }
+
+    void AssetManager::clearAssetCache()
+    {
+        std::lock_guard<std::mutex> lock(m_asset_cache_mutex);
+        m_asset_document_cache.clear();
+    }
+
+    std::shared_ptr<const JsonDocument> AssetManager::getCachedAssetDocument(const std::string& asset_url) const
+    {
+        const std::string asset_path = getFullPath(asset_url).generic_string();
+
+        std::promise<std::shared_ptr<const JsonDocument>>       parse_promise;
+        std::shared_future<std::shared_ptr<const JsonDocument>> cached_document;
+        bool                                                    is_parsing_thread = false;
+        {
+            std::lock_guard<std::mutex> lock(m_asset_cache_mutex);
+            auto                        find_it = m_asset_document_cache.find(asset_path);
+            if (find_it != m_asset_document_cache.end())
+            {
+                cached_document = find_it->second;
+            }
+            else
+            {
+                cached_document = parse_promise.get_future().share();
+                m_asset_document_cache.emplace(asset_path, cached_document);
+                is_parsing_thread = true;
+            }
+        }
+
+        if (is_parsing_thread)
+        {
+            auto asset_document = std::make_shared<JsonDocument>();
+            if (!loadAssetDocument(asset_url, *asset_document, true))
+            {
+                asset_document.reset();
+
+                // waiting threads still get the failure, later requests read the file again
+                std::lock_guard<std::mutex> lock(m_asset_cache_mutex);
+                m_asset_document_cache.erase(asset_path);
+            }
+            parse_promise.set_value(asset_document);
+        }
+
+        // the document is only read once parsed, any number of threads can deserialize from it at the same time
+        return cached_document.get();
+    }
+
+    void AssetManager::invalidateCachedAsset(const std::string& asset_url) const
+    {
+        // the saved loose file is newer than anything in the pak
+        const std::string entry_path = m_pak_archive.isOpen() ? getPakEntryPath(asset_url) : std::string();
+
+        std::lock_guard<std::mutex> lock(m_asset_cache_mutex);
+        m_asset_document_cache.erase(getFullPath(asset_url).generic_string());
+        if (!entry_path.empty())
+        {
+            m_loose_asset_paths.insert(entry_path);
+        }
+    }
 }
@@ -1,14 +1,25 @@
 #pragma once
 
 #include "runtime/core/base/macro.h"
+#include "runtime/core/meta/serializer/binary_serializer.h"
+#include "runtime/core/meta/serializer/json_document_serializer.h"
 #include "runtime/core/meta/serializer/serializer.h"
+#include "runtime/platform/file_service/pak_archive.h"
+#include "runtime/resource/asset_manager/asset_file.h"
 
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
+#include "_generated/serializer/all_binary_serializer.h"
+#include "_generated/serializer/all_json_document_serializer.h"
 #include "_generated/serializer/all_serializer.h"
 
 namespace Sammi
@@ -17,6 +28,9 @@ namespace Sammi
      * @brief ʲ࣬ʲļء漰·
      *
      * ṩģӿڣ֧ɱлʲͣSerializerʵ֣
+     *
+     * ȡһļ㣨openAssetFileԴʱȲԴûеԴ˵ɢļ
+     * дɢļдԴ֮Ҳɢļȡʱ´
      */
     class AssetManager
     {
@@ -29,45 +43,60 @@ namespace Sammi
          * @return سɹtrue򷵻false
          *
          * ̣
-         * 1. ·תΪ·
-         * 2. ļǷɹ
-         * 3. ȡļȫݵַ
-         * 4. JSONı
-         * 5. ʹSerializerJSONлΪʲ
+         * 1. ӳ䲢JSONļloadAssetDocumentıҲΪÿֵڴ
+         * 2. ʹJsonDocumentSerializerֱӴӽлΪʲ󣬲json11Json
+         *
+         * չΪ.pbin·ƴ浵ȡBinarySerializerJSON
          */
         template<typename AssetType>
         bool loadAsset(const std::string& asset_url, AssetType& out_asset) const
         {
-            // ·תΪ·ĿĿ¼+·
-            std::filesystem::path asset_path = getFullPath(asset_url);
+            if (isBinaryAssetUrl(asset_url))
+            {
+                return loadBinaryAsset(asset_url, [&out_asset](BinaryReader& reader) {
+                    return BinarySerializer::readArchive(reader, out_asset);
+                });
+            }
 
-            // JSONļֻģʽ
-            std::ifstream asset_json_file(asset_path);
-            if (!asset_json_file)
+            JsonDocument asset_document;
+            if (!loadAssetDocument(asset_url, asset_document, false))
             {
-                LOG_ERROR("open file: {} failed!", asset_path.generic_string());
                 return false;
             }
 
-            // ȡļȫݵַ
-            std::stringstream buffer;
-            buffer << asset_json_file.rdbuf();
-            std::string asset_json_text(buffer.str());
+            // ʹJsonDocumentSerializerJSONĵлΪʲԪɵػʵ֣
+            JsonDocumentSerializer::read(asset_document.getRoot(), out_asset);
+            return true;
+        }
 
-            // JSONıΪJsonʹõJSON⣬nlohmann/json
-            std::string error;
-            auto&&      asset_json = Json::parse(asset_json_text, error);
-            if (!error.empty())
+        /**
+         * @brief ʲ棬̰߳ȫ
+         * @tparam AssetType صʲ֧ͣSerializerл
+         * @param asset_url ʲ·
+         * @param out_asset 洢غʲ
+         * @return سɹtrue򷵻false
+         *
+         * ͬһļֻȡһΣJSONĵ·棬֮ÿεֻӻĵл¶
+         * ڱĶļObjectDefinitionResMaterialRes߳ͬʱͬһļʱֻһ߳̽ȴ
+         */
+        template<typename AssetType>
+        bool loadCachedAsset(const std::string& asset_url, AssetType& out_asset) const
+        {
+            std::shared_ptr<const JsonDocument> asset_document = getCachedAssetDocument(asset_url);
+            if (!asset_document)
             {
-                LOG_ERROR("parse json file {} failed!", asset_url);
                 return false;
             }
 
-            // ʹSerializerJSONлΪʲػSerializerʵ֣
-            Serializer::read(asset_json, out_asset);
+            JsonDocumentSerializer::read(asset_document->getRoot(), out_asset);
             return true;
         }
 
+        /**
+         * @brief loadCachedAssetĻ棨ؿжʱãԴⲿ޸ĺ
+         */
+        void clearAssetCache();
+
         /**
          * @brief ʲлΪJSONдļ
          * @tparam AssetType ʲ֧ͣSerializerл
@@ -81,10 +110,19 @@ namespace Sammi
          * 3. ʹSerializerʲлΪJSON
          * 4. JSONתΪʽַ
          * 5. JSONַдļˢ»
+         *
+         * չΪ.pbin·дɶƴ浵汾źֶαǩֶɾɴ浵Կɶȡ
          */
         template<typename AssetType>
         bool saveAsset(const AssetType& out_asset, const std::string& asset_url) const
         {
+            if (isBinaryAssetUrl(asset_url))
+            {
+                BinaryWriter writer;
+                BinarySerializer::writeArchive(writer, out_asset);
+                return saveBinaryAsset(asset_url, writer);
+            }
+
             // ļĬϸļ
             std::ofstream asset_json_file(getFullPath(asset_url));
             if (!asset_json_file)
@@ -102,6 +140,9 @@ namespace Sammi
             asset_json_file << asset_json_text;
             asset_json_file.flush();  // ǿˢ»ȷд
 
+            // еľʧЧ
+            invalidateCachedAsset(asset_url);
+
             return true;
         }
 
@@ -118,5 +159,72 @@ namespace Sammi
          * ʾʵֿΪreturn std::filesystem::current_path() / "assets" / relative_path;
          */
         std::filesystem::path getFullPath(const std::string& relative_path) const;
+
+        /**
+         * @brief Ʊ·ͬչΪ.pbin"levels/1-1.level.json" -> "levels/1-1.level.pbin"
+         */
+        static std::string getBinaryAssetUrl(const std::string& asset_url);
+        static bool        isBinaryAssetUrl(const std::string& asset_url);
+
+        /**
+         * @brief ƱҲԭļʱضƱ·򷵻ԭ·
+         */
+        std::string getPreferredAssetUrl(const std::string& asset_url) const;
+
+        /**
+         * @brief ԴԴɣڼԴǰãغԴֻɱ̷߳
+         * @param pak_path Դ·
+         * @return سɹtrueʧʱԴȫɢļȡ
+         */
+        bool mountPak(const std::filesystem::path& pak_path);
+        void unmountPak();
+        bool isPakMounted() const { return m_pak_archive.isOpen(); }
+
+        /**
+         * @brief ȡʲļȫ
+         * @param asset_url ···λԴĿ¼²Դ
+         * @return ļݣڻȡʧʱnullptr
+         *
+         * ԴδѹĿֱӷӳڴͼ㿽ѹĿѹ»ɢļӳ䡣
+         */
+        std::shared_ptr<AssetFile> openAssetFile(const std::string& asset_url) const;
+        bool                       hasAssetFile(const std::string& asset_url) const;
+
+        /**
+         * @brief жļ決񡢶ƱȣǷãҲԴļ
+         *
+         * ļԴʱΪãʱͬһԴĿ¼Դļֱ֮Ϊɢļ
+         */
+        bool isDerivedAssetUpToDate(const std::string& source_url, const std::string& derived_url) const;
+
+    private:
+        // ӳ.pbinļread_funcȡļͷħ汾ƥʱfalse
+        bool loadBinaryAsset(const std::string& asset_url, const std::function<bool(BinaryReader&)>& read_func) const;
+        bool saveBinaryAsset(const std::string& asset_url, const BinaryWriter& writer) const;
+
+        /**
+         * @brief ȡʲJSONļ
+         *
+         * ֱӳļϽĵӳֱ٣is_retainedΪtrueʱĵȿһı
+         * ⳤӳɢļ޷渲ǡ
+         */
+        bool loadAssetDocument(const std::string& asset_url, JsonDocument& out_document, bool is_retained) const;
+
+        // ԴеĿ·ԴĿ¼Ŀ¼֮·ؿմ
+        std::string     getPakEntryPath(const std::string& asset_url) const;
+        const PakEntry* findPakEntry(const std::string& asset_url) const;
+
+        // ȡʲJSON״ʱ仺棨̰߳ȫʧʱnullptr
+        std::shared_ptr<const JsonDocument> getCachedAssetDocument(const std::string& asset_url) const;
+        void invalidateCachedAsset(const std::string& asset_url) const;
+
+        // ʲ·ֵʧܵĿᱻƳ´¶ȡ
+        mutable std::mutex m_asset_cache_mutex;
+        mutable std::unordered_map<std::string, std::shared_future<std::shared_ptr<const JsonDocument>>>
+            m_asset_document_cache;
+        // غ󱣴ԴԴеĿ·ЩԴƹԴȡɢļ
+        mutable std::unordered_set<std::string> m_loose_asset_paths;
+
+        PakArchive m_pak_archive;
     };
 }
@@ -52,6 +52,10 @@ namespace Sammi
                 {
                     m_schema_folder = m_root_folder / value;
                 }
+                else if (name == "AssetPakFile")
+                {
+                    m_asset_pak_path = m_root_folder / value;
+                }
                 else if (name == "DefaultWorld")
                 {
                     m_default_world_url = value;
@@ -92,6 +96,8 @@ namespace Sammi
 
     const std::filesystem::path& ConfigManager::getSchemaFolder() const { return m_schema_folder; }
 
+    const std::filesystem::path& ConfigManager::getAssetPakPath() const { return m_asset_pak_path; }
+
     const std::filesystem::path& ConfigManager::getEditorBigIconPath() const { return m_editor_big_icon_path; }
 
     const std::filesystem::path& ConfigManager::getEditorSmallIconPath() const { return m_editor_small_icon_path; }
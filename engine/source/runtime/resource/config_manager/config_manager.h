@@ -30,6 +30,10 @@ namespace Sammi
         /// @return ģʽļ·"/Project/Root/Schemas/"
         const std::filesystem::path& getSchemaFolder() const;
 
+        /// ȡԴ·ʱԴɣδʱΪգԴȫɢļȡ
+        /// @return Դ·"/Project/Root/asset.pak"
+        const std::filesystem::path& getAssetPakPath() const;
+
         // ༭ר·ڱ༭ģʽʹã
         /// ȡ༭ͼ·ڴڱ/
         /// @return ͼ·"/Editor/Resources/Icons/EditorLarge.ico"
@@ -68,6 +72,7 @@ namespace Sammi
         std::filesystem::path m_root_folder;             // ļ·
         std::filesystem::path m_asset_folder;            // Դļ·
         std::filesystem::path m_schema_folder;           // ģʽļ·
+        std::filesystem::path m_asset_pak_path;          // Դ·ѡ
         std::filesystem::path m_editor_big_icon_path;    // ༭ͼ·
         std::filesystem::path m_editor_small_icon_path;  // ༭Сͼ·
         std::filesystem::path m_editor_font_path;        // ༭·
@@ -38,9 +38,6 @@ namespace Piccolo
         BlendState  blend_state;
         // animation to skeleton map
         float       frame_position; // 0-1
-
-        META(Disable)
-        AnimationResult animation_result;
     };
 
 } // namespace Piccolo
\ No newline at end of file
@@ -2,10 +2,12 @@
 #include "runtime/core/meta/reflection/reflection.h"
 #include "runtime/resource/res_type/data/animation_clip.h"
 #include "runtime/resource/res_type/data/animation_skeleton_node_map.h"
+#include <memory>
 #include <string>
 #include <vector>
 namespace Piccolo
 {
+    class CompressedAnimationClip;
 
     REFLECTION_TYPE(BoneBlendWeight)
     CLASS(BoneBlendWeight, Fields)
@@ -22,9 +24,17 @@ namespace Piccolo
         REFLECTION_BODY(BlendStateWithClipData);
 
     public:
-        int                          clip_count;
-        std::vector<AnimationClip>   blend_clip;
-        std::vector<AnimSkelMap>     blend_anim_skel_map;
+        int clip_count;
+
+        // shared with the AnimationManager caches, never modified after loading
+        META(Disable)
+        std::vector<std::shared_ptr<const AnimationClip>> blend_clip;
+        META(Disable)
+        std::vector<std::shared_ptr<const AnimSkelMap>> blend_anim_skel_map;
+        // sampled instead of blend_clip when not null
+        META(Disable)
+        std::vector<std::shared_ptr<const CompressedAnimationClip>> blend_compressed_clip;
+
         std::vector<BoneBlendWeight> blend_weight;
         std::vector<float>           blend_ratio;
     };
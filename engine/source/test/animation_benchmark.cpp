@@ -0,0 +1,172 @@
+#include "runtime/core/base/thread_pool.h"
+
+#include "runtime/function/animation/skeleton.h"
+
+#include "runtime/resource/res_type/data/animation_clip.h"
+#include "runtime/resource/res_type/data/animation_skeleton_node_map.h"
+#include "runtime/resource/res_type/data/blend_state.h"
+#include "runtime/resource/res_type/data/skeleton_data.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Sammi;
+using namespace Piccolo;
+
+namespace
+{
+    void printUsage()
+    {
+        std::cout << "usage: SammiAnimationBenchmark [character count] [bone count] [frame count]\n"
+                     "  evaluates a crowd of skinned characters once per frame with 1 to hardware_concurrency\n"
+                     "  threads, the same way the level animation stage does, and prints the scaling\n";
+    }
+
+    // a chain of bones, every bone is offset along its parent and keeps the identity bind pose
+    SkeletonData buildSkeletonData(int bone_count)
+    {
+        SkeletonData skeleton_data;
+        skeleton_data.is_flat              = true;
+        skeleton_data.in_topological_order = true;
+        skeleton_data.root_index           = 0;
+        skeleton_data.bones_map.resize(bone_count);
+        for (int bone_index = 0; bone_index < bone_count; ++bone_index)
+        {
+            RawBone& bone     = skeleton_data.bones_map[bone_index];
+            bone.name         = "bone_" + std::to_string(bone_index);
+            bone.index        = bone_index;
+            bone.parent_index = bone_index - 1;
+            bone.binding_pose = Transform(Vector3(0.0f, 0.0f, 0.1f), Quaternion::IDENTITY, Vector3::UNIT_SCALE);
+            bone.tpose_matrix = Matrix4x4().toMatrix4x4_();
+        }
+        return skeleton_data;
+    }
+
+    // every channel bends its bone around z, one key per frame
+    std::shared_ptr<AnimationClip> buildAnimationClip(int bone_count, int frame_count)
+    {
+        auto clip         = std::make_shared<AnimationClip>();
+        clip->total_frame = frame_count;
+        clip->node_count  = bone_count;
+        clip->node_channels.resize(bone_count);
+        for (int bone_index = 0; bone_index < bone_count; ++bone_index)
+        {
+            AnimationChannel& channel = clip->node_channels[bone_index];
+            channel.name              = "bone_" + std::to_string(bone_index);
+            for (int frame = 0; frame < frame_count; ++frame)
+            {
+                const float angle = 0.5f * std::sin(0.1f * frame + 0.3f * bone_index);
+                channel.position_keys.push_back(Vector3::ZERO);
+                channel.rotation_keys.push_back(Quaternion(Radian(angle), Vector3::UNIT_Z));
+                channel.scaling_keys.push_back(Vector3::UNIT_SCALE);
+            }
+        }
+        return clip;
+    }
+
+    struct Character
+    {
+        Skeleton               skeleton;
+        BlendStateWithClipData blend_state;
+        std::vector<Matrix4x4> joint_matrices;
+    };
+
+    // ms per frame of evaluating every character frame_count times with the given pool, nullptr is serial
+    double evaluateCrowd(std::vector<Character>& characters, ThreadPool* thread_pool, int frame_count)
+    {
+        auto evaluate = [&](size_t begin, size_t end) {
+            for (size_t index = begin; index < end; ++index)
+            {
+                Character& character = characters[index];
+                character.skeleton.applyAnimation(character.blend_state);
+                character.skeleton.outputJointMatrices(character.joint_matrices.data());
+            }
+        };
+
+        const auto start_time = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frame_count; ++frame)
+        {
+            for (size_t index = 0; index < characters.size(); ++index)
+            {
+                characters[index].blend_state.blend_ratio[0] =
+                    std::fmod((frame + static_cast<float>(index)) / frame_count, 1.0f);
+            }
+
+            if (thread_pool)
+            {
+                // same grain as Level::tickAnimations
+                const size_t grain_size =
+                    std::max<size_t>(1, characters.size() / (4 * (thread_pool->getThreadCount() + 1)));
+                thread_pool->parallelFor(characters.size(), grain_size, evaluate);
+            }
+            else
+            {
+                evaluate(0, characters.size());
+            }
+        }
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start_time;
+        return elapsed.count() / frame_count;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && std::string(argv[1]) == "--help")
+    {
+        printUsage();
+        return 0;
+    }
+
+    const int character_count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 512;
+    const int bone_count      = argc > 2 ? std::max(1, std::atoi(argv[2])) : 64;
+    const int frame_count     = argc > 3 ? std::max(1, std::atoi(argv[3])) : 120;
+
+    const SkeletonData                   skeleton_data = buildSkeletonData(bone_count);
+    std::shared_ptr<const AnimationClip> clip          = buildAnimationClip(bone_count, 60);
+
+    auto anim_skel_map = std::make_shared<AnimSkelMap>();
+    for (int bone_index = 0; bone_index < bone_count; ++bone_index)
+    {
+        anim_skel_map->convert.push_back(bone_index);
+    }
+
+    std::vector<Character> characters(character_count);
+    for (Character& character : characters)
+    {
+        character.skeleton.buildSkeleton(skeleton_data);
+        character.blend_state.clip_count = 1;
+        character.blend_state.blend_clip.push_back(clip);
+        character.blend_state.blend_anim_skel_map.push_back(anim_skel_map);
+        character.blend_state.blend_ratio.push_back(0.0f);
+        character.joint_matrices.resize(bone_count);
+    }
+
+    std::cout << character_count << " characters, " << bone_count << " bones, " << frame_count << " frames\n";
+
+    // warm up the caches and the allocations of the first frames
+    evaluateCrowd(characters, nullptr, 1);
+    const double serial_time_ms = evaluateCrowd(characters, nullptr, frame_count);
+    std::cout << "threads  1: " << serial_time_ms << " ms/frame\n";
+
+    // the calling thread takes chunks too, a pool of n workers runs on n + 1 threads
+    const size_t hardware_thread_count = std::max<size_t>(2, std::thread::hardware_concurrency());
+    for (size_t thread_count = 2; thread_count <= hardware_thread_count;
+         thread_count = (thread_count * 2 > hardware_thread_count && thread_count < hardware_thread_count) ?
+                            hardware_thread_count :
+                            thread_count * 2)
+    {
+        ThreadPool thread_pool(thread_count - 1);
+        evaluateCrowd(characters, &thread_pool, 1);
+        const double time_ms = evaluateCrowd(characters, &thread_pool, frame_count);
+        std::cout << "threads " << (thread_count < 10 ? " " : "") << thread_count << ": " << time_ms
+                  << " ms/frame, speedup " << serial_time_ms / time_ms << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,230 @@
+#include "runtime/core/meta/json.h"
+#include "runtime/core/meta/reflection/reflection_register.h"
+#include "runtime/core/meta/serializer/json_document_serializer.h"
+#include "runtime/core/meta/serializer/serializer.h"
+
+#include "runtime/resource/res_type/common/level.h"
+#include "runtime/resource/res_type/common/object.h"
+#include "runtime/resource/res_type/common/world.h"
+#include "runtime/resource/res_type/data/animation_clip.h"
+#include "runtime/resource/res_type/data/animation_skeleton_node_map.h"
+#include "runtime/resource/res_type/data/material.h"
+#include "runtime/resource/res_type/data/skeleton_data.h"
+#include "runtime/resource/res_type/data/skeleton_mask.h"
+#include "runtime/resource/res_type/global/global_particle.h"
+#include "runtime/resource/res_type/global/global_rendering.h"
+
+#include "_generated/serializer/all_json_document_serializer.h"
+#include "_generated/serializer/all_serializer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace Sammi;
+using namespace Piccolo;
+
+namespace
+{
+    void printUsage()
+    {
+        std::cout << "usage: SammiJsonBenchmark <asset folder> [iteration count]\n"
+                     "  parses every *.json under the folder with json11 and with JsonDocument, and deserializes the\n"
+                     "  asset types the runtime loads through Serializer and JsonDocumentSerializer, prints bytes/s\n";
+    }
+
+    bool hasSuffix(const std::string& name, const char* suffix)
+    {
+        const size_t suffix_length = std::strlen(suffix);
+        return name.size() >= suffix_length && name.compare(name.size() - suffix_length, suffix_length, suffix) == 0;
+    }
+
+    // the old path: a std::string copy of the file, json11 values, then the generated Json readers
+    template<typename AssetType>
+    bool loadWithJson(const std::string& text)
+    {
+        const std::string asset_json_text(text);
+        std::string       error;
+        const Json        asset_json = Json::parse(asset_json_text, error);
+        if (!error.empty())
+            return false;
+
+        AssetType asset;
+        Serializer::read(asset_json, asset);
+        return true;
+    }
+
+    // the AssetManager path: parsed where the file is mapped, read without building json11 values
+    template<typename AssetType>
+    bool loadWithDocument(const std::string& text)
+    {
+        JsonDocument asset_document;
+        if (!asset_document.parse(text.data(), text.size()))
+            return false;
+
+        AssetType asset;
+        JsonDocumentSerializer::read(asset_document.getRoot(), asset);
+        return true;
+    }
+
+    typedef bool (*LoadFunc)(const std::string&);
+
+    struct AssetLoader
+    {
+        const char* m_suffix;
+        LoadFunc    m_load_with_json;
+        LoadFunc    m_load_with_document;
+    };
+
+    template<typename T>
+    AssetLoader makeAssetLoader(const char* suffix)
+    {
+        return AssetLoader {suffix, &loadWithJson<T>, &loadWithDocument<T>};
+    }
+
+    // the suffixes the runtime loads as the given type, other json files are only parsed
+    const std::vector<AssetLoader>& getAssetLoaders()
+    {
+        static const std::vector<AssetLoader> asset_loaders = {
+            makeAssetLoader<WorldRes>(".world.json"),
+            makeAssetLoader<LevelRes>(".level.json"),
+            makeAssetLoader<ObjectDefinitionRes>(".object.json"),
+            makeAssetLoader<MaterialRes>(".material.json"),
+            makeAssetLoader<AnimationAsset>(".animation_clip.json"),
+            makeAssetLoader<SkeletonData>(".skeleton.json"),
+            makeAssetLoader<AnimSkelMap>(".skeleton_map.json"),
+            makeAssetLoader<BoneBlendMask>(".skeleton_mask.json"),
+            makeAssetLoader<GlobalRenderingRes>("rendering.global.json"),
+            makeAssetLoader<GlobalParticleRes>("particle.global.json"),
+        };
+        return asset_loaders;
+    }
+
+    struct AssetText
+    {
+        std::string        m_path;
+        std::string        m_text;
+        const AssetLoader* m_loader {nullptr};
+    };
+
+    // MB/s of running the task over every text iteration_count times, the files are in memory beforehand
+    template<typename Task>
+    double measureThroughput(const std::vector<const AssetText*>& assets, int iteration_count, Task task)
+    {
+        size_t total_size = 0;
+        for (const AssetText* asset : assets)
+        {
+            total_size += asset->m_text.size();
+        }
+
+        const auto start_time = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < iteration_count; ++iteration)
+        {
+            for (const AssetText* asset : assets)
+            {
+                if (!task(*asset))
+                {
+                    std::cerr << "failed to read " << asset->m_path << "\n";
+                    std::exit(1);
+                }
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+        return static_cast<double>(total_size) * iteration_count / elapsed.count() / (1024.0 * 1024.0);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || std::string(argv[1]) == "--help")
+    {
+        printUsage();
+        return argc < 2 ? 1 : 0;
+    }
+
+    const std::filesystem::path asset_folder(argv[1]);
+    const int                   iteration_count = argc > 2 ? std::max(1, std::atoi(argv[2])) : 200;
+    if (!std::filesystem::is_directory(asset_folder))
+    {
+        std::cerr << "folder " << asset_folder.generic_string() << " does not exist\n";
+        return 1;
+    }
+
+    // ReflectionPtr members go through the type tables, as in SammiEngine::startEngine
+    Reflection::TypeMetaRegister::metaRegister();
+    JsonDocumentSerializer::registerTypes();
+
+    std::vector<AssetText> assets;
+    for (const auto& directory_entry : std::filesystem::recursive_directory_iterator(asset_folder))
+    {
+        const std::string file_name = directory_entry.path().filename().generic_string();
+        if (!directory_entry.is_regular_file() || !hasSuffix(file_name, ".json"))
+            continue;
+
+        std::ifstream asset_file(directory_entry.path(), std::ios::binary);
+        AssetText     asset;
+        asset.m_path = directory_entry.path().generic_string();
+        asset.m_text.assign(std::istreambuf_iterator<char>(asset_file), std::istreambuf_iterator<char>());
+        for (const AssetLoader& asset_loader : getAssetLoaders())
+        {
+            if (hasSuffix(file_name, asset_loader.m_suffix))
+            {
+                asset.m_loader = &asset_loader;
+                break;
+            }
+        }
+        assets.push_back(std::move(asset));
+    }
+
+    std::vector<const AssetText*> all_assets;
+    std::vector<const AssetText*> typed_assets;
+    size_t                        all_size   = 0;
+    size_t                        typed_size = 0;
+    for (const AssetText& asset : assets)
+    {
+        all_assets.push_back(&asset);
+        all_size += asset.m_text.size();
+        if (asset.m_loader)
+        {
+            typed_assets.push_back(&asset);
+            typed_size += asset.m_text.size();
+        }
+    }
+    std::cout << all_assets.size() << " json files (" << all_size << " bytes), " << typed_assets.size()
+              << " of a known asset type (" << typed_size << " bytes), " << iteration_count << " iterations\n";
+
+    const double json_parse_rate = measureThroughput(all_assets, iteration_count, [](const AssetText& asset) {
+        std::string error;
+        Json::parse(asset.m_text, error);
+        return error.empty();
+    });
+    const double document_parse_rate = measureThroughput(all_assets, iteration_count, [](const AssetText& asset) {
+        JsonDocument asset_document;
+        return asset_document.parse(asset.m_text.data(), asset.m_text.size());
+    });
+    std::cout << "parse json11:        " << json_parse_rate << " MB/s\n"
+              << "parse JsonDocument:  " << document_parse_rate << " MB/s, speedup "
+              << document_parse_rate / json_parse_rate << "\n";
+
+    if (!typed_assets.empty())
+    {
+        const double json_load_rate = measureThroughput(typed_assets, iteration_count, [](const AssetText& asset) {
+            return asset.m_loader->m_load_with_json(asset.m_text);
+        });
+        const double document_load_rate =
+            measureThroughput(typed_assets, iteration_count, [](const AssetText& asset) {
+                return asset.m_loader->m_load_with_document(asset.m_text);
+            });
+        std::cout << "load Serializer:     " << json_load_rate << " MB/s\n"
+                  << "load JsonDocument:   " << document_load_rate << " MB/s, speedup "
+                  << document_load_rate / json_load_rate << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,320 @@
+#include "runtime/core/base/macro.h"
+#include "runtime/core/meta/reflection/reflection_register.h"
+#include "runtime/core/meta/serializer/binary_serializer.h"
+#include "runtime/core/meta/serializer/json_document_serializer.h"
+
+#include "runtime/function/animation/animation_loader.h"
+#include "runtime/function/animation/animation_system.h"
+#include "runtime/function/global/global_context.h"
+#include "runtime/function/render/render_resource.h"
+
+#include "runtime/resource/asset_manager/asset_manager.h"
+#include "runtime/resource/config_manager/config_manager.h"
+#include "runtime/resource/res_type/data/material.h"
+#include "runtime/resource/res_type/global/global_rendering.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Sammi;
+using namespace Piccolo;
+
+namespace
+{
+    void printUsage()
+    {
+        std::cout << "usage: SammiAssetCooker <config file> [--force] [--animation-tolerance <position> <rotation> "
+                     "<scale>] [--ibl-format rgba16f|e5b9g9r9] [folder...]\n"
+                     "  cooks the sources under the given folders (default: the AssetFolder of the config) next to\n"
+                     "  them, the runtime loads a cooked file while it is newer than its source:\n"
+                     "    *.obj, *.mesh.json -> *.mesh\n"
+                     "    *.animation_clip.json -> *.anim, keys dropped within the tolerances (model units, radians)\n"
+                     "    *.material.json -> *.tex next to every texture it references\n"
+                     "  and the skybox faces of the GlobalRenderingRes of the config into one .ibl\n"
+                     "  up to date outputs are skipped unless --force is given\n";
+    }
+
+    // a tolerance is a whole non negative number, anything else is a usage error
+    bool parseTolerance(const char* text, float& tolerance)
+    {
+        char* end = nullptr;
+        tolerance = std::strtof(text, &end);
+        return end != text && *end == '\0' && tolerance >= 0.0f;
+    }
+
+    bool hasSuffix(const std::string& name, const char* suffix)
+    {
+        const size_t suffix_length = std::strlen(suffix);
+        return name.size() >= suffix_length && name.compare(name.size() - suffix_length, suffix_length, suffix) == 0;
+    }
+
+    struct CookStatistics
+    {
+        size_t m_cooked_count {0};
+        size_t m_skipped_count {0};
+        size_t m_failed_count {0};
+    };
+
+    class AssetCooker
+    {
+    public:
+        explicit AssetCooker(bool is_forced) : m_is_forced(is_forced) {}
+
+        // the irradiance and specular cubemaps of the global rendering resource, as RenderSystem uploads them
+        void cookGlobalIBL(IBLCookFormat format)
+        {
+            const std::string& global_rendering_res_url =
+                g_runtime_global_context.m_config_manager->getGlobalRenderingResUrl();
+
+            GlobalRenderingRes global_rendering_res;
+            if (!g_runtime_global_context.m_asset_manager->loadAsset(global_rendering_res_url, global_rendering_res))
+            {
+                count(false, global_rendering_res_url);
+                return;
+            }
+
+            LevelIBLResourceDesc ibl_resource_desc;
+            ibl_resource_desc.m_skybox_irradiance_map = global_rendering_res.m_skybox_irradiance_map;
+            ibl_resource_desc.m_skybox_specular_map   = global_rendering_res.m_skybox_specular_map;
+            ibl_resource_desc.m_brdf_map              = global_rendering_res.m_brdf_map;
+
+            if (!m_is_forced && RenderResourceBase::isIBLDataUpToDate(ibl_resource_desc))
+            {
+                ++m_statistics.m_skipped_count;
+                return;
+            }
+            count(m_render_resource.cookIBLData(ibl_resource_desc, format), global_rendering_res_url);
+        }
+
+        void cookFile(const std::filesystem::path& file)
+        {
+            const std::string file_url  = file.generic_string();
+            const std::string file_name = file.filename().generic_string();
+            if (hasSuffix(file_name, ".obj") || hasSuffix(file_name, ".mesh.json"))
+            {
+                cookMesh(file_url);
+            }
+            else if (hasSuffix(file_name, ".animation_clip.json"))
+            {
+                cookAnimation(file_url);
+            }
+            else if (hasSuffix(file_name, ".material.json"))
+            {
+                cookMaterial(file_url);
+            }
+        }
+
+        const CookStatistics& getStatistics() const { return m_statistics; }
+
+    private:
+        bool isUpToDate(const std::string& source_url, const std::string& cooked_url) const
+        {
+            return !m_is_forced &&
+                   g_runtime_global_context.m_asset_manager->isDerivedAssetUpToDate(source_url, cooked_url);
+        }
+
+        void count(bool is_cooked, const std::string& source_url)
+        {
+            if (is_cooked)
+            {
+                ++m_statistics.m_cooked_count;
+                LOG_INFO("cooked {}", source_url);
+            }
+            else
+            {
+                ++m_statistics.m_failed_count;
+                LOG_ERROR("failed to cook {}", source_url);
+            }
+        }
+
+        void cookMesh(const std::string& mesh_url)
+        {
+            if (isUpToDate(mesh_url, RenderResourceBase::getCookedMeshUrl(mesh_url)))
+            {
+                ++m_statistics.m_skipped_count;
+                return;
+            }
+
+            MeshSourceDesc mesh_source;
+            mesh_source.m_mesh_file = mesh_url;
+            count(m_render_resource.cookMeshData(mesh_source), mesh_url);
+        }
+
+        void cookAnimation(const std::string& animation_clip_url)
+        {
+            if (isUpToDate(animation_clip_url, AnimationLoader::getCompressedAnimationClipUrl(animation_clip_url)))
+            {
+                ++m_statistics.m_skipped_count;
+                return;
+            }
+            count(AnimationManager::cookAnimation(animation_clip_url), animation_clip_url);
+        }
+
+        // textures take the settings of the slot they are bound to, so they are cooked through their material
+        void cookMaterial(const std::string& material_url)
+        {
+            std::shared_ptr<AssetManager> asset_manager = g_runtime_global_context.m_asset_manager;
+
+            MaterialRes material_res;
+            if (!asset_manager->loadAsset(material_url, material_res))
+            {
+                count(false, material_url);
+                return;
+            }
+
+            // same urls as MeshComponent::postLoadResource, so the runtime finds the cooked files
+            auto getTextureUrl = [&](const std::string& texture_file) {
+                return texture_file.empty() ? texture_file : asset_manager->getFullPath(texture_file).generic_string();
+            };
+            MaterialSourceDesc material_source;
+            material_source.m_base_color_file         = getTextureUrl(material_res.m_base_colour_texture_file);
+            material_source.m_metallic_roughness_file = getTextureUrl(material_res.m_metallic_roughness_texture_file);
+            material_source.m_normal_file             = getTextureUrl(material_res.m_normal_texture_file);
+            material_source.m_occlusion_file          = getTextureUrl(material_res.m_occlusion_texture_file);
+            material_source.m_emissive_file           = getTextureUrl(material_res.m_emissive_texture_file);
+
+            // textures shared by several materials are cooked by the first one only
+            bool is_up_to_date = true;
+            for (const std::string* texture_url : {&material_source.m_base_color_file,
+                                                   &material_source.m_metallic_roughness_file,
+                                                   &material_source.m_normal_file,
+                                                   &material_source.m_occlusion_file,
+                                                   &material_source.m_emissive_file})
+            {
+                if (!texture_url->empty() &&
+                    !isUpToDate(*texture_url, RenderResourceBase::getCookedTextureUrl(*texture_url)))
+                {
+                    is_up_to_date = false;
+                }
+            }
+            if (is_up_to_date)
+            {
+                ++m_statistics.m_skipped_count;
+                return;
+            }
+
+            // cookTextureData spreads the block encoding over the thread pool, materials are cooked one at a time
+            count(m_render_resource.cookMaterialData(material_source), material_url);
+        }
+
+        bool           m_is_forced {false};
+        CookStatistics m_statistics;
+        // only its cook functions are used, nothing is uploaded
+        RenderResource m_render_resource;
+    };
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printUsage();
+        return 1;
+    }
+
+    bool                         is_forced  = false;
+    IBLCookFormat                ibl_format = IBLCookFormat::e5b9g9r9;
+    AnimationCompressionSettings animation_compression_settings;
+    std::vector<std::string>     folders;
+    for (int index = 2; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--force") == 0)
+        {
+            is_forced = true;
+        }
+        else if (std::strcmp(argv[index], "--animation-tolerance") == 0)
+        {
+            if (index + 3 >= argc ||
+                !parseTolerance(argv[index + 1], animation_compression_settings.m_position_tolerance) ||
+                !parseTolerance(argv[index + 2], animation_compression_settings.m_rotation_tolerance) ||
+                !parseTolerance(argv[index + 3], animation_compression_settings.m_scale_tolerance))
+            {
+                std::cerr << "--animation-tolerance needs three non negative numbers\n";
+                printUsage();
+                return 1;
+            }
+            index += 3;
+        }
+        else if (std::strcmp(argv[index], "--ibl-format") == 0)
+        {
+            const char* format = index + 1 < argc ? argv[++index] : "";
+            if (std::strcmp(format, "rgba16f") == 0)
+            {
+                ibl_format = IBLCookFormat::rgba16f;
+            }
+            else if (std::strcmp(format, "e5b9g9r9") == 0)
+            {
+                ibl_format = IBLCookFormat::e5b9g9r9;
+            }
+            else
+            {
+                std::cerr << "unknown --ibl-format '" << format << "'\n";
+                printUsage();
+                return 1;
+            }
+        }
+        else
+        {
+            folders.emplace_back(argv[index]);
+        }
+    }
+
+    Reflection::TypeMetaRegister::metaRegister();
+    BinarySerializer::registerTypes();
+    JsonDocumentSerializer::registerTypes();
+    g_runtime_global_context.startToolSystems(std::filesystem::absolute(argv[1]).generic_string());
+    AnimationManager::setCompressionSettings(animation_compression_settings);
+
+    const std::filesystem::path root_folder = g_runtime_global_context.m_config_manager->getRootFolder();
+    std::vector<std::filesystem::path> folder_paths;
+    for (const std::string& folder : folders)
+    {
+        folder_paths.push_back(root_folder / folder);
+    }
+    if (folder_paths.empty())
+    {
+        folder_paths.push_back(g_runtime_global_context.m_config_manager->getAssetFolder());
+    }
+
+    // sorted so the log of two runs over the same tree can be compared
+    std::vector<std::filesystem::path> files;
+    for (const std::filesystem::path& folder_path : folder_paths)
+    {
+        if (!std::filesystem::is_directory(folder_path))
+        {
+            std::cerr << "folder " << folder_path.generic_string() << " does not exist\n";
+            g_runtime_global_context.shutdownSystems();
+            return 1;
+        }
+        for (const auto& directory_entry : std::filesystem::recursive_directory_iterator(folder_path))
+        {
+            if (directory_entry.is_regular_file())
+            {
+                files.push_back(std::filesystem::absolute(directory_entry.path()).lexically_normal());
+            }
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    CookStatistics statistics;
+    {
+        AssetCooker cooker(is_forced);
+        cooker.cookGlobalIBL(ibl_format);
+        for (const std::filesystem::path& file : files)
+        {
+            cooker.cookFile(file);
+        }
+        statistics = cooker.getStatistics();
+    }
+
+    std::cout << "cooked " << statistics.m_cooked_count << ", up to date " << statistics.m_skipped_count
+              << ", failed " << statistics.m_failed_count << "\n";
+
+    g_runtime_global_context.shutdownSystems();
+    return statistics.m_failed_count == 0 ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+#include "runtime/platform/file_service/mapped_file.h"
+#include "runtime/platform/file_service/pak_archive.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Sammi;
+
+namespace
+{
+    void printUsage()
+    {
+        std::cout << "usage: SammiAssetPacker <root folder> <output pak> [--compress] [--alignment <bytes>] "
+                     "[--verify] [folder...]\n"
+                     "  packs every file under the given folders (default: asset) relative to the root folder,\n"
+                     "  the root folder is the BinaryRootFolder of the engine config\n";
+    }
+
+    // formats with their own entropy coding don't shrink, storing them keeps their reads zero copy
+    bool isPrecompressedFile(const std::filesystem::path& path)
+    {
+        std::string extension = path.extension().generic_string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        return extension == ".png" || extension == ".jpg" || extension == ".jpeg";
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printUsage();
+        return 1;
+    }
+
+    const std::filesystem::path root_folder = std::filesystem::absolute(argv[1]);
+    const std::filesystem::path output_path = argv[2];
+
+    bool                     is_compressing = false;
+    bool                     is_verifying   = false;
+    uint32_t                 alignment      = k_pak_default_alignment;
+    std::vector<std::string> folders;
+    for (int index = 3; index < argc; ++index)
+    {
+        if (std::strcmp(argv[index], "--compress") == 0)
+        {
+            is_compressing = true;
+        }
+        else if (std::strcmp(argv[index], "--verify") == 0)
+        {
+            is_verifying = true;
+        }
+        else if (std::strcmp(argv[index], "--alignment") == 0 && index + 1 < argc)
+        {
+            alignment = static_cast<uint32_t>(std::strtoul(argv[++index], nullptr, 10));
+            if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+            {
+                std::cerr << "alignment must be a power of two\n";
+                return 1;
+            }
+        }
+        else
+        {
+            folders.emplace_back(argv[index]);
+        }
+    }
+    if (folders.empty())
+    {
+        folders.emplace_back("asset");
+    }
+
+    // sorted so the same tree always produces the same archive
+    std::vector<std::filesystem::path> files;
+    for (const std::string& folder : folders)
+    {
+        const std::filesystem::path folder_path = root_folder / folder;
+        if (!std::filesystem::is_directory(folder_path))
+        {
+            std::cerr << "folder " << folder_path.generic_string() << " does not exist\n";
+            return 1;
+        }
+        for (const auto& directory_entry : std::filesystem::recursive_directory_iterator(folder_path))
+        {
+            if (directory_entry.is_regular_file())
+            {
+                files.push_back(directory_entry.path());
+            }
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    PakWriter writer(alignment);
+    for (const std::filesystem::path& file : files)
+    {
+        const std::string entry_path = normalizePakEntryPath(file.lexically_relative(root_folder));
+
+        // MappedFile does not map empty files
+        if (std::filesystem::file_size(file) == 0)
+        {
+            writer.addEntry(entry_path, nullptr, 0, PakCompression::none);
+            continue;
+        }
+
+        MappedFile mapped_file;
+        if (!mapped_file.open(file))
+        {
+            std::cerr << "failed to read " << file.generic_string() << "\n";
+            return 1;
+        }
+        const PakCompression compression =
+            is_compressing && !isPrecompressedFile(file) ? PakCompression::lz4 : PakCompression::none;
+        writer.addEntry(entry_path, mapped_file.getData(), mapped_file.getSize(), compression);
+    }
+
+    if (!writer.write(output_path))
+    {
+        std::cerr << "failed to write " << output_path.generic_string() << "\n";
+        return 1;
+    }
+    std::cout << "packed " << writer.getEntryCount() << " files, " << writer.getOriginalSize() << " bytes stored as "
+              << writer.getStoredSize() << " bytes into " << output_path.generic_string() << "\n";
+
+    if (is_verifying)
+    {
+        PakArchive archive;
+        if (!archive.open(output_path))
+        {
+            std::cerr << "failed to open " << output_path.generic_string() << "\n";
+            return 1;
+        }
+        for (size_t index = 0; index < archive.getEntryCount(); ++index)
+        {
+            const PakEntry& entry = archive.getEntry(index);
+            if (!archive.verifyEntry(entry) || archive.findEntry(archive.getEntryName(entry)) != &entry)
+            {
+                std::cerr << "entry " << archive.getEntryName(entry) << " is corrupted\n";
+                return 1;
+            }
+        }
+        std::cout << "verified " << archive.getEntryCount() << " entries\n";
+    }
+    return 0;
+}